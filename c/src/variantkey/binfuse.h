@@ -0,0 +1,374 @@
+// VariantKey
+//
+// binfuse.h
+//
+// @category   Libraries
+// @author     Nicola Asuni <nicola.asuni@genomicsplc.com>
+// @copyright  2017-2018 GENOMICS plc
+// @license    MIT (see LICENSE)
+// @link       https://github.com/genomicsplc/variantkey
+//
+// LICENSE
+//
+// Copyright (c) 2017-2018 GENOMICS plc
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+/**
+ * @file binfuse.h
+ * @brief Binary fuse filter for sorted uint64 columns.
+ *
+ * The functions provided here build and query a binary fuse filter (8-bit fingerprints, 3-wise)
+ * for a column of unsigned 64-bit integers (e.g. the VariantKey column of NRVK or VKRS files).
+ * The filter answers "the key is not in the column" with no false negatives
+ * and about 0.4% false positives, using about 9 bits per key.
+ * A query reads three bytes from the filter, so most lookup misses can be rejected
+ * without touching the (possibly cold) memory mapped column.
+ *
+ * The filter is stored as a BINSRC1 file with two columns:
+ *   - info (uint64_t, BINFUSE_INFO_SIZE items): version, seed, segment length, segment count length,
+ *     number of fingerprints, number of distinct keys, number of rows of the source column
+ *     and check value of the first and last key of the source column;
+ *   - fingerprints (uint8_t).
+ * The info column is immediately followed by the fingerprints,
+ * so the whole filter is referenced by a pointer to the info column.
+ */
+
+#ifndef VARIANTKEY_BINFUSE_H
+#define VARIANTKEY_BINFUSE_H
+
+#include <stdlib.h>
+#include <string.h>
+#include "binsearch.h"
+
+#define BINFUSE_VERSION      1   //!< Version of the binary fuse filter format.
+#define BINFUSE_INFO_SIZE    8   //!< Number of uint64_t items of the info column.
+#define BINFUSE_MAX_ATTEMPTS 100 //!< Maximum number of seeds tried to build the filter.
+
+#define BINFUSE_INFO_VERSION 0 //!< Info item containing the format version.
+#define BINFUSE_INFO_SEED    1 //!< Info item containing the hash seed.
+#define BINFUSE_INFO_SEGLEN  2 //!< Info item containing the segment length (power of 2).
+#define BINFUSE_INFO_SCLEN   3 //!< Info item containing the segment count length.
+#define BINFUSE_INFO_NFP     4 //!< Info item containing the number of fingerprints.
+#define BINFUSE_INFO_NKEYS   5 //!< Info item containing the number of distinct keys.
+#define BINFUSE_INFO_NROWS   6 //!< Info item containing the number of rows of the source column.
+#define BINFUSE_INFO_CHECK   7 //!< Info item containing the check value of the first and last key of the source column.
+
+static inline uint64_t binfuse_mix(uint64_t key, uint64_t seed)
+{
+    // murmur3 64-bit finalizer
+    uint64_t h = (key + seed);
+    h ^= (h >> 33);
+    h *= 0xff51afd7ed558ccd;
+    h ^= (h >> 33);
+    h *= 0xc4ceb9fe1a85ec53;
+    h ^= (h >> 33);
+    return h;
+}
+
+static inline uint64_t binfuse_check(const uint64_t *src, uint64_t nrows)
+{
+    return (nrows > 0) ? binfuse_mix(src[0], binfuse_mix(src[(nrows - 1)], nrows)) : 0;
+}
+
+static inline void binfuse_hash(uint64_t h, uint64_t seglen, uint64_t sclen, uint64_t *hh)
+{
+    uint64_t mask = (seglen - 1);
+    hh[0] = (((h >> 32) * sclen) >> 32);
+    hh[1] = ((hh[0] + seglen) ^ ((h >> 18) & mask));
+    hh[2] = ((hh[0] + (2 * seglen)) ^ (h & mask));
+}
+
+static inline uint8_t binfuse_fingerprint(uint64_t h)
+{
+    return (uint8_t)(h ^ (h >> 32));
+}
+
+/**
+ * Check if the key may be contained in the filter.
+ *
+ * @param filter    Pointer to the filter (info column followed by the fingerprints).
+ * @param key       Key to search.
+ *
+ * @return 0 if the key is certainly not in the source column, 1 if it may be.
+ */
+static inline int binfuse_contain(const uint64_t *filter, uint64_t key)
+{
+    const uint8_t *fp = (const uint8_t *)(filter + BINFUSE_INFO_SIZE);
+    uint64_t hh[3];
+    uint64_t h = binfuse_mix(key, filter[BINFUSE_INFO_SEED]);
+    binfuse_hash(h, filter[BINFUSE_INFO_SEGLEN], filter[BINFUSE_INFO_SCLEN], hh);
+    return ((binfuse_fingerprint(h) ^ fp[hh[0]] ^ fp[hh[1]] ^ fp[hh[2]]) == 0);
+}
+
+/**
+ * Returns the number of uint64_t items needed to store the filter for the specified number of distinct keys.
+ *
+ * @param nkeys     Number of distinct keys.
+ * @param info      Info array of BINFUSE_INFO_SIZE items to be populated with the filter geometry.
+ *
+ * @return Number of uint64_t items of the filter (info column and fingerprints).
+ */
+static inline uint64_t binfuse_size(uint64_t nkeys, uint64_t *info)
+{
+    // segment length = 2^floor(log(n) / log(3.33) + 2.25), with log2(n) approximated by the bit length
+    uint64_t bits = 0, n = nkeys;
+    while (n > 0)
+    {
+        bits++;
+        n >>= 1;
+    }
+    uint64_t e = (uint64_t)(((double)bits / 1.7355) + 2.25);
+    if (e > 18)
+    {
+        e = 18;
+    }
+    uint64_t seglen = ((uint64_t)1 << e);
+    double factor = (bits > 1) ? (0.875 + (0.25 * 19.93 / (double)bits)) : 2.0;
+    if (factor < 1.125)
+    {
+        factor = 1.125;
+    }
+    uint64_t capacity = (uint64_t)((double)nkeys * factor);
+    uint64_t segcount = ((capacity + seglen - 1) / seglen);
+    segcount = (segcount > 2) ? (segcount - 2) : 1;
+    uint64_t nfp = ((segcount + 2) * seglen);
+    memset(info, 0, (BINFUSE_INFO_SIZE * sizeof(uint64_t)));
+    info[BINFUSE_INFO_VERSION] = BINFUSE_VERSION;
+    info[BINFUSE_INFO_SEGLEN] = seglen;
+    info[BINFUSE_INFO_SCLEN] = (segcount * seglen);
+    info[BINFUSE_INFO_NFP] = nfp;
+    info[BINFUSE_INFO_NKEYS] = nkeys;
+    return (BINFUSE_INFO_SIZE + ((nfp + 7) / 8));
+}
+
+static inline int binfuse_peel(const uint64_t *filter, const uint64_t *src, uint64_t nrows, uint64_t *hashes, uint32_t *count, uint64_t *cells, uint64_t *stack, uint8_t *pos)
+{
+    uint64_t seglen = filter[BINFUSE_INFO_SEGLEN];
+    uint64_t sclen = filter[BINFUSE_INFO_SCLEN];
+    uint64_t nfp = filter[BINFUSE_INFO_NFP];
+    uint64_t hh[5], h, i, c, nq = 0, ns = 0;
+    uint8_t j, k;
+    memset(hashes, 0, (size_t)(nfp * sizeof(uint64_t)));
+    memset(count, 0, (size_t)(nfp * sizeof(uint32_t)));
+    for (i = 0; i < nrows; i++)
+    {
+        if ((i > 0) && (src[i] == src[(i - 1)]))
+        {
+            continue; // duplicate key
+        }
+        h = binfuse_mix(src[i], filter[BINFUSE_INFO_SEED]);
+        binfuse_hash(h, seglen, sclen, hh);
+        for (k = 0; k < 3; k++)
+        {
+            count[hh[k]] += 4; // number of keys in the cell
+            count[hh[k]] ^= k; // xor of the key positions in the cell
+            hashes[hh[k]] ^= h;
+        }
+    }
+    for (i = 0; i < nfp; i++)
+    {
+        if ((count[i] >> 2) == 1)
+        {
+            cells[nq++] = i;
+        }
+    }
+    while (nq > 0)
+    {
+        c = cells[--nq];
+        if ((count[c] >> 2) != 1)
+        {
+            continue; // already peeled
+        }
+        h = hashes[c];
+        k = (uint8_t)(count[c] & 3);
+        stack[ns] = h;
+        pos[ns] = k;
+        ns++;
+        binfuse_hash(h, seglen, sclen, hh);
+        hh[3] = hh[0];
+        hh[4] = hh[1];
+        for (j = 1; j < 3; j++)
+        {
+            c = hh[(k + j)];
+            count[c] -= 4;
+            count[c] ^= (uint8_t)((k + j) % 3);
+            hashes[c] ^= h;
+            if ((count[c] >> 2) == 1)
+            {
+                cells[nq++] = c;
+            }
+        }
+        count[hh[k]] = 0;
+    }
+    return (ns == filter[BINFUSE_INFO_NKEYS]);
+}
+
+/**
+ * Build the binary fuse filter for a column sorted in ascending order.
+ *
+ * @param src       Column sorted in ascending order (duplicates are allowed).
+ * @param nrows     Number of rows of the column.
+ *
+ * @return Pointer to the filter (to be freed with free()) or NULL in case of error.
+ */
+static inline uint64_t *build_binfuse(const uint64_t *src, uint64_t nrows)
+{
+    uint64_t info[BINFUSE_INFO_SIZE];
+    uint64_t i, nkeys = 0;
+    for (i = 0; i < nrows; i++)
+    {
+        if ((i > 0) && (src[i] < src[(i - 1)]))
+        {
+            return NULL; // not sorted
+        }
+        nkeys += ((i == 0) || (src[i] != src[(i - 1)]));
+    }
+    uint64_t size = binfuse_size(nkeys, info);
+    uint64_t nfp = info[BINFUSE_INFO_NFP];
+    info[BINFUSE_INFO_NROWS] = nrows;
+    info[BINFUSE_INFO_CHECK] = binfuse_check(src, nrows);
+    uint64_t *filter = (uint64_t *)calloc((size_t)size, sizeof(uint64_t));
+    uint64_t *hashes = (uint64_t *)malloc((size_t)(nfp * sizeof(uint64_t)));
+    uint32_t *count = (uint32_t *)malloc((size_t)(nfp * sizeof(uint32_t)));
+    uint64_t *cells = (uint64_t *)malloc((size_t)((nfp + (2 * nkeys)) * sizeof(uint64_t))); // queue of cells with a single key
+    uint64_t *stack = (uint64_t *)malloc((size_t)((nkeys + 1) * sizeof(uint64_t))); // peeled key hashes
+    uint8_t *pos = (uint8_t *)malloc((size_t)(nkeys + 1)); // peeled key positions
+    int ok = 0;
+    if ((filter != NULL) && (hashes != NULL) && (count != NULL) && (cells != NULL) && (stack != NULL) && (pos != NULL))
+    {
+        memcpy(filter, info, sizeof(info));
+        uint64_t seed = 0x726b5b8a5b9f1c3d;
+        for (i = 0; (i < BINFUSE_MAX_ATTEMPTS) && !ok; i++)
+        {
+            seed = binfuse_mix(seed, i);
+            filter[BINFUSE_INFO_SEED] = seed;
+            ok = binfuse_peel(filter, src, nrows, hashes, count, cells, stack, pos);
+        }
+    }
+    if (ok)
+    {
+        // assign the fingerprints in the reverse peeling order
+        uint8_t *fp = (uint8_t *)(filter + BINFUSE_INFO_SIZE);
+        uint64_t hh[5], h;
+        uint8_t k;
+        for (i = nkeys; i > 0; i--)
+        {
+            h = stack[(i - 1)];
+            k = pos[(i - 1)];
+            binfuse_hash(h, info[BINFUSE_INFO_SEGLEN], info[BINFUSE_INFO_SCLEN], hh);
+            hh[3] = hh[0];
+            hh[4] = hh[1];
+            fp[hh[k]] = (uint8_t)(binfuse_fingerprint(h) ^ fp[hh[(k + 1)]] ^ fp[hh[(k + 2)]]);
+        }
+    }
+    free(hashes);
+    free(count);
+    free(cells);
+    free(stack);
+    free(pos);
+    if (!ok)
+    {
+        free(filter);
+        return NULL;
+    }
+    return filter;
+}
+
+/**
+ * Save the filter as a BINSRC1 file.
+ *
+ * @param file      Path of the output file. NOTE: existing files will be replaced.
+ * @param filter    Pointer to the filter.
+ *
+ * @return Number of bytes written or 0 in case of error.
+ */
+static inline size_t save_binfuse_file(const char *file, const uint64_t *filter)
+{
+    uint64_t nfp = filter[BINFUSE_INFO_NFP];
+    const uint8_t ctbytes[2] = {8, 1};
+    const uint64_t nitems[2] = {BINFUSE_INFO_SIZE, nfp};
+    FILE *fp = fopen(file, "we");
+    if (fp == NULL)
+    {
+        return 0;
+    }
+    uint8_t pad[8] = {0};
+    size_t npad = (size_t)((8 - (nfp & 7)) & 7);
+    size_t ret = write_binsrc1_header_nitems(fp, 2, ctbytes, nfp, nitems, NULL);
+    size_t exp = ret;
+    ret += fwrite(filter, 1, (size_t)((BINFUSE_INFO_SIZE * 8) + nfp), fp);
+    ret += fwrite(pad, 1, npad, fp);
+    exp += (size_t)((BINFUSE_INFO_SIZE * 8) + nfp + npad);
+    if ((fclose(fp) != 0) || (exp == 0) || (ret != exp))
+    {
+        return 0;
+    }
+    return ret;
+}
+
+/**
+ * Build the binary fuse filter for a column sorted in ascending order and save it as a BINSRC1 file.
+ *
+ * @param file      Path of the output file. NOTE: existing files will be replaced.
+ * @param src       Column sorted in ascending order (duplicates are allowed).
+ * @param nrows     Number of rows of the column.
+ *
+ * @return Number of bytes written or 0 in case of error.
+ */
+static inline size_t build_binfuse_file(const char *file, const uint64_t *src, uint64_t nrows)
+{
+    uint64_t *filter = build_binfuse(src, nrows);
+    if (filter == NULL)
+    {
+        return 0;
+    }
+    size_t ret = save_binfuse_file(file, filter);
+    free(filter);
+    return ret;
+}
+
+/**
+ * Memory map the binary fuse filter file.
+ *
+ * @param file      Path to the file to map.
+ * @param mf        Structure containing the memory mapped file.
+ * @param src       Column the filter must be built for.
+ * @param nrows     Number of rows of the column.
+ *
+ * @return Pointer to the filter or NULL if the file can't be mapped or doesn't match the column.
+ */
+static inline const uint64_t *mmap_binfuse_file(const char *file, mmfile_t *mf, const uint64_t *src, uint64_t nrows)
+{
+    mmap_binfile(file, mf);
+    if ((mf->fd < 0) || (mf->src == MAP_FAILED) || (mf->ncols != 2) || (mf->ctbytes[0] != 8) || (mf->ctbytes[1] != 1)
+            || ((mf->index[1] - mf->index[0]) != (BINFUSE_INFO_SIZE * 8)))
+    {
+        return NULL;
+    }
+    const uint64_t *filter = (const uint64_t *)(mf->src + mf->index[0]);
+    if ((filter[BINFUSE_INFO_VERSION] != BINFUSE_VERSION) || (filter[BINFUSE_INFO_NROWS] != nrows) || (filter[BINFUSE_INFO_NFP] != mf->nrows)
+            || (filter[BINFUSE_INFO_CHECK] != binfuse_check(src, nrows)))
+    {
+        return NULL;
+    }
+    return filter;
+}
+
+#endif  // VARIANTKEY_BINFUSE_H
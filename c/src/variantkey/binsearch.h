@@ -54,6 +54,8 @@
 #include <inttypes.h>
 #include <fcntl.h>
 #include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
@@ -295,17 +297,20 @@ define_get_src_offset(uint64_t)
     { \
         middle = get_middle_point(*first, *last); \
 
-#define FIND_END_LOOP_BLOCK \
-    if (x == search) \
-    { \
-        return middle; \
-    } \
+#define FIND_NOTFOUND_BLOCK \
     if (*first > 0) \
     { \
         --(*first); \
     } \
     return notfound;
 
+#define FIND_END_LOOP_BLOCK \
+    if (x == search) \
+    { \
+        return middle; \
+    } \
+    FIND_NOTFOUND_BLOCK
+
 #define SUB_ITEM_VARS(T) \
     T bitmask = ((T)1 << (bitend - bitstart)); \
     bitmask ^= (bitmask - 1); \
@@ -333,7 +338,11 @@ define_get_src_offset(uint64_t)
             *last = middle; \
         } \
     } \
-    middle = *first;
+    middle = *first; \
+    if (middle == notfound) /* do not read past the end */ \
+    { \
+        FIND_NOTFOUND_BLOCK \
+    }
 
 #define FIND_LAST_INNER_CHECK \
         if (x > search) { \
@@ -345,6 +354,10 @@ define_get_src_offset(uint64_t)
             ++(*first); \
         } \
     } \
+    if (*first == 0) /* do not read before the beginning */ \
+    { \
+        return notfound; \
+    } \
     middle = *first; \
     --middle;
 
@@ -921,6 +934,286 @@ define_col_has_prev_sub(uint16_t)
 define_col_has_prev_sub(uint32_t)
 define_col_has_prev_sub(uint64_t)
 
+/**
+ * Generic function to search the lower bound of an unsigned integer
+ * on a memory buffer containing contiguos blocks of unsigned integers of the same type,
+ * using a galloping (exponential) search from the start of the range.
+ *
+ * @param T Unsigned integer type, one of: uint8_t, uint16_t, uint32_t, uint64_t
+ */
+#define define_col_find_gallop(T) \
+/** Search for the position of the first item that is not less than the search value,
+using a galloping (exponential) search followed by a binary search.
+The cost is O(log d), where d is the distance of the result from first,
+so this is faster than col_find_first_##T when the searches are sorted and close to each other.
+The values must be encoded in Little-Endian format and sorted in ascending order.
+@param src       Memory mapped file address.
+@param first     First element of the range to search (min value = 0).
+@param last      Element (up to but not including) where to end the search (max value = nrows).
+@param search    Unsigned number to search (type T).
+@return Position of the first item not less than search, or last if all items are less than search.
+ */ \
+static inline uint64_t col_find_gallop_##T(const T *src, uint64_t first, uint64_t last, T search) \
+{ \
+    uint64_t middle, step = 1, pos = first; \
+    if ((first >= last) || (*(src + first) >= search)) \
+    { \
+        return first; \
+    } \
+    ++pos; \
+    while ((pos < last) && (*(src + pos) < search)) \
+    { \
+        first = pos; \
+        step <<= 1; \
+        pos = ((last - first) > step) ? (first + step) : last; \
+    } \
+    ++first; /* src[first - 1] < search <= src[pos] */ \
+    last = pos; \
+    while (first < last) \
+    { \
+        middle = get_middle_point(first, last); \
+        if (*(src + middle) < search) \
+        { \
+            first = middle + 1; \
+        } \
+        else \
+        { \
+            last = middle; \
+        } \
+    } \
+    return first; \
+}
+
+define_col_find_gallop(uint8_t)
+define_col_find_gallop(uint16_t)
+define_col_find_gallop(uint32_t)
+define_col_find_gallop(uint64_t)
+
+// --- BATCH ---
+
+#ifndef BINSEARCH_BATCH
+#define BINSEARCH_BATCH 16 //!< Number of searches interleaved by the *_batch functions.
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define binsearch_prefetch(addr) __builtin_prefetch((addr), 0, 0) //!< Prefetch the cache line containing addr.
+#else
+#define binsearch_prefetch(addr) //!< Prefetch not supported.
+#endif
+
+#define BATCH_GET_ITEM_TASK(O, T) \
+        x = bytes_##O##_to_##T(src, get_address(blklen, blkpos, p));
+
+#define BATCH_PREFETCH_TASK \
+        binsearch_prefetch(src + get_address(blklen, blkpos, p));
+
+#define COL_BATCH_GET_ITEM_TASK \
+        x = *(src + p);
+
+#define COL_BATCH_PREFETCH_TASK \
+        binsearch_prefetch(src + p);
+
+// Branchless binary search of up to BINSEARCH_BATCH keys in lockstep.
+// All the searches in a group share the same range length at each step, so the
+// memory accesses of each key are prefetched while the other keys are processed.
+// At the end base[j] contains the position of the first item not satisfying (item CMP search).
+#define BATCH_START_LOOP_BLOCK(T, GET_TASK, PREFETCH_TASK, CMP) \
+    uint64_t base[BINSEARCH_BATCH]; \
+    uint64_t i, j, m, n, half, p; \
+    T x; \
+    for (i = 0; i < nitems; i += m) \
+    { \
+        m = ((nitems - i) < BINSEARCH_BATCH) ? (nitems - i) : BINSEARCH_BATCH; \
+        n = last - first; \
+        for (j = 0; j < m; j++) \
+        { \
+            base[j] = first; \
+            p = first + (n >> 1); \
+            PREFETCH_TASK \
+        } \
+        while (n > 1) \
+        { \
+            half = (n >> 1); \
+            for (j = 0; j < m; j++) \
+            { \
+                p = base[j] + half; \
+                GET_TASK \
+                base[j] = (x CMP search[(i + j)]) ? p : base[j]; \
+                p = base[j] + ((n - half) >> 1); \
+                PREFETCH_TASK \
+            } \
+            n -= half; \
+        } \
+        for (j = 0; j < m; j++) \
+        { \
+            p = base[j]; \
+            if (n > 0) \
+            { \
+                GET_TASK \
+                p += (x CMP search[(i + j)]); \
+            }
+
+#define BATCH_FIND_FIRST_END_BLOCK(GET_TASK) \
+            found[(i + j)] = last; \
+            if (p < last) \
+            { \
+                GET_TASK \
+                if (x == search[(i + j)]) \
+                { \
+                    found[(i + j)] = p; \
+                } \
+            } \
+        } \
+    }
+
+#define BATCH_FIND_LAST_END_BLOCK(GET_TASK) \
+            found[(i + j)] = last; \
+            if (p > first) \
+            { \
+                --p; \
+                GET_TASK \
+                if (x == search[(i + j)]) \
+                { \
+                    found[(i + j)] = p; \
+                } \
+            } \
+        } \
+    }
+
+/**
+ * Generic function to search for the first occurrence of multiple unsigned integers
+ * on a memory mapped binary file containing adjacent blocks of sorted binary data.
+ *
+ * @param O Endiannes: be or le.
+ * @param T Unsigned integer type, one of: uint8_t, uint16_t, uint32_t, uint64_t
+ */
+#define define_find_first_batch(O, T) \
+/** Search for the first occurrence of multiple unsigned integers on a memory mapped
+binary file containing adjacent blocks of sorted binary data.
+The values in the file must be encoded in "O" format and sorted in ascending order.
+The searches are interleaved in groups of BINSEARCH_BATCH to overlap the memory accesses.
+The search keys can be in any order, but sorted keys improve the cache locality.
+@param src       Memory mapped file address.
+@param blklen    Length of the binary block in bytes.
+@param blkpos    Indicates the position of the number to search inside a binary block.
+@param first     First element of the range to search (min value = 0).
+@param last      Element (up to but not including) where to end the search (max value = nrows).
+@param search    Array of unsigned numbers to search (type T).
+@param nitems    Number of items in the search array.
+@param found     Output array of nitems positions: item number of the first occurrence or last if not found.
+ */ \
+static inline void find_first_batch_##O##_##T(const uint8_t *src, uint64_t blklen, uint64_t blkpos, uint64_t first, uint64_t last, const T *search, uint64_t nitems, uint64_t *found) \
+{ \
+BATCH_START_LOOP_BLOCK(T, BATCH_GET_ITEM_TASK(O, T), BATCH_PREFETCH_TASK, <) \
+BATCH_FIND_FIRST_END_BLOCK(BATCH_GET_ITEM_TASK(O, T)) \
+}
+
+define_find_first_batch(be, uint8_t)
+define_find_first_batch(be, uint16_t)
+define_find_first_batch(be, uint32_t)
+define_find_first_batch(be, uint64_t)
+define_find_first_batch(le, uint8_t)
+define_find_first_batch(le, uint16_t)
+define_find_first_batch(le, uint32_t)
+define_find_first_batch(le, uint64_t)
+
+/**
+ * Generic function to search for the last occurrence of multiple unsigned integers
+ * on a memory mapped binary file containing adjacent blocks of sorted binary data.
+ *
+ * @param O Endiannes: be or le.
+ * @param T Unsigned integer type, one of: uint8_t, uint16_t, uint32_t, uint64_t
+ */
+#define define_find_last_batch(O, T) \
+/** Search for the last occurrence of multiple unsigned integers on a memory mapped
+binary file containing adjacent blocks of sorted binary data.
+The values in the file must be encoded in "O" format and sorted in ascending order.
+The searches are interleaved in groups of BINSEARCH_BATCH to overlap the memory accesses.
+Together with find_first_batch_##O##_##T this returns the same range of items visited by has_next_##O##_##T.
+@param src       Memory mapped file address.
+@param blklen    Length of the binary block in bytes.
+@param blkpos    Indicates the position of the number to search inside a binary block.
+@param first     First element of the range to search (min value = 0).
+@param last      Element (up to but not including) where to end the search (max value = nrows).
+@param search    Array of unsigned numbers to search (type T).
+@param nitems    Number of items in the search array.
+@param found     Output array of nitems positions: item number of the last occurrence or last if not found.
+ */ \
+static inline void find_last_batch_##O##_##T(const uint8_t *src, uint64_t blklen, uint64_t blkpos, uint64_t first, uint64_t last, const T *search, uint64_t nitems, uint64_t *found) \
+{ \
+BATCH_START_LOOP_BLOCK(T, BATCH_GET_ITEM_TASK(O, T), BATCH_PREFETCH_TASK, <=) \
+BATCH_FIND_LAST_END_BLOCK(BATCH_GET_ITEM_TASK(O, T)) \
+}
+
+define_find_last_batch(be, uint8_t)
+define_find_last_batch(be, uint16_t)
+define_find_last_batch(be, uint32_t)
+define_find_last_batch(be, uint64_t)
+define_find_last_batch(le, uint8_t)
+define_find_last_batch(le, uint16_t)
+define_find_last_batch(le, uint32_t)
+define_find_last_batch(le, uint64_t)
+
+/**
+ * Generic function to search for the first occurrence of multiple unsigned integers
+ * on a memory buffer containing contiguos blocks of unsigned integers of the same type.
+ *
+ * @param T Unsigned integer type, one of: uint8_t, uint16_t, uint32_t, uint64_t
+ */
+#define define_col_find_first_batch(T) \
+/** Search for the first occurrence of multiple unsigned integers on a memory buffer
+containing contiguos blocks of unsigned integers of the same type.
+The values must be encoded in Little-Endian format and sorted in ascending order.
+The searches are interleaved in groups of BINSEARCH_BATCH to overlap the memory accesses.
+The search keys can be in any order, but sorted keys improve the cache locality.
+@param src       Memory mapped file address.
+@param first     First element of the range to search (min value = 0).
+@param last      Element (up to but not including) where to end the search (max value = nrows).
+@param search    Array of unsigned numbers to search (type T).
+@param nitems    Number of items in the search array.
+@param found     Output array of nitems positions: item number of the first occurrence or last if not found.
+ */ \
+static inline void col_find_first_batch_##T(const T *src, uint64_t first, uint64_t last, const T *search, uint64_t nitems, uint64_t *found) \
+{ \
+BATCH_START_LOOP_BLOCK(T, COL_BATCH_GET_ITEM_TASK, COL_BATCH_PREFETCH_TASK, <) \
+BATCH_FIND_FIRST_END_BLOCK(COL_BATCH_GET_ITEM_TASK) \
+}
+
+define_col_find_first_batch(uint8_t)
+define_col_find_first_batch(uint16_t)
+define_col_find_first_batch(uint32_t)
+define_col_find_first_batch(uint64_t)
+
+/**
+ * Generic function to search for the last occurrence of multiple unsigned integers
+ * on a memory buffer containing contiguos blocks of unsigned integers of the same type.
+ *
+ * @param T Unsigned integer type, one of: uint8_t, uint16_t, uint32_t, uint64_t
+ */
+#define define_col_find_last_batch(T) \
+/** Search for the last occurrence of multiple unsigned integers on a memory buffer
+containing contiguos blocks of unsigned integers of the same type.
+The values must be encoded in Little-Endian format and sorted in ascending order.
+The searches are interleaved in groups of BINSEARCH_BATCH to overlap the memory accesses.
+Together with col_find_first_batch_##T this returns the same range of items visited by col_has_next_##T.
+@param src       Memory mapped file address.
+@param first     First element of the range to search (min value = 0).
+@param last      Element (up to but not including) where to end the search (max value = nrows).
+@param search    Array of unsigned numbers to search (type T).
+@param nitems    Number of items in the search array.
+@param found     Output array of nitems positions: item number of the last occurrence or last if not found.
+ */ \
+static inline void col_find_last_batch_##T(const T *src, uint64_t first, uint64_t last, const T *search, uint64_t nitems, uint64_t *found) \
+{ \
+BATCH_START_LOOP_BLOCK(T, COL_BATCH_GET_ITEM_TASK, COL_BATCH_PREFETCH_TASK, <=) \
+BATCH_FIND_LAST_END_BLOCK(COL_BATCH_GET_ITEM_TASK) \
+}
+
+define_col_find_last_batch(uint8_t)
+define_col_find_last_batch(uint16_t)
+define_col_find_last_batch(uint32_t)
+define_col_find_last_batch(uint64_t)
+
 // --- FILE ---
 
 static inline void parse_col_offset(mmfile_t *mf)
@@ -1049,4 +1342,117 @@ static inline int munmap_binfile(mmfile_t mf)
     return close(mf.fd);
 }
 
+/**
+ * Write the header of a BINSRC1 file with columns of different lengths.
+ * The column data is expected to follow the header at the returned column offsets,
+ * each column padded to 8 bytes.
+ *
+ * @param fp        Output file stream.
+ * @param ncols     Number of columns.
+ * @param ctbytes   Number of bytes of each column type (i.e. 1 for uint8_t, 2 for uint16_t, 4 for uint32_t, 8 for uint64_t).
+ * @param nrows     Number of rows stored in the header.
+ * @param nitems    Array of ncols elements containing the number of items of each column (NULL = nrows for all columns).
+ * @param offset    Array of ncols elements to be populated with the absolute column offsets (can be NULL).
+ *
+ * @return Number of bytes written (the offset of the first column) or 0 in case of error.
+ */
+static inline size_t write_binsrc1_header_nitems(FILE *fp, uint8_t ncols, const uint8_t *ctbytes, uint64_t nrows, const uint64_t *nitems, uint64_t *offset)
+{
+    uint8_t pad[8] = {0};
+    uint64_t magic = 0x00314352534e4942; // "BINSRC1" in LE
+    size_t hlen = (size_t)9 + ncols;
+    size_t npad = (8 - (hlen & 7)) & 7;
+    uint64_t coff = hlen + npad + (8 * ((uint64_t)ncols + 1));
+    size_t exp = coff;
+    size_t ret = fwrite(&magic, 1, 8, fp);
+    ret += fwrite(&ncols, 1, 1, fp);
+    ret += fwrite(ctbytes, 1, ncols, fp);
+    ret += fwrite(pad, 1, npad, fp);
+    ret += (8 * fwrite(&nrows, 8, 1, fp));
+    uint8_t i;
+    for (i = 0; i < ncols; i++)
+    {
+        if (offset != NULL)
+        {
+            offset[i] = coff;
+        }
+        ret += (8 * fwrite(&coff, 8, 1, fp));
+        coff += (ctbytes[i] * ((nitems != NULL) ? nitems[i] : nrows));
+        coff += ((8 - (coff & 7)) & 7); // 8-byte padding
+    }
+    return (ret == exp) ? ret : 0;
+}
+
+/**
+ * Write the header of a BINSRC1 file.
+ * The column data is expected to follow the header at the returned column offsets,
+ * each column padded to 8 bytes.
+ *
+ * @param fp        Output file stream.
+ * @param ncols     Number of columns.
+ * @param ctbytes   Number of bytes of each column type (i.e. 1 for uint8_t, 2 for uint16_t, 4 for uint32_t, 8 for uint64_t).
+ * @param nrows     Number of rows.
+ * @param offset    Array of ncols elements to be populated with the absolute column offsets (can be NULL).
+ *
+ * @return Number of bytes written (the offset of the first column) or 0 in case of error.
+ */
+static inline size_t write_binsrc1_header(FILE *fp, uint8_t ncols, const uint8_t *ctbytes, uint64_t nrows, uint64_t *offset)
+{
+    return write_binsrc1_header_nitems(fp, ncols, ctbytes, nrows, NULL, offset);
+}
+
+/**
+ * Save the specified columns as a BINSRC1 file.
+ * The file can be memory-mapped with mmap_binfile().
+ *
+ * @param file      Path of the output file.
+ * @param ncols     Number of columns.
+ * @param ctbytes   Number of bytes of each column type (i.e. 1 for uint8_t, 2 for uint16_t, 4 for uint32_t, 8 for uint64_t).
+ * @param cols      Pointers to the data of each column.
+ * @param nrows     Number of rows.
+ *
+ * @return Number of bytes written or 0 in case of error.
+ */
+static inline size_t save_binsrc1_cols(const char *file, uint8_t ncols, const uint8_t *ctbytes, const void **cols, uint64_t nrows)
+{
+    FILE *fp = fopen(file, "we");
+    if (fp == NULL)
+    {
+        return 0;
+    }
+    uint8_t pad[8] = {0};
+    size_t ret = write_binsrc1_header(fp, ncols, ctbytes, nrows, NULL);
+    size_t exp = ret;
+    size_t len, npad;
+    uint8_t i;
+    for (i = 0; (i < ncols) && (exp > 0); i++)
+    {
+        len = (size_t)(ctbytes[i] * nrows);
+        npad = (8 - (len & 7)) & 7;
+        ret += fwrite(cols[i], 1, len, fp);
+        ret += fwrite(pad, 1, npad, fp);
+        exp += len + npad;
+    }
+    if ((fclose(fp) != 0) || (exp == 0) || (ret != exp))
+    {
+        return 0;
+    }
+    return ret;
+}
+
+/**
+ * Save a single column of unsigned integers as a BINSRC1 file.
+ *
+ * @param file      Path of the output file.
+ * @param src       Column data.
+ * @param ctbytes   Number of bytes of the column type (i.e. 1 for uint8_t, 2 for uint16_t, 4 for uint32_t, 8 for uint64_t).
+ * @param nrows     Number of rows.
+ *
+ * @return Number of bytes written or 0 in case of error.
+ */
+static inline size_t save_binsrc1_col(const char *file, const void *src, uint8_t ctbytes, uint64_t nrows)
+{
+    return save_binsrc1_cols(file, 1, &ctbytes, &src, nrows);
+}
+
 #endif  // VARIANTKEY_BINSEARCH_H
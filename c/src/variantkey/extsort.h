@@ -0,0 +1,741 @@
+// VariantKey
+//
+// extsort.h
+//
+// @category   Libraries
+// @author     Nicola Asuni <nicola.asuni@genomicsplc.com>
+// @copyright  2017-2018 GENOMICS plc
+// @license    MIT (see LICENSE)
+// @link       https://github.com/genomicsplc/variantkey
+//
+// LICENSE
+//
+// Copyright (c) 2017-2018 GENOMICS plc
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+/**
+ * @file extsort.h
+ * @brief External-memory sort for uint64_t (VariantKey) arrays and key/value pairs.
+ *
+ * Sort arrays of unsigned 64-bit integers larger than the available memory.
+ * The values are accumulated in a memory-bounded chunk that is radix sorted
+ * (parallel_sort_uint64_t) and spilled to a temporary sorted run when full.
+ * The runs are then k-way merged into a sorted column,
+ * optionally removing the duplicates as unique_uint64_t.
+ *
+ * Key/value pairs (e.g. VariantKey and rsID) are sorted by key and then by value,
+ * using the stable parallel_order_uint64_t on both columns,
+ * and the merged pairs are passed to a callback (extsort_merge).
+ *
+ * Usage:
+ *   extsort_t es;
+ *   extsort_init(&es, maxmem, tmpdir, nthreads, unique);
+ *   extsort_add_uint64_t(&es, arr, nitems); // repeat as needed
+ *   extsort_save_binsrc1(&es, "vk.bin", &nrows);
+ *   extsort_free(&es);
+ *
+ *   extsort_init_kv(&es, maxmem, tmpdir, nthreads, unique);
+ *   extsort_add_kv_uint64_t(&es, key, val, nitems); // repeat as needed
+ *   extsort_merge(&es, put, ctx);
+ *   extsort_free(&es);
+ */
+
+#ifndef VARIANTKEY_EXTSORT_H
+#define VARIANTKEY_EXTSORT_H
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "binsearch.h"
+#include "fileio.h"
+#include "set.h"
+
+#define EXTSORT_MINITEMS   1024        //!< Minimum number of items of the in-memory chunk.
+#define EXTSORT_MINRUNBUF  4096        //!< Minimum number of items of the read buffer of each run.
+#define EXTSORT_OUTBUF     65536       //!< Number of items of the output buffer.
+#define EXTSORT_MAXPATH    4096        //!< Maximum length of the temporary file paths.
+
+/**
+ * External sort state.
+ */
+typedef struct extsort_t
+{
+    uint64_t *arr;       //!< In-memory chunk (the keys when sorting key/value pairs).
+    uint64_t *val;       //!< Values of the in-memory chunk (NULL when sorting plain values).
+    uint64_t *tmp;       //!< Temporary array used to sort the chunk.
+    uint64_t *idx;       //!< Permutation index used to reorder the values (NULL when sorting plain values).
+    uint64_t *tdx;       //!< Temporary permutation index (NULL when sorting plain values).
+    uint64_t capacity;   //!< Number of items allocated for each array.
+    uint64_t maxitems;   //!< Maximum number of items in the chunk (it can be lowered after the initialization to limit the size of the sorted runs).
+    uint64_t nitems;     //!< Number of items in the chunk.
+    int *run;            //!< File descriptors of the sorted runs.
+    uint64_t *runlen;    //!< Number of items in each sorted run.
+    uint32_t nruns;      //!< Number of sorted runs.
+    uint32_t nthreads;   //!< Number of threads used to sort each chunk.
+    uint8_t unique;      //!< Set to 1 to remove the duplicates.
+    const char *tmpdir;  //!< Directory for the temporary files.
+} extsort_t;
+
+/**
+ * Allocate the arrays of the external sort in a single memory block, shared by the run readers during the merge.
+ *
+ * @param es        External sort state to initialize.
+ * @param maxmem    Maximum memory used for sorting, in bytes.
+ * @param tmpdir    Directory for the temporary files (NULL for "/tmp").
+ * @param nthreads  Number of threads used to sort each chunk.
+ * @param unique    Set to 1 to remove the duplicates.
+ * @param narrays   Number of arrays: 2 for plain values, 5 for key/value pairs.
+ *
+ * @return 0 on success, -1 on memory allocation failure.
+ */
+static inline int extsort_alloc(extsort_t *es, uint64_t maxmem, const char *tmpdir, uint32_t nthreads, uint8_t unique, uint8_t narrays)
+{
+    memset(es, 0, sizeof(extsort_t));
+    es->capacity = maxmem / (narrays * sizeof(uint64_t));
+    if (es->capacity < EXTSORT_MINITEMS)
+    {
+        es->capacity = EXTSORT_MINITEMS;
+    }
+    es->maxitems = es->capacity;
+    es->nthreads = nthreads;
+    es->unique = unique;
+    es->tmpdir = (tmpdir == NULL) ? "/tmp" : tmpdir;
+    es->arr = (uint64_t *)malloc((size_t)(narrays * es->capacity * sizeof(uint64_t)));
+    if (es->arr == NULL)
+    {
+        return -1;
+    }
+    es->tmp = es->arr + es->capacity;
+    if (narrays > 2)
+    {
+        es->val = es->tmp + es->capacity;
+        es->idx = es->val + es->capacity;
+        es->tdx = es->idx + es->capacity;
+    }
+    return 0;
+}
+
+/**
+ * Initialize the external sort of uint64_t values.
+ *
+ * @param es        External sort state to initialize.
+ * @param maxmem    Maximum memory used for sorting, in bytes (the chunk and its sort buffer).
+ * @param tmpdir    Directory for the temporary files (NULL for "/tmp"). The string must be valid until extsort_free().
+ * @param nthreads  Number of threads used to sort each chunk.
+ * @param unique    Set to 1 to remove the duplicate values.
+ *
+ * @return 0 on success, -1 on memory allocation failure.
+ */
+static inline int extsort_init(extsort_t *es, uint64_t maxmem, const char *tmpdir, uint32_t nthreads, uint8_t unique)
+{
+    return extsort_alloc(es, maxmem, tmpdir, nthreads, unique, 2);
+}
+
+/**
+ * Initialize the external sort of uint64_t key/value pairs,
+ * sorted by key and then by value (e.g. VariantKey and rsID).
+ *
+ * @param es        External sort state to initialize.
+ * @param maxmem    Maximum memory used for sorting, in bytes (the chunk, its sort buffer and the permutation indexes).
+ * @param tmpdir    Directory for the temporary files (NULL for "/tmp"). The string must be valid until extsort_free().
+ * @param nthreads  Number of threads used to sort each chunk.
+ * @param unique    Set to 1 to remove the duplicate pairs.
+ *
+ * @return 0 on success, -1 on memory allocation failure.
+ */
+static inline int extsort_init_kv(extsort_t *es, uint64_t maxmem, const char *tmpdir, uint32_t nthreads, uint8_t unique)
+{
+    return extsort_alloc(es, maxmem, tmpdir, nthreads, unique, 5);
+}
+
+/**
+ * Free the memory and the temporary files of the external sort.
+ *
+ * @param es        External sort state.
+ */
+static inline void extsort_free(extsort_t *es)
+{
+    uint32_t i;
+    for (i = 0; i < es->nruns; i++)
+    {
+        close(es->run[i]);
+    }
+    free(es->run);
+    free(es->runlen);
+    free(es->arr);
+    memset(es, 0, sizeof(extsort_t));
+}
+
+/**
+ * Reorder an array following a permutation index.
+ *
+ * @param arr       Array to reorder.
+ * @param tmp       Temporary array.
+ * @param idx       Permutation index: the item i is moved from position idx[i].
+ * @param nitems    Number of items.
+ */
+static inline void extsort_permute(uint64_t *arr, uint64_t *tmp, const uint64_t *idx, uint64_t nitems)
+{
+    uint64_t i;
+    for (i = 0; i < nitems; i++)
+    {
+        tmp[i] = arr[idx[i]];
+    }
+    memcpy(arr, tmp, (size_t)(nitems * sizeof(uint64_t)));
+}
+
+/**
+ * Sort the in-memory chunk and optionally remove the duplicates.
+ * Key/value pairs are ordered by value and then by key, as the radix sort is stable.
+ *
+ * @param es        External sort state.
+ */
+static inline void extsort_sort_chunk(extsort_t *es)
+{
+    uint64_t i, j, n = es->nitems;
+    if (es->val == NULL)
+    {
+        parallel_sort_uint64_t(es->arr, es->tmp, n, es->nthreads);
+        if (es->unique)
+        {
+            es->nitems = (uint64_t)(unique_uint64_t(es->arr, n) - es->arr);
+        }
+        return;
+    }
+    // the value pass is skipped when the values are already in ascending order (e.g. row numbers or offsets)
+    for (i = 1; (i < n) && (es->val[(i - 1)] <= es->val[i]); i++) {}
+    if (i < n)
+    {
+        parallel_order_uint64_t(es->val, es->tmp, es->idx, es->tdx, n, es->nthreads);
+        extsort_permute(es->arr, es->tmp, es->idx, n);
+    }
+    parallel_order_uint64_t(es->arr, es->tmp, es->idx, es->tdx, n, es->nthreads);
+    extsort_permute(es->val, es->tmp, es->idx, n);
+    if (es->unique && (n > 0))
+    {
+        for (i = 1, j = 0; i < n; i++)
+        {
+            if ((es->arr[i] != es->arr[j]) || (es->val[i] != es->val[j]))
+            {
+                j++;
+                es->arr[j] = es->arr[i];
+                es->val[j] = es->val[i];
+            }
+        }
+        es->nitems = (j + 1);
+    }
+}
+
+/**
+ * Sort the in-memory chunk and spill it to a new temporary run file
+ * (the keys followed by the values when sorting key/value pairs).
+ * The file is unlinked as soon as it is created and removed when closed.
+ *
+ * @param es        External sort state.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static inline int extsort_spill(extsort_t *es)
+{
+    if (es->nitems == 0)
+    {
+        return 0;
+    }
+    extsort_sort_chunk(es);
+    int *run = (int *)realloc(es->run, (es->nruns + 1) * sizeof(int));
+    if (run == NULL)
+    {
+        return -1;
+    }
+    es->run = run;
+    uint64_t *runlen = (uint64_t *)realloc(es->runlen, (es->nruns + 1) * sizeof(uint64_t));
+    if (runlen == NULL)
+    {
+        return -1;
+    }
+    es->runlen = runlen;
+    char path[EXTSORT_MAXPATH];
+    unsigned int seq = 0;
+    int fd;
+    do
+    {
+        if (snprintf(path, sizeof(path), "%s/extsort.%ld.%u.%u.tmp", es->tmpdir, (long)getpid(), es->nruns, seq++) >= (int)sizeof(path))
+        {
+            return -1;
+        }
+        fd = open(path, O_RDWR | O_CREAT | O_EXCL, 0600);
+    }
+    while ((fd < 0) && (errno == EEXIST));
+    if (fd < 0)
+    {
+        return -1;
+    }
+    unlink(path);
+    size_t len = (size_t)(es->nitems * sizeof(uint64_t));
+    if ((write_all_fd(fd, es->arr, len) != 0) || ((es->val != NULL) && (write_all_fd(fd, es->val, len) != 0)))
+    {
+        close(fd);
+        return -1;
+    }
+    es->run[es->nruns] = fd;
+    es->runlen[es->nruns] = es->nitems;
+    es->nruns++;
+    es->nitems = 0;
+    return 0;
+}
+
+/**
+ * Add values to the external sort.
+ *
+ * @param es        External sort state (initialized with extsort_init).
+ * @param arr       Values to add.
+ * @param nitems    Number of values.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static inline int extsort_add_uint64_t(extsort_t *es, const uint64_t *arr, uint64_t nitems)
+{
+    uint64_t n;
+    if (es->val != NULL)
+    {
+        return -1;
+    }
+    while (nitems > 0)
+    {
+        if ((es->nitems >= es->maxitems) && (extsort_spill(es) != 0))
+        {
+            return -1;
+        }
+        n = es->maxitems - es->nitems;
+        if (n > nitems)
+        {
+            n = nitems;
+        }
+        memcpy(es->arr + es->nitems, arr, (size_t)(n * sizeof(uint64_t)));
+        es->nitems += n;
+        arr += n;
+        nitems -= n;
+    }
+    return 0;
+}
+
+/**
+ * Add key/value pairs to the external sort.
+ *
+ * @param es        External sort state (initialized with extsort_init_kv).
+ * @param key       Keys to add.
+ * @param val       Values to add.
+ * @param nitems    Number of pairs.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static inline int extsort_add_kv_uint64_t(extsort_t *es, const uint64_t *key, const uint64_t *val, uint64_t nitems)
+{
+    uint64_t n;
+    if (es->val == NULL)
+    {
+        return -1;
+    }
+    while (nitems > 0)
+    {
+        if ((es->nitems >= es->maxitems) && (extsort_spill(es) != 0))
+        {
+            return -1;
+        }
+        n = es->maxitems - es->nitems;
+        if (n > nitems)
+        {
+            n = nitems;
+        }
+        memcpy(es->arr + es->nitems, key, (size_t)(n * sizeof(uint64_t)));
+        memcpy(es->val + es->nitems, val, (size_t)(n * sizeof(uint64_t)));
+        es->nitems += n;
+        key += n;
+        val += n;
+        nitems -= n;
+    }
+    return 0;
+}
+
+/**
+ * Sorted run reader used during the k-way merge.
+ */
+typedef struct extsort_reader_t
+{
+    int fd;          //!< File descriptor of the run.
+    uint64_t *buf;   //!< Read buffer of the keys (or plain values).
+    uint64_t *vbuf;  //!< Read buffer of the values (NULL when sorting plain values).
+    uint64_t size;   //!< Size of each buffer in items.
+    uint64_t pos;    //!< Position of the next item in the buffers.
+    uint64_t len;    //!< Number of items in the buffers.
+    uint64_t next;   //!< Index of the next item to be read from the file.
+    uint64_t nitems; //!< Number of items in the run.
+} extsort_reader_t;
+
+/**
+ * Load the next item of a sorted run.
+ *
+ * @param r         Run reader.
+ * @param key       Variable to be set with the next key (or plain value).
+ * @param val       Variable to be set with the next value (0 when sorting plain values).
+ *
+ * @return 1 if an item is returned, 0 at the end of the run, -1 on error.
+ */
+static inline int extsort_reader_next(extsort_reader_t *r, uint64_t *key, uint64_t *val)
+{
+    if (r->pos == r->len)
+    {
+        if (r->next == r->nitems)
+        {
+            return 0;
+        }
+        uint64_t n = r->nitems - r->next;
+        if (n > r->size)
+        {
+            n = r->size;
+        }
+        size_t len = (size_t)(n * sizeof(uint64_t));
+        if ((read_all_fd_at(r->fd, r->buf, len, (off_t)(r->next * sizeof(uint64_t))) != 0)
+                || ((r->vbuf != NULL) && (read_all_fd_at(r->fd, r->vbuf, len, (off_t)((r->nitems + r->next) * sizeof(uint64_t))) != 0)))
+        {
+            return -1;
+        }
+        r->next += n;
+        r->len = n;
+        r->pos = 0;
+    }
+    *key = r->buf[r->pos];
+    *val = (r->vbuf == NULL) ? 0 : r->vbuf[r->pos];
+    r->pos++;
+    return 1;
+}
+
+/**
+ * Callback receiving the sorted items of extsort_merge.
+ *
+ * @param ctx       User context.
+ * @param key       Key (or plain value).
+ * @param val       Value (0 when sorting plain values).
+ *
+ * @return 0 to continue, any other value to stop the merge with an error.
+ */
+typedef int (*extsort_put_t)(void *ctx, uint64_t key, uint64_t val);
+
+#define EXTSORT_HEAD_LT(A, B) ((hkey[(A)] < hkey[(B)]) || ((hkey[(A)] == hkey[(B)]) && (hval[(A)] < hval[(B)])))
+
+/**
+ * Merge all the items added to the external sort and pass them in ascending order to the callback,
+ * skipping the duplicates if required.
+ * The sort state is reset and can be reused after this call.
+ *
+ * @param es        External sort state.
+ * @param put       Callback receiving each item.
+ * @param ctx       User context passed to the callback.
+ *
+ * @return 0 on success, -1 on error (including a callback error).
+ */
+static inline int extsort_merge(extsort_t *es, extsort_put_t put, void *ctx)
+{
+    uint64_t i, k, v, lastk = 0, lastv = 0, count = 0;
+    uint32_t r;
+    int err = 0;
+    if (es->nruns == 0)
+    {
+        // all the items fit in memory
+        extsort_sort_chunk(es);
+        for (i = 0; (i < es->nitems) && (err == 0); i++)
+        {
+            err = put(ctx, es->arr[i], ((es->val == NULL) ? 0 : es->val[i]));
+        }
+        es->nitems = 0;
+        return (err == 0) ? 0 : -1;
+    }
+    if ((es->nitems > 0) && (extsort_spill(es) != 0))
+    {
+        return -1;
+    }
+    // k-way merge using a binary min-heap of run indexes;
+    // the memory block of the chunk is shared among the run readers
+    uint8_t kv = (es->val != NULL);
+    uint64_t total = (kv ? 5 : 2) * es->capacity;
+    uint64_t size = total / ((uint64_t)es->nruns * (kv ? 2 : 1));
+    uint64_t *rbuf = es->arr;
+    if (size < EXTSORT_MINRUNBUF)
+    {
+        size = EXTSORT_MINRUNBUF;
+        rbuf = (uint64_t *)malloc((size_t)((uint64_t)es->nruns * size * (kv ? 2 : 1) * sizeof(uint64_t)));
+    }
+    extsort_reader_t *rd = (extsort_reader_t *)calloc(es->nruns, sizeof(extsort_reader_t));
+    uint32_t *heap = (uint32_t *)malloc(es->nruns * sizeof(uint32_t));
+    uint64_t *hkey = (uint64_t *)malloc(es->nruns * sizeof(uint64_t));
+    uint64_t *hval = (uint64_t *)malloc(es->nruns * sizeof(uint64_t));
+    uint32_t nheap = 0, c, p;
+    int ret = 0;
+    if ((rd == NULL) || (heap == NULL) || (hkey == NULL) || (hval == NULL) || (rbuf == NULL))
+    {
+        err = 1;
+    }
+    for (r = 0; (r < es->nruns) && (err == 0); r++)
+    {
+        rd[r].fd = es->run[r];
+        rd[r].size = size;
+        rd[r].nitems = es->runlen[r];
+        rd[r].buf = rbuf + ((uint64_t)r * size * (kv ? 2 : 1));
+        rd[r].vbuf = kv ? (rd[r].buf + size) : NULL;
+        ret = extsort_reader_next(&rd[r], &hkey[r], &hval[r]);
+        if (ret < 0)
+        {
+            err = 1;
+        }
+        if (ret > 0)
+        {
+            // sift up
+            for (c = nheap++; c > 0; c = p)
+            {
+                p = (c - 1) / 2;
+                if (!EXTSORT_HEAD_LT(r, heap[p]))
+                {
+                    break;
+                }
+                heap[c] = heap[p];
+            }
+            heap[c] = r;
+        }
+    }
+    while ((nheap > 0) && (err == 0))
+    {
+        r = heap[0];
+        k = hkey[r];
+        v = hval[r];
+        if (!es->unique || (count == 0) || (k != lastk) || (v != lastv))
+        {
+            err = put(ctx, k, v);
+            lastk = k;
+            lastv = v;
+            count++;
+        }
+        ret = extsort_reader_next(&rd[r], &hkey[r], &hval[r]);
+        if (ret < 0)
+        {
+            err = 1;
+            break;
+        }
+        if (ret == 0)
+        {
+            r = heap[--nheap];
+        }
+        // sift down
+        for (p = 0; (c = (2 * p) + 1) < nheap; p = c)
+        {
+            if (((c + 1) < nheap) && EXTSORT_HEAD_LT(heap[c + 1], heap[c]))
+            {
+                c++;
+            }
+            if (!EXTSORT_HEAD_LT(heap[c], r))
+            {
+                break;
+            }
+            heap[p] = heap[c];
+        }
+        if (nheap > 0)
+        {
+            heap[p] = r;
+        }
+    }
+    if (rbuf != es->arr)
+    {
+        free(rbuf);
+    }
+    free(rd);
+    free(heap);
+    free(hkey);
+    free(hval);
+    for (r = 0; r < es->nruns; r++)
+    {
+        close(es->run[r]);
+    }
+    es->nruns = 0;
+    return (err == 0) ? 0 : -1;
+}
+
+/**
+ * Output buffer of extsort_write.
+ */
+typedef struct extsort_writer_t
+{
+    FILE *fp;        //!< Output stream.
+    uint64_t *buf;   //!< Output buffer.
+    uint64_t len;    //!< Number of items in the buffer.
+    uint64_t nrows;  //!< Total number of items written.
+    int err;         //!< Error flag.
+} extsort_writer_t;
+
+/**
+ * Write the buffered values to the output stream.
+ *
+ * @param w         Output buffer.
+ */
+static inline void extsort_writer_flush(extsort_writer_t *w)
+{
+    if ((w->len > 0) && (fwrite(w->buf, sizeof(uint64_t), (size_t)w->len, w->fp) != w->len))
+    {
+        w->err = 1;
+    }
+    w->len = 0;
+}
+
+/**
+ * Append a key to the output buffer (extsort_put_t callback).
+ *
+ * @param ctx       Pointer to the extsort_writer_t output buffer.
+ * @param key       Key (or plain value) to append.
+ * @param val       Value (not written).
+ *
+ * @return The error flag of the output buffer.
+ */
+static inline int extsort_writer_put(void *ctx, uint64_t key, uint64_t val)
+{
+    extsort_writer_t *w = (extsort_writer_t *)ctx;
+    (void)val;
+    w->nrows++;
+    w->buf[w->len++] = key;
+    if (w->len == EXTSORT_OUTBUF)
+    {
+        extsort_writer_flush(w);
+    }
+    return w->err;
+}
+
+/**
+ * Merge all the values added to the external sort and write them in ascending order to the output stream,
+ * as a raw array of uint64_t values (the keys only when sorting key/value pairs).
+ * The sort state is reset and can be reused after this call.
+ *
+ * @param es        External sort state.
+ * @param fp        Output stream.
+ * @param nrows     Pointer to the variable to be set with the number of values written.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static inline int extsort_write(extsort_t *es, FILE *fp, uint64_t *nrows)
+{
+    extsort_writer_t w;
+    memset(&w, 0, sizeof(w));
+    w.fp = fp;
+    w.buf = (uint64_t *)malloc(EXTSORT_OUTBUF * sizeof(uint64_t));
+    *nrows = 0;
+    if (w.buf == NULL)
+    {
+        return -1;
+    }
+    if (extsort_merge(es, extsort_writer_put, &w) != 0)
+    {
+        w.err = 1;
+    }
+    extsort_writer_flush(&w);
+    free(w.buf);
+    *nrows = w.nrows;
+    return (w.err == 0) ? 0 : -1;
+}
+
+/**
+ * Merge all the values added to the external sort and save them in ascending order as a single-column BINSRC1 file.
+ * The file can be memory-mapped with mmap_binfile().
+ * The sort state is reset and can be reused after this call.
+ *
+ * @param es        External sort state.
+ * @param file      Path of the output file.
+ * @param nrows     Pointer to the variable to be set with the number of rows written.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static inline int extsort_save_binsrc1(extsort_t *es, const char *file, uint64_t *nrows)
+{
+    *nrows = 0;
+    FILE *fp = fopen(file, "we");
+    if (fp == NULL)
+    {
+        return -1;
+    }
+    const uint8_t ctbytes = 8;
+    // the number of rows is only known after the merge (when removing duplicates),
+    // the header is rewritten at the end: the column offset does not depend on it.
+    int err = (write_binsrc1_header(fp, 1, &ctbytes, 0, NULL) == 0);
+    if (err == 0)
+    {
+        err = ((extsort_write(es, fp, nrows) != 0) || (fseek(fp, 0, SEEK_SET) != 0) || (write_binsrc1_header(fp, 1, &ctbytes, *nrows, NULL) == 0));
+    }
+    err |= (fclose(fp) != 0);
+    return (err == 0) ? 0 : -1;
+}
+
+/**
+ * Sort a binary file containing a raw array of uint64_t values (in host byte order)
+ * and save the result as a single-column BINSRC1 file, using at most maxmem bytes of memory for sorting.
+ *
+ * @param infile    Path of the input file.
+ * @param outfile   Path of the output file.
+ * @param maxmem    Maximum memory used for sorting, in bytes.
+ * @param tmpdir    Directory for the temporary files (NULL for "/tmp").
+ * @param nthreads  Number of threads used to sort each chunk.
+ * @param unique    Set to 1 to remove the duplicate values.
+ * @param nrows     Pointer to the variable to be set with the number of rows written.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static inline int extsort_file_uint64_t(const char *infile, const char *outfile, uint64_t maxmem, const char *tmpdir, uint32_t nthreads, uint8_t unique, uint64_t *nrows)
+{
+    *nrows = 0;
+    extsort_t es;
+    if (extsort_init(&es, maxmem, tmpdir, nthreads, unique) != 0)
+    {
+        return -1;
+    }
+    FILE *fp = fopen(infile, "re");
+    if (fp == NULL)
+    {
+        extsort_free(&es);
+        return -1;
+    }
+    int err = 0;
+    size_t n;
+    // read directly into the free part of the chunk
+    while ((err == 0) && ((n = fread(es.arr + es.nitems, sizeof(uint64_t), (size_t)(es.maxitems - es.nitems), fp)) > 0))
+    {
+        es.nitems += n;
+        if (es.nitems == es.maxitems)
+        {
+            err = extsort_spill(&es);
+        }
+    }
+    err |= ferror(fp);
+    fclose(fp);
+    if (err == 0)
+    {
+        err = extsort_save_binsrc1(&es, outfile, nrows);
+    }
+    extsort_free(&es);
+    return (err == 0) ? 0 : -1;
+}
+
+#endif  // VARIANTKEY_EXTSORT_H
@@ -0,0 +1,120 @@
+// VariantKey
+//
+// fileio.h
+//
+// @category   Libraries
+// @author     Nicola Asuni <nicola.asuni@genomicsplc.com>
+// @copyright  2017-2018 GENOMICS plc
+// @license    MIT (see LICENSE)
+// @link       https://github.com/genomicsplc/variantkey
+//
+// LICENSE
+//
+// Copyright (c) 2017-2018 GENOMICS plc
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+/**
+ * @file fileio.h
+ * @brief File descriptor I/O helpers.
+ *
+ * Small functions shared by the headers that stream data to file descriptors
+ * (e.g. extsort.h), without depending on the memory-mapping code of binsearch.h.
+ */
+
+#ifndef VARIANTKEY_FILEIO_H
+#define VARIANTKEY_FILEIO_H
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+/**
+ * Write the whole buffer to a file descriptor, resuming after partial writes and interrupted (EINTR) calls.
+ *
+ * @param fd    Output file descriptor.
+ * @param buf   Buffer to write.
+ * @param len   Number of bytes to write.
+ *
+ * @return 0 in case of success, -1 in case of error.
+ */
+static inline int write_all_fd(int fd, const void *buf, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)buf;
+    ssize_t n;
+    while (len > 0)
+    {
+        n = write(fd, p, len);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+/**
+ * Read exactly len bytes from a file descriptor starting at the specified offset,
+ * resuming after partial reads and interrupted (EINTR) calls.
+ *
+ * @param fd        Input file descriptor.
+ * @param buf       Buffer to fill.
+ * @param len       Number of bytes to read.
+ * @param offset    Position of the first byte to read.
+ *
+ * @return 0 in case of success, -1 in case of error or if the file ends before len bytes.
+ */
+static inline int read_all_fd_at(int fd, void *buf, size_t len, off_t offset)
+{
+    uint8_t *p = (uint8_t *)buf;
+    ssize_t n;
+    if (lseek(fd, offset, SEEK_SET) != offset)
+    {
+        return -1;
+    }
+    while (len > 0)
+    {
+        n = read(fd, p, len);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0)
+        {
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+#endif  // VARIANTKEY_FILEIO_H
@@ -39,21 +39,32 @@
  *
  * The input reference binary files can be generated from a FASTA file using the
  * `resources/tools/fastabin.sh` script.
+ *
+ * A 2-bit packed version of the binary reference file (about 4 times smaller)
+ * can be generated with genoref_to_2bit_file and accessed with the *_2bit functions.
  */
 
 #ifndef VARIANTKEY_GENOREF_H
 #define VARIANTKEY_GENOREF_H
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "binsearch.h"
 #include "variantkey.h"
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #ifndef ALLELE_MAXSIZE
-#define ALLELE_MAXSIZE 256 //!< Maximum allele length.
+#define ALLELE_MAXSIZE 256 //!< Default allele buffer size for the callers (normalize_variant has no allele length limit).
 #endif
 
 // Return codes for normalize_variant()
+#define NORM_NOMEM      (-3) //!< Normalization: Unable to allocate the buffer for the normalized alleles (see normalize_variant_arena).
 #define NORM_WRONGPOS   (-2) //!< Normalization: Invalid position.
 #define NORM_INVALID    (-1) //!< Normalization: Invalid reference.
 #define NORM_OK          (0) //!< Normalization: The reference allele perfectly match the genome reference.
@@ -138,6 +149,157 @@ static inline char get_genoref_seq(mmfile_t mf, uint8_t chrom, uint32_t pos)
     return *(mf.src + offset);
 }
 
+/*
+    Abbreviation codes for degenerate bases
+
+    Cornish-Bowden A.
+    Nomenclature for incompletely specified bases in nucleic acid sequences: recommendations 1984.
+    Nucleic Acids Research. 1985;13(9):3021-3030.
+
+    SYMBOL | DESCRIPTION                   | BASES   | COMPLEMENT
+    -------+-------------------------------+---------+-----------
+       A   | Adenine                       | A       |  T
+       C   | Cytosine                      |   C     |  G
+       G   | Guanine                       |     G   |  C
+       T   | Thymine                       |       T |  A
+       W   | Weak                          | A     T |  W
+       S   | Strong                        |   C G   |  S
+       M   | aMino                         | A C     |  K
+       K   | Keto                          |     G T |  M
+       R   | puRine                        | A   G   |  Y
+       Y   | pYrimidine                    |   C   T |  R
+       B   | not A (B comes after A)       |   C G T |  V
+       D   | not C (D comes after C)       | A   G T |  H
+       H   | not G (H comes after G)       | A C   T |  D
+       V   | not T (V comes after T and U) | A C G   |  B
+       N   | aNy base (not a gap)          | A C G T |  N
+    -------+-------------------------------+---------+----------
+
+    Each character is mapped to a 16 bit value:
+    - the lower 5 bits identify the character class: A=1, C=2, G=4, T=8, any other character=16;
+    - the upper byte is the mask of the classes accepted by a degenerate base:
+      N accepts everything, B/D/H/V accept everything except one base,
+      W/S/M/K/R/Y only accept their two bases.
+    Two different characters are consistent if either of them accepts the class of the other one.
+*/
+static const uint16_t iupac_map[256] =
+{
+        0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010,
+        0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010,
+        0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010,
+        0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010,
+        0x0010, 0x0001, 0x1e10, 0x0002, 0x1d10, 0x0010, 0x0010, 0x0004, 0x1b10, 0x0010, 0x0010, 0x0c10, 0x0010, 0x0310, 0x1f10, 0x0010,
+        0x0010, 0x0010, 0x0510, 0x0610, 0x0008, 0x0010, 0x1710, 0x0910, 0x0010, 0x0a10, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010,
+        0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010,
+        0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010,
+        0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010,
+        0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010,
+        0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010,
+        0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010,
+        0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010,
+        0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010,
+        0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010,
+        0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010, 0x0010
+};
+
+#if defined(__AVX2__)
+#define CHECKREF_BLOCK 32 //!< Number of nucleotides compared at once by check_reference_seq.
+#elif defined(__SSE2__)
+#define CHECKREF_BLOCK 16 //!< Number of nucleotides compared at once by check_reference_seq.
+#endif
+
+/**
+ * Check if the uppercase version of the reference allele block exactly matches the genome reference block.
+ *
+ * @param gseq    Genome reference sequence block (CHECKREF_BLOCK bytes).
+ * @param ref     Reference allele block (CHECKREF_BLOCK bytes).
+ *
+ * @return 1 if the blocks match, 0 otherwise.
+ */
+#if defined(__AVX2__)
+static inline int check_reference_block(const char *gseq, const char *ref)
+{
+    __m256i r = _mm256_loadu_si256((const __m256i *)(const void *)ref);
+    __m256i g = _mm256_loadu_si256((const __m256i *)(const void *)gseq);
+    // same as aztoupper: flip the case bit of the (signed) characters above 'a'
+    r = _mm256_xor_si256(r, _mm256_and_si256(_mm256_cmpgt_epi8(r, _mm256_set1_epi8('a' - 1)), _mm256_set1_epi8('a' - 'A')));
+    return ((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(r, g)) == 0xFFFFFFFF);
+}
+#elif defined(__SSE2__)
+static inline int check_reference_block(const char *gseq, const char *ref)
+{
+    __m128i r = _mm_loadu_si128((const __m128i *)(const void *)ref);
+    __m128i g = _mm_loadu_si128((const __m128i *)(const void *)gseq);
+    // same as aztoupper: flip the case bit of the (signed) characters above 'a'
+    r = _mm_xor_si128(r, _mm_and_si128(_mm_cmpgt_epi8(r, _mm_set1_epi8('a' - 1)), _mm_set1_epi8('a' - 'A')));
+    return (_mm_movemask_epi8(_mm_cmpeq_epi8(r, g)) == 0xFFFF);
+}
+#endif
+
+/**
+ * Check if a reference allele character is consistent with a genome reference character.
+ *
+ * @param uref    Uppercase reference allele character.
+ * @param gref    Genome reference character.
+ *
+ * @return 0 if the characters match, 1 (NORM_VALID) if they are consistent, -1 (NORM_INVALID) otherwise.
+ */
+static inline int check_reference_char(char uref, char gref)
+{
+    if (uref == gref)
+    {
+        return 0;
+    }
+    uint16_t u = iupac_map[(uint8_t)uref];
+    uint16_t g = iupac_map[(uint8_t)gref];
+    return ((((u >> 8) & g) | ((g >> 8) & u)) & 0x1F) ? NORM_VALID : NORM_INVALID;
+}
+
+/**
+ * Check if the reference allele matches a genome reference sequence.
+ *
+ * @param gseq    Genome reference sequence (uppercase nucleotide letters), at least sizeref bytes long.
+ * @param ref     Reference allele. String containing a sequence of nucleotide letters.
+ * @param sizeref Length of the ref string, excluding the terminating null byte.
+ *
+ * @return Positive number in case of success, negative in case of error:
+ *       *  0 the reference allele match the reference genome;
+ *       *  1 the reference allele is inconsistent with the genome reference (i.e. when contains nucleotide letters other than A, C, G and T);
+ *       * -1 the reference allele don't match the reference genome.
+ */
+static inline int check_reference_seq(const char *gseq, const char *ref, size_t sizeref)
+{
+    size_t i = 0, end;
+    int ret = 0; // return value
+    int status;
+    while (i < sizeref)
+    {
+        end = sizeref;
+#ifdef CHECKREF_BLOCK
+        // fast path for exactly matching blocks
+        if ((i + CHECKREF_BLOCK) <= sizeref)
+        {
+            if (check_reference_block(gseq + i, ref + i))
+            {
+                i += CHECKREF_BLOCK;
+                continue;
+            }
+            end = (i + CHECKREF_BLOCK);
+        }
+#endif
+        for (; i < end; i++)
+        {
+            status = check_reference_char((char)aztoupper(ref[i]), gseq[i]);
+            if (status < 0)
+            {
+                return NORM_INVALID; // invalid reference
+            }
+            ret |= status; // NORM_VALID if valid but not consistent
+        }
+    }
+    return ret; // sequence OK
+}
+
 /**
  * Check if the reference allele matches the reference genome data.
  *
@@ -160,83 +322,379 @@ static inline int check_reference(mmfile_t mf, uint8_t chrom, uint32_t pos, cons
     {
         return NORM_WRONGPOS;
     }
+    return check_reference_seq((const char *)(mf.src + offset), ref, sizeref);
+}
+
+/*
+    2-bit packed genome reference format.
+
+    The file is a BINSRC1 file with one row for each encoded chromosome (row 0 is empty)
+    and four uint64_t columns:
+
+        - offset of the packed sequence (4 nucleotides per byte, A=0 C=1 G=2 T=3, first nucleotide in the lowest bits);
+        - length of the sequence (number of nucleotides);
+        - offset of the exception list;
+        - number of entries in the exception list.
+
+    The exception list stores the runs of letters other than A, C, G and T (i.e. N and IUPAC codes)
+    as three arrays: uint32_t start positions (sorted), uint32_t run lengths and uint8_t letters.
+    All offsets are absolute file positions aligned to 8 bytes.
+    Sequences are stored in uppercase.
+*/
+
+#define GENOREF_2BIT_NCOLS 4 //!< Number of columns in the 2-bit packed genoref file.
+#define GENOREF_2BIT_COL_SEQ 0 //!< Column containing the offsets of the packed sequences.
+#define GENOREF_2BIT_COL_LEN 1 //!< Column containing the sequence lengths.
+#define GENOREF_2BIT_COL_EXC 2 //!< Column containing the offsets of the exception lists.
+#define GENOREF_2BIT_COL_NEXC 3 //!< Column containing the number of exceptions.
+#define GENOREF_2BIT_BUFSIZE 256 //!< Number of nucleotides decoded at once by check_reference_2bit.
+#define CHECKREF_FLIP_BUFSIZE 64 //!< Number of nucleotides flipped at once by check_flipped_reference_any.
+
+/**
+ * Sequence of one chromosome in a 2-bit packed genoref file.
+ */
+typedef struct genoref_2bit_seq_t
+{
+    const uint8_t *seq;         //!< Packed sequence.
+    uint64_t size;              //!< Number of nucleotides.
+    const uint32_t *exc_start;  //!< Start positions of the exception runs.
+    const uint32_t *exc_len;    //!< Lengths of the exception runs.
+    const uint8_t *exc_base;    //!< Letters of the exception runs.
+    uint64_t nexc;              //!< Number of exception runs.
+} genoref_2bit_seq_t;
+
+/**
+ * Memory map the 2-bit packed genoref binary file.
+ *
+ * @param file  Path to the file to map.
+ * @param mf    Structure containing the memory mapped file.
+ *
+ * @return Returns the memory-mapped file descriptors.
+ */
+static inline void mmap_genoref_2bit_file(const char *file, mmfile_t *mf)
+{
+    mmap_binfile(file, mf);
+}
+
+/**
+ * Load the sequence information for the specified chromosome from a 2-bit packed genoref file.
+ *
+ * @param mf      Structure containing the memory mapped file.
+ * @param chrom   Encoded Chromosome number (see encode_chrom).
+ * @param gs      Structure to be populated.
+ *
+ * @return 0 in case of success, -1 if the chromosome is not present.
+ */
+static inline int get_genoref_2bit_seq_info(mmfile_t mf, uint8_t chrom, genoref_2bit_seq_t *gs)
+{
+    if ((mf.ncols != GENOREF_2BIT_NCOLS) || (chrom >= mf.nrows))
+    {
+        return -1;
+    }
+    gs->seq = (mf.src + ((const uint64_t *)(mf.src + mf.index[GENOREF_2BIT_COL_SEQ]))[chrom]);
+    gs->size = ((const uint64_t *)(mf.src + mf.index[GENOREF_2BIT_COL_LEN]))[chrom];
+    gs->nexc = ((const uint64_t *)(mf.src + mf.index[GENOREF_2BIT_COL_NEXC]))[chrom];
+    gs->exc_start = (const uint32_t *)(mf.src + ((const uint64_t *)(mf.src + mf.index[GENOREF_2BIT_COL_EXC]))[chrom]);
+    gs->exc_len = gs->exc_start + gs->nexc;
+    gs->exc_base = (const uint8_t *)(gs->exc_len + gs->nexc);
+    return 0;
+}
+
+/**
+ * Returns the index of the first exception run ending after the specified position.
+ *
+ * @param gs      Chromosome sequence information.
+ * @param pos     Position. The reference position, with the first base having position 0.
+ *
+ * @return Index of the exception run or gs->nexc if there are no runs after pos.
+ */
+static inline uint64_t find_genoref_2bit_exception(const genoref_2bit_seq_t *gs, uint32_t pos)
+{
+    // find the first run starting after pos
+    uint64_t first = 0, last = gs->nexc, middle;
+    while (first < last)
+    {
+        middle = get_middle_point(first, last);
+        if (gs->exc_start[middle] <= pos)
+        {
+            first = middle + 1;
+        }
+        else
+        {
+            last = middle;
+        }
+    }
+    // the previous run may still contain pos
+    if ((first > 0) && (((uint64_t)gs->exc_start[(first - 1)] + gs->exc_len[(first - 1)]) > pos))
+    {
+        return (first - 1);
+    }
+    return first;
+}
+
+/**
+ * Decode a genome reference subsequence from a 2-bit packed genoref file.
+ *
+ * @param gs      Chromosome sequence information (see get_genoref_2bit_seq_info).
+ * @param pos     Position. The reference position, with the first base having position 0.
+ * @param size    Number of nucleotides to decode.
+ * @param seq     Output buffer (at least size bytes, it is not null-terminated).
+ *
+ * @return Number of decoded nucleotides (less than size if the sequence ends before pos + size).
+ */
+static inline size_t decode_genoref_2bit_seq(const genoref_2bit_seq_t *gs, uint32_t pos, size_t size, char *seq)
+{
+    static const char nuc[4] = {'A', 'C', 'G', 'T'};
+    if (pos >= gs->size)
+    {
+        return 0;
+    }
+    if (size > (gs->size - pos))
+    {
+        size = (size_t)(gs->size - pos);
+    }
     size_t i;
-    char uref, gref;
-    int ret = 0; // return value
-    for (i = 0; i < sizeref; i++)
+    uint64_t p = pos;
+    for (i = 0; i < size; i++, p++)
+    {
+        seq[i] = nuc[((gs->seq[(p >> 2)] >> ((p & 3) << 1)) & 3)];
+    }
+    // overwrite the positions covered by the exception runs
+    uint64_t end = (uint64_t)pos + size;
+    uint64_t e, rs, re;
+    for (e = find_genoref_2bit_exception(gs, pos); (e < gs->nexc) && (gs->exc_start[e] < end); e++)
     {
-        uref = aztoupper(ref[i]);
-        gref = mf.src[(offset + i)];
-        if (uref == gref)
+        rs = (gs->exc_start[e] > pos) ? gs->exc_start[e] : pos;
+        re = (uint64_t)gs->exc_start[e] + gs->exc_len[e];
+        if (re > end)
         {
-            continue;
+            re = end;
         }
-        /*
-            Abbreviation codes for degenerate bases
-
-            Cornish-Bowden A.
-            Nomenclature for incompletely specified bases in nucleic acid sequences: recommendations 1984.
-            Nucleic Acids Research. 1985;13(9):3021-3030.
-
-            SYMBOL | DESCRIPTION                   | BASES   | COMPLEMENT
-            -------+-------------------------------+---------+-----------
-               A   | Adenine                       | A       |  T
-               C   | Cytosine                      |   C     |  G
-               G   | Guanine                       |     G   |  C
-               T   | Thymine                       |       T |  A
-               W   | Weak                          | A     T |  W
-               S   | Strong                        |   C G   |  S
-               M   | aMino                         | A C     |  K
-               K   | Keto                          |     G T |  M
-               R   | puRine                        | A   G   |  Y
-               Y   | pYrimidine                    |   C   T |  R
-               B   | not A (B comes after A)       |   C G T |  V
-               D   | not C (D comes after C)       | A   G T |  H
-               H   | not G (H comes after G)       | A C   T |  D
-               V   | not T (V comes after T and U) | A C G   |  B
-               N   | aNy base (not a gap)          | A C G T |  N
-            -------+-------------------------------+---------+----------
-        */
-        if ((uref == 'N')
-                || (gref == 'N')
-                || ((uref == 'B') && (gref != 'A'))
-                || ((gref == 'B') && (uref != 'A'))
-                || ((uref == 'D') && (gref != 'C'))
-                || ((gref == 'D') && (uref != 'C'))
-                || ((uref == 'H') && (gref != 'G'))
-                || ((gref == 'H') && (uref != 'G'))
-                || ((uref == 'V') && (gref != 'T'))
-                || ((gref == 'V') && (uref != 'T'))
-                || ((uref == 'W') && ((gref == 'A') || (gref == 'T')))
-                || ((gref == 'W') && ((uref == 'A') || (uref == 'T')))
-                || ((uref == 'S') && ((gref == 'C') || (gref == 'G')))
-                || ((gref == 'S') && ((uref == 'C') || (uref == 'G')))
-                || ((uref == 'M') && ((gref == 'A') || (gref == 'C')))
-                || ((gref == 'M') && ((uref == 'A') || (uref == 'C')))
-                || ((uref == 'K') && ((gref == 'G') || (gref == 'T')))
-                || ((gref == 'K') && ((uref == 'G') || (uref == 'T')))
-                || ((uref == 'R') && ((gref == 'A') || (gref == 'G')))
-                || ((gref == 'R') && ((uref == 'A') || (uref == 'G')))
-                || ((uref == 'Y') && ((gref == 'C') || (gref == 'T')))
-                || ((gref == 'Y') && ((uref == 'C') || (uref == 'T'))))
+        memset(seq + (rs - pos), gs->exc_base[e], (size_t)(re - rs));
+    }
+    return size;
+}
+
+/**
+ * Returns the genome reference nucleotide at the specified chromosome and position from a 2-bit packed genoref file.
+ *
+ * @param mf      Structure containing the memory mapped file.
+ * @param chrom   Encoded Chromosome number (see encode_chrom).
+ * @param pos     Position. The reference position, with the first base having position 0.
+ *
+ * @return The nucleotide letter or 0 in case of invalid position.
+ */
+static inline char get_genoref_2bit_seq(mmfile_t mf, uint8_t chrom, uint32_t pos)
+{
+    genoref_2bit_seq_t gs;
+    char ref = 0;
+    if (get_genoref_2bit_seq_info(mf, chrom, &gs) != 0)
+    {
+        return 0;
+    }
+    decode_genoref_2bit_seq(&gs, pos, 1, &ref);
+    return ref;
+}
+
+/**
+ * Check if the reference allele matches the reference genome data in a 2-bit packed genoref file.
+ *
+ * @param mf      Structure containing the memory mapped file.
+ * @param chrom   Encoded Chromosome number (see encode_chrom).
+ * @param pos     Position. The reference position, with the first base having position 0.
+ * @param ref     Reference allele. String containing a sequence of nucleotide letters.
+ * @param sizeref Length of the ref string, excluding the terminating null byte.
+ *
+ * @return Positive number in case of success, negative in case of error:
+ *       *  0 the reference allele match the reference genome;
+ *       *  1 the reference allele is inconsistent with the genome reference (i.e. when contains nucleotide letters other than A, C, G and T);
+ *       * -1 the reference allele don't match the reference genome;
+ *       * -2 the reference allele is longer than the genome reference sequence.
+ */
+static inline int check_reference_2bit(mmfile_t mf, uint8_t chrom, uint32_t pos, const char *ref, size_t sizeref)
+{
+    genoref_2bit_seq_t gs;
+    if ((get_genoref_2bit_seq_info(mf, chrom, &gs) != 0) || (((uint64_t)pos + sizeref) > gs.size))
+    {
+        return NORM_WRONGPOS;
+    }
+    char gseq[GENOREF_2BIT_BUFSIZE];
+    size_t len;
+    int status, ret = 0;
+    while (sizeref > 0)
+    {
+        len = decode_genoref_2bit_seq(&gs, pos, ((sizeref < GENOREF_2BIT_BUFSIZE) ? sizeref : GENOREF_2BIT_BUFSIZE), gseq);
+        status = check_reference_seq(gseq, ref, len);
+        if (status < 0)
         {
-            ret = NORM_VALID; // valid but not consistent
-            continue;
+            return status;
         }
-        return NORM_INVALID; // invalid reference
+        ret |= status;
+        pos += (uint32_t)len;
+        ref += len;
+        sizeref -= len;
     }
-    return ret; // sequence OK
+    return ret;
 }
 
 /**
- * Flip the allele nucleotides (replaces each letter with its complement).
- * The resulting string is always in uppercase.
+ * Write a 2-bit packed genoref file from a memory mapped genoref file (see mmap_genoref_file).
+ * Lowercase letters are stored in uppercase.
+ *
+ * @param mf      Structure containing the memory mapped genoref file.
+ * @param file    Path of the output 2-bit packed genoref file.
+ *
+ * @return Number of bytes written or 0 in case of error.
+ */
+static inline size_t genoref_to_2bit_file(mmfile_t mf, const char *file)
+{
+    uint8_t ctbytes[GENOREF_2BIT_NCOLS] = {8, 8, 8, 8};
+    uint64_t coloff[GENOREF_2BIT_NCOLS];
+    uint64_t seqoff[256], len[256], excoff[256], nexc[256];
+    uint8_t pad[8] = {0};
+    uint8_t nrows = (uint8_t)(mf.ncols - 1);
+    uint64_t i, j, p, size;
+    uint8_t c, b;
+    FILE *fp = fopen(file, "we");
+    if (fp == NULL)
+    {
+        return 0;
+    }
+    size_t hsize = write_binsrc1_header(fp, GENOREF_2BIT_NCOLS, ctbytes, nrows, coloff);
+    if (hsize == 0)
+    {
+        fclose(fp);
+        return 0;
+    }
+    // compute the layout: packed sequence followed by the exception list for each chromosome
+    size = coloff[(GENOREF_2BIT_NCOLS - 1)] + ((uint64_t)nrows * 8);
+    for (c = 0; c < nrows; c++)
+    {
+        len[c] = mf.index[(c + 1)] - mf.index[c];
+        nexc[c] = 0;
+        for (i = 0; i < len[c]; i++)
+        {
+            b = (uint8_t)aztoupper(mf.src[(mf.index[c] + i)]);
+            if ((b != 'A') && (b != 'C') && (b != 'G') && (b != 'T') && ((i == 0) || ((uint8_t)aztoupper(mf.src[(mf.index[c] + i - 1)]) != b)))
+            {
+                nexc[c]++;
+            }
+        }
+        seqoff[c] = size;
+        size += ((len[c] + 3) >> 2);
+        size += ((8 - (size & 7)) & 7);
+        excoff[c] = size;
+        size += (nexc[c] * 9);
+        size += ((8 - (size & 7)) & 7);
+    }
+    size_t ret = hsize;
+    ret += (8 * fwrite(seqoff, 8, nrows, fp));
+    ret += (8 * fwrite(len, 8, nrows, fp));
+    ret += (8 * fwrite(excoff, 8, nrows, fp));
+    ret += (8 * fwrite(nexc, 8, nrows, fp));
+    uint8_t buf[4096];
+    uint32_t *rstart, *rlen;
+    uint8_t *rbase;
+    for (c = 0; c < nrows; c++)
+    {
+        rstart = (uint32_t *)malloc((size_t)(nexc[c] * 9) + 1);
+        if (rstart == NULL)
+        {
+            fclose(fp);
+            return 0;
+        }
+        rlen = rstart + nexc[c];
+        rbase = (uint8_t *)(rlen + nexc[c]);
+        memset(buf, 0, sizeof(buf));
+        for (i = 0, j = 0, p = 0; i < len[c]; i++)
+        {
+            b = (uint8_t)aztoupper(mf.src[(mf.index[c] + i)]);
+            switch (b)
+            {
+            case 'A':
+                break;
+            case 'C':
+                buf[p] |= (uint8_t)(1 << ((i & 3) << 1));
+                break;
+            case 'G':
+                buf[p] |= (uint8_t)(2 << ((i & 3) << 1));
+                break;
+            case 'T':
+                buf[p] |= (uint8_t)(3 << ((i & 3) << 1));
+                break;
+            default:
+                if ((j > 0) && (rbase[(j - 1)] == b) && (((uint64_t)rstart[(j - 1)] + rlen[(j - 1)]) == i))
+                {
+                    rlen[(j - 1)]++;
+                    break;
+                }
+                rstart[j] = (uint32_t)i;
+                rlen[j] = 1;
+                rbase[j] = b;
+                j++;
+            }
+            if ((i & 3) == 3)
+            {
+                if (++p == sizeof(buf))
+                {
+                    ret += fwrite(buf, 1, p, fp);
+                    memset(buf, 0, sizeof(buf));
+                    p = 0;
+                }
+            }
+        }
+        p += ((len[c] & 3) != 0);
+        ret += fwrite(buf, 1, p, fp);
+        ret += fwrite(pad, 1, (excoff[c] - seqoff[c] - ((len[c] + 3) >> 2)), fp);
+        ret += fwrite(rstart, 1, (size_t)(nexc[c] * 9), fp);
+        ret += fwrite(pad, 1, ((8 - ((nexc[c] * 9) & 7)) & 7), fp);
+        free(rstart);
+    }
+    if ((fclose(fp) != 0) || (ret != size))
+    {
+        return 0;
+    }
+    return ret;
+}
+
+/**
+ * Returns true if the memory mapped file is a 2-bit packed genoref file.
+ *
+ * @param mf      Structure containing the memory mapped file.
+ */
+static inline int is_genoref_2bit(mmfile_t mf)
+{
+    return (mf.ncols == GENOREF_2BIT_NCOLS);
+}
+
+/**
+ * Returns the genome reference nucleotide from either a genoref or a 2-bit packed genoref file.
+ * See get_genoref_seq and get_genoref_2bit_seq.
+ */
+static inline char get_genoref_seq_any(mmfile_t mf, uint8_t chrom, uint32_t pos)
+{
+    return is_genoref_2bit(mf) ? get_genoref_2bit_seq(mf, chrom, pos) : get_genoref_seq(mf, chrom, pos);
+}
+
+/**
+ * Check the reference allele against either a genoref or a 2-bit packed genoref file.
+ * See check_reference and check_reference_2bit.
+ */
+static inline int check_reference_any(mmfile_t mf, uint8_t chrom, uint32_t pos, const char *ref, size_t sizeref)
+{
+    return is_genoref_2bit(mf) ? check_reference_2bit(mf, chrom, pos, ref, sizeref) : check_reference(mf, chrom, pos, ref, sizeref);
+}
+
+/**
+ * Copy the flipped allele nucleotides (replaces each letter with its complement) to the output buffer.
+ * The resulting string is always in uppercase and it is not null-terminated.
  * Support extended nucleotide letters.
  *
  * @param allele  Allele. String containing a sequence of nucleotide letters.
  * @param size    Length of the allele string.
+ * @param out     Output buffer (at least size bytes). It can be the same as allele.
  */
-static inline void flip_allele(char *allele, size_t size)
+static inline void flip_allele_copy(const char *allele, size_t size, char *out)
 {
     /*
       Byte map for allele flipping (complement):
@@ -267,8 +725,21 @@ static inline void flip_allele(char *allele, size_t size)
     size_t i;
     for (i = 0; i < size; i++)
     {
-        allele[i] = map[((uint8_t)allele[i])];
+        out[i] = map[((uint8_t)allele[i])];
     }
+}
+
+/**
+ * Flip the allele nucleotides (replaces each letter with its complement).
+ * The resulting string is always in uppercase.
+ * Support extended nucleotide letters.
+ *
+ * @param allele  Allele. String containing a sequence of nucleotide letters.
+ * @param size    Length of the allele string.
+ */
+static inline void flip_allele(char *allele, size_t size)
+{
+    flip_allele_copy(allele, size, allele);
     allele[size] = 0;
 }
 
@@ -279,23 +750,70 @@ static inline void swap_sizes(size_t *first, size_t *second)
     *second = tmp;
 }
 
+/**
+ * Swap two alleles in place.
+ * Both buffers must be large enough to contain the longest allele and the terminating null byte.
+ *
+ * @param first       First allele.
+ * @param sizefirst   Length of the first allele, excluding the terminating null byte.
+ * @param second      Second allele.
+ * @param sizesecond  Length of the second allele, excluding the terminating null byte.
+ */
 static inline void swap_alleles(char *first, size_t *sizefirst, char *second, size_t *sizesecond)
 {
-    char tmp[ALLELE_MAXSIZE];
-    strncpy(tmp, first, *sizefirst);
-    strncpy(first, second, *sizesecond);
-    strncpy(second, tmp, *sizefirst);
+    size_t i, size = ((*sizefirst > *sizesecond) ? *sizefirst : *sizesecond);
+    char tmp;
+    for (i = 0; i < size; i++)
+    {
+        tmp = first[i];
+        first[i] = second[i];
+        second[i] = tmp;
+    }
     swap_sizes(sizefirst, sizesecond);
     first[*sizefirst] = 0;
     second[*sizesecond] = 0;
 }
 
+/**
+ * Check the flipped allele (see flip_allele) against either a genoref or a 2-bit packed genoref file,
+ * without modifying the allele. The result is the same of check_reference_any on the flipped allele.
+ *
+ * @param mf      Structure containing the memory mapped genoref or 2-bit packed genoref file.
+ * @param chrom   Encoded Chromosome number (see encode_chrom).
+ * @param pos     Position. The reference position, with the first base having position 0.
+ * @param ref     Allele to be flipped and checked.
+ * @param sizeref Length of the ref string, excluding the terminating null byte.
+ *
+ * @return Same as check_reference.
+ */
+static inline int check_flipped_reference_any(mmfile_t mf, uint8_t chrom, uint32_t pos, const char *ref, size_t sizeref)
+{
+    char buf[CHECKREF_FLIP_BUFSIZE];
+    size_t last, off;
+    int status, ret;
+    if (sizeref == 0)
+    {
+        return check_reference_any(mf, chrom, pos, ref, 0);
+    }
+    // the last block is checked first to report an invalid position before any mismatch
+    last = (((sizeref - 1) / CHECKREF_FLIP_BUFSIZE) * CHECKREF_FLIP_BUFSIZE);
+    flip_allele_copy((ref + last), (sizeref - last), buf);
+    ret = check_reference_any(mf, chrom, (pos + (uint32_t)last), buf, (sizeref - last));
+    for (off = 0; (off < last) && (ret >= 0); off += CHECKREF_FLIP_BUFSIZE)
+    {
+        flip_allele_copy((ref + off), CHECKREF_FLIP_BUFSIZE, buf);
+        status = check_reference_any(mf, chrom, (pos + (uint32_t)off), buf, CHECKREF_FLIP_BUFSIZE);
+        ret = ((status < 0) ? status : (ret | status));
+    }
+    return ret;
+}
+
 /**
  * Normalize a variant.
  * Flip alleles if required and apply the normalization algorithm described at:
  * https://genome.sph.umich.edu/wiki/Variant_Normalization
  *
- * @param mf         Structure containing the memory mapped file.
+ * @param mf         Structure containing the memory mapped genoref or 2-bit packed genoref file.
  * @param chrom      Chromosome encoded number.
  * @param pos        Position. The reference position, with the first base having position 0.
  * @param ref        Reference allele. String containing a sequence of nucleotide letters.
@@ -303,6 +821,10 @@ static inline void swap_alleles(char *first, size_t *sizefirst, char *second, si
  * @param alt        Alternate non-reference allele string.
  * @param sizealt    Length of the alt string, excluding the terminating null byte.
  *
+ * The ref and alt buffers are modified in place: both must be at least max(sizeref, sizealt) + 2 bytes long
+ * to contain the swapped or left-extended alleles and the terminating null byte.
+ * There is no limit on the allele length (see normalize_variant_arena for a version that does not modify the input).
+ *
  * @return Positive bitmask number in case of success, negative number in case of error.
  *         When positive, each bit has a different meaning when set, has defined by the NORM_* defines:
  *         - bit 0 (NORM_VALID) : The reference allele is inconsistent with the genome reference (i.e. when contains nucleotide letters other than A, C, G and T).
@@ -315,17 +837,15 @@ static inline void swap_alleles(char *first, size_t *sizefirst, char *second, si
 static inline int normalize_variant(mmfile_t mf, uint8_t chrom, uint32_t *pos, char *ref, size_t *sizeref, char *alt, size_t *sizealt)
 {
     char left;
-    char fref[ALLELE_MAXSIZE];
-    char falt[ALLELE_MAXSIZE];
     int status;
-    status = check_reference(mf, chrom, *pos, ref, *sizeref);
+    status = check_reference_any(mf, chrom, *pos, ref, *sizeref);
     if (status == -2)
     {
         return status; // invalid position
     }
     if (status < 0)
     {
-        status = check_reference(mf, chrom, *pos, alt, *sizealt);
+        status = check_reference_any(mf, chrom, *pos, alt, *sizealt);
         if (status >= 0)
         {
             swap_alleles(ref, sizeref, alt, sizealt);
@@ -333,25 +853,21 @@ static inline int normalize_variant(mmfile_t mf, uint8_t chrom, uint32_t *pos, c
         }
         else
         {
-            strncpy(fref, ref, *sizeref);
-            flip_allele(fref, *sizeref);
-            status = check_reference(mf, chrom, *pos, fref, *sizeref);
+            status = check_flipped_reference_any(mf, chrom, *pos, ref, *sizeref);
             if (status >= 0)
             {
-                strncpy(ref, fref, *sizealt);
+                flip_allele(ref, *sizeref);
                 flip_allele(alt, *sizealt);
                 status |= NORM_FLIP;
             }
             else
             {
-                strncpy(falt, alt, *sizealt);
-                flip_allele(falt, *sizealt);
-                status = check_reference(mf, chrom, *pos, falt, *sizealt);
+                status = check_flipped_reference_any(mf, chrom, *pos, alt, *sizealt);
                 if (status >= 0)
                 {
-                    strncpy(ref, falt, *sizealt);
-                    strncpy(alt, fref, *sizeref);
-                    swap_sizes(sizeref, sizealt);
+                    swap_alleles(ref, sizeref, alt, sizealt);
+                    flip_allele(ref, *sizeref);
+                    flip_allele(alt, *sizealt);
                     status |= NORM_SWAP + NORM_FLIP;
                 }
                 else
@@ -371,7 +887,7 @@ static inline int normalize_variant(mmfile_t mf, uint8_t chrom, uint32_t *pos, c
         if (((*sizealt == 0) || (*sizeref == 0)) && (*pos > 0))
         {
             (*pos)--;
-            left = (char)mf.src[(mf.index[chrom] + *pos)];
+            left = get_genoref_seq_any(mf, chrom, *pos);
             prepend_char(left, alt, sizealt);
             prepend_char(left, ref, sizeref);
             status |= NORM_LEXT;
@@ -392,8 +908,8 @@ static inline int normalize_variant(mmfile_t mf, uint8_t chrom, uint32_t *pos, c
         }
     }
     // left trim
-    uint8_t offset = 0;
-    while ((offset < (*sizealt - 1)) && (offset < (*sizeref - 1)) && (aztoupper(alt[offset]) == aztoupper(ref[offset])))
+    size_t offset = 0;
+    while (((offset + 1) < *sizealt) && ((offset + 1) < *sizeref) && (aztoupper(alt[offset]) == aztoupper(ref[offset])))
     {
         offset++;
     }
@@ -413,7 +929,7 @@ static inline int normalize_variant(mmfile_t mf, uint8_t chrom, uint32_t *pos, c
 
 /** @brief Returns a normalized 64 bit variant key based on CHROM, POS, REF, ALT.
  *
- * @param mf         Structure containing the memory mapped binary fasta file.
+ * @param mf         Structure containing the memory mapped genoref or 2-bit packed genoref file.
  * @param chrom      Chromosome. An identifier from the reference genome, no white-space or leading zeros permitted.
  * @param sizechrom  Length of the chrom string, excluding the terminating null byte.
  * @param pos        Position. The reference position.
@@ -437,4 +953,307 @@ static inline uint64_t normalized_variantkey(mmfile_t mf, const char *chrom, siz
     return encode_variantkey(echrom, *pos, encode_refalt(ref, *sizeref, alt, *sizealt));
 }
 
+/**
+ * Struct containing the output columns of the batch variant normalization (see normalize_variant_cols).
+ * The normalized REF and ALT alleles are stored in caller-provided arenas as concatenated strings
+ * (without separators or terminating null bytes), using the same layout as variantkey_cols_t.
+ */
+typedef struct normalized_cols_t
+{
+    uint32_t *pos;        //!< Output POS column, with the first base having position 0.
+    char *ref;            //!< Arena for the normalized REF alleles.
+    uint64_t *refoffset;  //!< Output column containing the offset of each REF allele in the ref arena.
+    uint32_t *sizeref;    //!< Output column containing the length of each REF allele.
+    char *alt;            //!< Arena for the normalized ALT alleles.
+    uint64_t *altoffset;  //!< Output column containing the offset of each ALT allele in the alt arena.
+    uint32_t *sizealt;    //!< Output column containing the length of each ALT allele.
+    int *status;          //!< Output column containing the normalization return code of each variant (see normalize_variant).
+    uint64_t refbufsize;  //!< Size in bytes of the ref arena.
+    uint64_t altbufsize;  //!< Size in bytes of the alt arena.
+} normalized_cols_t;
+
+/**
+ * Returns the arena size required to normalize all the variants with normalize_variant_cols.
+ * Both the ref and alt arenas must be at least this size.
+ *
+ * @param vc    Structure containing the pointers to the input columns.
+ *
+ * @return Arena size in bytes.
+ */
+static inline uint64_t normalize_variant_cols_bufsize(variantkey_cols_t vc)
+{
+    uint64_t i, size = 0;
+    for (i = 0; i < vc.nrows; i++)
+    {
+        size += ((vc.sizeref[i] > vc.sizealt[i]) ? vc.sizeref[i] : vc.sizealt[i]) + 1;
+    }
+    return size;
+}
+
+/**
+ * Normalize the variant at row i of the input columns (see normalize_variant).
+ * The alleles are processed in the arena slots R and A, each with one free byte on the left for the left extension.
+ * The normalized alleles are then moved at the beginning of the slots.
+ */
+static inline int normalize_variant_cols_row(mmfile_t mf, variantkey_cols_t vc, uint64_t i, uint32_t *pos, char *R, uint32_t *sizeref, char *A, uint32_t *sizealt)
+{
+    uint8_t chrom = vc.chrom[i];
+    const char *ref = (vc.ref + vc.refoffset[i]);
+    const char *alt = (vc.alt + vc.altoffset[i]);
+    uint32_t sr = vc.sizeref[i];
+    uint32_t sa = vc.sizealt[i];
+    char *rs = (R + 1);
+    char *as = (A + 1);
+    int status = check_reference_any(mf, chrom, *pos, ref, sr);
+    if ((status < 0) && (status != NORM_WRONGPOS))
+    {
+        status = check_reference_any(mf, chrom, *pos, alt, sa);
+        if (status >= 0)
+        {
+            memcpy(rs, alt, sa);
+            memcpy(as, ref, sr);
+            sr = vc.sizealt[i];
+            sa = vc.sizeref[i];
+            status |= NORM_SWAP;
+        }
+        else
+        {
+            flip_allele_copy(ref, sr, rs);
+            status = check_reference_any(mf, chrom, *pos, rs, sr);
+            if (status >= 0)
+            {
+                flip_allele_copy(alt, sa, as);
+                status |= NORM_FLIP;
+            }
+            else
+            {
+                flip_allele_copy(alt, sa, rs);
+                status = check_reference_any(mf, chrom, *pos, rs, sa);
+                if (status >= 0)
+                {
+                    flip_allele_copy(ref, sr, as);
+                    sr = vc.sizealt[i];
+                    sa = vc.sizeref[i];
+                    status |= NORM_SWAP + NORM_FLIP;
+                }
+            }
+        }
+    }
+    if (status < 0)
+    {
+        // invalid reference or position: return the original alleles
+        memcpy(R, ref, vc.sizeref[i]);
+        memcpy(A, alt, vc.sizealt[i]);
+        *sizeref = vc.sizeref[i];
+        *sizealt = vc.sizealt[i];
+        return status;
+    }
+    if ((status & NORM_SWAP) == 0)
+    {
+        if ((status & NORM_FLIP) == 0)
+        {
+            memcpy(rs, ref, sr);
+            memcpy(as, alt, sa);
+        }
+    }
+    if ((sa != 1) || (sr != 1))
+    {
+        while (1)
+        {
+            // left extend: the first extension makes both alleles non-empty and the right trim never empties them,
+            // so this happens at most once and the reserved byte in front of each slot is enough.
+            if (((sa == 0) || (sr == 0)) && (*pos > 0))
+            {
+                (*pos)--;
+                *(--rs) = get_genoref_seq_any(mf, chrom, *pos);
+                *(--as) = *rs;
+                sr++;
+                sa++;
+                status |= NORM_LEXT;
+            }
+            else
+            {
+                // right trim
+                if ((sa > 1) && (sr > 1) && (aztoupper(as[(sa - 1)]) == aztoupper(rs[(sr - 1)])))
+                {
+                    sa--;
+                    sr--;
+                    status |= NORM_RTRIM;
+                }
+                else
+                {
+                    break;
+                }
+            }
+        }
+        // left trim
+        uint32_t offset = 0;
+        while (((offset + 1) < sa) && ((offset + 1) < sr) && (aztoupper(as[offset]) == aztoupper(rs[offset])))
+        {
+            offset++;
+        }
+        if (offset > 0)
+        {
+            *pos += offset;
+            sr -= offset;
+            sa -= offset;
+            rs += offset;
+            as += offset;
+            status |= NORM_LTRIM;
+        }
+    }
+    memmove(R, rs, sr);
+    memmove(A, as, sa);
+    *sizeref = sr;
+    *sizealt = sa;
+    return status;
+}
+
+/**
+ * Normalize an array of variants stored in columnar format.
+ * This returns exactly the same results of calling normalize_variant for each row,
+ * but the alleles are not limited by ALLELE_MAXSIZE, no stack buffers are used
+ * and the left extension does not move the allele strings at every step.
+ * The normalized alleles are written to the caller-provided arenas in nc.
+ *
+ * @param mf    Structure containing the memory mapped genoref or 2-bit packed genoref file.
+ * @param vc    Structure containing the pointers to the input columns.
+ * @param nc    Structure containing the pointers to the output columns and arenas.
+ *              The output columns must be sized to contain at least vc.nrows elements.
+ *
+ * @return Number of normalized rows. This is less than vc.nrows if the arenas are too small
+ *         (see normalize_variant_cols_bufsize), in which case the remaining rows can be processed
+ *         by calling this function again with new arenas and columns starting from the returned row.
+ */
+static inline uint64_t normalize_variant_cols(mmfile_t mf, variantkey_cols_t vc, normalized_cols_t nc)
+{
+    uint64_t i, rcur = 0, acur = 0, cap;
+    for (i = 0; i < vc.nrows; i++)
+    {
+        cap = ((vc.sizeref[i] > vc.sizealt[i]) ? vc.sizeref[i] : vc.sizealt[i]) + 1;
+        if (((rcur + cap) > nc.refbufsize) || ((acur + cap) > nc.altbufsize))
+        {
+            break;
+        }
+        nc.pos[i] = vc.pos[i];
+        nc.status[i] = normalize_variant_cols_row(mf, vc, i, &nc.pos[i], (nc.ref + rcur), &nc.sizeref[i], (nc.alt + acur), &nc.sizealt[i]);
+        nc.refoffset[i] = rcur;
+        nc.altoffset[i] = acur;
+        rcur += nc.sizeref[i];
+        acur += nc.sizealt[i];
+    }
+    return i;
+}
+
+/**
+ * Normalize an array of variants stored in columnar format and returns their VariantKeys.
+ * This is the batch version of normalized_variantkey, with the positions already 0-based
+ * and the chromosomes already encoded (see normalize_variant_cols and variantkey_cols).
+ *
+ * @param mf    Structure containing the memory mapped genoref or 2-bit packed genoref file.
+ * @param vc    Structure containing the pointers to the input columns.
+ * @param nc    Structure containing the pointers to the output columns and arenas.
+ * @param vk    Output array of VariantKeys. It must be sized to contain at least vc.nrows elements.
+ *
+ * @return Number of normalized rows (see normalize_variant_cols).
+ */
+static inline uint64_t normalized_variantkey_cols(mmfile_t mf, variantkey_cols_t vc, normalized_cols_t nc, uint64_t *vk)
+{
+    uint64_t n = normalize_variant_cols(mf, vc, nc);
+    variantkey_cols_t out = vc;
+    out.pos = nc.pos;
+    out.ref = nc.ref;
+    out.refoffset = nc.refoffset;
+    out.sizeref = nc.sizeref;
+    out.alt = nc.alt;
+    out.altoffset = nc.altoffset;
+    out.sizealt = nc.sizealt;
+    out.refbufsize = nc.refbufsize;
+    out.altbufsize = nc.altbufsize;
+    out.nrows = n;
+    variantkey_cols(out, vk);
+    return n;
+}
+
+/**
+ * Normalize a variant without modifying the input alleles and without limits on the allele length.
+ * This returns the same results of normalize_variant, but the normalized alleles are stored
+ * (null-terminated) in the arena, so no memory is allocated once the arena is large enough.
+ * The returned alleles are valid until the next call using the same arena.
+ *
+ * @param mf         Structure containing the memory mapped genoref or 2-bit packed genoref file.
+ * @param chrom      Chromosome encoded number.
+ * @param pos        Position. The reference position, with the first base having position 0.
+ * @param ref        Reference allele. String containing a sequence of nucleotide letters.
+ * @param sizeref    Length of the ref string, excluding the terminating null byte.
+ * @param alt        Alternate non-reference allele string.
+ * @param sizealt    Length of the alt string, excluding the terminating null byte.
+ * @param arena      Allele arena (one for each thread). The input alleles must not be stored in the same arena.
+ * @param nref       Pointer to the normalized reference allele.
+ * @param nsizeref   Length of the normalized reference allele.
+ * @param nalt       Pointer to the normalized alternate allele.
+ * @param nsizealt   Length of the normalized alternate allele.
+ *
+ * @return Same as normalize_variant or NORM_NOMEM if the arena can't be allocated,
+ *         in which case the returned alleles are the input ones.
+ */
+static inline int normalize_variant_arena(mmfile_t mf, uint8_t chrom, uint32_t *pos, const char *ref, size_t sizeref, const char *alt, size_t sizealt, allele_arena_t *arena, const char **nref, size_t *nsizeref, const char **nalt, size_t *nsizealt)
+{
+    size_t cap = (((sizeref > sizealt) ? sizeref : sizealt) + 2); // left extension and terminating null byte
+    char *buf = NULL;
+    if ((sizeref < MAXUINT32) && (sizealt < MAXUINT32))
+    {
+        buf = allele_arena_reserve(arena, (2 * cap));
+    }
+    if (buf == NULL)
+    {
+        *nref = ref;
+        *nsizeref = sizeref;
+        *nalt = alt;
+        *nsizealt = sizealt;
+        return NORM_NOMEM;
+    }
+    uint64_t offset = 0;
+    uint32_t sr = (uint32_t)sizeref, sa = (uint32_t)sizealt;
+    variantkey_cols_t vc = {&chrom, pos, ref, &offset, &sr, alt, &offset, &sa, sizeref, sizealt, 1};
+    int status = normalize_variant_cols_row(mf, vc, 0, pos, buf, &sr, (buf + cap), &sa);
+    buf[sr] = 0;
+    buf[(cap + sa)] = 0;
+    *nref = buf;
+    *nsizeref = sr;
+    *nalt = (buf + cap);
+    *nsizealt = sa;
+    return status;
+}
+
+/** @brief Returns a normalized 64 bit variant key based on CHROM, POS, REF, ALT, without limits on the allele length.
+ * This is the same as normalized_variantkey, but the input alleles are not modified
+ * and the normalized alleles are returned in the arena (see normalize_variant_arena).
+ *
+ * @param mf         Structure containing the memory mapped genoref or 2-bit packed genoref file.
+ * @param chrom      Chromosome. An identifier from the reference genome, no white-space or leading zeros permitted.
+ * @param sizechrom  Length of the chrom string, excluding the terminating null byte.
+ * @param pos        Position. The reference position.
+ * @param posindex   Position index: 0 for 0-based, 1 for 1-based.
+ * @param ref        Reference allele. String containing a sequence of nucleotide letters.
+ * @param sizeref    Length of the ref string, excluding the terminating null byte.
+ * @param alt        Alternate non-reference allele string.
+ * @param sizealt    Length of the alt string, excluding the terminating null byte.
+ * @param arena      Allele arena (one for each thread).
+ * @param nref       Pointer to the normalized reference allele.
+ * @param nsizeref   Length of the normalized reference allele.
+ * @param nalt       Pointer to the normalized alternate allele.
+ * @param nsizealt   Length of the normalized alternate allele.
+ * @param ret        Normalization return value (see: normalize_variant_arena).
+ *
+ * @return      Normalized VariantKey 64 bit code.
+ */
+static inline uint64_t normalized_variantkey_arena(mmfile_t mf, const char *chrom, size_t sizechrom, uint32_t *pos, uint8_t posindex, const char *ref, size_t sizeref, const char *alt, size_t sizealt, allele_arena_t *arena, const char **nref, size_t *nsizeref, const char **nalt, size_t *nsizealt, int *ret)
+{
+    uint8_t echrom = encode_chrom(chrom, sizechrom);
+    (*pos) -= posindex;
+    *ret = normalize_variant_arena(mf, echrom, pos, ref, sizeref, alt, sizealt, arena, nref, nsizeref, nalt, nsizealt);
+    return encode_variantkey(echrom, *pos, encode_refalt(*nref, *nsizeref, *nalt, *nsizealt));
+}
+
 #endif  // VARIANTKEY_GENOREF_H
@@ -35,6 +35,9 @@
  * @brief Utility functions to manipulate strings.
  *
  * Collection of utility functions to manipulate strings.
+ *
+ * The array and stream functions convert whole columns of uint64_t values (e.g. VariantKeys)
+ * to and from 16 digit hexadecimal strings, using SIMD instructions when AVX2 or SSSE3 are available.
  */
 
 #ifndef VARIANTKEY_HEX_H
@@ -42,6 +45,36 @@
 
 #include <inttypes.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "fileio.h"
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+#include <immintrin.h>
+#endif
+
+#define HEX_LINES_RUN 256 //!< Maximum number of 16 digit lines parsed at once by parse_hex_uint64_lines.
+
+#ifndef HEX_STREAM_BUFSIZE
+#define HEX_STREAM_BUFSIZE 1048576 //!< Size of the input buffer of the hexadecimal stream converters (multiple of 8).
+#endif
+
+/** @brief Writes the 16 lowercase hexadecimal digits of a uint64_t number (without the terminating null byte).
+ *
+ * @param n     Number to encode.
+ * @param str   Output buffer (it must be sized 16 bytes at least).
+ */
+static inline void write_hex_uint64_t(uint64_t n, char *str)
+{
+    static const char hexdigit[] = "0123456789abcdef";
+    int i;
+    for (i = 15; i >= 0; i--)
+    {
+        str[i] = hexdigit[(n & 0xF)];
+        n >>= 4;
+    }
+}
 
 /** @brief Returns uint64_t hexadecimal string (16 characters).
  *
@@ -55,7 +88,9 @@
  */
 static inline size_t hex_uint64_t(uint64_t n, char *str)
 {
-    return sprintf(str, "%016" PRIx64, n);
+    write_hex_uint64_t(n, str);
+    str[16] = 0;
+    return 16;
 }
 
 /** @brief Parses a 16 chars hexadecimal string and returns the code.
@@ -92,4 +127,316 @@ static inline uint64_t parse_hex_uint64_t(const char *s)
     return v;
 }
 
+/** @brief Parses a string of up to 16 hexadecimal characters, checking that all the characters are valid.
+ *
+ * @param s     Hexadecimal string to parse.
+ * @param len   Number of characters to parse (1 to 16).
+ * @param v     Parsed value.
+ *
+ * @return 0 in case of success, 1 in case of invalid string.
+ */
+static inline int parse_hex_uint64_t_checked(const char *s, size_t len, uint64_t *v)
+{
+    uint64_t r = 0;
+    uint8_t b, d, l, bad = 0;
+    size_t i;
+    if ((len == 0) || (len > 16))
+    {
+        return 1;
+    }
+    for (i = 0; i < len; i++)
+    {
+        b = (uint8_t)s[i];
+        d = (uint8_t)(b - '0');           // 0-9
+        l = (uint8_t)((b | 0x20) - 'a');  // a-f and A-F
+        bad |= (uint8_t)((d > 9) & (l > 5));
+        r = ((r << 4) | ((d <= 9) ? d : (uint8_t)(l + 10)));
+    }
+    if (bad)
+    {
+        return 1;
+    }
+    *v = r;
+    return 0;
+}
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+
+// Returns the 16 hexadecimal digits of the uint64_t value in the lower 8 bytes of x.
+static inline __m128i hex_uint64_ssse3(__m128i x)
+{
+    const __m128i lut = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+    const __m128i rev = _mm_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1); // most significant byte first
+    const __m128i m = _mm_set1_epi8(0x0F);
+    __m128i d = _mm_unpacklo_epi8(_mm_and_si128(_mm_srli_epi16(x, 4), m), _mm_and_si128(x, m));
+    return _mm_shuffle_epi8(lut, _mm_shuffle_epi8(d, rev));
+}
+
+// Parses 16 hexadecimal digits, storing the value in the lower 8 bytes of the returned vector.
+// Returns a bitmask with one bit set for every valid (0-9, a-f, A-F) character in valid.
+static inline __m128i parse_hex_uint64_ssse3(__m128i v, uint32_t *valid)
+{
+    const __m128i lc = _mm_or_si128(v, _mm_set1_epi8(0x20)); // lowercase
+    const __m128i isdigit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), v));
+    const __m128i isalpha = _mm_and_si128(_mm_cmpgt_epi8(lc, _mm_set1_epi8('a' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('f' + 1), lc));
+    // the low nibble of '0'-'9' is the value, the low nibble of 'a'-'f' and 'A'-'F' is the value - 9
+    __m128i d = _mm_add_epi8(_mm_and_si128(v, _mm_set1_epi8(0x0F)), _mm_and_si128(isalpha, _mm_set1_epi8(9)));
+    d = _mm_maddubs_epi16(d, _mm_set1_epi16(0x0110)); // 2 digits per 16 bit
+    d = _mm_packus_epi16(d, d);
+    *valid = (uint32_t)_mm_movemask_epi8(_mm_or_si128(isdigit, isalpha));
+    return _mm_shuffle_epi8(d, _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8)); // least significant byte first
+}
+
+#endif
+
+/** @brief Writes the 16 lowercase hexadecimal digits of each uint64_t value, followed by an optional separator.
+ * This returns the same characters of calling hex_uint64_t for each value,
+ * but the conversion is processed with SIMD instructions when AVX2 or SSSE3 are available.
+ *
+ * @param src       Array of values to encode.
+ * @param nitems    Number of values.
+ * @param dst       Output buffer (nitems * 16 bytes, or nitems * 17 bytes with a separator). It is not null-terminated.
+ * @param sep       Character written after each value (e.g. '\\n'), or 0 for no separator.
+ *
+ * @return Number of bytes written in dst.
+ */
+static inline size_t hex_uint64_array(const uint64_t *src, uint64_t nitems, char *dst, char sep)
+{
+    size_t stride = (sep != 0) ? 17 : 16;
+    uint64_t i = 0;
+#if defined(__AVX2__)
+    const __m256i lut = _mm256_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+                                         '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+    const __m256i rev = _mm256_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1,
+                                         14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+    const __m128i m = _mm_set1_epi8(0x0F);
+    const uint64_t nv = (nitems & ~(uint64_t)1);
+    __m128i x, hi, lo;
+    __m256i d;
+    for (; i < nv; i += 2)
+    {
+        x = _mm_loadu_si128((const __m128i *)(src + i));
+        hi = _mm_and_si128(_mm_srli_epi16(x, 4), m);
+        lo = _mm_and_si128(x, m);
+        d = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi8(hi, lo)), _mm_unpackhi_epi8(hi, lo), 1);
+        d = _mm256_shuffle_epi8(lut, _mm256_shuffle_epi8(d, rev));
+        if (sep == 0)
+        {
+            _mm256_storeu_si256((__m256i *)(dst + (i * 16)), d);
+            continue;
+        }
+        _mm_storeu_si128((__m128i *)(dst + (i * 17)), _mm256_castsi256_si128(d));
+        dst[((i * 17) + 16)] = sep;
+        _mm_storeu_si128((__m128i *)(dst + (i * 17) + 17), _mm256_extracti128_si256(d, 1));
+        dst[((i * 17) + 33)] = sep;
+    }
+#endif
+    for (; i < nitems; i++)
+    {
+#if defined(__AVX2__) || defined(__SSSE3__)
+        _mm_storeu_si128((__m128i *)(dst + (i * stride)), hex_uint64_ssse3(_mm_loadl_epi64((const __m128i *)(src + i))));
+#else
+        write_hex_uint64_t(src[i], (dst + (i * stride)));
+#endif
+        if (sep != 0)
+        {
+            dst[((i * 17) + 16)] = sep;
+        }
+    }
+    return (size_t)(nitems * stride);
+}
+
+/** @brief Parses an array of 16 digit hexadecimal strings, each followed by an optional separator.
+ * Both lowercase and uppercase digits are accepted, and the conversion stops at the first invalid string
+ * (the separators are not checked).
+ * The conversion is processed with SIMD instructions when AVX2 or SSSE3 are available.
+ *
+ * @param src       Input buffer (nitems * 16 bytes, or nitems * 17 bytes with a separator).
+ * @param nitems    Number of values.
+ * @param dst       Output array of values (nitems items).
+ * @param sep       1 if each string is followed by a one byte separator, 0 otherwise.
+ *
+ * @return Number of parsed values: less than nitems if an invalid string was found.
+ */
+static inline uint64_t parse_hex_uint64_array(const char *src, uint64_t nitems, uint64_t *dst, uint8_t sep)
+{
+    size_t stride = (sep != 0) ? 17 : 16;
+    uint64_t i = 0;
+#if defined(__AVX2__) || defined(__SSSE3__)
+    uint32_t valid;
+    __m128i x;
+    for (; i < nitems; i++)
+    {
+        x = parse_hex_uint64_ssse3(_mm_loadu_si128((const __m128i *)(src + (i * stride))), &valid);
+        if (valid != 0xFFFF)
+        {
+            break;
+        }
+        _mm_storel_epi64((__m128i *)(dst + i), x);
+    }
+#else
+    for (; i < nitems; i++)
+    {
+        if (parse_hex_uint64_t_checked((src + (i * stride)), 16, (dst + i)) != 0)
+        {
+            break;
+        }
+    }
+#endif
+    return i;
+}
+
+/** @brief Parses a buffer of newline-delimited hexadecimal strings (one value per line).
+ * Each line contains 1 to 16 hexadecimal digits, optionally followed by a carriage return; empty lines are skipped.
+ * The lines of exactly 16 digits are parsed with SIMD instructions when AVX2 or SSSE3 are available.
+ * The parsing stops at the last line without a newline or at the first invalid line:
+ * the function can be called again on a buffer starting at *pos with more data appended.
+ *
+ * @param src       Input buffer.
+ * @param len       Length of the input buffer.
+ * @param dst       Output array of values (at least len / 2 items).
+ * @param pos       Position of the first unprocessed byte (the last line without a newline or the first invalid line).
+ *
+ * @return Number of parsed values.
+ */
+static inline uint64_t parse_hex_uint64_lines(const char *src, size_t len, uint64_t *dst, size_t *pos)
+{
+    const char *nl;
+    size_t p = 0, llen;
+    uint64_t n = 0, k, m;
+    while (p < len)
+    {
+        // fast path: a run of lines with exactly 16 digits
+        k = 0;
+        while ((k < HEX_LINES_RUN) && ((p + ((k + 1) * 17)) <= len) && (src[(p + (k * 17) + 16)] == '\n'))
+        {
+            ++k;
+        }
+        if (k > 0)
+        {
+            m = parse_hex_uint64_array((src + p), k, (dst + n), 1);
+            n += m;
+            p += (m * 17);
+            if (m == k)
+            {
+                continue;
+            }
+        }
+        nl = (const char *)memchr((src + p), '\n', (len - p));
+        if (nl == NULL)
+        {
+            break; // incomplete line
+        }
+        llen = (size_t)(nl - (src + p));
+        if ((llen > 0) && (src[(p + llen - 1)] == '\r'))
+        {
+            llen--;
+        }
+        if (llen > 0)
+        {
+            if (parse_hex_uint64_t_checked((src + p), llen, (dst + n)) != 0)
+            {
+                break; // invalid line
+            }
+            n++;
+        }
+        p = (size_t)(nl - src) + 1;
+    }
+    *pos = p;
+    return n;
+}
+
+/** @brief Converts a stream of newline-delimited hexadecimal strings (see parse_hex_uint64_lines)
+ * to a stream of binary uint64_t values in the host byte order (e.g. the raw input of "vkbin -b").
+ *
+ * @param infd      Input file descriptor.
+ * @param outfd     Output file descriptor.
+ * @param nitems    Number of converted values.
+ *
+ * @return 0 in case of success, 1 in case of read/write error, invalid line or memory allocation error.
+ */
+static inline int hex_to_uint64_stream(int infd, int outfd, uint64_t *nitems)
+{
+    char *in = (char *)malloc(HEX_STREAM_BUFSIZE + 1);
+    uint64_t *out = (uint64_t *)malloc(((HEX_STREAM_BUFSIZE / 2) + 1) * sizeof(uint64_t));
+    size_t len = 0, pos;
+    ssize_t r = 1;
+    uint64_t n;
+    int err = ((in == NULL) || (out == NULL));
+    *nitems = 0;
+    while ((err == 0) && (r > 0))
+    {
+        r = read(infd, (in + len), (HEX_STREAM_BUFSIZE - len));
+        if (r < 0)
+        {
+            if (errno == EINTR)
+            {
+                r = 1;
+                continue;
+            }
+            err = 1;
+            break;
+        }
+        len += (size_t)r;
+        if ((r == 0) && (len > 0) && (in[(len - 1)] != '\n'))
+        {
+            in[len++] = '\n'; // last line without newline
+        }
+        n = parse_hex_uint64_lines(in, len, out, &pos);
+        *nitems += n;
+        err = (write_all_fd(outfd, out, (size_t)(n * sizeof(uint64_t))) != 0);
+        if ((memchr((in + pos), '\n', (len - pos)) != NULL) || ((pos == 0) && (len == HEX_STREAM_BUFSIZE)))
+        {
+            err = 1; // invalid or too long line
+        }
+        len -= pos;
+        memmove(in, (in + pos), len);
+    }
+    free(in);
+    free(out);
+    return err;
+}
+
+/** @brief Converts a stream of binary uint64_t values in the host byte order
+ * to a stream of newline-delimited 16 digit hexadecimal strings.
+ *
+ * @param infd      Input file descriptor.
+ * @param outfd     Output file descriptor.
+ * @param nitems    Number of converted values.
+ *
+ * @return 0 in case of success, 1 in case of read/write error, truncated input or memory allocation error.
+ */
+static inline int uint64_to_hex_stream(int infd, int outfd, uint64_t *nitems)
+{
+    uint64_t *in = (uint64_t *)malloc(HEX_STREAM_BUFSIZE);
+    char *out = (char *)malloc((HEX_STREAM_BUFSIZE / 8) * 17);
+    size_t len = 0, n;
+    ssize_t r = 1;
+    int err = ((in == NULL) || (out == NULL));
+    *nitems = 0;
+    while ((err == 0) && (r > 0))
+    {
+        r = read(infd, ((char *)in + len), (HEX_STREAM_BUFSIZE - len));
+        if (r < 0)
+        {
+            if (errno == EINTR)
+            {
+                r = 1;
+                continue;
+            }
+            err = 1;
+            break;
+        }
+        len += (size_t)r;
+        n = (len / 8);
+        *nitems += n;
+        err = (write_all_fd(outfd, out, hex_uint64_array(in, n, out, '\n')) != 0);
+        len -= (n * 8);
+        memmove(in, (in + n), len);
+    }
+    free(in);
+    free(out);
+    return (err | (len != 0));
+}
+
 #endif  // VARIANTKEY_HEX_H
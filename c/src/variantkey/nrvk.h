@@ -55,13 +55,30 @@
 
 #include <stdio.h>
 #include <string.h>
+#include "binfuse.h"
 #include "binsearch.h"
+#include "fileio.h"
+#include "set.h"
 #include "variantkey.h"
 
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 #ifndef ALLELE_MAXSIZE
 #define ALLELE_MAXSIZE 256 //!< Maximum allele length.
 #endif
 
+#ifndef NRVK_TSV_CHUNK_ROWS
+#define NRVK_TSV_CHUNK_ROWS 65536 //!< Number of rows formatted at once by each chunk of parallel_nrvk_bin_to_tsv.
+#endif
+
+#define NRVK_TSV_MAXTHREADS 64 //!< Maximum number of threads used by parallel_nrvk_bin_to_tsv.
+
+#ifndef NRVK_BATCH_SIZE
+#define NRVK_BATCH_SIZE 65536 //!< Maximum number of non-reversible VariantKeys sorted at once by get_variantkey_ref_length_array.
+#endif
+
 /**
  * VariantKey decoded struct
  */
@@ -75,51 +92,410 @@ typedef struct variantkey_rev_t
     size_t sizealt;            //!< Length of alternate allele
 } variantkey_rev_t;
 
+/**
+ * VariantKey decoded struct with variable-length alleles stored in an allele arena (see reverse_variantkey_arena).
+ */
+typedef struct variantkey_rev_arena_t
+{
+    char chrom[3];             //!< Chromosome.
+    uint32_t pos;              //!< Reference position, with the first base having position 0.
+    const char *ref;           //!< Reference allele (null-terminated).
+    const char *alt;           //!< Alternate allele (null-terminated).
+    size_t sizeref;            //!< Length of reference allele
+    size_t sizealt;            //!< Length of alternate allele
+} variantkey_rev_arena_t;
+
+/*
+    Compressed NRVK format (v2).
+
+    The file is a BINSRC1 file with nrows = number of VariantKeys and four columns of different lengths:
+
+        - VariantKey (uint64_t, nrows items, sorted as in the uncompressed format);
+        - format information (uint64_t, 2 items): version (2) and number of rows per block;
+        - offset of each block in the data column (uint64_t, nblocks + 1 items, the last one is the data length);
+        - data (uint8_t): the compressed blocks, stored one after the other.
+
+    Each block contains up to "number of rows per block" rows, stored as:
+
+        - varint header: (REF length << 2) | (same REF << 1) | packed;
+        - varint ALT length;
+        - payload: REF and ALT letters, or ALT only when "same REF" is set
+          (the REF is the last one stored in the block, so this is never set for the first row of a block).
+          When "packed" is set the letters are all A, C, G or T and are 2-bit packed
+          (4 nucleotides per byte, A=0 C=1 G=2 T=3, first nucleotide in the lowest bits).
+
+    A row is accessed by jumping to the beginning of its block and decoding the rows headers up to the requested one.
+*/
+
+#define NRVK2_NCOLS      4  //!< Number of columns in the compressed NRVK file.
+#define NRVK2_COL_VK     0  //!< Column containing the VariantKeys.
+#define NRVK2_COL_INFO   1  //!< Column containing the format version and the number of rows per block.
+#define NRVK2_COL_BLOCK  2  //!< Column containing the offset of each block in the data column.
+#define NRVK2_COL_DATA   3  //!< Column containing the compressed blocks.
+#define NRVK2_VERSION    2  //!< Version of the compressed NRVK format.
+#define NRVK2_BLOCK_ROWS 64 //!< Default number of rows per block.
+
 /**
  * Struct containing the NRVK memory mapped file column info.
  */
 typedef struct nrvk_cols_t
 {
     const uint64_t *vk;      //!< Pointer to the VariantKey column.
-    const uint64_t *offset;  //!< Pointer to the Offset column.
+    const uint64_t *offset;  //!< Pointer to the Offset column (block offsets in the compressed format).
     const uint8_t  *data;    //!< Pointer to the Data column.
     uint64_t nrows;          //!< Number of rows.
+    uint64_t blockrows;      //!< Number of rows per block in the compressed format, 0 for the uncompressed format.
+    const uint64_t *hash;    //!< Pointer to the optional hash index slots (NULL when the hash index is not loaded).
+    uint64_t hashbits;       //!< Number of bits of the hash index slot number.
+    const uint64_t *filter;  //!< Pointer to the optional binary fuse filter of the VariantKey column (NULL when not loaded).
 } nrvk_cols_t;
 
 /**
- * Memory map the NRVK binary file.
+ * Location of a REF or ALT allele in the NRVK data column.
+ */
+typedef struct nrvk_allele_t
+{
+    const uint8_t *data;     //!< Pointer to the allele letters or to the 2-bit packed nucleotides.
+    uint64_t start;          //!< Index of the first nucleotide in the packed data (always 0 for letters).
+    size_t size;             //!< Allele length.
+    uint8_t packed;          //!< 1 if the nucleotides are 2-bit packed.
+} nrvk_allele_t;
+
+/**
+ * Cursor to sequentially decode the rows of a compressed NRVK file.
+ */
+typedef struct nrvk2_cursor_t
+{
+    const uint8_t *p;        //!< Pointer to the next row in the data column.
+    uint64_t row;            //!< Index of the next row.
+    nrvk_allele_t ref;       //!< Last REF allele stored in the current block.
+} nrvk2_cursor_t;
+
+/**
+ * Memory map the NRVK binary file (either the uncompressed or the compressed format).
  *
  * @param file  Path to the file to map.
  * @param mf    Structure containing the memory mapped file.
  * @param nvc   Structure containing the pointers to the memory mapped file columns.
  *
- * @return Returns the memory-mapped file descriptors.
+ * @return 0 in case of success, 1 if the file can't be mapped or uses an unsupported compressed format version
+ *         (the columns are then left empty).
  */
-static inline void mmap_nrvk_file(const char *file, mmfile_t *mf, nrvk_cols_t *nvc)
+static inline int mmap_nrvk_file(const char *file, mmfile_t *mf, nrvk_cols_t *nvc)
 {
     mmap_binfile(file, mf);
+    nvc->vk = NULL;
+    nvc->offset = NULL;
+    nvc->data = NULL;
+    nvc->nrows = 0;
+    nvc->blockrows = 0;
+    nvc->hash = NULL;
+    nvc->hashbits = 0;
+    nvc->filter = NULL;
+    if ((mf->fd < 0) || (mf->src == MAP_FAILED))
+    {
+        return 1;
+    }
+    if (mf->ncols == NRVK2_NCOLS)
+    {
+        const uint64_t *info = (const uint64_t *)(mf->src + mf->index[NRVK2_COL_INFO]);
+        if ((info[0] != NRVK2_VERSION) || (info[1] == 0))
+        {
+            return 1; // unsupported format
+        }
+        nvc->vk = (const uint64_t *)(mf->src + mf->index[NRVK2_COL_VK]);
+        nvc->offset = (const uint64_t *)(mf->src + mf->index[NRVK2_COL_BLOCK]);
+        nvc->data = (const uint8_t *)(mf->src + mf->index[NRVK2_COL_DATA]);
+        nvc->nrows = mf->nrows;
+        nvc->blockrows = info[1];
+        return 0;
+    }
     nvc->vk = (const uint64_t *)(mf->src + mf->index[0]);
     nvc->offset = (const uint64_t *)(mf->src + mf->index[1]);
     nvc->data = (const uint8_t *)(mf->src + mf->index[2]);
     nvc->nrows = mf->nrows;
+    return 0;
 }
 
-static inline size_t get_nrvk_ref_alt_by_pos(nrvk_cols_t nvc, uint64_t pos, char *ref, size_t *sizeref, char *alt, size_t *sizealt)
+static inline const uint8_t *nrvk2_read_varint(const uint8_t *p, uint64_t *v)
+{
+    uint64_t r = 0;
+    uint8_t shift = 0;
+    uint8_t b;
+    do
+    {
+        b = *p++;
+        r |= ((uint64_t)(b & 0x7f) << shift);
+        shift += 7;
+    }
+    while (b & 0x80);
+    *v = r;
+    return p;
+}
+
+static inline size_t nrvk2_write_varint(uint8_t *p, uint64_t v)
+{
+    size_t n = 0;
+    while (v >= 0x80)
+    {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+/**
+ * Position the cursor at the beginning of the block containing the specified row.
+ *
+ * @param nvc   Structure containing the pointers to the memory mapped compressed NRVK file columns.
+ * @param row   Row index.
+ * @param cur   Cursor to be initialized.
+ */
+static inline void nrvk2_cursor_seek(nrvk_cols_t nvc, uint64_t row, nrvk2_cursor_t *cur)
+{
+    uint64_t block = (row / nvc.blockrows);
+    cur->p = (nvc.data + nvc.offset[block]);
+    cur->row = (block * nvc.blockrows);
+    memset(&cur->ref, 0, sizeof(cur->ref));
+}
+
+/**
+ * Decode the row at the cursor position and move the cursor to the next row.
+ * The blocks are contiguous, so the cursor can be used to scan the whole file.
+ *
+ * @param cur   Cursor.
+ * @param ref   REF allele location to be returned.
+ * @param alt   ALT allele location to be returned.
+ */
+static inline void nrvk2_cursor_next(nrvk2_cursor_t *cur, nrvk_allele_t *ref, nrvk_allele_t *alt)
+{
+    uint64_t h, sizealt, n;
+    cur->p = nrvk2_read_varint(cur->p, &h);
+    cur->p = nrvk2_read_varint(cur->p, &sizealt);
+    alt->packed = (uint8_t)(h & 1);
+    alt->size = (size_t)sizealt;
+    alt->data = cur->p;
+    alt->start = 0;
+    n = sizealt;
+    if (h & 2)
+    {
+        *ref = cur->ref; // same REF of the previous row
+    }
+    else
+    {
+        ref->data = cur->p;
+        ref->start = 0;
+        ref->size = (size_t)(h >> 2);
+        ref->packed = alt->packed;
+        cur->ref = *ref;
+        if (alt->packed)
+        {
+            alt->start = ref->size;
+        }
+        else
+        {
+            alt->data += ref->size;
+        }
+        n += ref->size;
+    }
+    cur->p += (alt->packed ? ((n + 3) >> 2) : n);
+    cur->row++;
+}
+
+/**
+ * Copy the allele letters to the output buffer (not null-terminated).
+ *
+ * @param a     Allele location.
+ * @param out   Output buffer of at least a.size bytes.
+ */
+static inline void decode_nrvk_allele(nrvk_allele_t a, char *out)
+{
+    static const char base[] = "ACGT";
+    uint64_t k;
+    size_t i;
+    if (!a.packed)
+    {
+        memcpy(out, a.data, a.size);
+        return;
+    }
+    for (i = 0; i < a.size; i++)
+    {
+        k = (a.start + i);
+        out[i] = base[((a.data[(k >> 2)] >> ((k & 3) << 1)) & 3)];
+    }
+}
+
+/**
+ * Returns the location of the REF and ALT alleles at the specified row of an NRVK file (either format).
+ *
+ * @param nvc   Structure containing the pointers to the memory mapped file columns.
+ * @param pos   Row index.
+ * @param ref   REF allele location to be returned.
+ * @param alt   ALT allele location to be returned.
+ *
+ * @return 1 if the row exists, 0 otherwise.
+ */
+static inline int get_nrvk_alleles_by_pos(nrvk_cols_t nvc, uint64_t pos, nrvk_allele_t *ref, nrvk_allele_t *alt)
 {
     if (pos >= nvc.nrows)
     {
         return 0; // not found
     }
-    const uint8_t *data = (nvc.data + *(nvc.offset + pos));
-    *sizeref = (size_t)(*(data++));
-    *sizealt = (size_t)(*(data++));
-    memcpy(ref, data, *sizeref);
+    if (nvc.blockrows == 0)
+    {
+        const uint8_t *data = (nvc.data + nvc.offset[pos]);
+        ref->size = (size_t)data[0];
+        ref->data = (data + 2);
+        ref->start = 0;
+        ref->packed = 0;
+        alt->size = (size_t)data[1];
+        alt->data = (ref->data + ref->size);
+        alt->start = 0;
+        alt->packed = 0;
+        return 1;
+    }
+    nrvk2_cursor_t cur;
+    memset(ref, 0, sizeof(nrvk_allele_t));
+    memset(alt, 0, sizeof(nrvk_allele_t));
+    nrvk2_cursor_seek(nvc, pos, &cur);
+    do
+    {
+        nrvk2_cursor_next(&cur, ref, alt);
+    }
+    while (cur.row <= pos);
+    return 1;
+}
+
+static inline size_t get_nrvk_ref_alt_by_pos(nrvk_cols_t nvc, uint64_t pos, char *ref, size_t *sizeref, char *alt, size_t *sizealt)
+{
+    nrvk_allele_t r, a;
+    if (get_nrvk_alleles_by_pos(nvc, pos, &r, &a) == 0)
+    {
+        return 0; // not found
+    }
+    *sizeref = r.size;
+    *sizealt = a.size;
+    decode_nrvk_allele(r, ref);
     ref[*sizeref] = 0;
-    memcpy(alt, (data + *sizeref), *sizealt);
+    decode_nrvk_allele(a, alt);
     alt[*sizealt] = 0;
     return (*sizeref + *sizealt);
 }
 
+/*
+    NRVK hash index.
+
+    Optional sidecar file to find the NRVK row of a VariantKey with (on average) a single memory access
+    instead of a binary search. The file is a BINSRC1 file with nrows = number of slots (a power of 2) and two columns:
+
+        - format information (uint64_t, 4 items): version (2), number of bits of the slot number, number of NRVK rows
+          and check value of the NRVK VariantKey column (see binfuse_check);
+        - slots (uint64_t, 2 * nrows items): VariantKey and NRVK row + 1 (0 = empty slot) for each slot.
+
+    The slot of a VariantKey is the top bits of the VariantKey multiplied by a 64-bit odd constant,
+    collisions are resolved with linear probing. The table is at most half full.
+    The row returned by the index is verified against the NRVK VariantKey column before being used.
+*/
+
+#define NRVKHASH_NCOLS    2  //!< Number of columns in the NRVK hash index file.
+#define NRVKHASH_COL_INFO 0  //!< Column containing the format information.
+#define NRVKHASH_COL_SLOT 1  //!< Column containing the hash slots.
+#define NRVKHASH_VERSION  2  //!< Version of the NRVK hash index format.
+#define NRVKHASH_NINFO    4  //!< Number of uint64_t items of the format information column.
+
+static inline uint64_t nrvk_hash_slot(uint64_t vk, uint64_t bits)
+{
+    return ((vk * 0x9e3779b97f4a7c15) >> (64 - bits));
+}
+
+/**
+ * Memory map the NRVK hash index file and attach it to the NRVK columns.
+ * Once attached, the VariantKey lookups use the hash index instead of the binary search.
+ * The index is ignored if it was not built for the same NRVK file.
+ *
+ * @param file  Path to the file to map.
+ * @param mf    Structure containing the memory mapped file.
+ * @param nvc   Structure containing the pointers to the memory mapped NRVK file columns (already mapped).
+ */
+static inline void mmap_nrvk_hash_file(const char *file, mmfile_t *mf, nrvk_cols_t *nvc)
+{
+    mmap_binfile(file, mf);
+    if ((mf->ncols != NRVKHASH_NCOLS) || (mf->nrows == 0))
+    {
+        return;
+    }
+    if ((mf->index[NRVKHASH_COL_SLOT] - mf->index[NRVKHASH_COL_INFO]) < (NRVKHASH_NINFO * sizeof(uint64_t)))
+    {
+        return;
+    }
+    const uint64_t *info = (const uint64_t *)(mf->src + mf->index[NRVKHASH_COL_INFO]);
+    if ((info[0] != NRVKHASH_VERSION) || (info[1] == 0) || (info[1] > 63) || (mf->nrows != ((uint64_t)1 << info[1]))
+            || (info[2] != nvc->nrows) || (info[3] != binfuse_check(nvc->vk, nvc->nrows)))
+    {
+        return;
+    }
+    nvc->hash = (const uint64_t *)(mf->src + mf->index[NRVKHASH_COL_SLOT]);
+    nvc->hashbits = info[1];
+}
+
+/**
+ * Memory map the binary fuse filter of the NRVK VariantKey column and attach it to the NRVK columns.
+ * The filter can be built with build_binfuse_file(file, nvc.vk, nvc.nrows) (see binfuse.h).
+ * Once attached, most of the VariantKeys that are not in the NRVK file are rejected without accessing the file.
+ * The filter is ignored if it was not built for the same NRVK file.
+ *
+ * @param file  Path to the file to map.
+ * @param mf    Structure containing the memory mapped file.
+ * @param nvc   Structure containing the pointers to the memory mapped NRVK file columns (already mapped).
+ */
+static inline void mmap_nrvk_filter_file(const char *file, mmfile_t *mf, nrvk_cols_t *nvc)
+{
+    nvc->filter = mmap_binfuse_file(file, mf, nvc->vk, nvc->nrows);
+}
+
+/**
+ * Returns the NRVK row of the specified VariantKey.
+ * The VariantKey is first checked against the filter attached with mmap_nrvk_filter_file (if any).
+ * The hash index is used when attached with mmap_nrvk_hash_file, otherwise the VariantKey column is binary searched.
+ *
+ * @param nvc      Structure containing the pointers to the memory mapped file columns.
+ * @param vk       VariantKey to search.
+ *
+ * @return Row index (the first one in case of duplicates) or nvc.nrows if not found.
+ */
+static inline uint64_t find_nrvk_row(nrvk_cols_t nvc, uint64_t vk)
+{
+    if ((nvc.filter != NULL) && !binfuse_contain(nvc.filter, vk))
+    {
+        return nvc.nrows; // certainly not found
+    }
+    if (nvc.hash == NULL)
+    {
+        uint64_t first = 0;
+        uint64_t max = nvc.nrows;
+        uint64_t found = col_find_first_uint64_t(nvc.vk, &first, &max, vk);
+        return (found < nvc.nrows) ? found : nvc.nrows;
+    }
+    uint64_t mask = (((uint64_t)1 << nvc.hashbits) - 1);
+    uint64_t h = nrvk_hash_slot(vk, nvc.hashbits);
+    const uint64_t *slot;
+    while (1)
+    {
+        slot = (nvc.hash + (h << 1));
+        if (slot[1] == 0)
+        {
+            return nvc.nrows; // not found
+        }
+        if (slot[0] == vk)
+        {
+            uint64_t row = (slot[1] - 1);
+            return ((row < nvc.nrows) && (nvc.vk[row] == vk)) ? row : nvc.nrows;
+        }
+        h = ((h + 1) & mask);
+    }
+}
+
 /**
  * Retrieve the REF and ALT strings for the specified VariantKey.
  *
@@ -136,10 +512,7 @@ static inline size_t get_nrvk_ref_alt_by_pos(nrvk_cols_t nvc, uint64_t pos, char
  */
 static inline size_t find_ref_alt_by_variantkey(nrvk_cols_t nvc, uint64_t vk, char *ref, size_t *sizeref, char *alt, size_t *sizealt)
 {
-    uint64_t first = 0;
-    uint64_t max = nvc.nrows;
-    uint64_t found = col_find_first_uint64_t(nvc.vk, &first, &max, vk);
-    return get_nrvk_ref_alt_by_pos(nvc, found, ref, sizeref, alt, sizealt);
+    return get_nrvk_ref_alt_by_pos(nvc, find_nrvk_row(nvc, vk), ref, sizeref, alt, sizealt);
 }
 
 /**
@@ -163,6 +536,67 @@ static inline size_t reverse_variantkey(nrvk_cols_t nvc, uint64_t vk, variantkey
     return len;
 }
 
+/**
+ * Reverse a VariantKey code without limits on the allele length.
+ * This is the same as reverse_variantkey, but the alleles are stored in the arena,
+ * so no memory is allocated once the arena is large enough and only the actual allele bytes are copied.
+ * The returned alleles are valid until the next call using the same arena.
+ *
+ * @param nvc      Structure containing the pointers to the memory mapped file columns.
+ * @param vk       VariantKey code.
+ * @param arena    Allele arena (one for each thread).
+ * @param rev      Structure containing the return values.
+ *
+ * @return REF+ALT length or 0 if the VariantKey is not reversible and not found (or the arena can't be allocated).
+ */
+static inline size_t reverse_variantkey_arena(nrvk_cols_t nvc, uint64_t vk, allele_arena_t *arena, variantkey_rev_arena_t *rev)
+{
+    char *buf;
+    size_t len = 0;
+    decode_chrom(extract_variantkey_chrom(vk), rev->chrom);
+    rev->pos = extract_variantkey_pos(vk);
+    rev->ref = rev->alt = "";
+    rev->sizeref = rev->sizealt = 0;
+    if ((vk & 0x1) == 0) // reversible encoding: up to 11 bases in total
+    {
+        buf = allele_arena_reserve(arena, 32); // the allele lengths are stored in 4 bits
+        if (buf == NULL)
+        {
+            return 0;
+        }
+        len = decode_refalt(extract_variantkey_refalt(vk), buf, &rev->sizeref, (buf + 16), &rev->sizealt);
+        rev->ref = buf;
+        rev->alt = (buf + 16);
+        return len;
+    }
+    if (nvc.nrows == 0)
+    {
+        return 0;
+    }
+    uint64_t found = find_nrvk_row(nvc, vk);
+    if (found >= nvc.nrows)
+    {
+        return 0; // not found
+    }
+    nrvk_allele_t r, a;
+    get_nrvk_alleles_by_pos(nvc, found, &r, &a);
+    len = (r.size + a.size);
+    buf = allele_arena_reserve(arena, (len + 2));
+    if (buf == NULL)
+    {
+        return 0;
+    }
+    rev->sizeref = r.size;
+    rev->sizealt = a.size;
+    decode_nrvk_allele(r, buf);
+    buf[rev->sizeref] = 0;
+    decode_nrvk_allele(a, (buf + rev->sizeref + 1));
+    buf[(len + 1)] = 0;
+    rev->ref = buf;
+    rev->alt = (buf + rev->sizeref + 1);
+    return len;
+}
+
 /**
  * Retrieve the REF length for the specified VariantKey.
  *
@@ -177,14 +611,12 @@ static inline size_t get_variantkey_ref_length(nrvk_cols_t nvc, uint64_t vk)
     {
         return ((vk & 0x0000000078000000) >> 27); // [00000000 00000000 00000000 00000000 01111000 00000000 00000000 00000000]
     }
-    uint64_t first = 0;
-    uint64_t max = nvc.nrows;
-    uint64_t found = col_find_first_uint64_t(nvc.vk, &first, &max, vk);
-    if (found >= nvc.nrows)
+    nrvk_allele_t ref, alt;
+    if (get_nrvk_alleles_by_pos(nvc, find_nrvk_row(nvc, vk), &ref, &alt) == 0)
     {
         return 0; // not found
     }
-    return (size_t)(*(nvc.data + *(nvc.offset + found)));
+    return ref.size;
 }
 
 /**
@@ -224,7 +656,400 @@ static inline uint64_t get_variantkey_chrom_endpos(nrvk_cols_t nvc, uint64_t vk)
 }
 
 /**
- * Convert a vrnr.bin file to a simple TSV.
+ * Decode the REF lengths of an array of VariantKeys without branches, using SIMD instructions when AVX2 or SSE2 are available.
+ * Each output item is set to (POS & posmask) + REF length, where the REF length is zero for the non-reversible VariantKeys.
+ *
+ * @param vk       Array of VariantKeys.
+ * @param nitems   Number of VariantKeys in the array.
+ * @param out      Output array (nitems items).
+ * @param posmask  Mask applied to the POS value: 0 to return the REF lengths, 0x0FFFFFFF to return the end positions.
+ */
+static inline void decode_variantkey_ref_length_array(const uint64_t *vk, uint64_t nitems, uint32_t *out, uint32_t posmask)
+{
+    uint64_t i = 0;
+#if defined(__AVX2__)
+    const __m256i pm = _mm256_set1_epi64x((int64_t)posmask);
+    const __m256i lm = _mm256_set1_epi64x(0xF);
+    const __m256i one = _mm256_set1_epi64x(1);
+    const __m256i perm = _mm256_setr_epi32(0, 2, 4, 6, 0, 0, 0, 0);
+    const uint64_t nv = (nitems & ~(uint64_t)3);
+    __m256i v, rev, len;
+    for (; i < nv; i += 4)
+    {
+        v = _mm256_loadu_si256((const __m256i *)(vk + i));
+        rev = _mm256_sub_epi64(_mm256_and_si256(v, one), one); // all bits set for the reversible keys
+        len = _mm256_and_si256(_mm256_and_si256(_mm256_srli_epi64(v, 27), lm), rev);
+        v = _mm256_add_epi64(_mm256_and_si256(_mm256_srli_epi64(v, 31), pm), len);
+        _mm_storeu_si128((__m128i *)(out + i), _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(v, perm)));
+    }
+#elif defined(__SSE2__)
+    const __m128i pm = _mm_set1_epi64x((int64_t)posmask);
+    const __m128i lm = _mm_set1_epi64x(0xF);
+    const __m128i one = _mm_set1_epi64x(1);
+    const uint64_t nv = (nitems & ~(uint64_t)1);
+    __m128i v, rev, len;
+    for (; i < nv; i += 2)
+    {
+        v = _mm_loadu_si128((const __m128i *)(vk + i));
+        rev = _mm_sub_epi64(_mm_and_si128(v, one), one); // all bits set for the reversible keys
+        len = _mm_and_si128(_mm_and_si128(_mm_srli_epi64(v, 27), lm), rev);
+        v = _mm_add_epi64(_mm_and_si128(_mm_srli_epi64(v, 31), pm), len);
+        _mm_storel_epi64((__m128i *)(out + i), _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+#endif
+    for (; i < nitems; i++)
+    {
+        out[i] = (uint32_t)(((vk[i] >> 31) & posmask) + (((vk[i] >> 27) & 0xF) & ((vk[i] & 0x1) - 1)));
+    }
+}
+
+// Returns the REF length of a non-reversible VariantKey, searching the NRVK VariantKey column from *row with a galloping search.
+static inline uint32_t gallop_nrvk_ref_length(nrvk_cols_t nvc, uint64_t *row, uint64_t vk)
+{
+    nrvk_allele_t ref, alt;
+    *row = col_find_gallop_uint64_t(nvc.vk, *row, nvc.nrows, vk);
+    if ((*row < nvc.nrows) && (nvc.vk[*row] == vk) && (get_nrvk_alleles_by_pos(nvc, *row, &ref, &alt) != 0))
+    {
+        return (uint32_t)ref.size;
+    }
+    return 0;
+}
+
+// Resolve the REF lengths (posmask = 0) or end positions (posmask = 0x0FFFFFFF) of an array of VariantKeys.
+static inline void resolve_variantkey_ref_length_array(nrvk_cols_t nvc, const uint64_t *vk, uint64_t nitems, uint32_t *out, uint32_t posmask)
+{
+    uint64_t i, j, nh, row = 0, prev = 0;
+    decode_variantkey_ref_length_array(vk, nitems, out, posmask);
+    for (i = 0; (i < nitems) && (((vk[i] & 0x1) == 0) || (vk[i] >= prev)); i++)
+    {
+        prev = ((vk[i] & 0x1) ? vk[i] : prev);
+    }
+    if (i == nitems)
+    {
+        // the non-reversible keys are already sorted: merge them in place
+        for (i = 0; i < nitems; i++)
+        {
+            if (vk[i] & 0x1)
+            {
+                out[i] += gallop_nrvk_ref_length(nvc, &row, vk[i]);
+            }
+        }
+        return;
+    }
+    uint64_t bsize = ((nitems < NRVK_BATCH_SIZE) ? nitems : NRVK_BATCH_SIZE);
+    uint64_t *hk = (uint64_t *)malloc((size_t)(3 * bsize * sizeof(uint64_t)));
+    uint32_t *idx = (uint32_t *)malloc((size_t)(2 * bsize * sizeof(uint32_t)));
+    if ((hk == NULL) || (idx == NULL))
+    {
+        // not enough memory to sort: search each key
+        for (i = 0; i < nitems; i++)
+        {
+            if (vk[i] & 0x1)
+            {
+                out[i] += (uint32_t)get_variantkey_ref_length(nvc, vk[i]);
+            }
+        }
+        free(hk);
+        free(idx);
+        return;
+    }
+    uint64_t *tmp = (hk + bsize);
+    uint64_t *hpos = (tmp + bsize);
+    uint32_t *tdx = (idx + bsize);
+    for (i = 0; i < nitems;)
+    {
+        // partition a batch of non-reversible keys, sort them and merge them with the NRVK VariantKey column
+        for (nh = 0; (i < nitems) && (nh < bsize); i++)
+        {
+            if (vk[i] & 0x1)
+            {
+                hk[nh] = vk[i];
+                hpos[nh++] = i;
+            }
+        }
+        order_uint64_t(hk, tmp, idx, tdx, (uint32_t)nh);
+        for (row = 0, j = 0; j < nh; j++)
+        {
+            out[hpos[idx[j]]] += gallop_nrvk_ref_length(nvc, &row, hk[j]);
+        }
+    }
+    free(hk);
+    free(idx);
+}
+
+/**
+ * Get the REF lengths of an array of VariantKeys.
+ * This returns the same values of calling get_variantkey_ref_length() for each item, but:
+ * the reversible VariantKeys are decoded without branches using SIMD instructions;
+ * the non-reversible VariantKeys are partitioned out, sorted (unless already sorted)
+ * and resolved with a single merge pass over the NRVK VariantKey column.
+ *
+ * @param nvc      Structure containing the pointers to the memory mapped file columns.
+ * @param vk       Array of VariantKeys.
+ * @param nitems   Number of VariantKeys in the array.
+ * @param reflen   Output array of REF lengths (nitems items), 0 for the non-reversible keys not found.
+ */
+static inline void get_variantkey_ref_length_array(nrvk_cols_t nvc, const uint64_t *vk, uint64_t nitems, uint32_t *reflen)
+{
+    resolve_variantkey_ref_length_array(nvc, vk, nitems, reflen, 0);
+}
+
+/**
+ * Get the end positions (POS + REF length) of an array of VariantKeys.
+ * This returns the same values of calling get_variantkey_endpos() for each item
+ * (see get_variantkey_ref_length_array).
+ *
+ * @param nvc      Structure containing the pointers to the memory mapped file columns.
+ * @param vk       Array of VariantKeys.
+ * @param nitems   Number of VariantKeys in the array.
+ * @param endpos   Output array of the variant end positions (nitems items).
+ */
+static inline void get_variantkey_endpos_array(nrvk_cols_t nvc, const uint64_t *vk, uint64_t nitems, uint32_t *endpos)
+{
+    resolve_variantkey_ref_length_array(nvc, vk, nitems, endpos, 0x0FFFFFFF);
+}
+
+/**
+ * Chunk of rows of the TSV export, formatted by one thread in its own buffer.
+ */
+typedef struct nrvk_tsv_chunk_t
+{
+    nrvk_cols_t nvc;  //!< Structure containing the pointers to the memory mapped file columns.
+    uint64_t first;   //!< First row of the chunk.
+    uint64_t last;    //!< Row (up to but not including) where the chunk ends.
+    char *buf;        //!< Output buffer.
+    size_t size;      //!< Number of bytes written in the output buffer.
+    size_t maxsize;   //!< Allocated size of the output buffer.
+    int err;          //!< 1 in case of memory allocation error.
+    int ready;        //!< 1 when the chunk has been formatted and is waiting to be written.
+} nrvk_tsv_chunk_t;
+
+/**
+ * State shared by the threads of the TSV export.
+ * The chunks are formatted in a ring of NRVK_TSV_SLOTS(nthreads) buffers:
+ * the chunk k can be formatted only after the chunk (k - nslots) has been written,
+ * so the worker threads keep formatting the next chunks while the writer thread writes the previous ones.
+ */
+typedef struct nrvk_tsv_pool_t
+{
+    nrvk_tsv_chunk_t slot[(2 * NRVK_TSV_MAXTHREADS)]; //!< Ring of chunk buffers.
+    nrvk_cols_t nvc;        //!< Structure containing the pointers to the memory mapped file columns.
+    uint64_t nchunks;       //!< Total number of chunks.
+    uint64_t next;          //!< Next chunk to format.
+    uint64_t written;       //!< Number of chunks already written.
+    uint32_t nslots;        //!< Number of chunk buffers in use.
+    int stop;               //!< 1 to stop the worker threads in case of error.
+    pthread_mutex_t mutex;  //!< Mutex protecting the fields above.
+    pthread_cond_t cond;    //!< Signalled when a chunk is formatted or written.
+} nrvk_tsv_pool_t;
+
+// Format one TSV row: 16 hex digits VariantKey, REF and ALT separated by tabs. Returns the number of written bytes.
+static inline size_t format_nrvk_tsv_row(char *buf, uint64_t vk, nrvk_allele_t ref, nrvk_allele_t alt)
+{
+    size_t p = 17;
+    write_hex_uint64_t(vk, buf);
+    buf[16] = '\t';
+    decode_nrvk_allele(ref, (buf + p));
+    p += ref.size;
+    buf[p++] = '\t';
+    decode_nrvk_allele(alt, (buf + p));
+    p += alt.size;
+    buf[p++] = '\n';
+    return p;
+}
+
+/**
+ * Format the rows of one chunk in the chunk buffer.
+ */
+static inline void format_nrvk_tsv_chunk(nrvk_tsv_chunk_t *c)
+{
+    nrvk_allele_t ref, alt;
+    nrvk2_cursor_t cur;
+    size_t need, maxsize;
+    char *tmp;
+    uint64_t i;
+    memset(&ref, 0, sizeof(ref));
+    memset(&alt, 0, sizeof(alt));
+    c->size = 0;
+    c->err = 0;
+    if ((c->nvc.blockrows > 0) && (c->first < c->last))
+    {
+        nrvk2_cursor_seek(c->nvc, c->first, &cur);
+        while (cur.row < c->first)
+        {
+            nrvk2_cursor_next(&cur, &ref, &alt);
+        }
+    }
+    for (i = c->first; i < c->last; i++)
+    {
+        if (c->nvc.blockrows == 0)
+        {
+            get_nrvk_alleles_by_pos(c->nvc, i, &ref, &alt);
+        }
+        else
+        {
+            nrvk2_cursor_next(&cur, &ref, &alt);
+        }
+        need = (c->size + ref.size + alt.size + 19);
+        if (need > c->maxsize)
+        {
+            maxsize = ((c->maxsize << 1) > need) ? (c->maxsize << 1) : need;
+            tmp = (char *)realloc(c->buf, maxsize);
+            if (tmp == NULL)
+            {
+                c->err = 1;
+                return;
+            }
+            c->buf = tmp;
+            c->maxsize = maxsize;
+        }
+        c->size += format_nrvk_tsv_row((c->buf + c->size), c->nvc.vk[i], ref, alt);
+    }
+}
+
+/**
+ * Take the next chunk to format and format it, releasing the pool mutex in the meantime.
+ * The pool mutex must be locked by the caller.
+ */
+static inline void take_nrvk_tsv_chunk(nrvk_tsv_pool_t *pool)
+{
+    uint64_t k = pool->next++;
+    nrvk_tsv_chunk_t *c = &pool->slot[(k % pool->nslots)];
+    c->nvc = pool->nvc;
+    c->first = (k * NRVK_TSV_CHUNK_ROWS);
+    c->last = ((pool->nvc.nrows - c->first) > NRVK_TSV_CHUNK_ROWS) ? (c->first + NRVK_TSV_CHUNK_ROWS) : pool->nvc.nrows;
+    pthread_mutex_unlock(&pool->mutex);
+    format_nrvk_tsv_chunk(c);
+    pthread_mutex_lock(&pool->mutex);
+    c->ready = 1;
+    pthread_cond_broadcast(&pool->cond);
+}
+
+/**
+ * Thread worker of the TSV export: format the chunks while there is a free buffer.
+ */
+static inline void *nrvk_tsv_chunk_worker(void *arg)
+{
+    nrvk_tsv_pool_t *pool = (nrvk_tsv_pool_t *)arg;
+    pthread_mutex_lock(&pool->mutex);
+    while ((pool->stop == 0) && (pool->next < pool->nchunks))
+    {
+        if (pool->next >= (pool->written + pool->nslots))
+        {
+            pthread_cond_wait(&pool->cond, &pool->mutex); // wait for a free buffer
+            continue;
+        }
+        take_nrvk_tsv_chunk(pool);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+/**
+ * Convert a vrnr.bin file (either format) to a simple TSV, using multiple threads.
+ * The rows are split in chunks of NRVK_TSV_CHUNK_ROWS rows: (nthreads - 1) worker threads format
+ * the chunks in a ring of 2 * nthreads buffers, while the calling thread writes the formatted chunks in order
+ * (formatting the next chunk itself when it would otherwise wait).
+ * The output is identical to nrvk_bin_to_tsv.
+ *
+ * @param nvc      Structure containing the pointers to the memory mapped file columns.
+ * @param tsvfile  Output tsv file name. NOTE: existing files will be replaced.
+ * @param nthreads Maximum number of threads to use.
+ *
+ * @return Number of written bytes or 0 in case of error.
+ */
+static inline size_t parallel_nrvk_bin_to_tsv(nrvk_cols_t nvc, const char *tsvfile, uint32_t nthreads)
+{
+    nrvk_tsv_pool_t *pool;
+    nrvk_tsv_chunk_t *c;
+    pthread_t tid[NRVK_TSV_MAXTHREADS];
+    uint32_t t, nworkers = 0;
+    uint64_t k;
+    size_t len = 0;
+    int err = 0;
+#ifdef O_CLOEXEC
+    int fd = open(tsvfile, (O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC), 0666);
+#else
+    int fd = open(tsvfile, (O_WRONLY | O_CREAT | O_TRUNC), 0666);
+    if (fd >= 0)
+    {
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+#endif
+    if (fd < 0)
+    {
+        return 0;
+    }
+    pool = (nrvk_tsv_pool_t *)calloc(1, sizeof(nrvk_tsv_pool_t));
+    if (pool == NULL)
+    {
+        close(fd);
+        return 0;
+    }
+    if (nthreads > NRVK_TSV_MAXTHREADS)
+    {
+        nthreads = NRVK_TSV_MAXTHREADS;
+    }
+    if (nthreads == 0)
+    {
+        nthreads = 1;
+    }
+    pool->nvc = nvc;
+    pool->nchunks = ((nvc.nrows + NRVK_TSV_CHUNK_ROWS - 1) / NRVK_TSV_CHUNK_ROWS);
+    pool->nslots = (2 * nthreads);
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->cond, NULL);
+    for (t = 1; (t < nthreads) && ((uint64_t)t < pool->nchunks); t++)
+    {
+        if (pthread_create(&tid[nworkers], NULL, nrvk_tsv_chunk_worker, pool) == 0)
+        {
+            ++nworkers;
+        }
+    }
+    for (k = 0; (k < pool->nchunks) && (err == 0); k++)
+    {
+        c = &pool->slot[(k % pool->nslots)];
+        pthread_mutex_lock(&pool->mutex);
+        while (c->ready == 0)
+        {
+            if (pool->next == k)
+            {
+                take_nrvk_tsv_chunk(pool); // no worker is formatting this chunk yet
+                continue;
+            }
+            pthread_cond_wait(&pool->cond, &pool->mutex);
+        }
+        pthread_mutex_unlock(&pool->mutex);
+        err = ((c->err != 0) || (write_all_fd(fd, c->buf, c->size) != 0));
+        len += c->size;
+        pthread_mutex_lock(&pool->mutex);
+        c->ready = 0;
+        pool->written++;
+        pool->stop = err;
+        pthread_cond_broadcast(&pool->cond);
+        pthread_mutex_unlock(&pool->mutex);
+    }
+    for (t = 0; t < nworkers; t++)
+    {
+        pthread_join(tid[t], NULL);
+    }
+    pthread_cond_destroy(&pool->cond);
+    pthread_mutex_destroy(&pool->mutex);
+    for (t = 0; t < pool->nslots; t++)
+    {
+        free(pool->slot[t].buf);
+    }
+    free(pool);
+    if ((close(fd) != 0) || (err != 0))
+    {
+        return 0;
+    }
+    return len;
+}
+
+/**
+ * Convert a vrnr.bin file (either format) to a simple TSV.
+ * This is equivalent to parallel_nrvk_bin_to_tsv with one thread.
  * For the reverse operation see the resources/tools/nrvk.sh script.
  *
  * @param nvc      Structure containing the pointers to the memory mapped file columns.
@@ -234,23 +1059,212 @@ static inline uint64_t get_variantkey_chrom_endpos(nrvk_cols_t nvc, uint64_t vk)
  */
 static inline size_t nrvk_bin_to_tsv(nrvk_cols_t nvc, const char *tsvfile)
 {
-    FILE * fp;
-    size_t sizeref, sizealt, len = 0;
-    char ref[ALLELE_MAXSIZE];
-    char alt[ALLELE_MAXSIZE];
-    uint64_t i;
-    fp = fopen(tsvfile, "we");
+    return parallel_nrvk_bin_to_tsv(nvc, tsvfile, 1);
+}
+
+static inline int nrvk2_is_packable(const uint8_t *s, size_t size)
+{
+    size_t i;
+    for (i = 0; i < size; i++)
+    {
+        if ((s[i] != 'A') && (s[i] != 'C') && (s[i] != 'G') && (s[i] != 'T'))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static inline void nrvk2_pack(uint8_t *out, uint64_t start, const uint8_t *s, size_t size)
+{
+    uint64_t k;
+    size_t i;
+    uint8_t b;
+    for (i = 0; i < size; i++)
+    {
+        b = (uint8_t)((s[i] >> 1) & 3); // A=0 C=1 T=2 G=3
+        b ^= (b >> 1); // A=0 C=1 G=2 T=3
+        k = (start + i);
+        out[(k >> 2)] |= (uint8_t)(b << ((k & 3) << 1));
+    }
+}
+
+/**
+ * Encode a row of the uncompressed NRVK file in the compressed format.
+ *
+ * @param ref       REF allele letters.
+ * @param sizeref   REF length.
+ * @param alt       ALT allele letters.
+ * @param sizealt   ALT length.
+ * @param sameref   1 if the REF is the same of the previous row in the block.
+ * @param out       Output buffer (or NULL to only compute the encoded length).
+ *                  The buffer must be at least (sizeref + sizealt + 20) bytes and set to zero.
+ *
+ * @return Number of encoded bytes.
+ */
+static inline size_t nrvk2_encode_row(const uint8_t *ref, size_t sizeref, const uint8_t *alt, size_t sizealt, int sameref, uint8_t *out)
+{
+    uint8_t tmp[20];
+    size_t nref = (sameref ? 0 : sizeref);
+    uint8_t packed = (uint8_t)(nrvk2_is_packable(alt, sizealt) && (sameref || nrvk2_is_packable(ref, sizeref)));
+    uint64_t h = (sameref ? 2 : ((uint64_t)sizeref << 2)) | packed;
+    uint8_t *p = (out != NULL) ? out : tmp;
+    size_t n = nrvk2_write_varint(p, h);
+    n += nrvk2_write_varint((p + n), sizealt);
+    if (out == NULL)
+    {
+        return (n + (packed ? ((nref + sizealt + 3) >> 2) : (nref + sizealt)));
+    }
+    if (packed)
+    {
+        nrvk2_pack((out + n), 0, ref, nref);
+        nrvk2_pack((out + n), nref, alt, sizealt);
+        return (n + ((nref + sizealt + 3) >> 2));
+    }
+    memcpy((out + n), ref, nref);
+    memcpy((out + n + nref), alt, sizealt);
+    return (n + nref + sizealt);
+}
+
+static inline size_t nrvk2_encode_pos(nrvk_cols_t nvc, uint64_t blockrows, uint64_t pos, uint8_t *out)
+{
+    nrvk_allele_t ref, alt, pref, palt;
+    int sameref = 0;
+    memset(&pref, 0, sizeof(pref));
+    memset(&palt, 0, sizeof(palt));
+    get_nrvk_alleles_by_pos(nvc, pos, &ref, &alt);
+    if ((pos % blockrows) > 0)
+    {
+        get_nrvk_alleles_by_pos(nvc, (pos - 1), &pref, &palt);
+        sameref = ((pref.size == ref.size) && (memcmp(pref.data, ref.data, ref.size) == 0));
+    }
+    return nrvk2_encode_row(ref.data, ref.size, alt.data, alt.size, sameref, out);
+}
+
+/**
+ * Convert an uncompressed NRVK file to the compressed format (v2).
+ * The compressed file can be memory mapped with mmap_nrvk_file and used with the same functions.
+ *
+ * @param nvc        Structure containing the pointers to the memory mapped uncompressed NRVK file columns.
+ * @param blockrows  Number of rows per block (i.e. NRVK2_BLOCK_ROWS):
+ *                   smaller blocks are faster to access, larger blocks are smaller.
+ * @param file       Path of the output file. NOTE: existing files will be replaced.
+ *
+ * @return Number of bytes written or 0 in case of error.
+ */
+static inline size_t nrvk_to_v2_file(nrvk_cols_t nvc, uint64_t blockrows, const char *file)
+{
+    if ((nvc.blockrows != 0) || (blockrows == 0))
+    {
+        return 0; // the source must be uncompressed
+    }
+    uint64_t nblocks = ((nvc.nrows + blockrows - 1) / blockrows);
+    uint64_t *boff = (uint64_t *)malloc((nblocks + 1) * sizeof(uint64_t));
+    if (boff == NULL)
+    {
+        return 0;
+    }
+    uint64_t i, datalen = 0;
+    for (i = 0; i < nvc.nrows; i++)
+    {
+        if ((i % blockrows) == 0)
+        {
+            boff[(i / blockrows)] = datalen;
+        }
+        datalen += nrvk2_encode_pos(nvc, blockrows, i, NULL);
+    }
+    boff[nblocks] = datalen;
+    FILE *fp = fopen(file, "we");
     if (fp == NULL)
     {
+        free(boff);
         return 0;
     }
+    const uint8_t ctbytes[NRVK2_NCOLS] = {8, 8, 8, 1};
+    const uint64_t nitems[NRVK2_NCOLS] = {nvc.nrows, 2, (nblocks + 1), datalen};
+    const uint64_t info[2] = {NRVK2_VERSION, blockrows};
+    uint8_t pad[8] = {0};
+    uint8_t row[(255 + 255 + 20)]; // the uncompressed alleles are at most 255 bytes
+    size_t n, ret = write_binsrc1_header_nitems(fp, NRVK2_NCOLS, ctbytes, nvc.nrows, nitems, NULL);
+    size_t exp = ret;
+    ret += fwrite(nvc.vk, 1, (size_t)(8 * nvc.nrows), fp);
+    ret += fwrite(info, 1, sizeof(info), fp);
+    ret += fwrite(boff, 1, (size_t)(8 * (nblocks + 1)), fp);
+    exp += (size_t)(8 * (nvc.nrows + 2 + nblocks + 1));
     for (i = 0; i < nvc.nrows; i++)
     {
-        len += (get_nrvk_ref_alt_by_pos(nvc, i, ref, &sizeref, alt, &sizealt) + 19);
-        fprintf(fp, "%016" PRIx64 "\t%s\t%s\n", *nvc.vk++, ref, alt);
+        memset(row, 0, sizeof(row));
+        n = nrvk2_encode_pos(nvc, blockrows, i, row);
+        ret += fwrite(row, 1, n, fp);
     }
-    fclose(fp);
-    return len;
+    n = (size_t)((8 - (datalen & 7)) & 7);
+    ret += fwrite(pad, 1, n, fp);
+    exp += (size_t)datalen + n;
+    free(boff);
+    if ((fclose(fp) != 0) || (exp == 0) || (ret != exp))
+    {
+        return 0;
+    }
+    return ret;
+}
+
+/**
+ * Build the hash index of an NRVK file (either format).
+ * The index can be attached to the NRVK columns with mmap_nrvk_hash_file.
+ *
+ * @param nvc   Structure containing the pointers to the memory mapped NRVK file columns.
+ * @param file  Path of the output file. NOTE: existing files will be replaced.
+ *
+ * @return Number of bytes written or 0 in case of error.
+ */
+static inline size_t nrvk_hash_to_file(nrvk_cols_t nvc, const char *file)
+{
+    uint64_t bits = 1;
+    while (((uint64_t)1 << bits) < (2 * nvc.nrows))
+    {
+        bits++;
+    }
+    uint64_t nslots = ((uint64_t)1 << bits);
+    uint64_t mask = (nslots - 1);
+    uint64_t *slots = (uint64_t *)calloc((size_t)(2 * nslots), sizeof(uint64_t));
+    if (slots == NULL)
+    {
+        return 0;
+    }
+    uint64_t i, h;
+    for (i = 0; i < nvc.nrows; i++)
+    {
+        if ((i > 0) && (nvc.vk[i] == nvc.vk[(i - 1)]))
+        {
+            continue; // keep the first row of duplicated keys
+        }
+        h = nrvk_hash_slot(nvc.vk[i], bits);
+        while (slots[((h << 1) + 1)] != 0)
+        {
+            h = ((h + 1) & mask);
+        }
+        slots[(h << 1)] = nvc.vk[i];
+        slots[((h << 1) + 1)] = (i + 1);
+    }
+    const uint8_t ctbytes[NRVKHASH_NCOLS] = {8, 8};
+    const uint64_t nitems[NRVKHASH_NCOLS] = {NRVKHASH_NINFO, (2 * nslots)};
+    const uint64_t info[NRVKHASH_NINFO] = {NRVKHASH_VERSION, bits, nvc.nrows, binfuse_check(nvc.vk, nvc.nrows)};
+    size_t ret = 0, exp = 0;
+    FILE *fp = fopen(file, "we");
+    if (fp != NULL)
+    {
+        ret = write_binsrc1_header_nitems(fp, NRVKHASH_NCOLS, ctbytes, nslots, nitems, NULL);
+        exp = ret;
+        ret += fwrite(info, 1, sizeof(info), fp);
+        ret += fwrite(slots, 1, (size_t)(16 * nslots), fp);
+        exp += (size_t)(sizeof(info) + (16 * nslots)); // both columns are already 8-byte aligned
+        if ((fclose(fp) != 0) || (exp == 0) || (ret != exp))
+        {
+            ret = 0;
+        }
+    }
+    free(slots);
+    return ret;
 }
 
 #endif  // VARIANTKEY_NRVK_H
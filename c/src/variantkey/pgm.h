@@ -0,0 +1,376 @@
+// VariantKey
+//
+// pgm.h
+//
+// @category   Libraries
+// @author     Nicola Asuni <nicola.asuni@genomicsplc.com>
+// @copyright  2017-2018 GENOMICS plc
+// @license    MIT (see LICENSE)
+// @link       https://github.com/genomicsplc/variantkey
+//
+// LICENSE
+//
+// Copyright (c) 2017-2018 GENOMICS plc
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+/**
+ * @file pgm.h
+ * @brief Learned index (PGM-style) for sorted uint64 columns.
+ *
+ * The functions provided here build and search a Piecewise Geometric Model (PGM) index
+ * for a column of unsigned 64-bit integers sorted in ascending order
+ * (e.g. the VariantKey column of NRVK or VKRS files).
+ *
+ * VariantKeys are sorted by CHROM, POS and REF+ALT, so the position of a key in the column
+ * is close to a piecewise linear function of the key value.
+ * The index contains a set of linear segments, each one predicting the position
+ * of the keys it covers with an error of at most eps rows.
+ * The segments are indexed recursively by smaller levels of segments (with error PGM_EPS_REC),
+ * up to a single root segment.
+ * A lookup is a model evaluation per level plus a small local search around the predicted position.
+ *
+ * The index is stored as a BINSRC1 file with three 8-byte columns:
+ *   - key:   first key covered by each segment;
+ *   - pos:   row of the first key covered by each segment (in the column or in the lower level);
+ *   - slope: slope of each segment (IEEE 754 double).
+ * The segments of each level are stored from the bottom level up to the root.
+ * The last row contains the metadata: key = eps, pos = number of rows of the column, slope = number of levels.
+ */
+
+#ifndef VARIANTKEY_PGM_H
+#define VARIANTKEY_PGM_H
+
+#include <stdlib.h>
+#include "binsearch.h"
+
+#define PGM_EPS_REC 4 //!< Maximum error of the upper levels of the index.
+
+/**
+ * Struct containing the PGM index columns.
+ */
+typedef struct pgm_t
+{
+    const uint64_t *key; //!< Pointer to the column containing the first key of each segment.
+    const uint64_t *pos; //!< Pointer to the column containing the first position of each segment.
+    const double *slope; //!< Pointer to the column containing the slope of each segment.
+    uint64_t nsegs;      //!< Total number of segments (the metadata row is at position nsegs).
+} pgm_t;
+
+/**
+ * Returns the position of the first item that is not less (or not greater if upper is true) than the search value,
+ * using an exponential search in both directions from the predicted position.
+ *
+ * @param src       Array sorted in ascending order.
+ * @param first     First element of the range to search.
+ * @param last      Element (up to but not including) where to end the search.
+ * @param pos       Predicted position (first <= pos < last).
+ * @param search    Value to search.
+ * @param upper     If true returns the position of the first item greater than search.
+ *
+ * @return Item position in the range [first, last].
+ */
+static inline uint64_t pgm_local_search(const uint64_t *src, uint64_t first, uint64_t last, uint64_t pos, uint64_t search, bool upper)
+{
+    uint64_t middle, step = 1;
+    if ((src[pos] < search) || (upper && (src[pos] == search)))
+    {
+        // forward: the result is after pos
+        first = pos + 1;
+        while (first < last)
+        {
+            middle = ((last - first) > step) ? (first + step) : last;
+            if ((middle == last) || (src[middle] > search) || (!upper && (src[middle] == search)))
+            {
+                last = middle;
+                break;
+            }
+            first = middle + 1;
+            step <<= 1;
+        }
+    }
+    else
+    {
+        // backward: the result is at or before pos
+        last = pos;
+        while (last > first)
+        {
+            middle = ((last - first) > step) ? (last - step) : first;
+            if ((src[middle] < search) || (upper && (src[middle] == search)))
+            {
+                first = middle + 1;
+                break;
+            }
+            last = middle;
+            step <<= 1;
+        }
+    }
+    while (first < last)
+    {
+        middle = get_middle_point(first, last);
+        if ((src[middle] < search) || (upper && (src[middle] == search)))
+        {
+            first = middle + 1;
+        }
+        else
+        {
+            last = middle;
+        }
+    }
+    return first;
+}
+
+/**
+ * Build one level of segments approximating the points (src[i], offset + i) with the maximum error eps.
+ * Repeated keys are represented by their first occurrence only.
+ * This uses the shrinking cone algorithm: each segment is extended while a slope exists
+ * that predicts all its points within the error.
+ *
+ * @param src       Point keys sorted in ascending order.
+ * @param n         Number of points.
+ * @param offset    Position of the first point.
+ * @param eps       Maximum error.
+ * @param key       Output array of segment keys (or NULL to only count the segments).
+ * @param pos       Output array of segment positions (or NULL to only count the segments).
+ * @param slope     Output array of segment slopes (or NULL to only count the segments).
+ *
+ * @return Number of segments.
+ */
+static inline uint64_t pgm_build_level(const uint64_t *src, uint64_t n, uint64_t offset, uint64_t eps, uint64_t *key, uint64_t *pos, double *slope)
+{
+    uint64_t i, x0 = 0, y0 = 0, nsegs = 0;
+    double dx, smin = 0, smax = 0, lo, hi;
+    for (i = 0; i < n; i++)
+    {
+        if (nsegs > 0)
+        {
+            if (src[i] == src[(i - 1)])
+            {
+                continue;
+            }
+            dx = (double)(src[i] - x0);
+            lo = ((double)i - (double)y0 - (double)eps) / dx;
+            hi = ((double)i - (double)y0 + (double)eps) / dx;
+            if ((lo <= smax) && (hi >= smin))
+            {
+                smin = (lo > smin) ? lo : smin;
+                smax = (hi < smax) ? hi : smax;
+                if (slope != NULL)
+                {
+                    slope[(nsegs - 1)] = (smin + smax) / 2;
+                }
+                continue;
+            }
+        }
+        x0 = src[i];
+        y0 = i;
+        smin = 0;
+        smax = (double)UINT64_MAX;
+        if (key != NULL)
+        {
+            key[nsegs] = x0;
+            pos[nsegs] = offset + y0;
+            slope[nsegs] = 0;
+        }
+        ++nsegs;
+    }
+    return nsegs;
+}
+
+/**
+ * Returns the maximum number of rows of the PGM index for the specified column.
+ * Each segment except the last one covers at least two points,
+ * so each upper level has at most half of the segments of the level below.
+ *
+ * @param src       Column values sorted in ascending order.
+ * @param nrows     Number of rows in the column.
+ * @param eps       Maximum error of the bottom level (e.g. 64).
+ *
+ * @return Maximum number of index rows, including the metadata row.
+ */
+static inline uint64_t get_pgm_max_size(const uint64_t *src, uint64_t nrows, uint64_t eps)
+{
+    return ((2 * pgm_build_level(src, nrows, 0, eps, NULL, NULL, NULL)) + 66);
+}
+
+/**
+ * Build the PGM index for a column sorted in ascending order.
+ *
+ * @param src       Column values sorted in ascending order.
+ * @param nrows     Number of rows in the column.
+ * @param eps       Maximum error of the bottom level (e.g. 64).
+ * @param key       Output array of segment keys (at least get_pgm_max_size() items).
+ * @param pos       Output array of segment positions (at least get_pgm_max_size() items).
+ * @param slope     Output array of segment slopes (at least get_pgm_max_size() items).
+ *
+ * @return Number of rows of the index, including the metadata row.
+ */
+static inline uint64_t build_pgm(const uint64_t *src, uint64_t nrows, uint64_t eps, uint64_t *key, uint64_t *pos, double *slope)
+{
+    uint64_t start = 0, end, nsegs = 0, nlevels = 0;
+    if (nrows > 0)
+    {
+        nsegs = pgm_build_level(src, nrows, 0, eps, key, pos, slope);
+        nlevels = 1;
+        while ((nsegs - start) > 1)
+        {
+            // the next level approximates the first key of each segment of this level
+            end = nsegs;
+            nsegs += pgm_build_level(key + start, (end - start), start, PGM_EPS_REC, key + end, pos + end, slope + end);
+            start = end;
+            ++nlevels;
+        }
+    }
+    key[nsegs] = eps;
+    pos[nsegs] = nrows;
+    slope[nsegs] = (double)nlevels;
+    return (nsegs + 1);
+}
+
+/**
+ * Search for the position of the first item that is not less than the search value using the PGM index.
+ *
+ * @param src       Column values sorted in ascending order.
+ * @param pgm       Structure containing the PGM index columns.
+ * @param search    Value to search.
+ *
+ * @return Position of the first item not less than search, or the number of rows if all items are less than search.
+ */
+static inline uint64_t pgm_lower_bound(const uint64_t *src, pgm_t pgm, uint64_t search)
+{
+    uint64_t nrows = pgm.pos[pgm.nsegs];
+    uint64_t nlevels = (uint64_t)pgm.slope[pgm.nsegs];
+    if (nlevels == 0)
+    {
+        return 0;
+    }
+    uint64_t ls = pgm.nsegs - 1; // first segment of the current level
+    uint64_t le = pgm.nsegs;     // end of the current level
+    uint64_t s = ls;             // current segment
+    uint64_t first, last, end, p;
+    double d;
+    while (true)
+    {
+        if (--nlevels == 0)
+        {
+            first = 0; // bottom level: search the column
+            last = nrows;
+        }
+        else
+        {
+            first = pgm.pos[ls]; // lower level
+            last = ls;
+        }
+        end = ((s + 1) < le) ? pgm.pos[(s + 1)] : last;
+        p = pgm.pos[s];
+        if (search > pgm.key[s])
+        {
+            d = pgm.slope[s] * (double)(search - pgm.key[s]);
+            p += (d < (double)(end - p)) ? (uint64_t)d : (end - p);
+        }
+        if (p >= last)
+        {
+            p = last - 1;
+        }
+        if (nlevels == 0)
+        {
+            return pgm_local_search(src, first, last, p, search, false);
+        }
+        // last segment with key <= search
+        s = pgm_local_search(pgm.key, first, last, p, search, true);
+        s = (s > first) ? (s - 1) : first;
+        ls = first;
+        le = last;
+    }
+}
+
+/**
+ * Search for the first occurrence of an unsigned integer using the PGM index.
+ *
+ * @param src       Column values sorted in ascending order.
+ * @param pgm       Structure containing the PGM index columns.
+ * @param search    Value to search.
+ *
+ * @return Item number if found or the number of rows if not found (same as col_find_first over the full column).
+ */
+static inline uint64_t pgm_find_first(const uint64_t *src, pgm_t pgm, uint64_t search)
+{
+    uint64_t nrows = pgm.pos[pgm.nsegs];
+    uint64_t p = pgm_lower_bound(src, pgm, search);
+    if ((p < nrows) && (src[p] == search))
+    {
+        return p;
+    }
+    return nrows;
+}
+
+/**
+ * Build the PGM index for a column sorted in ascending order and save it as a BINSRC1 file.
+ *
+ * @param file      Path of the output file.
+ * @param src       Column values sorted in ascending order.
+ * @param nrows     Number of rows in the column.
+ * @param eps       Maximum error of the bottom level (e.g. 64).
+ *
+ * @return Number of bytes written or 0 in case of error.
+ */
+static inline size_t save_pgm_file(const char *file, const uint64_t *src, uint64_t nrows, uint64_t eps)
+{
+    size_t ret = 0;
+    uint64_t size = get_pgm_max_size(src, nrows, eps);
+    uint64_t *key = (uint64_t *)malloc(sizeof(uint64_t) * size);
+    uint64_t *pos = (uint64_t *)malloc(sizeof(uint64_t) * size);
+    double *slope = (double *)malloc(sizeof(double) * size);
+    if ((key != NULL) && (pos != NULL) && (slope != NULL))
+    {
+        uint64_t n = build_pgm(src, nrows, eps, key, pos, slope);
+        const uint8_t ctbytes[3] = {8, 8, 8};
+        const void *cols[3] = {key, pos, slope};
+        ret = save_binsrc1_cols(file, 3, ctbytes, cols, n);
+    }
+    free(key);
+    free(pos);
+    free(slope);
+    return ret;
+}
+
+/**
+ * Memory map the PGM index file.
+ *
+ * @param file  Path to the file to map.
+ * @param mf    Structure containing the memory mapped file.
+ * @param pgm   Structure containing the PGM index columns.
+ *
+ * @return 0 in case of success, 1 if the file can't be mapped or is not a valid index.
+ */
+static inline int mmap_pgm_file(const char *file, mmfile_t *mf, pgm_t *pgm)
+{
+    mmap_binfile(file, mf);
+    if ((mf->fd < 0) || (mf->src == MAP_FAILED) || (mf->ncols != 3) || (mf->nrows == 0))
+    {
+        return 1;
+    }
+    pgm->key = (const uint64_t *)(mf->src + mf->index[0]);
+    pgm->pos = (const uint64_t *)(mf->src + mf->index[1]);
+    pgm->slope = (const double *)(mf->src + mf->index[2]);
+    pgm->nsegs = mf->nrows - 1;
+    return 0;
+}
+
+#endif  // VARIANTKEY_PGM_H
@@ -36,12 +36,22 @@
  *
  * The functions provided here allows to generate and process a 64 bit Unsigned Integer Keys for Human Genomic Regions.
  * The RegionKey is sortable for chromosome and start position, and it is also fully reversible.
+ *
+ * rkindex.bin:
+ * Optional interval index of a column of RegionKeys sorted in ascending order,
+ * generated by save_regionkey_index_file() (see find_overlapping_regionkeys).
+ *
+ * The overlaps between a sorted set of VariantKeys and a sorted set of RegionKeys
+ * can be computed in bulk with join_variantkey_regionkey() or parallel_join_variantkey_regionkey().
  */
 
 #ifndef VARIANTKEY_REGIONKEY_H
 #define VARIANTKEY_REGIONKEY_H
 
+#include <pthread.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "nrvk.h"
 
 #define RK_MAX_POS       0x000000000FFFFFFF  //!< Maximum position value (2^28 - 1)
@@ -336,4 +346,552 @@ static inline uint64_t variantkey_to_regionkey(nrvk_cols_t nvc, uint64_t vk)
     return ((vk & VKMASK_CHROMPOS) | ((uint64_t)get_variantkey_endpos(nvc, vk) << RKSHIFT_ENDPOS));
 }
 
+/*
+    RegionKey interval index.
+
+    Implicit augmented interval tree over a column of RegionKeys sorted in ascending order.
+    The regions are compared using the CHROM + START POS and CHROM + END POS encodings,
+    so the regions of different chromosomes never overlap and a single tree covers all chromosomes.
+    The sorted column is the in-order layout of a binary tree:
+    the nodes at level k are the rows with the k lowest bits set to 1 and the root is at row 2^K - 1,
+    where K is the highest level with 2^K <= nrows.
+    Each row stores the maximum CHROM + END POS of its subtree, so the subtrees that end before the query are skipped.
+
+    The index is stored as a BINSRC1 file with two uint64_t columns:
+        - RegionKey: the RegionKeys sorted in ascending order;
+        - MaxEnd: maximum CHROM + END POS (see get_regionkey_chrom_endpos) of the subtree rooted at each row.
+*/
+
+#define RKINDEX_NCOLS     2  //!< Number of columns of the RegionKey index file.
+#define RKINDEX_SMALLTREE 3  //!< Subtrees with this level or less are scanned linearly.
+
+/**
+ * Struct containing the RegionKey index columns.
+ */
+typedef struct rkindex_cols_t
+{
+    const uint64_t *rk;      //!< Pointer to the RegionKey column (sorted in ascending order).
+    const uint64_t *maxend;  //!< Pointer to the column containing the maximum CHROM + END POS of each subtree.
+    uint64_t nrows;          //!< Number of rows.
+} rkindex_cols_t;
+
+static inline uint8_t get_regionkey_index_root_level(uint64_t nrows)
+{
+    uint8_t k = 0;
+    while ((k < 63) && (((uint64_t)1 << (k + 1)) <= nrows))
+    {
+        k++;
+    }
+    return k;
+}
+
+/**
+ * Build the MaxEnd column of the RegionKey interval index.
+ *
+ * @param rk        Column of RegionKeys sorted in ascending order.
+ * @param nrows     Number of rows.
+ * @param maxend    Output column of nrows items.
+ *
+ * @return 0 in case of success, 1 if the RegionKeys are not sorted.
+ */
+static inline int build_regionkey_index(const uint64_t *rk, uint64_t nrows, uint64_t *maxend)
+{
+    uint64_t i, k, x, lasti = 0, last = 0, el, er, e;
+    for (i = 0; i < nrows; i++)
+    {
+        if ((i > 0) && (rk[i] < rk[(i - 1)]))
+        {
+            return 1;
+        }
+        maxend[i] = get_regionkey_chrom_endpos(rk[i]);
+    }
+    // leaves (level 0)
+    for (i = 0; i < nrows; i += 2)
+    {
+        lasti = i;
+        last = maxend[i];
+    }
+    // internal nodes in bottom-up order: "last" is the maximum of the last node at the previous level,
+    // used for the right children that are out of range
+    for (k = 1; ((uint64_t)1 << k) <= nrows; k++)
+    {
+        x = ((uint64_t)1 << (k - 1));
+        for (i = ((x << 1) - 1); i < nrows; i += (x << 2))
+        {
+            el = maxend[(i - x)];
+            er = ((i + x) < nrows) ? maxend[(i + x)] : last;
+            e = maxend[i];
+            e = (e > el) ? e : el;
+            e = (e > er) ? e : er;
+            maxend[i] = e;
+        }
+        lasti = (((lasti >> k) & 1) ? (lasti - x) : (lasti + x)); // parent of the last node
+        if ((lasti < nrows) && (maxend[lasti] > last))
+        {
+            last = maxend[lasti];
+        }
+    }
+    return 0;
+}
+
+/**
+ * Build the RegionKey interval index and save it as a BINSRC1 file.
+ *
+ * @param file      Path of the output file. NOTE: existing files will be replaced.
+ * @param rk        Column of RegionKeys sorted in ascending order.
+ * @param nrows     Number of rows.
+ *
+ * @return Number of bytes written or 0 in case of error (including unsorted RegionKeys).
+ */
+static inline size_t save_regionkey_index_file(const char *file, const uint64_t *rk, uint64_t nrows)
+{
+    uint64_t *maxend = (uint64_t *)malloc((size_t)((nrows + 1) * sizeof(uint64_t)));
+    if (maxend == NULL)
+    {
+        return 0;
+    }
+    size_t ret = 0;
+    if (build_regionkey_index(rk, nrows, maxend) == 0)
+    {
+        const uint8_t ctbytes[RKINDEX_NCOLS] = {8, 8};
+        const void *cols[RKINDEX_NCOLS] = {rk, maxend};
+        ret = save_binsrc1_cols(file, RKINDEX_NCOLS, ctbytes, cols, nrows);
+    }
+    free(maxend);
+    return ret;
+}
+
+/**
+ * Memory map the RegionKey interval index file.
+ *
+ * @param file  Path to the file to map.
+ * @param mf    Structure containing the memory mapped file.
+ * @param idx   Structure containing the index columns.
+ *
+ * @return 0 in case of success, 1 if the file can't be mapped or is not a valid index.
+ */
+static inline int mmap_regionkey_index_file(const char *file, mmfile_t *mf, rkindex_cols_t *idx)
+{
+    idx->nrows = 0;
+    mmap_binfile(file, mf);
+    if ((mf->fd < 0) || (mf->src == MAP_FAILED) || (mf->ncols != RKINDEX_NCOLS) || (mf->ctbytes[0] != 8) || (mf->ctbytes[1] != 8))
+    {
+        return 1;
+    }
+    idx->rk = (const uint64_t *)(mf->src + mf->index[0]);
+    idx->maxend = (const uint64_t *)(mf->src + mf->index[1]);
+    idx->nrows = mf->nrows;
+    return 0;
+}
+
+/**
+ * Find all the regions of the index overlapping the specified region.
+ * This is an O(log(n) + k) search for n regions and k overlaps.
+ * The rows are returned in ascending order (i.e. sorted by RegionKey).
+ *
+ * @param idx       Structure containing the index columns.
+ * @param rk        RegionKey of the query region (see also variantkey_to_regionkey).
+ * @param rows      Output array of row numbers of the overlapping regions (at least maxrows items).
+ * @param maxrows   Maximum number of rows to return.
+ *
+ * @return Total number of overlapping regions (only the first maxrows are returned).
+ */
+static inline uint64_t find_overlapping_regionkeys(rkindex_cols_t idx, uint64_t rk, uint64_t *rows, uint64_t maxrows)
+{
+    struct
+    {
+        uint64_t x;  // node row
+        uint8_t k;   // node level
+        uint8_t w;   // 1 if the left child has been processed
+    } stack[128];
+    uint64_t st = get_regionkey_chrom_startpos(rk);
+    uint64_t en = get_regionkey_chrom_endpos(rk);
+    uint64_t i, i0, i1, y, n = 0;
+    int t = 0;
+    if (idx.nrows == 0)
+    {
+        return 0;
+    }
+    uint8_t rootk = get_regionkey_index_root_level(idx.nrows);
+    stack[t].x = (((uint64_t)1 << rootk) - 1);
+    stack[t].k = rootk;
+    stack[t++].w = 0;
+    while (t > 0)
+    {
+        --t;
+        uint64_t x = stack[t].x;
+        uint8_t k = stack[t].k;
+        if (k <= RKINDEX_SMALLTREE)
+        {
+            // small subtree: scan all the nodes in order
+            i0 = ((x >> k) << k);
+            i1 = (i0 + ((uint64_t)1 << (k + 1)) - 1);
+            if (i1 > idx.nrows)
+            {
+                i1 = idx.nrows;
+            }
+            for (i = i0; (i < i1) && (get_regionkey_chrom_startpos(idx.rk[i]) < en); i++)
+            {
+                if (st < get_regionkey_chrom_endpos(idx.rk[i]))
+                {
+                    if (n < maxrows)
+                    {
+                        rows[n] = i;
+                    }
+                    n++;
+                }
+            }
+        }
+        else if (stack[t].w == 0)
+        {
+            // process the left child first
+            y = (x - ((uint64_t)1 << (k - 1)));
+            stack[t++].w = 1;
+            if ((y >= idx.nrows) || (idx.maxend[y] > st))
+            {
+                stack[t].x = y;
+                stack[t].k = (uint8_t)(k - 1);
+                stack[t++].w = 0;
+            }
+        }
+        else if ((x < idx.nrows) && (get_regionkey_chrom_startpos(idx.rk[x]) < en))
+        {
+            if (st < get_regionkey_chrom_endpos(idx.rk[x]))
+            {
+                if (n < maxrows)
+                {
+                    rows[n] = x;
+                }
+                n++;
+            }
+            stack[t].x = (x + ((uint64_t)1 << (k - 1)));
+            stack[t].k = (uint8_t)(k - 1);
+            stack[t++].w = 0;
+        }
+    }
+    return n;
+}
+
+/*
+    VariantKey - RegionKey overlap join.
+
+    Sweep-line join of an array of VariantKeys and an array of RegionKeys, both sorted in ascending order.
+    The keys are compared using the CHROM + POS encodings, so a single sweep covers all chromosomes.
+    The regions that started before the current variant and are still open are kept in a list:
+    the list is pruned once per variant, and all the remaining regions overlap the variant.
+    The regions starting inside the variant are found with a forward scan.
+    The whole join costs O(n + m + k) for n variants, m regions and k overlapping pairs.
+*/
+
+#define RKJOIN_NCHROM 32                   //!< Number of CHROM codes (the parallel join processes one CHROM per job).
+#define RKJOIN_BLOCK  4096                 //!< Number of variant end positions resolved at once by the parallel join.
+#define RKJOIN_NOMEM  0xFFFFFFFFFFFFFFFF   //!< Return value of the parallel join in case of memory allocation error.
+
+/**
+ * State of the VariantKey - RegionKey overlap join.
+ */
+typedef struct vkrk_join_t
+{
+    uint64_t vpos;       //!< Next VariantKey to process.
+    uint64_t rpos;       //!< First RegionKey not yet started.
+    uint64_t apos;       //!< Next item of the active list to return for the current VariantKey.
+    uint64_t fpos;       //!< Next RegionKey of the forward scan for the current VariantKey.
+    uint64_t *active;    //!< List of the regions started before the current VariantKey and still open.
+    uint64_t nactive;    //!< Number of items in the active list.
+    uint64_t maxactive;  //!< Allocated size of the active list.
+    uint8_t ready;       //!< 1 if the active list has been updated for the current VariantKey.
+    uint8_t err;         //!< 1 in case of memory allocation error.
+} vkrk_join_t;
+
+/**
+ * Initialize the state of the VariantKey - RegionKey overlap join.
+ *
+ * @param jn    Join state to initialize.
+ */
+static inline void init_vkrk_join(vkrk_join_t *jn)
+{
+    memset(jn, 0, sizeof(vkrk_join_t));
+}
+
+/**
+ * Free the memory allocated by the VariantKey - RegionKey overlap join.
+ *
+ * @param jn    Join state.
+ */
+static inline void free_vkrk_join(vkrk_join_t *jn)
+{
+    free(jn->active);
+    init_vkrk_join(jn);
+}
+
+/**
+ * Join an array of VariantKeys with an array of RegionKeys, both sorted in ascending order,
+ * and return the (VariantKey, RegionKey) pairs for all the overlapping items, with a single sweep.
+ * The pairs are sorted by VariantKey position and then by RegionKey position.
+ * The overlap condition is the same as are_overlapping_variantkey_regionkey().
+ * The output is limited to maxpairs items: the function can be called in a loop
+ * with the same join state until jn->vpos is equal to nvk (or jn->err is set).
+ * To process the VariantKeys in consecutive blocks, set jn->vpos to 0 before passing the next block.
+ *
+ * @param jn        Join state, initialized with init_vkrk_join() and released with free_vkrk_join().
+ * @param vk        Array of VariantKeys sorted in ascending order.
+ * @param endpos    Array of the variant end positions (see get_variantkey_endpos_array).
+ * @param nvk       Number of VariantKeys.
+ * @param rk        Array of RegionKeys sorted in ascending order.
+ * @param nrk       Number of RegionKeys.
+ * @param ovk       Output array of VariantKeys (at least maxpairs items).
+ * @param ork       Output array of the RegionKeys overlapping ovk (at least maxpairs items).
+ * @param maxpairs  Maximum number of pairs to return.
+ *
+ * @return Number of pairs written in ovk and ork.
+ */
+static inline uint64_t join_variantkey_regionkey(vkrk_join_t *jn, const uint64_t *vk, const uint32_t *endpos, uint64_t nvk, const uint64_t *rk, uint64_t nrk, uint64_t *ovk, uint64_t *ork, uint64_t maxpairs)
+{
+    uint64_t vs, ve, r, i, k, n = 0;
+    uint64_t *tmp;
+    while ((jn->vpos < nvk) && (n < maxpairs))
+    {
+        vs = get_variantkey_chrom_startpos(vk[jn->vpos]);
+        ve = (((vk[jn->vpos] & VKMASK_CHROM) >> VKSHIFT_POS) | endpos[jn->vpos]);
+        if (jn->ready == 0)
+        {
+            // move the regions started before the variant into the active list
+            r = jn->rpos;
+            while ((r < nrk) && (get_regionkey_chrom_startpos(rk[r]) < vs))
+            {
+                ++r;
+            }
+            if ((jn->nactive + (r - jn->rpos)) > jn->maxactive)
+            {
+                k = ((jn->maxactive << 1) > (jn->nactive + (r - jn->rpos))) ? (jn->maxactive << 1) : (jn->nactive + (r - jn->rpos));
+                tmp = (uint64_t *)realloc(jn->active, (size_t)(k * sizeof(uint64_t)));
+                if (tmp == NULL)
+                {
+                    jn->err = 1;
+                    return n;
+                }
+                jn->active = tmp;
+                jn->maxactive = k;
+            }
+            for (i = jn->rpos; i < r; i++)
+            {
+                jn->active[jn->nactive++] = i;
+            }
+            jn->rpos = r;
+            // remove the regions ending before the variant
+            for (i = 0, k = 0; i < jn->nactive; i++)
+            {
+                if (get_regionkey_chrom_endpos(rk[jn->active[i]]) > vs)
+                {
+                    jn->active[k++] = jn->active[i];
+                }
+            }
+            jn->nactive = k;
+            jn->apos = 0;
+            jn->fpos = r;
+            jn->ready = 1;
+        }
+        while ((jn->apos < jn->nactive) && (n < maxpairs))
+        {
+            ovk[n] = vk[jn->vpos];
+            ork[n++] = rk[jn->active[jn->apos++]];
+        }
+        while ((jn->fpos < nrk) && (get_regionkey_chrom_startpos(rk[jn->fpos]) < ve) && (n < maxpairs))
+        {
+            if (get_regionkey_chrom_endpos(rk[jn->fpos]) > vs)
+            {
+                ovk[n] = vk[jn->vpos];
+                ork[n++] = rk[jn->fpos];
+            }
+            jn->fpos++;
+        }
+        if ((jn->apos < jn->nactive) || ((jn->fpos < nrk) && (get_regionkey_chrom_startpos(rk[jn->fpos]) < ve)))
+        {
+            break; // output full, resume from this variant
+        }
+        jn->vpos++;
+        jn->ready = 0;
+    }
+    return n;
+}
+
+/**
+ * Shared state of the parallel VariantKey - RegionKey overlap join.
+ */
+typedef struct vkrk_join_parallel_t
+{
+    nrvk_cols_t nvc;                       //!< NRVK columns used to resolve the variant end positions.
+    const uint64_t *vk;                    //!< Array of VariantKeys sorted in ascending order.
+    const uint64_t *rk;                    //!< Array of RegionKeys sorted in ascending order.
+    uint64_t vfirst[(RKJOIN_NCHROM + 1)];  //!< First VariantKey of each CHROM.
+    uint64_t rfirst[(RKJOIN_NCHROM + 1)];  //!< First RegionKey of each CHROM.
+    uint64_t *pvk[RKJOIN_NCHROM];          //!< Output VariantKeys of each CHROM.
+    uint64_t *prk[RKJOIN_NCHROM];          //!< Output RegionKeys of each CHROM.
+    uint64_t npairs[RKJOIN_NCHROM];        //!< Number of pairs of each CHROM.
+    uint32_t next;                         //!< Next CHROM to process.
+    int err;                               //!< Error flag.
+    pthread_mutex_t lock;                  //!< Lock for the CHROM queue.
+} vkrk_join_parallel_t;
+
+/**
+ * Join the VariantKeys and RegionKeys of one CHROM, collecting the pairs in growing buffers.
+ *
+ * @return 0 in case of success, 1 in case of memory allocation error.
+ */
+static inline int join_variantkey_regionkey_chrom(vkrk_join_parallel_t *jp, uint32_t c, uint32_t *endpos)
+{
+    const uint64_t *vk = (jp->vk + jp->vfirst[c]);
+    const uint64_t *rk = (jp->rk + jp->rfirst[c]);
+    uint64_t nvk = (jp->vfirst[(c + 1)] - jp->vfirst[c]);
+    uint64_t nrk = (jp->rfirst[(c + 1)] - jp->rfirst[c]);
+    uint64_t pos, nblk, room, maxpairs = 0, n = 0;
+    uint64_t *tmp;
+    vkrk_join_t jn;
+    init_vkrk_join(&jn);
+    for (pos = 0; (pos < nvk) && (jn.err == 0); pos += nblk)
+    {
+        nblk = ((nvk - pos) < RKJOIN_BLOCK) ? (nvk - pos) : RKJOIN_BLOCK;
+        get_variantkey_endpos_array(jp->nvc, (vk + pos), nblk, endpos);
+        jn.vpos = 0;
+        while ((jn.vpos < nblk) && (jn.err == 0))
+        {
+            if (n == maxpairs)
+            {
+                maxpairs = (maxpairs == 0) ? RKJOIN_BLOCK : (maxpairs << 1);
+                tmp = (uint64_t *)realloc(jp->pvk[c], (size_t)(maxpairs * sizeof(uint64_t)));
+                if (tmp != NULL)
+                {
+                    jp->pvk[c] = tmp;
+                    tmp = (uint64_t *)realloc(jp->prk[c], (size_t)(maxpairs * sizeof(uint64_t)));
+                }
+                if (tmp == NULL)
+                {
+                    jn.err = 1;
+                    break;
+                }
+                jp->prk[c] = tmp;
+            }
+            room = (maxpairs - n);
+            n += join_variantkey_regionkey(&jn, (vk + pos), endpos, nblk, rk, nrk, (jp->pvk[c] + n), (jp->prk[c] + n), room);
+        }
+    }
+    jp->npairs[c] = n;
+    free_vkrk_join(&jn);
+    return (jn.err != 0);
+}
+
+/**
+ * Thread worker of the parallel VariantKey - RegionKey overlap join: process the CHROMs until the queue is empty.
+ */
+static inline void *join_variantkey_regionkey_worker(void *arg)
+{
+    vkrk_join_parallel_t *jp = (vkrk_join_parallel_t *)arg;
+    uint32_t *endpos = (uint32_t *)malloc(RKJOIN_BLOCK * sizeof(uint32_t));
+    uint32_t c;
+    int err = (endpos == NULL);
+    for (;;)
+    {
+        pthread_mutex_lock(&jp->lock);
+        jp->err |= err;
+        c = jp->next++;
+        if (jp->err)
+        {
+            c = RKJOIN_NCHROM;
+        }
+        pthread_mutex_unlock(&jp->lock);
+        if (c >= RKJOIN_NCHROM)
+        {
+            break;
+        }
+        if ((jp->vfirst[(c + 1)] > jp->vfirst[c]) && (jp->rfirst[(c + 1)] > jp->rfirst[c]))
+        {
+            err = join_variantkey_regionkey_chrom(jp, c, endpos);
+        }
+    }
+    free(endpos);
+    return NULL;
+}
+
+/**
+ * Parallel VariantKey - RegionKey overlap join.
+ * The arrays are split by CHROM and each CHROM is joined independently by up to nthreads threads,
+ * resolving the variant end positions in blocks with get_variantkey_endpos_array().
+ * The pairs are returned in the same order as join_variantkey_regionkey().
+ *
+ * @param nvc       Structure containing the pointers to the NRVK memory mapped file columns.
+ * @param vk        Array of VariantKeys sorted in ascending order.
+ * @param nvk       Number of VariantKeys.
+ * @param rk        Array of RegionKeys sorted in ascending order.
+ * @param nrk       Number of RegionKeys.
+ * @param ovk       Output array of VariantKeys (at least maxpairs items).
+ * @param ork       Output array of the RegionKeys overlapping ovk (at least maxpairs items).
+ * @param maxpairs  Maximum number of pairs to return.
+ * @param nthreads  Maximum number of threads to use.
+ *
+ * @return Total number of overlapping pairs (only the first maxpairs are returned),
+ *         or RKJOIN_NOMEM in case of memory allocation error.
+ */
+static inline uint64_t parallel_join_variantkey_regionkey(nrvk_cols_t nvc, const uint64_t *vk, uint64_t nvk, const uint64_t *rk, uint64_t nrk, uint64_t *ovk, uint64_t *ork, uint64_t maxpairs, uint32_t nthreads)
+{
+    pthread_t tid[RKJOIN_NCHROM];
+    uint8_t started[RKJOIN_NCHROM];
+    uint64_t cnt, n = 0;
+    uint32_t c, t;
+    vkrk_join_parallel_t *jp = (vkrk_join_parallel_t *)calloc(1, sizeof(vkrk_join_parallel_t));
+    if (jp == NULL)
+    {
+        return RKJOIN_NOMEM;
+    }
+    jp->nvc = nvc;
+    jp->vk = vk;
+    jp->rk = rk;
+    for (c = 1; c < RKJOIN_NCHROM; c++)
+    {
+        jp->vfirst[c] = col_find_gallop_uint64_t(vk, jp->vfirst[(c - 1)], nvk, ((uint64_t)c << VKSHIFT_CHROM));
+        jp->rfirst[c] = col_find_gallop_uint64_t(rk, jp->rfirst[(c - 1)], nrk, ((uint64_t)c << RKSHIFT_CHROM));
+    }
+    jp->vfirst[RKJOIN_NCHROM] = nvk;
+    jp->rfirst[RKJOIN_NCHROM] = nrk;
+    pthread_mutex_init(&jp->lock, NULL);
+    if (nthreads > RKJOIN_NCHROM)
+    {
+        nthreads = RKJOIN_NCHROM;
+    }
+    for (t = 1; t < nthreads; t++)
+    {
+        started[t] = (pthread_create(&tid[t], NULL, join_variantkey_regionkey_worker, jp) == 0);
+    }
+    join_variantkey_regionkey_worker(jp);
+    for (t = 1; t < nthreads; t++)
+    {
+        if (started[t])
+        {
+            pthread_join(tid[t], NULL);
+        }
+    }
+    // concatenate the CHROM results
+    for (c = 0; c < RKJOIN_NCHROM; c++)
+    {
+        if (n < maxpairs)
+        {
+            cnt = ((maxpairs - n) < jp->npairs[c]) ? (maxpairs - n) : jp->npairs[c];
+            if (cnt > 0)
+            {
+                memcpy((ovk + n), jp->pvk[c], (size_t)(cnt * sizeof(uint64_t)));
+                memcpy((ork + n), jp->prk[c], (size_t)(cnt * sizeof(uint64_t)));
+            }
+        }
+        n += jp->npairs[c];
+        free(jp->pvk[c]);
+        free(jp->prk[c]);
+    }
+    if (jp->err)
+    {
+        n = RKJOIN_NOMEM;
+    }
+    pthread_mutex_destroy(&jp->lock);
+    free(jp);
+    return n;
+}
+
 #endif  // VARIANTKEY_REGIONKEY_H
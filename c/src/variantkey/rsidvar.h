@@ -43,6 +43,11 @@
  * This can also be in *Apache Arrow File* format with a single *RecordBatch*, or *Feather* format.
  * The first column must contain the rsID sorted in ascending order.
  *
+ * rsvk.bin.dir:
+ * Optional directory of the rsvk.bin file, generated by save_rsvk_dir_file().
+ * It maps the rsID high bits to the range of rows containing them,
+ * so each rsID lookup only searches a small bucket (see find_rv_variantkey_by_rsid_dir).
+ *
  * vkrs.bin:
  * Lookup table to retrieve rsID from VariantKey.
  * This binary file can be generated by the `resources/tools/vkrs.sh' script from a TSV file.
@@ -53,6 +58,8 @@
 #ifndef VARIANTKEY_RSIDVAR_H
 #define VARIANTKEY_RSIDVAR_H
 
+#include <stdlib.h>
+#include "binfuse.h"
 #include "binsearch.h"
 #include "variantkey.h"
 
@@ -64,6 +71,7 @@ typedef struct rsidvar_cols_t
     const uint64_t *vk;  //!< Pointer to the VariantKey column.
     const uint32_t *rs;  //!< Pointer to the rsID column.
     uint64_t nrows;      //!< Number of rows.
+    const uint64_t *filter; //!< Pointer to the optional binary fuse filter of the VKRS VariantKey column (NULL when not loaded).
 } rsidvar_cols_t;
 
 /**
@@ -81,6 +89,22 @@ static inline void mmap_vkrs_file(const char *file, mmfile_t *mf, rsidvar_cols_t
     cvr->vk = (const uint64_t *)(mf->src + mf->index[0]);
     cvr->rs = (const uint32_t *)(mf->src + mf->index[1]);
     cvr->nrows = mf->nrows;
+    cvr->filter = NULL;
+}
+
+/**
+ * Memory map the binary fuse filter of the VKRS VariantKey column and attach it to the VKRS columns.
+ * The filter can be built with build_binfuse_file(file, cvr.vk, cvr.nrows) (see binfuse.h).
+ * Once attached, most of the VariantKeys that are not in the VKRS file are rejected without accessing the file.
+ * The filter is ignored if it was not built for the same VKRS file.
+ *
+ * @param file  Path to the file to map.
+ * @param mf    Structure containing the memory mapped file.
+ * @param cvr   Structure containing the pointers to the VKRS memory mapped file columns (already mapped).
+ */
+static inline void mmap_vkrs_filter_file(const char *file, mmfile_t *mf, rsidvar_cols_t *cvr)
+{
+    cvr->filter = mmap_binfuse_file(file, mf, cvr->vk, cvr->nrows);
 }
 
 /**
@@ -98,6 +122,7 @@ static inline void mmap_rsvk_file(const char *file, mmfile_t *mf, rsidvar_cols_t
     crv->rs = (const uint32_t *)(mf->src + mf->index[0]);
     crv->vk = (const uint64_t *)(mf->src + mf->index[1]);
     crv->nrows = mf->nrows;
+    crv->filter = NULL;
 }
 
 /**
@@ -144,12 +169,136 @@ static inline uint64_t get_next_rv_variantkey_by_rsid(rsidvar_cols_t crv, uint64
     return 0;
 }
 
+#define RSIDVAR_DIR_SHIFT 8 //!< Number of rsID low bits grouped in each bucket of the RSVK directory.
+
+/**
+ * Struct containing the RSVK directory info.
+ * The directory maps the rsID high bits (rsid >> RSIDVAR_DIR_SHIFT) to the range of rows containing them.
+ */
+typedef struct rsidvar_dir_t
+{
+    const uint64_t *idx; //!< Pointer to the directory: idx[b] is the first row with (rsid >> RSIDVAR_DIR_SHIFT) >= b.
+    uint64_t nitems;     //!< Number of items in the directory (number of buckets + 1).
+} rsidvar_dir_t;
+
+/**
+ * Returns the number of items of the directory for the specified RSVK file.
+ *
+ * @param crv       Structure containing the pointers to the RSVK memory mapped file columns (rsvk.bin).
+ *
+ * @return Number of directory items.
+ */
+static inline uint64_t get_rsvk_dir_size(rsidvar_cols_t crv)
+{
+    if (crv.nrows == 0)
+    {
+        return 1;
+    }
+    return ((uint64_t)(crv.rs[(crv.nrows - 1)] >> RSIDVAR_DIR_SHIFT) + 2);
+}
+
+/**
+ * Build the directory for the specified RSVK file.
+ *
+ * @param crv       Structure containing the pointers to the RSVK memory mapped file columns (rsvk.bin).
+ * @param idx       Output array of get_rsvk_dir_size(crv) items.
+ */
+static inline void build_rsvk_dir(rsidvar_cols_t crv, uint64_t *idx)
+{
+    uint64_t nitems = get_rsvk_dir_size(crv);
+    uint64_t b, row = 0;
+    for (b = 0; b < nitems; b++)
+    {
+        while ((row < crv.nrows) && ((uint64_t)(crv.rs[row] >> RSIDVAR_DIR_SHIFT) < b))
+        {
+            ++row;
+        }
+        idx[b] = row;
+    }
+}
+
+/**
+ * Build the directory for the specified RSVK file and save it as a BINSRC1 file (e.g. rsvk.bin.dir).
+ *
+ * @param file      Path of the output file.
+ * @param crv       Structure containing the pointers to the RSVK memory mapped file columns (rsvk.bin).
+ *
+ * @return Number of bytes written or 0 in case of error.
+ */
+static inline size_t save_rsvk_dir_file(const char *file, rsidvar_cols_t crv)
+{
+    uint64_t nitems = get_rsvk_dir_size(crv);
+    uint64_t *idx = (uint64_t *)malloc(sizeof(uint64_t) * nitems);
+    if (idx == NULL)
+    {
+        return 0;
+    }
+    build_rsvk_dir(crv, idx);
+    size_t ret = save_binsrc1_col(file, idx, 8, nitems);
+    free(idx);
+    return ret;
+}
+
+/**
+ * Memory map the RSVK directory file.
+ *
+ * @param file      Path to the file to map.
+ * @param crv       Structure containing the pointers to the RSVK memory mapped file columns (rsvk.bin).
+ * @param mf        Structure containing the memory mapped file.
+ * @param dir       Structure containing the directory info.
+ *
+ * @return 0 in case of success, 1 if the file can't be mapped or doesn't match the RSVK file.
+ */
+static inline int mmap_rsvk_dir_file(const char *file, rsidvar_cols_t crv, mmfile_t *mf, rsidvar_dir_t *dir)
+{
+    dir->idx = NULL;
+    dir->nitems = 0;
+    mmap_binfile(file, mf);
+    if ((mf->fd < 0) || (mf->src == MAP_FAILED) || (mf->ncols != 1) || (mf->ctbytes[0] != 8) || (mf->nrows != get_rsvk_dir_size(crv)))
+    {
+        return 1;
+    }
+    dir->idx = (const uint64_t *)(mf->src + mf->index[0]);
+    dir->nitems = mf->nrows;
+    return 0;
+}
+
+/**
+ * Search for the specified rsID using the RSVK directory and returns the first occurrence of VariantKey in the RV file.
+ * This is equivalent to find_rv_variantkey_by_rsid over the whole file,
+ * but the binary search is limited to the rows of a single directory bucket.
+ *
+ * @param crv       Structure containing the pointers to the RSVK memory mapped file columns (rsvk.bin).
+ * @param dir       Structure containing the directory info.
+ * @param first     Pointer to the first element found.
+ * @param rsid      rsID to search.
+ *
+ * @return VariantKey data or zero data if not found
+ */
+static inline uint64_t find_rv_variantkey_by_rsid_dir(rsidvar_cols_t crv, rsidvar_dir_t dir, uint64_t *first, uint32_t rsid)
+{
+    uint64_t b = (uint64_t)(rsid >> RSIDVAR_DIR_SHIFT);
+    if ((b + 1) >= dir.nitems)
+    {
+        *first = crv.nrows;
+        return 0;
+    }
+    *first = dir.idx[b];
+    if (*first >= dir.idx[(b + 1)])
+    {
+        return 0; // empty bucket
+    }
+    return find_rv_variantkey_by_rsid(crv, first, dir.idx[(b + 1)], rsid);
+}
+
 /**
  * Search for the specified VariantKey and returns the first occurrence of rsID in the VR file.
+ * The VariantKey is first checked against the filter attached with mmap_vkrs_filter_file (if any).
  *
  * @param cvr       Structure containing the pointers to the VKRS memory mapped file columns (vkrs.bin).
  * @param first     Pointer to the first element of the range to search (min value = 0).
- *                  This will hold the position of the first record found.
+ *                  This will hold the position of the first record found
+ *                  (it is not modified when the VariantKey is rejected by the filter).
  * @param last      Element (up to but not including) where to end the search (max value = nitems).
  * @param vk        VariantKey.
  *
@@ -157,6 +306,10 @@ static inline uint64_t get_next_rv_variantkey_by_rsid(rsidvar_cols_t crv, uint64
  */
 static inline uint32_t find_vr_rsid_by_variantkey(rsidvar_cols_t cvr, uint64_t *first, uint64_t last, uint64_t vk)
 {
+    if ((cvr.filter != NULL) && !binfuse_contain(cvr.filter, vk))
+    {
+        return 0; // certainly not found
+    }
     uint64_t max = last;
     uint64_t found = col_find_first_uint64_t(cvr.vk, first, &max, vk);
     if (found >= last)
@@ -188,6 +341,57 @@ static inline uint32_t get_next_vr_rsid_by_variantkey(rsidvar_cols_t cvr, uint64
     return 0;
 }
 
+/**
+ * Join an array of VariantKeys sorted in ascending order with the VR file,
+ * and return the (VariantKey, rsID) pairs for all the matching rows.
+ * Each search starts from the position of the previous one using a galloping search,
+ * so the whole join costs O(n log(m/n)) instead of O(n log m) for n keys and m rows.
+ * The output is limited to maxpairs items: the function can be called in a loop
+ * with the same kpos and rpos variables until kpos is equal to nitems.
+ *
+ * @param cvr       Structure containing the pointers to the VKRS memory mapped file columns (vkrs.bin).
+ * @param vk        Array of VariantKeys sorted in ascending order.
+ * @param nitems    Number of VariantKeys in the array.
+ * @param kpos      Pointer to the position of the next VariantKey to process (initial value = 0).
+ * @param rpos      Pointer to the VR file row from where to start the next search (initial value = 0).
+ * @param ovk       Output array of matching VariantKeys (at least maxpairs items).
+ * @param ors       Output array of the rsIDs associated with ovk (at least maxpairs items).
+ * @param maxpairs  Maximum number of pairs to return.
+ *
+ * @return Number of pairs written in ovk and ors.
+ */
+static inline uint64_t join_vr_rsid_by_variantkey(rsidvar_cols_t cvr, const uint64_t *vk, uint64_t nitems, uint64_t *kpos, uint64_t *rpos, uint64_t *ovk, uint32_t *ors, uint64_t maxpairs)
+{
+    uint64_t i = *kpos, row = *rpos, n = 0;
+    while ((i < nitems) && (n < maxpairs))
+    {
+        row = col_find_gallop_uint64_t(cvr.vk, row, cvr.nrows, vk[i]);
+        while ((row < cvr.nrows) && (cvr.vk[row] == vk[i]) && (n < maxpairs))
+        {
+            ovk[n] = vk[i];
+            ors[n] = cvr.rs[row];
+            ++n;
+            ++row;
+        }
+        if ((row < cvr.nrows) && (cvr.vk[row] == vk[i]))
+        {
+            break; // output full, resume from this key and row
+        }
+        ++i;
+        if ((i < nitems) && (vk[i] == vk[(i - 1)]))
+        {
+            // duplicate key: rewind to the first matching row
+            while ((row > 0) && (cvr.vk[(row - 1)] == vk[i]))
+            {
+                --row;
+            }
+        }
+    }
+    *kpos = i;
+    *rpos = row;
+    return n;
+}
+
 /**
  * Search for the specified CHROM-POS range and returns the first occurrence of rsID in the VR file.
  *
@@ -41,7 +41,28 @@
 #define VARIANTKEY_SET_H
 
 #include <inttypes.h>
+#include <pthread.h>
 #include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#ifndef SET_GALLOP_RATIO
+#define SET_GALLOP_RATIO 32 //!< Minimum size ratio between two sets to use the galloping (exponential) search instead of the linear merge.
+#endif
+
+#define KWAY_NOMEM 0xFFFFFFFFFFFFFFFF //!< Value returned by the k-way functions on memory allocation failure.
+#define KWAY_PARTITION_SHIFT 56 //!< The parallel k-way functions split the sets on the most significant byte (the VariantKey CHROM byte).
+
+#ifndef PARALLEL_SORT_MAXTHREADS
+#define PARALLEL_SORT_MAXTHREADS 256 //!< Maximum number of threads used by the parallel sort functions.
+#endif
+
+#ifndef PARALLEL_SORT_MINBLOCK
+#define PARALLEL_SORT_MINBLOCK 65536 //!< Minimum number of items processed by each sorting thread.
+#endif
 
 #define RADIX_SORT_COUNT_BLOCK \
     uint32_t c7[256]= {0}, c6[256]= {0}, c5[256]= {0}, c4[256]= {0}, c3[256]= {0}, c2[256]= {0}, c1[256]= {0}, c0[256]= {0}; \
@@ -203,6 +224,301 @@ static inline void order_uint64_t(uint64_t *arr, uint64_t *tmp, uint32_t *idx, u
     }
 }
 
+#define PARALLEL_SORT_OP_COUNTALL 0 //!< Count the occurrences of all the 8 bytes.
+#define PARALLEL_SORT_OP_COUNT    1 //!< Count the occurrences of the current byte.
+#define PARALLEL_SORT_OP_SCATTER  2 //!< Move the items to their sorted position for the current byte.
+#define PARALLEL_SORT_OP_COPY     3 //!< Copy the items back to the output array.
+
+/**
+ * Work block of a parallel radix sort thread.
+ */
+typedef struct parallel_sort_job_t
+{
+    const uint64_t *src;  //!< Source array for the current pass.
+    uint64_t *dst;        //!< Destination array for the current pass.
+    const uint64_t *isrc; //!< Source index array (NULL for the identity permutation).
+    uint64_t *idst;       //!< Destination index array (NULL when the order is not required).
+    uint64_t first;       //!< First item of the block.
+    uint64_t last;        //!< Last item of the block (excluded).
+    uint8_t op;           //!< Operation (PARALLEL_SORT_OP_*).
+    uint8_t byte;         //!< Current byte, 0 for the least significant.
+    uint64_t cnt[8][256]; //!< Histogram (or scatter position) of each byte value for this block.
+} parallel_sort_job_t;
+
+/**
+ * Execute the operation of a parallel radix sort job on its block.
+ *
+ * @param arg    Pointer to a parallel_sort_job_t structure.
+ *
+ * @return Always NULL.
+ */
+static inline void *parallel_sort_worker(void *arg)
+{
+    parallel_sort_job_t *job = (parallel_sort_job_t *)arg;
+    const uint64_t *src = job->src;
+    const uint64_t *isrc = job->isrc;
+    uint64_t *dst = job->dst;
+    uint64_t *idst = job->idst;
+    uint64_t pos[256];
+    const uint64_t first = job->first; // local copies as the arrays may alias the job fields
+    const uint64_t last = job->last;
+    uint64_t i, v, j;
+    uint8_t shift = (uint8_t)(job->byte * 8);
+    uint64_t (*cnt)[256] = job->cnt;
+    uint64_t *c = cnt[job->byte];
+    switch (job->op)
+    {
+    case PARALLEL_SORT_OP_COUNTALL:
+        memset(cnt, 0, sizeof(job->cnt));
+        for (i = first; i < last; i++)
+        {
+            v = src[i];
+            cnt[0][(v & 0xff)]++;
+            cnt[1][((v >> 8) & 0xff)]++;
+            cnt[2][((v >> 16) & 0xff)]++;
+            cnt[3][((v >> 24) & 0xff)]++;
+            cnt[4][((v >> 32) & 0xff)]++;
+            cnt[5][((v >> 40) & 0xff)]++;
+            cnt[6][((v >> 48) & 0xff)]++;
+            cnt[7][((v >> 56) & 0xff)]++;
+        }
+        break;
+    case PARALLEL_SORT_OP_COUNT:
+        memset(pos, 0, sizeof(pos));
+        for (i = first; i < last; i++)
+        {
+            pos[((src[i] >> shift) & 0xff)]++;
+        }
+        memcpy(c, pos, sizeof(pos));
+        break;
+    case PARALLEL_SORT_OP_SCATTER:
+        memcpy(pos, c, sizeof(pos));
+        if (idst == NULL)
+        {
+            for (i = first; i < last; i++)
+            {
+                v = src[i];
+                dst[pos[((v >> shift) & 0xff)]++] = v;
+            }
+            break;
+        }
+        for (i = first; i < last; i++)
+        {
+            v = src[i];
+            j = pos[((v >> shift) & 0xff)]++;
+            dst[j] = v;
+            idst[j] = (isrc == NULL) ? i : isrc[i];
+        }
+        break;
+    case PARALLEL_SORT_OP_COPY:
+        if (dst != src)
+        {
+            memcpy(dst + first, src + first, (size_t)((last - first) * sizeof(uint64_t)));
+        }
+        if (idst != NULL)
+        {
+            if (isrc == NULL)
+            {
+                for (i = first; i < last; i++)
+                {
+                    idst[i] = i;
+                }
+                break;
+            }
+            memcpy(idst + first, isrc + first, (size_t)((last - first) * sizeof(uint64_t)));
+        }
+        break;
+    }
+    return NULL;
+}
+
+/**
+ * Run the same operation on all the parallel radix sort jobs and wait for completion.
+ * The first job is executed by the calling thread.
+ *
+ * @param job      Array of jobs.
+ * @param nthreads Number of jobs.
+ * @param op       Operation (PARALLEL_SORT_OP_*).
+ */
+static inline void parallel_sort_run(parallel_sort_job_t *job, uint32_t nthreads, uint8_t op)
+{
+    pthread_t tid[PARALLEL_SORT_MAXTHREADS];
+    uint8_t started[PARALLEL_SORT_MAXTHREADS];
+    uint32_t t;
+    for (t = 0; t < nthreads; t++)
+    {
+        job[t].op = op;
+    }
+    for (t = 1; t < nthreads; t++)
+    {
+        started[t] = (pthread_create(&tid[t], NULL, parallel_sort_worker, &job[t]) == 0);
+    }
+    parallel_sort_worker(&job[0]);
+    for (t = 1; t < nthreads; t++)
+    {
+        if (started[t])
+        {
+            pthread_join(tid[t], NULL);
+        }
+        else
+        {
+            parallel_sort_worker(&job[t]); // fallback on thread creation failure
+        }
+    }
+}
+
+/**
+ * Multi-threaded radix sort implementation used by parallel_sort_uint64_t and parallel_order_uint64_t.
+ *
+ * @param arr      Pointer to the first element of the array to process.
+ * @param tmp      Pointer to the first element of a temporary array.
+ * @param idx      Pointer to the first element of the index array to be returned (NULL if not required).
+ * @param tdx      Pointer to the first element of a temporary index array (NULL if not required).
+ * @param nitems   Number of elements in the array.
+ * @param nthreads Maximum number of threads to use.
+ */
+static inline void parallel_radix_sort_uint64_t(uint64_t *arr, uint64_t *tmp, uint64_t *idx, uint64_t *tdx, uint64_t nitems, uint32_t nthreads)
+{
+    parallel_sort_job_t single;
+    parallel_sort_job_t *job = &single;
+    uint64_t maxthreads = (nitems / PARALLEL_SORT_MINBLOCK) + 1;
+    if (nthreads > PARALLEL_SORT_MAXTHREADS)
+    {
+        nthreads = PARALLEL_SORT_MAXTHREADS;
+    }
+    if (nthreads > maxthreads)
+    {
+        nthreads = (uint32_t)maxthreads;
+    }
+    if (nthreads > 1)
+    {
+        job = (parallel_sort_job_t *)malloc(nthreads * sizeof(parallel_sort_job_t));
+        if (job == NULL)
+        {
+            job = &single;
+            nthreads = 1;
+        }
+    }
+    if (nthreads == 0)
+    {
+        nthreads = 1;
+    }
+    uint64_t blk = nitems / nthreads;
+    uint32_t t;
+    for (t = 0; t < nthreads; t++)
+    {
+        job[t].first = (t * blk);
+        job[t].last = (t == (nthreads - 1)) ? nitems : ((t + 1) * blk);
+        job[t].src = arr;
+        job[t].byte = 0;
+    }
+    parallel_sort_run(job, nthreads, PARALLEL_SORT_OP_COUNTALL);
+    uint64_t *src = arr, *dst = tmp, *isrc = NULL, *idst = idx, *swp;
+    uint64_t sum, c;
+    uint8_t b;
+    int counted = 1; // the initial histograms are valid until the first scatter (or always with a single block)
+    uint32_t i;
+    for (b = 0; b < 8; b++)
+    {
+        // skip the pass when all the items share the same byte value
+        for (i = 0; i < 256; i++)
+        {
+            for (sum = 0, t = 0; t < nthreads; t++)
+            {
+                sum += job[t].cnt[b][i];
+            }
+            if (sum != 0)
+            {
+                break;
+            }
+        }
+        if ((i == 256) || (sum == nitems))
+        {
+            continue;
+        }
+        for (t = 0; t < nthreads; t++)
+        {
+            job[t].src = src;
+            job[t].byte = b;
+        }
+        if (!counted)
+        {
+            parallel_sort_run(job, nthreads, PARALLEL_SORT_OP_COUNT);
+        }
+        // exclusive prefix sum over (byte value, thread) to get the scatter positions
+        for (sum = 0, i = 0; i < 256; i++)
+        {
+            for (t = 0; t < nthreads; t++)
+            {
+                c = job[t].cnt[b][i];
+                job[t].cnt[b][i] = sum;
+                sum += c;
+            }
+        }
+        for (t = 0; t < nthreads; t++)
+        {
+            job[t].dst = dst;
+            job[t].isrc = isrc;
+            job[t].idst = (idx == NULL) ? NULL : idst;
+        }
+        parallel_sort_run(job, nthreads, PARALLEL_SORT_OP_SCATTER);
+        counted = (nthreads == 1);
+        swp = src;
+        src = dst;
+        dst = swp;
+        if (idx != NULL)
+        {
+            isrc = idst;
+            idst = (idst == idx) ? tdx : idx;
+        }
+    }
+    if ((src != arr) || ((idx != NULL) && (isrc != idx)))
+    {
+        for (t = 0; t < nthreads; t++)
+        {
+            job[t].src = src;
+            job[t].dst = arr;
+            job[t].isrc = isrc;
+            job[t].idst = idx;
+        }
+        parallel_sort_run(job, nthreads, PARALLEL_SORT_OP_COPY);
+    }
+    if (job != &single)
+    {
+        free(job);
+    }
+}
+
+/**
+ * Sorts in-memory an array of uint64_t values in ascending order using multiple threads.
+ * The passes on the bytes that are equal for all the items (e.g. the CHROM byte of VariantKeys from the same chromosome) are skipped.
+ *
+ * @param arr      Pointer to the first element of the array to process.
+ * @param tmp      Pointer to the first element of a temporary array.
+ * @param nitems   Number of elements in the array.
+ * @param nthreads Maximum number of threads to use.
+ */
+static inline void parallel_sort_uint64_t(uint64_t *arr, uint64_t *tmp, uint64_t nitems, uint32_t nthreads)
+{
+    parallel_radix_sort_uint64_t(arr, tmp, NULL, NULL, nitems, nthreads);
+}
+
+/**
+ * Sorts in-memory an array of uint64_t values in ascending order and store the permutation order index, using multiple threads.
+ * The passes on the bytes that are equal for all the items are skipped.
+ *
+ * @param arr      Pointer to the first element of the array to process.
+ * @param tmp      Pointer to the first element of a temporary array.
+ * @param idx      Pointer to the first element of the index array to be returned.
+ * @param tdx      Pointer to the first element of a temporary index array.
+ * @param nitems   Number of elements in the array.
+ * @param nthreads Maximum number of threads to use.
+ */
+static inline void parallel_order_uint64_t(uint64_t *arr, uint64_t *tmp, uint64_t *idx, uint64_t *tdx, uint64_t nitems, uint32_t nthreads)
+{
+    parallel_radix_sort_uint64_t(arr, tmp, idx, tdx, nitems, nthreads);
+}
+
 /**
  * Reverse in-place an array of uint64_t values.
  *
@@ -319,4 +635,854 @@ static inline uint64_t *union_uint64_t(uint64_t *a_arr, uint64_t a_nitems, uint6
     return o_arr;
 }
 
+/**
+ * Returns the position of the first element that is not less than the search value,
+ * using a galloping (exponential) search from the start of the array followed by a binary search.
+ * The cost is O(log d), where d is the distance of the result from the start of the array.
+ *
+ * @param arr    Pointer to the first element of the sorted array to search.
+ * @param nitems Number of elements in the array.
+ * @param search Value to search.
+ *
+ * @return Position of the first element not less than search, or nitems if all elements are less than search.
+ */
+static inline uint64_t gallop_uint64_t(const uint64_t *arr, uint64_t nitems, uint64_t search)
+{
+    uint64_t first = 0, step = 1, last, middle;
+    while ((first + step) < nitems)
+    {
+        if (arr[first + step - 1] >= search)
+        {
+            break;
+        }
+        first += step;
+        step <<= 1;
+    }
+    last = first + step;
+    if (last > nitems)
+    {
+        last = nitems;
+    }
+    while (first < last)
+    {
+        middle = first + ((last - first) >> 1);
+        if (arr[middle] < search)
+        {
+            first = middle + 1;
+        }
+        else
+        {
+            last = middle;
+        }
+    }
+    return first;
+}
+
+/**
+ * Compare a block of 4 elements against another block of 4 elements.
+ *
+ * @param a      Pointer to the first element of the first block.
+ * @param b      Pointer to the first element of the second block.
+ *
+ * @return 4-bit mask with bit k set if a[k] is equal to any element of b.
+ */
+static inline uint32_t set_match_block4(const uint64_t *a, const uint64_t *b)
+{
+#if defined(__AVX2__)
+    __m256i va = _mm256_loadu_si256((const __m256i *)a);
+    __m256i vb = _mm256_loadu_si256((const __m256i *)b);
+    __m256i m = _mm256_cmpeq_epi64(va, vb);
+    m = _mm256_or_si256(m, _mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x39))); // rotate by 1
+    m = _mm256_or_si256(m, _mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x4e))); // rotate by 2
+    m = _mm256_or_si256(m, _mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x93))); // rotate by 3
+    return (uint32_t)_mm256_movemask_pd(_mm256_castsi256_pd(m));
+#else
+    uint32_t mask = 0, k;
+    for (k = 0; k < 4; k++)
+    {
+        mask |= (uint32_t)((a[k] == b[0]) | (a[k] == b[1]) | (a[k] == b[2]) | (a[k] == b[3])) << k;
+    }
+    return mask;
+#endif
+}
+
+// Append to o_arr the elements a_arr[i + k] for which bit k of MASK is set.
+// The elements are packed branch-free in a local block to never write past the end of the output.
+#define SET_PACK_BLOCK4(MASK) \
+    { \
+        uint64_t blk[4]; \
+        uint32_t m = (MASK), n = 0; \
+        blk[n] = a_arr[i]; \
+        n += (m & 1); \
+        blk[n] = a_arr[i + 1]; \
+        n += ((m >> 1) & 1); \
+        blk[n] = a_arr[i + 2]; \
+        n += ((m >> 2) & 1); \
+        blk[n] = a_arr[i + 3]; \
+        n += ((m >> 3) & 1); \
+        memcpy(o_arr, blk, (n * sizeof(uint64_t))); \
+        o_arr += n; \
+    }
+
+/**
+ * Returns the intersection of two sorted sets (uint64_t arrays in ascending order without duplicates).
+ * The galloping search is used when one set is at least SET_GALLOP_RATIO times larger than the other,
+ * otherwise the sets are scanned in blocks of 4 elements with SIMD (AVX2) or branch-free comparisons.
+ *
+ * @param a_arr    Pointer to the first element of the first set.
+ * @param a_nitems Number of elements in the first set.
+ * @param b_arr    Pointer to the first element of the second set.
+ * @param b_nitems Number of elements in the second set.
+ * @param o_arr    Pointer to the first element of the output array (at least min(a_nitems, b_nitems) elements).
+ *
+ * @return Pointer to the end of the output array.
+ */
+static inline uint64_t *intersection_set_uint64_t(const uint64_t *a_arr, uint64_t a_nitems, const uint64_t *b_arr, uint64_t b_nitems, uint64_t *o_arr)
+{
+    uint64_t i = 0, j = 0;
+    if ((b_nitems / SET_GALLOP_RATIO) > a_nitems)
+    {
+        for (i = 0; (i < a_nitems) && (j < b_nitems); i++)
+        {
+            j += gallop_uint64_t(b_arr + j, b_nitems - j, a_arr[i]);
+            if ((j < b_nitems) && (b_arr[j] == a_arr[i]))
+            {
+                *o_arr++ = a_arr[i];
+            }
+        }
+        return o_arr;
+    }
+    if ((a_nitems / SET_GALLOP_RATIO) > b_nitems)
+    {
+        return intersection_set_uint64_t(b_arr, b_nitems, a_arr, a_nitems, o_arr);
+    }
+    uint32_t mask;
+    uint64_t amax, bmax;
+    while (((i + 4) <= a_nitems) && ((j + 4) <= b_nitems))
+    {
+        // each element of a can only match once as the sets have no duplicates
+        mask = set_match_block4(a_arr + i, b_arr + j);
+        SET_PACK_BLOCK4(mask)
+        amax = a_arr[i + 3];
+        bmax = b_arr[j + 3];
+        i += (amax <= bmax) << 2;
+        j += (bmax <= amax) << 2;
+    }
+    while ((i < a_nitems) && (j < b_nitems))
+    {
+        amax = a_arr[i];
+        bmax = b_arr[j];
+        if (amax == bmax)
+        {
+            *o_arr++ = amax;
+        }
+        i += (amax <= bmax);
+        j += (bmax <= amax);
+    }
+    return o_arr;
+}
+
+/**
+ * Returns the union of two sorted sets (uint64_t arrays in ascending order without duplicates).
+ * When one set is at least SET_GALLOP_RATIO times larger than the other,
+ * the runs of the larger set between the elements of the smaller one are located with a galloping search and copied in bulk,
+ * otherwise a branch-free merge is used.
+ *
+ * @param a_arr    Pointer to the first element of the first set.
+ * @param a_nitems Number of elements in the first set.
+ * @param b_arr    Pointer to the first element of the second set.
+ * @param b_nitems Number of elements in the second set.
+ * @param o_arr    Pointer to the first element of the output array (at least a_nitems + b_nitems elements).
+ *
+ * @return Pointer to the end of the output array.
+ */
+static inline uint64_t *union_set_uint64_t(const uint64_t *a_arr, uint64_t a_nitems, const uint64_t *b_arr, uint64_t b_nitems, uint64_t *o_arr)
+{
+    uint64_t i = 0, j = 0, p, x, y;
+    if ((a_nitems / SET_GALLOP_RATIO) > b_nitems)
+    {
+        return union_set_uint64_t(b_arr, b_nitems, a_arr, a_nitems, o_arr);
+    }
+    if ((b_nitems / SET_GALLOP_RATIO) > a_nitems)
+    {
+        for (i = 0; i < a_nitems; i++)
+        {
+            p = j + gallop_uint64_t(b_arr + j, b_nitems - j, a_arr[i]);
+            memcpy(o_arr, b_arr + j, (size_t)((p - j) * sizeof(uint64_t)));
+            o_arr += (p - j);
+            *o_arr++ = a_arr[i];
+            j = p + ((p < b_nitems) && (b_arr[p] == a_arr[i]));
+        }
+    }
+    else
+    {
+        while ((i < a_nitems) && (j < b_nitems))
+        {
+            x = a_arr[i];
+            y = b_arr[j];
+            *o_arr++ = (x < y) ? x : y;
+            i += (x <= y);
+            j += (y <= x);
+        }
+        memcpy(o_arr, a_arr + i, (size_t)((a_nitems - i) * sizeof(uint64_t)));
+        o_arr += (a_nitems - i);
+    }
+    memcpy(o_arr, b_arr + j, (size_t)((b_nitems - j) * sizeof(uint64_t)));
+    return (o_arr + (b_nitems - j));
+}
+
+/**
+ * Returns the difference of two sorted sets (uint64_t arrays in ascending order without duplicates):
+ * the elements of the first set that are not in the second one.
+ * The galloping search is used when one set is at least SET_GALLOP_RATIO times larger than the other,
+ * otherwise the sets are scanned in blocks of 4 elements with SIMD (AVX2) or branch-free comparisons.
+ *
+ * @param a_arr    Pointer to the first element of the first set.
+ * @param a_nitems Number of elements in the first set.
+ * @param b_arr    Pointer to the first element of the second set.
+ * @param b_nitems Number of elements in the second set.
+ * @param o_arr    Pointer to the first element of the output array (at least a_nitems elements).
+ *
+ * @return Pointer to the end of the output array.
+ */
+static inline uint64_t *difference_set_uint64_t(const uint64_t *a_arr, uint64_t a_nitems, const uint64_t *b_arr, uint64_t b_nitems, uint64_t *o_arr)
+{
+    uint64_t i = 0, j = 0, p;
+    if ((b_nitems / SET_GALLOP_RATIO) > a_nitems)
+    {
+        for (i = 0; i < a_nitems; i++)
+        {
+            j += gallop_uint64_t(b_arr + j, b_nitems - j, a_arr[i]);
+            if ((j >= b_nitems) || (b_arr[j] != a_arr[i]))
+            {
+                *o_arr++ = a_arr[i];
+            }
+        }
+        return o_arr;
+    }
+    if ((a_nitems / SET_GALLOP_RATIO) > b_nitems)
+    {
+        for (j = 0; (j < b_nitems) && (i < a_nitems); j++)
+        {
+            p = i + gallop_uint64_t(a_arr + i, a_nitems - i, b_arr[j]);
+            memcpy(o_arr, a_arr + i, (size_t)((p - i) * sizeof(uint64_t)));
+            o_arr += (p - i);
+            i = p + ((p < a_nitems) && (a_arr[p] == b_arr[j]));
+        }
+    }
+    else
+    {
+        uint32_t mask = 0; // elements of the current block of a found in b
+        uint64_t amax, bmax;
+        while (((i + 4) <= a_nitems) && ((j + 4) <= b_nitems))
+        {
+            mask |= set_match_block4(a_arr + i, b_arr + j);
+            amax = a_arr[i + 3];
+            bmax = b_arr[j + 3];
+            if (amax <= bmax)
+            {
+                // all the elements of b that can match this block have been compared
+                SET_PACK_BLOCK4(~mask)
+                mask = 0;
+                i += 4;
+            }
+            j += (bmax <= amax) << 2;
+        }
+        // scalar merge, skipping the elements of the partially compared block already found in b
+        uint64_t blk = i;
+        while ((i < a_nitems) && ((j < b_nitems) || ((i - blk) < 4)))
+        {
+            if (((i - blk) < 4) && ((mask >> (i - blk)) & 1))
+            {
+                i++;
+                continue;
+            }
+            if (j >= b_nitems)
+            {
+                *o_arr++ = a_arr[i++];
+                continue;
+            }
+            amax = a_arr[i];
+            bmax = b_arr[j];
+            if (amax < bmax)
+            {
+                *o_arr++ = amax;
+            }
+            i += (amax <= bmax);
+            j += (bmax <= amax);
+        }
+    }
+    memcpy(o_arr, a_arr + i, (size_t)((a_nitems - i) * sizeof(uint64_t)));
+    return (o_arr + (a_nitems - i));
+}
+
+/**
+ * Returns the symmetric difference of two sorted sets (uint64_t arrays in ascending order without duplicates):
+ * the elements that are in only one of the two sets.
+ * When one set is at least SET_GALLOP_RATIO times larger than the other,
+ * the runs of the larger set between the elements of the smaller one are located with a galloping search and copied in bulk,
+ * otherwise a branch-free merge is used.
+ *
+ * @param a_arr    Pointer to the first element of the first set.
+ * @param a_nitems Number of elements in the first set.
+ * @param b_arr    Pointer to the first element of the second set.
+ * @param b_nitems Number of elements in the second set.
+ * @param o_arr    Pointer to the first element of the output array (at least a_nitems + b_nitems elements).
+ *
+ * @return Pointer to the end of the output array.
+ */
+static inline uint64_t *symmetric_difference_set_uint64_t(const uint64_t *a_arr, uint64_t a_nitems, const uint64_t *b_arr, uint64_t b_nitems, uint64_t *o_arr)
+{
+    uint64_t i = 0, j = 0, p, x, y;
+    if ((a_nitems / SET_GALLOP_RATIO) > b_nitems)
+    {
+        return symmetric_difference_set_uint64_t(b_arr, b_nitems, a_arr, a_nitems, o_arr);
+    }
+    if ((b_nitems / SET_GALLOP_RATIO) > a_nitems)
+    {
+        for (i = 0; i < a_nitems; i++)
+        {
+            p = j + gallop_uint64_t(b_arr + j, b_nitems - j, a_arr[i]);
+            memcpy(o_arr, b_arr + j, (size_t)((p - j) * sizeof(uint64_t)));
+            o_arr += (p - j);
+            if ((p < b_nitems) && (b_arr[p] == a_arr[i]))
+            {
+                j = p + 1;
+                continue;
+            }
+            *o_arr++ = a_arr[i];
+            j = p;
+        }
+    }
+    else
+    {
+        while ((i < a_nitems) && (j < b_nitems))
+        {
+            x = a_arr[i];
+            y = b_arr[j];
+            *o_arr = (x < y) ? x : y;
+            o_arr += (x != y);
+            i += (x <= y);
+            j += (y <= x);
+        }
+        memcpy(o_arr, a_arr + i, (size_t)((a_nitems - i) * sizeof(uint64_t)));
+        o_arr += (a_nitems - i);
+    }
+    memcpy(o_arr, b_arr + j, (size_t)((b_nitems - j) * sizeof(uint64_t)));
+    return (o_arr + (b_nitems - j));
+}
+
+#define KWAY_TREE_MIN  0 //!< Rank of the virtual array used during the loser tree initialization.
+#define KWAY_TREE_LIVE 1 //!< Rank of an array with remaining elements.
+#define KWAY_TREE_DONE 2 //!< Rank of an exhausted array.
+
+/**
+ * Node of the k-way loser tree: the head value of an array is stored in the node to avoid indirect loads.
+ */
+typedef struct kway_node_t
+{
+    uint64_t key;  //!< Current head value of the array (maximum value when exhausted).
+    uint32_t src;  //!< Index of the array.
+    uint32_t rank; //!< Rank used to break ties between equal keys (KWAY_TREE_MIN, KWAY_TREE_LIVE or KWAY_TREE_DONE).
+} kway_node_t;
+
+/**
+ * Loser (tournament) tree over the heads of k sorted arrays.
+ */
+typedef struct kway_tree_t
+{
+    const uint64_t **arr;   //!< Arrays to merge.
+    const uint64_t *nitems; //!< Number of elements of each array.
+    uint64_t *pos;          //!< Position of the current head of each array.
+    kway_node_t *ls;        //!< Tree nodes: ls[1..k-1] are the losers.
+    kway_node_t win;        //!< Current winner (minimum head).
+    uint32_t k;             //!< Number of arrays.
+} kway_tree_t;
+
+/**
+ * Returns true if the node a is greater than the node b.
+ */
+static inline int kway_node_gt(const kway_node_t *a, const kway_node_t *b)
+{
+    return ((a->key > b->key) | ((a->key == b->key) & (a->rank > b->rank)));
+}
+
+/**
+ * Load the current head of the array s into the winner node and replay the matches on the path to the root.
+ */
+static inline void kway_tree_push(kway_tree_t *kt, uint32_t s)
+{
+    kway_node_t w, x;
+    uint32_t t;
+    int g;
+    w.src = s;
+    w.key = 0xFFFFFFFFFFFFFFFF;
+    w.rank = KWAY_TREE_DONE;
+    if (kt->pos[s] < kt->nitems[s])
+    {
+        w.key = kt->arr[s][kt->pos[s]];
+        w.rank = KWAY_TREE_LIVE;
+    }
+    for (t = (s + kt->k) / 2; t > 0; t /= 2)
+    {
+        x = kt->ls[t];
+        g = kway_node_gt(&w, &x);
+        kt->ls[t] = g ? w : x;
+        w = g ? x : w;
+    }
+    kt->win = w;
+}
+
+/**
+ * Allocate and initialize a loser tree over k sorted arrays.
+ *
+ * @return 0 on success, -1 on memory allocation failure.
+ */
+static inline int kway_tree_init(kway_tree_t *kt, const uint64_t **arr, const uint64_t *nitems, uint32_t k)
+{
+    kt->ls = (kway_node_t *)malloc((size_t)k * sizeof(kway_node_t));
+    kt->pos = (uint64_t *)calloc(k, sizeof(uint64_t));
+    if ((kt->ls == NULL) || (kt->pos == NULL))
+    {
+        free(kt->ls);
+        free(kt->pos);
+        return -1;
+    }
+    kt->arr = arr;
+    kt->nitems = nitems;
+    kt->k = k;
+    // all the nodes (and the winner slot) start with a virtual minimum key that is replaced by the real arrays
+    kway_node_t vmin;
+    vmin.key = 0;
+    vmin.src = k;
+    vmin.rank = KWAY_TREE_MIN;
+    kt->win = vmin;
+    uint32_t s;
+    for (s = 0; s < k; s++)
+    {
+        kt->ls[s] = vmin;
+    }
+    for (s = k; s > 0; s--)
+    {
+        kway_tree_push(kt, s - 1);
+    }
+    return 0;
+}
+
+/**
+ * Free the memory allocated by kway_tree_init.
+ */
+static inline void kway_tree_free(kway_tree_t *kt)
+{
+    free(kt->ls);
+    free(kt->pos);
+}
+
+/**
+ * Returns the distinct values contained in at least mincount of nsets sorted sets,
+ * and optionally the number of sets containing each value, with a single k-way merge pass over a loser (tournament) tree.
+ * Each set must be sorted in ascending order and contain no duplicates.
+ * This is the generalization of kway_union_uint64_t (mincount = 1) and kway_intersection_uint64_t (mincount = nsets).
+ *
+ * @param arr      Array of pointers to the first element of each set.
+ * @param nitems   Number of elements of each set.
+ * @param nsets    Number of sets.
+ * @param mincount Minimum number of sets that must contain a value to be returned.
+ * @param o_arr    Pointer to the first element of the output array (at least the sum of nitems elements).
+ * @param o_cnt    Pointer to the first element of the output array of counts (same size of o_arr), or NULL if not required.
+ *
+ * @return Number of elements in the output array or KWAY_NOMEM on memory allocation failure.
+ */
+static inline uint64_t kway_count_uint64_t(const uint64_t **arr, const uint64_t *nitems, uint32_t nsets, uint32_t mincount, uint64_t *o_arr, uint32_t *o_cnt)
+{
+    if (nsets == 0)
+    {
+        return 0;
+    }
+    kway_tree_t kt;
+    if (kway_tree_init(&kt, arr, nitems, nsets) != 0)
+    {
+        return KWAY_NOMEM;
+    }
+    uint64_t n = 0, v, last = 0;
+    uint32_t s, cnt = 0;
+    while (kt.win.rank != KWAY_TREE_DONE)
+    {
+        v = kt.win.key;
+        if ((cnt > 0) && (v == last))
+        {
+            ++cnt;
+        }
+        else
+        {
+            if ((cnt > 0) && (cnt >= mincount))
+            {
+                if (o_cnt != NULL)
+                {
+                    o_cnt[n] = cnt;
+                }
+                o_arr[n++] = last;
+            }
+            last = v;
+            cnt = 1;
+        }
+        s = kt.win.src;
+        kt.pos[s]++;
+        kway_tree_push(&kt, s);
+    }
+    if ((cnt > 0) && (cnt >= mincount))
+    {
+        if (o_cnt != NULL)
+        {
+            o_cnt[n] = cnt;
+        }
+        o_arr[n++] = last;
+    }
+    kway_tree_free(&kt);
+    return n;
+}
+
+/**
+ * Returns the union of nsets sorted sets with a single k-way merge pass.
+ * Each set must be sorted in ascending order and contain no duplicates.
+ *
+ * @param arr      Array of pointers to the first element of each set.
+ * @param nitems   Number of elements of each set.
+ * @param nsets    Number of sets.
+ * @param o_arr    Pointer to the first element of the output array (at least the sum of nitems elements).
+ *
+ * @return Number of elements in the output array or KWAY_NOMEM on memory allocation failure.
+ */
+static inline uint64_t kway_union_uint64_t(const uint64_t **arr, const uint64_t *nitems, uint32_t nsets, uint64_t *o_arr)
+{
+    return kway_count_uint64_t(arr, nitems, nsets, 1, o_arr, NULL);
+}
+
+/**
+ * Returns the intersection of nsets sorted sets.
+ * Each set must be sorted in ascending order and contain no duplicates.
+ * The sets are intersected in a single pass by leapfrogging: each set in turn is advanced with a galloping search
+ * to the current candidate value, so the cost is driven by the smallest set.
+ *
+ * @param arr      Array of pointers to the first element of each set.
+ * @param nitems   Number of elements of each set.
+ * @param nsets    Number of sets.
+ * @param o_arr    Pointer to the first element of the output array (at least as many elements as the smallest set).
+ *
+ * @return Number of elements in the output array or KWAY_NOMEM on memory allocation failure.
+ */
+static inline uint64_t kway_intersection_uint64_t(const uint64_t **arr, const uint64_t *nitems, uint32_t nsets, uint64_t *o_arr)
+{
+    uint64_t n = 0, p, v;
+    uint32_t s, matched = 0;
+    if (nsets == 0)
+    {
+        return 0;
+    }
+    for (s = 0; s < nsets; s++)
+    {
+        if (nitems[s] == 0)
+        {
+            return 0;
+        }
+    }
+    if (nsets == 1)
+    {
+        memcpy(o_arr, arr[0], (size_t)(nitems[0] * sizeof(uint64_t)));
+        return nitems[0];
+    }
+    // current position in each set (on the stack for a small number of sets)
+    uint64_t pos[64] = {0};
+    uint64_t *ppos = (nsets <= 64) ? pos : (uint64_t *)calloc(nsets, sizeof(uint64_t));
+    if (ppos == NULL)
+    {
+        return KWAY_NOMEM;
+    }
+    v = arr[0][0];
+    for (s = 0;;)
+    {
+        p = ppos[s] + gallop_uint64_t(arr[s] + ppos[s], nitems[s] - ppos[s], v);
+        if (p == nitems[s])
+        {
+            break;
+        }
+        ppos[s] = p;
+        if (arr[s][p] == v)
+        {
+            if (++matched == nsets)
+            {
+                o_arr[n++] = v;
+                if (++ppos[s] == nitems[s])
+                {
+                    break;
+                }
+                v = arr[s][ppos[s]];
+                matched = 1;
+            }
+        }
+        else
+        {
+            v = arr[s][p];
+            matched = 1;
+        }
+        if (++s == nsets)
+        {
+            s = 0;
+        }
+    }
+    if (ppos != pos)
+    {
+        free(ppos);
+    }
+    return n;
+}
+
+#define KWAY_OP_COUNT        0 //!< Parallel k-way operation: kway_count_uint64_t.
+#define KWAY_OP_INTERSECTION 1 //!< Parallel k-way operation: kway_intersection_uint64_t.
+#define KWAY_NPARTS (1 << (64 - KWAY_PARTITION_SHIFT)) //!< Number of partitions of the parallel k-way functions.
+
+/**
+ * Shared state of the parallel k-way functions.
+ */
+typedef struct kway_parallel_t
+{
+    const uint64_t **arr;          //!< Sets.
+    const uint64_t *nitems;        //!< Number of elements of each set.
+    uint32_t nsets;                //!< Number of sets.
+    uint32_t mincount;             //!< Minimum count (KWAY_OP_COUNT).
+    uint8_t op;                    //!< Operation (KWAY_OP_*).
+    uint8_t phase;                 //!< 0 = compute the output bounds, 1 = merge.
+    uint64_t *o_arr;               //!< Output values.
+    uint32_t *o_cnt;               //!< Output counts (can be NULL).
+    uint64_t offset[KWAY_NPARTS];  //!< Output offset of each partition (phase 0: output bound).
+    uint64_t count[KWAY_NPARTS];   //!< Number of output elements of each partition.
+    uint32_t next;                 //!< Next partition to process.
+    int err;                       //!< Error flag.
+    pthread_mutex_t lock;          //!< Lock for the partition queue.
+} kway_parallel_t;
+
+/**
+ * Thread worker of the parallel k-way functions: process the partitions until the queue is empty.
+ */
+static inline void *kway_parallel_worker(void *arg)
+{
+    kway_parallel_t *kp = (kway_parallel_t *)arg;
+    const uint64_t **sub = (const uint64_t **)malloc(kp->nsets * sizeof(uint64_t *));
+    uint64_t *subn = (uint64_t *)malloc(kp->nsets * sizeof(uint64_t));
+    uint64_t lo, hi, bound, n;
+    uint32_t p, s, nsub;
+    if ((sub == NULL) || (subn == NULL))
+    {
+        pthread_mutex_lock(&kp->lock);
+        kp->err = 1;
+        pthread_mutex_unlock(&kp->lock);
+    }
+    for (;;)
+    {
+        pthread_mutex_lock(&kp->lock);
+        p = kp->next++;
+        if (kp->err)
+        {
+            p = KWAY_NPARTS;
+        }
+        pthread_mutex_unlock(&kp->lock);
+        if (p >= KWAY_NPARTS)
+        {
+            break;
+        }
+        // locate the partition in each set
+        bound = (kp->op == KWAY_OP_INTERSECTION) ? KWAY_NOMEM : 0;
+        for (nsub = 0, s = 0; s < kp->nsets; s++)
+        {
+            lo = (p == 0) ? 0 : gallop_uint64_t(kp->arr[s], kp->nitems[s], ((uint64_t)p << KWAY_PARTITION_SHIFT));
+            hi = (p == (KWAY_NPARTS - 1)) ? kp->nitems[s] : (lo + gallop_uint64_t(kp->arr[s] + lo, kp->nitems[s] - lo, ((uint64_t)(p + 1) << KWAY_PARTITION_SHIFT)));
+            if (kp->op == KWAY_OP_INTERSECTION)
+            {
+                bound = ((hi - lo) < bound) ? (hi - lo) : bound;
+            }
+            else
+            {
+                bound += (hi - lo);
+            }
+            if (hi > lo)
+            {
+                sub[nsub] = kp->arr[s] + lo;
+                subn[nsub] = hi - lo;
+                nsub++;
+            }
+        }
+        if (kp->phase == 0)
+        {
+            kp->offset[p] = bound;
+            continue;
+        }
+        if (kp->op == KWAY_OP_INTERSECTION)
+        {
+            n = (nsub < kp->nsets) ? 0 : kway_intersection_uint64_t(sub, subn, nsub, kp->o_arr + kp->offset[p]);
+        }
+        else
+        {
+            n = kway_count_uint64_t(sub, subn, nsub, kp->mincount, kp->o_arr + kp->offset[p], (kp->o_cnt == NULL) ? NULL : (kp->o_cnt + kp->offset[p]));
+        }
+        if (n == KWAY_NOMEM)
+        {
+            pthread_mutex_lock(&kp->lock);
+            kp->err = 1;
+            pthread_mutex_unlock(&kp->lock);
+            n = 0;
+        }
+        kp->count[p] = n;
+    }
+    free((void *)sub);
+    free(subn);
+    return NULL;
+}
+
+/**
+ * Run the parallel k-way workers on nthreads threads (the calling thread included).
+ */
+static inline void kway_parallel_run(kway_parallel_t *kp, uint32_t nthreads)
+{
+    pthread_t tid[PARALLEL_SORT_MAXTHREADS];
+    uint8_t started[PARALLEL_SORT_MAXTHREADS];
+    uint32_t t;
+    kp->next = 0;
+    for (t = 1; t < nthreads; t++)
+    {
+        started[t] = (pthread_create(&tid[t], NULL, kway_parallel_worker, kp) == 0);
+    }
+    kway_parallel_worker(kp);
+    for (t = 1; t < nthreads; t++)
+    {
+        if (started[t])
+        {
+            pthread_join(tid[t], NULL);
+        }
+    }
+}
+
+/**
+ * Parallel k-way operation: the sets are split in KWAY_NPARTS partitions on the most significant byte,
+ * the partitions are processed independently by nthreads threads and the results are compacted.
+ */
+static inline uint64_t kway_parallel_uint64_t(uint8_t op, const uint64_t **arr, const uint64_t *nitems, uint32_t nsets, uint32_t mincount, uint64_t *o_arr, uint32_t *o_cnt, uint32_t nthreads)
+{
+    if (nsets == 0)
+    {
+        return 0;
+    }
+    kway_parallel_t *kp = (kway_parallel_t *)malloc(sizeof(kway_parallel_t));
+    if (kp == NULL)
+    {
+        return KWAY_NOMEM;
+    }
+    kp->arr = arr;
+    kp->nitems = nitems;
+    kp->nsets = nsets;
+    kp->mincount = mincount;
+    kp->op = op;
+    kp->o_arr = o_arr;
+    kp->o_cnt = o_cnt;
+    kp->err = 0;
+    pthread_mutex_init(&kp->lock, NULL);
+    if (nthreads > PARALLEL_SORT_MAXTHREADS)
+    {
+        nthreads = PARALLEL_SORT_MAXTHREADS;
+    }
+    if (nthreads == 0)
+    {
+        nthreads = 1;
+    }
+    // phase 0: output bound of each partition, so each partition writes to its own region of the output
+    kp->phase = 0;
+    kway_parallel_run(kp, nthreads);
+    uint64_t sum = 0, b;
+    uint32_t p;
+    for (p = 0; p < KWAY_NPARTS; p++)
+    {
+        b = kp->offset[p];
+        kp->offset[p] = sum;
+        sum += b;
+    }
+    kp->phase = 1;
+    kway_parallel_run(kp, nthreads);
+    // compact the partition results
+    uint64_t n = 0;
+    for (p = 0; p < KWAY_NPARTS; p++)
+    {
+        if ((kp->count[p] > 0) && (kp->offset[p] != n))
+        {
+            memmove(o_arr + n, o_arr + kp->offset[p], (size_t)(kp->count[p] * sizeof(uint64_t)));
+            if (o_cnt != NULL)
+            {
+                memmove(o_cnt + n, o_cnt + kp->offset[p], (size_t)(kp->count[p] * sizeof(uint32_t)));
+            }
+        }
+        n += kp->count[p];
+    }
+    if (kp->err)
+    {
+        n = KWAY_NOMEM;
+    }
+    pthread_mutex_destroy(&kp->lock);
+    free(kp);
+    return n;
+}
+
+/**
+ * Parallel version of kway_count_uint64_t.
+ * The sets are split in 256 partitions on the most significant byte (the VariantKey CHROM byte)
+ * that are processed independently by up to nthreads threads.
+ *
+ * @param arr      Array of pointers to the first element of each set.
+ * @param nitems   Number of elements of each set.
+ * @param nsets    Number of sets.
+ * @param mincount Minimum number of sets that must contain a value to be returned.
+ * @param o_arr    Pointer to the first element of the output array (at least the sum of nitems elements).
+ * @param o_cnt    Pointer to the first element of the output array of counts (same size of o_arr), or NULL if not required.
+ * @param nthreads Number of threads.
+ *
+ * @return Number of elements in the output array or KWAY_NOMEM on memory allocation failure.
+ */
+static inline uint64_t parallel_kway_count_uint64_t(const uint64_t **arr, const uint64_t *nitems, uint32_t nsets, uint32_t mincount, uint64_t *o_arr, uint32_t *o_cnt, uint32_t nthreads)
+{
+    return kway_parallel_uint64_t(KWAY_OP_COUNT, arr, nitems, nsets, mincount, o_arr, o_cnt, nthreads);
+}
+
+/**
+ * Parallel version of kway_union_uint64_t.
+ * The sets are split in 256 partitions on the most significant byte (the VariantKey CHROM byte)
+ * that are processed independently by up to nthreads threads.
+ *
+ * @param arr      Array of pointers to the first element of each set.
+ * @param nitems   Number of elements of each set.
+ * @param nsets    Number of sets.
+ * @param o_arr    Pointer to the first element of the output array (at least the sum of nitems elements).
+ * @param nthreads Number of threads.
+ *
+ * @return Number of elements in the output array or KWAY_NOMEM on memory allocation failure.
+ */
+static inline uint64_t parallel_kway_union_uint64_t(const uint64_t **arr, const uint64_t *nitems, uint32_t nsets, uint64_t *o_arr, uint32_t nthreads)
+{
+    return kway_parallel_uint64_t(KWAY_OP_COUNT, arr, nitems, nsets, 1, o_arr, NULL, nthreads);
+}
+
+/**
+ * Parallel version of kway_intersection_uint64_t.
+ * The sets are split in 256 partitions on the most significant byte (the VariantKey CHROM byte)
+ * that are processed independently by up to nthreads threads.
+ *
+ * @param arr      Array of pointers to the first element of each set.
+ * @param nitems   Number of elements of each set.
+ * @param nsets    Number of sets.
+ * @param o_arr    Pointer to the first element of the output array (at least as many elements as the smallest set).
+ * @param nthreads Number of threads.
+ *
+ * @return Number of elements in the output array or KWAY_NOMEM on memory allocation failure.
+ */
+static inline uint64_t parallel_kway_intersection_uint64_t(const uint64_t **arr, const uint64_t *nitems, uint32_t nsets, uint64_t *o_arr, uint32_t nthreads)
+{
+    return kway_parallel_uint64_t(KWAY_OP_INTERSECTION, arr, nitems, nsets, 0, o_arr, NULL, nthreads);
+}
+
 #endif  // VARIANTKEY_SET_H
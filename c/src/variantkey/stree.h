@@ -0,0 +1,254 @@
+// VariantKey
+//
+// stree.h
+//
+// @category   Libraries
+// @author     Nicola Asuni <nicola.asuni@genomicsplc.com>
+// @copyright  2017-2018 GENOMICS plc
+// @license    MIT (see LICENSE)
+// @link       https://github.com/genomicsplc/variantkey
+//
+// LICENSE
+//
+// Copyright (c) 2017-2018 GENOMICS plc
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+/**
+ * @file stree.h
+ * @brief Static B+tree (S-tree) index for sorted binary columns.
+ *
+ * The functions provided here build and search a compact companion index for a
+ * column of unsigned integers sorted in ascending order (e.g. the first column of a BINSRC1 file).
+ *
+ * The index contains the separator keys of a static B+tree with STREE_NODE_KEYS keys per node.
+ * The column itself is used as leaf level, so the tree only adds about 1/(STREE_NODE_KEYS - 1)
+ * of the column size, and the search returns row numbers of the original column.
+ * The upper levels are stored contiguously from the root down, so a lookup touches
+ * one node per level (log_STREE_NODE_KEYS(nrows) cache lines) instead of the
+ * log_2(nrows) scattered memory accesses of the plain binary search.
+ *
+ * The index can be saved as a single-column BINSRC1 file and memory-mapped with mmap_binfile().
+ * The index layout only depends on the number of rows of the source column.
+ */
+
+#ifndef VARIANTKEY_STREE_H
+#define VARIANTKEY_STREE_H
+
+#include "binsearch.h"
+
+#ifndef STREE_NODE_KEYS
+#define STREE_NODE_KEYS 16 //!< Number of keys in each tree node.
+#endif
+
+#define STREE_MAXLEVELS 24 //!< Maximum number of index levels (STREE_NODE_KEYS^STREE_MAXLEVELS >= 2^64).
+
+/**
+ * Struct containing the geometry of an S-tree index.
+ * Level 0 is the indexed column, levels 1 to nlevels are stored in the index, with the root at level nlevels.
+ */
+typedef struct stree_t
+{
+    uint64_t nrows;                     //!< Number of rows in the indexed column.
+    uint64_t nitems;                    //!< Total number of items in the index.
+    uint64_t size[STREE_MAXLEVELS];     //!< Number of keys at each level (level 0 is the column).
+    uint64_t offset[STREE_MAXLEVELS];   //!< Position of the first item of each level in the index.
+    uint8_t nlevels;                    //!< Number of index levels.
+} stree_t;
+
+/**
+ * Compute the S-tree geometry for a column with the specified number of rows.
+ *
+ * @param nrows Number of rows in the indexed column.
+ * @param st    Structure to be populated with the tree geometry.
+ *
+ * @return Number of items in the index (size of the index array to allocate).
+ */
+static inline uint64_t stree_layout(uint64_t nrows, stree_t *st)
+{
+    uint64_t n = nrows;
+    uint8_t l = 0;
+    st->nrows = nrows;
+    st->size[0] = nrows;
+    st->offset[0] = 0;
+    while (n > STREE_NODE_KEYS)
+    {
+        n = (n + STREE_NODE_KEYS - 1) / STREE_NODE_KEYS;
+        st->size[++l] = n;
+    }
+    st->nlevels = l;
+    st->nitems = 0;
+    for (; l > 0; l--)
+    {
+        st->offset[l] = st->nitems;
+        st->nitems += (st->size[l] + STREE_NODE_KEYS - 1) / STREE_NODE_KEYS * STREE_NODE_KEYS; // full nodes
+    }
+    return st->nitems;
+}
+
+/**
+ * Add to r the number of keys in a node that are less than the search value.
+ */
+#define STREE_NODE_RANK(node, num, search) \
+    for (i = 0; i < (num); i++) \
+    { \
+        r += ((node)[i] < (search)); \
+    }
+
+/**
+ * Generic function to build, save and search S-tree indexes.
+ *
+ * @param T Unsigned integer type, one of: uint8_t, uint16_t, uint32_t, uint64_t
+ */
+#define define_stree(T) \
+/** Build the S-tree index for a sorted column.
+@param src      Column values sorted in ascending order.
+@param st       Tree geometry as returned by stree_layout().
+@param idx      Index array with at least st->nitems elements.
+*/ \
+static inline void build_stree_##T(const T *src, const stree_t *st, T *idx) \
+{ \
+    uint64_t j, k, prevsize; \
+    const T *prev = src; \
+    T *cur; \
+    uint8_t l; \
+    for (l = 1; l <= st->nlevels; l++) \
+    { \
+        cur = idx + st->offset[l]; \
+        prevsize = st->size[(l - 1)]; \
+        for (j = 0; j < st->size[l]; j++) \
+        { \
+            k = (j * STREE_NODE_KEYS) + (STREE_NODE_KEYS - 1); \
+            cur[j] = prev[((k < prevsize) ? k : (prevsize - 1))]; /* max of the child node */ \
+        } \
+        for (; (j % STREE_NODE_KEYS) != 0; j++) \
+        { \
+            cur[j] = (T)(~(T)0); /* padding */ \
+        } \
+        prev = cur; \
+    } \
+} \
+/** Returns the position of the first column item that is not less than the search value.
+@param src      Column values sorted in ascending order.
+@param idx      S-tree index of the column.
+@param st       Tree geometry as returned by stree_layout().
+@param search   Unsigned number to search (type T).
+@return Item number or st->nrows if all items are less than the search value.
+*/ \
+static inline uint64_t stree_lower_bound_##T(const T *src, const T *idx, const stree_t *st, T search) \
+{ \
+    uint64_t r = 0, p = 0, i, n; \
+    uint8_t l = st->nlevels; \
+    if (l > 0) \
+    { \
+        STREE_NODE_RANK((idx + st->offset[l]), STREE_NODE_KEYS, search) \
+        if (r >= st->size[l]) \
+        { \
+            return st->nrows; \
+        } \
+        for (l--; l > 0; l--) \
+        { \
+            p = r * STREE_NODE_KEYS; \
+            r = p; \
+            STREE_NODE_RANK((idx + st->offset[l] + p), STREE_NODE_KEYS, search) \
+        } \
+        p = r * STREE_NODE_KEYS; \
+        r = p; \
+    } \
+    n = st->nrows - p; \
+    STREE_NODE_RANK((src + p), ((n < STREE_NODE_KEYS) ? n : STREE_NODE_KEYS), search) \
+    return r; \
+} \
+/** Search for the first occurrence of an unsigned integer using the S-tree index.
+@param src      Column values sorted in ascending order.
+@param idx      S-tree index of the column.
+@param st       Tree geometry as returned by stree_layout().
+@param search   Unsigned number to search (type T).
+@return Item number if found or st->nrows if not found (same as col_find_first over the full column).
+*/ \
+static inline uint64_t stree_find_first_##T(const T *src, const T *idx, const stree_t *st, T search) \
+{ \
+    uint64_t pos = stree_lower_bound_##T(src, idx, st, search); \
+    if ((pos < st->nrows) && (src[pos] == search)) \
+    { \
+        return pos; \
+    } \
+    return st->nrows; \
+} \
+/** Search for the last occurrence of an unsigned integer using the S-tree index.
+@param src      Column values sorted in ascending order.
+@param idx      S-tree index of the column.
+@param st       Tree geometry as returned by stree_layout().
+@param search   Unsigned number to search (type T).
+@return Item number if found or st->nrows if not found (same as col_find_last over the full column).
+*/ \
+static inline uint64_t stree_find_last_##T(const T *src, const T *idx, const stree_t *st, T search) \
+{ \
+    uint64_t pos = st->nrows; \
+    if (search != (T)(~(T)0)) \
+    { \
+        pos = stree_lower_bound_##T(src, idx, st, (T)(search + 1)); \
+    } \
+    if ((pos > 0) && (src[(pos - 1)] == search)) \
+    { \
+        return (pos - 1); \
+    } \
+    return st->nrows; \
+} \
+/** Save the S-tree index as a single-column BINSRC1 file.
+@param file     Path of the output file.
+@param idx      S-tree index.
+@param st       Tree geometry as returned by stree_layout().
+@return Number of bytes written or 0 in case of error.
+*/ \
+static inline size_t save_stree_##T(const char *file, const T *idx, const stree_t *st) \
+{ \
+    return save_binsrc1_col(file, idx, (uint8_t)sizeof(T), st->nitems); \
+}
+
+define_stree(uint8_t)
+define_stree(uint16_t)
+define_stree(uint32_t)
+define_stree(uint64_t)
+
+/**
+ * Memory map an S-tree index file and check that it matches the specified geometry.
+ *
+ * @param file  Path to the index file generated by save_stree_*().
+ * @param nrows Number of rows in the indexed column.
+ * @param mf    Structure containing the memory mapped file.
+ * @param st    Structure to be populated with the tree geometry.
+ *
+ * @return Pointer to the index items or NULL in case of error.
+ */
+static inline const uint8_t *mmap_stree_file(const char *file, uint64_t nrows, mmfile_t *mf, stree_t *st)
+{
+    mmap_binfile(file, mf);
+    if ((mf->fd < 0) || (mf->size == 0) || (mf->src == MAP_FAILED) || (mf->ncols != 1))
+    {
+        return NULL;
+    }
+    if (stree_layout(nrows, st) != mf->nrows)
+    {
+        return NULL;
+    }
+    return (const uint8_t *)(mf->src + mf->index[0]);
+}
+
+#endif  // VARIANTKEY_STREE_H
@@ -46,8 +46,20 @@
 #include <inttypes.h>
 #include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "hex.h"
 
+#if defined(__AVX2__) || defined(__SSSE3__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define HASH32_LANES 8 //!< Number of strings hashed in parallel by hash32_cols.
+#else
+#define HASH32_LANES 4 //!< Number of strings hashed in parallel by hash32_cols.
+#endif
+
 #define VKMASK_CHROM    0xF800000000000000  //!< VariantKey binary mask for CHROM     [ 11111000 00000000 00000000 00000000 00000000 00000000 00000000 00000000 ]
 #define VKMASK_POS      0x07FFFFFF80000000  //!< VariantKey binary mask for POS       [ 00000111 11111111 11111111 11111111 10000000 00000000 00000000 00000000 ]
 #define VKMASK_CHROMPOS 0xFFFFFFFF80000000  //!< VariantKey binary mask for CHROM+POS [ 11111111 11111111 11111111 11111111 10000000 00000000 00000000 00000000 ]
@@ -76,6 +88,80 @@ typedef struct vkrange_t
     uint64_t max; //!< Maximum VariantKey value for any given REF+ALT encoding
 } vkrange_t;
 
+/**
+ * Struct containing the columnar input for the batch VariantKey encoder.
+ * The REF and ALT alleles are stored as concatenated strings (without separators or terminating null bytes),
+ * and each allele is identified by a byte offset and a length.
+ */
+typedef struct variantkey_cols_t
+{
+    const uint8_t *chrom;      //!< Pointer to the encoded CHROM column (see encode_chrom).
+    const uint32_t *pos;       //!< Pointer to the POS column, with the first base having position 0.
+    const char *ref;           //!< Pointer to the buffer containing the concatenated REF alleles.
+    const uint64_t *refoffset; //!< Pointer to the column containing the offset of each REF allele in the ref buffer.
+    const uint32_t *sizeref;   //!< Pointer to the column containing the length of each REF allele.
+    const char *alt;           //!< Pointer to the buffer containing the concatenated ALT alleles.
+    const uint64_t *altoffset; //!< Pointer to the column containing the offset of each ALT allele in the alt buffer.
+    const uint32_t *sizealt;   //!< Pointer to the column containing the length of each ALT allele.
+    uint64_t refbufsize;       //!< Size in bytes of the ref buffer.
+    uint64_t altbufsize;       //!< Size in bytes of the alt buffer.
+    uint64_t nrows;            //!< Number of rows.
+} variantkey_cols_t;
+
+/**
+ * Reusable buffer for the variable-length alleles returned by the *_arena functions
+ * (see normalize_variant_arena and reverse_variantkey_arena).
+ * The buffer grows on demand and it is never shrunk, so no memory is allocated once it is large enough.
+ * An arena must not be shared between threads: each thread should use its own arena,
+ * initialized to {0} and released with allele_arena_free.
+ */
+typedef struct allele_arena_t
+{
+    char *buf;   //!< Buffer.
+    size_t size; //!< Size of the buffer in bytes.
+} allele_arena_t;
+
+/**
+ * Make sure that the arena buffer is at least size bytes long.
+ * Any data previously stored in the arena may be moved.
+ *
+ * @param arena  Allele arena.
+ * @param size   Required size in bytes.
+ *
+ * @return Pointer to the arena buffer or NULL if the memory can't be allocated.
+ */
+static inline char *allele_arena_reserve(allele_arena_t *arena, size_t size)
+{
+    if (size > arena->size)
+    {
+        size_t newsize = (arena->size > 0) ? arena->size : 64;
+        while (newsize < size)
+        {
+            newsize *= 2;
+        }
+        char *buf = (char *)realloc(arena->buf, newsize);
+        if (buf == NULL)
+        {
+            return NULL;
+        }
+        arena->buf = buf;
+        arena->size = newsize;
+    }
+    return arena->buf;
+}
+
+/**
+ * Release the memory used by the arena.
+ *
+ * @param arena  Allele arena.
+ */
+static inline void allele_arena_free(allele_arena_t *arena)
+{
+    free(arena->buf);
+    arena->buf = NULL;
+    arena->size = 0;
+}
+
 /** @brief Returns chromosome numerical encoding.
  *
  * @param chrom  Chromosome. An identifier from the reference genome, no white-space permitted.
@@ -289,10 +375,11 @@ static inline uint32_t hash32(const char *str, size_t size)
     return h;
 }
 
-static inline uint32_t encode_refalt_hash(const char *ref, size_t sizeref, const char *alt, size_t sizealt)
+// Mix the REF and ALT hashes into the final non-reversible REF+ALT code
+static inline uint32_t finalize_refalt_hash(uint32_t href, uint32_t halt)
 {
     // 0x3 is the separator character between REF and ALT [00000000 00000000 00000000 00000011]
-    uint32_t h = muxhash(hash32(alt, sizealt), muxhash(0x3, hash32(ref, sizeref)));
+    uint32_t h = muxhash(halt, muxhash(0x3, href));
     // MurmurHash3 finalization mix - force all bits of a hash block to avalanche
     h ^= h >> 16;
     h *= 0x85ebca6b;
@@ -302,6 +389,259 @@ static inline uint32_t encode_refalt_hash(const char *ref, size_t sizeref, const
     return ((h >> 1) | 0x1); // 0x1 is the set bit to indicate HASH mode [00000000 00000000 00000000 00000001]
 }
 
+static inline uint32_t encode_refalt_hash(const char *ref, size_t sizeref, const char *alt, size_t sizealt)
+{
+    return finalize_refalt_hash(hash32(ref, sizeref), hash32(alt, sizealt));
+}
+
+// Apply muxhash to HASH32_LANES independent (k, h) pairs at once
+static inline void muxhash_lanes(const uint32_t *k, uint32_t *h)
+{
+#if defined(__AVX2__)
+    __m256i vk = _mm256_loadu_si256((const __m256i *)k);
+    __m256i vh = _mm256_loadu_si256((const __m256i *)h);
+    vk = _mm256_mullo_epi32(vk, _mm256_set1_epi32((int)0xcc9e2d51));
+    vk = _mm256_or_si256(_mm256_srli_epi32(vk, 17), _mm256_slli_epi32(vk, 15));
+    vk = _mm256_mullo_epi32(vk, _mm256_set1_epi32(0x1b873593));
+    vh = _mm256_xor_si256(vh, vk);
+    vh = _mm256_or_si256(_mm256_srli_epi32(vh, 19), _mm256_slli_epi32(vh, 13));
+    vh = _mm256_add_epi32(_mm256_add_epi32(_mm256_slli_epi32(vh, 2), vh), _mm256_set1_epi32((int)0xe6546b64));
+    _mm256_storeu_si256((__m256i *)h, vh);
+#elif defined(__SSE4_1__)
+    __m128i vk = _mm_loadu_si128((const __m128i *)k);
+    __m128i vh = _mm_loadu_si128((const __m128i *)h);
+    vk = _mm_mullo_epi32(vk, _mm_set1_epi32((int)0xcc9e2d51));
+    vk = _mm_or_si128(_mm_srli_epi32(vk, 17), _mm_slli_epi32(vk, 15));
+    vk = _mm_mullo_epi32(vk, _mm_set1_epi32(0x1b873593));
+    vh = _mm_xor_si128(vh, vk);
+    vh = _mm_or_si128(_mm_srli_epi32(vh, 19), _mm_slli_epi32(vh, 13));
+    vh = _mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(vh, 2), vh), _mm_set1_epi32((int)0xe6546b64));
+    _mm_storeu_si128((__m128i *)h, vh);
+#else
+    int l;
+    for (l = 0; l < HASH32_LANES; l++)
+    {
+        h[l] = muxhash(k[l], h[l]);
+    }
+#endif
+}
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+
+// Encode 16 characters at once as in encode_packchar (characters are treated as signed).
+static inline __m128i encode_packchar_ssse3(__m128i c)
+{
+    __m128i e = _mm_sub_epi8(c, _mm_set1_epi8('A' - 1));
+    e = _mm_sub_epi8(e, _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('a' - 1)), _mm_set1_epi8('a' - 'A')));
+    const __m128i lt = _mm_cmpgt_epi8(_mm_set1_epi8('A'), c);
+    return _mm_or_si128(_mm_andnot_si128(lt, e), _mm_and_si128(lt, _mm_set1_epi8(27)));
+}
+
+/**
+ * Pack two consecutive blocks of 6 encoded characters into the low 32 bit of each 64 bit element.
+ * Returns a non-zero value if any character is encoded with more than 5 bit,
+ * as in this case the XOR in pack_chars can't be replaced with the SIMD sum.
+ */
+static inline int pack_chars_pair_ssse3(__m128i e, __m128i *r)
+{
+    // move each block of 6 characters to a zero padded 8 byte element
+    e = _mm_shuffle_epi8(e, _mm_setr_epi8(0, 1, 2, 3, 4, 5, -128, -128, 6, 7, 8, 9, 10, 11, -128, -128));
+    int overflow = _mm_movemask_epi8(_mm_cmpgt_epi8(e, _mm_set1_epi8(31)));
+    e = _mm_maddubs_epi16(e, _mm_setr_epi8(32, 1, 32, 1, 32, 1, 0, 0, 32, 1, 32, 1, 32, 1, 0, 0)); // 2 chars per 16 bit
+    e = _mm_madd_epi16(e, _mm_setr_epi16(1024, 1, 1024, 1, 1024, 1, 1024, 1)); // 4 + 2 chars per 32 bit
+    *r = _mm_or_si128(_mm_slli_epi32(e, 11), _mm_srli_epi64(_mm_srli_epi32(e, 9), 32));
+    return overflow;
+}
+
+#endif
+
+/**
+ * Pack consecutive blocks of 6 characters as in pack_chars.
+ * The SIMD loads never cross the end of the last block, so no extra padding is required.
+ *
+ * @param str    String to process.
+ * @param nblk   Number of 6-character blocks to pack.
+ * @param blk    Output array of packed blocks.
+ */
+static inline void pack_chars_blocks(const char *str, size_t nblk, uint32_t *blk)
+{
+    size_t i = 0;
+#if defined(__AVX2__)
+    __m128i lo, hi;
+    __m256i r;
+    for (; (i + 5) <= nblk; i += 4)
+    {
+        if ((pack_chars_pair_ssse3(encode_packchar_ssse3(_mm_loadu_si128((const __m128i *)str)), &lo)
+                | pack_chars_pair_ssse3(encode_packchar_ssse3(_mm_loadu_si128((const __m128i *)(str + 12))), &hi)) != 0)
+        {
+            blk[i] = pack_chars(str);
+            blk[(i + 1)] = pack_chars(str + 6);
+            blk[(i + 2)] = pack_chars(str + 12);
+            blk[(i + 3)] = pack_chars(str + 18);
+            str += 24;
+            continue;
+        }
+        r = _mm256_permutevar8x32_epi32(_mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1), _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6));
+        _mm_storeu_si128((__m128i *)(blk + i), _mm256_castsi256_si128(r));
+        str += 24;
+    }
+#elif defined(__SSSE3__)
+    __m128i r;
+    for (; (i + 3) <= nblk; i += 2)
+    {
+        if (pack_chars_pair_ssse3(encode_packchar_ssse3(_mm_loadu_si128((const __m128i *)str)), &r) != 0)
+        {
+            blk[i] = pack_chars(str);
+            blk[(i + 1)] = pack_chars(str + 6);
+            str += 12;
+            continue;
+        }
+        _mm_storel_epi64((__m128i *)(blk + i), _mm_shuffle_epi32(r, 0x08)); // [r0, r2]
+        str += 12;
+    }
+#endif
+    for (; i < nblk; i++)
+    {
+        blk[i] = pack_chars(str);
+        str += 6;
+    }
+}
+
+#define HASH32_BUFBLK 64 //!< Number of packed blocks buffered for each hash32_cols lane.
+
+/**
+ * Compute the hash32 value of multiple strings at once.
+ * The strings are distributed across HASH32_LANES independent lanes,
+ * and the 6-character blocks of each lane are mixed in parallel (AVX2 or SSE4.1 when available).
+ * Each lane takes the next string as soon as the current one is completed.
+ * The results are identical to calling hash32 for each string.
+ *
+ * @param buf     Buffer containing the concatenated strings.
+ * @param offset  Column containing the offset of each string in the buffer.
+ * @param size    Column containing the length of each string.
+ * @param nitems  Number of strings.
+ * @param h       Output array of hashes. It must be sized to contain at least nitems elements.
+ */
+static inline void hash32_cols(const char *buf, const uint64_t *offset, const uint32_t *size, uint64_t nitems, uint32_t *h)
+{
+    uint32_t blk[HASH32_LANES][HASH32_BUFBLK] = {{0}};
+    size_t nbuf[HASH32_LANES] = {0};
+    size_t bpos[HASH32_LANES] = {0};
+    const char *str[HASH32_LANES];
+    size_t rem[HASH32_LANES];
+    uint64_t item[HASH32_LANES];
+    uint32_t k[HASH32_LANES] = {0};
+    uint32_t lh[HASH32_LANES] = {0};
+    uint64_t next = 0;
+    size_t j, m;
+    int l, active = 0;
+    for (l = 0; l < HASH32_LANES; l++)
+    {
+        str[l] = buf;
+        rem[l] = 0;
+        item[l] = nitems; // idle lane
+    }
+    while (1)
+    {
+        for (l = 0; l < HASH32_LANES; l++)
+        {
+            if (nbuf[l] > 0)
+            {
+                continue;
+            }
+            if (rem[l] >= 6)
+            {
+                // refill the lane buffer
+                nbuf[l] = ((rem[l] / 6) < HASH32_BUFBLK) ? (rem[l] / 6) : HASH32_BUFBLK;
+                bpos[l] = 0;
+                pack_chars_blocks(str[l], nbuf[l], blk[l]);
+                str[l] += (nbuf[l] * 6);
+                rem[l] -= (nbuf[l] * 6);
+                continue;
+            }
+            if (rem[l] > 0)
+            {
+                lh[l] = muxhash(pack_chars_tail(str[l], rem[l]), lh[l]);
+                rem[l] = 0;
+            }
+            // the current string is completed: assign the next one
+            if (item[l] < nitems)
+            {
+                h[item[l]] = lh[l];
+                item[l] = nitems;
+                bpos[l] = 0;
+                --active;
+            }
+            while ((next < nitems) && (size[next] == 0))
+            {
+                h[next++] = 0;
+            }
+            if (next < nitems)
+            {
+                item[l] = next++;
+                str[l] = (buf + offset[item[l]]);
+                rem[l] = size[item[l]];
+                lh[l] = 0;
+                ++active;
+                l--; // fill the buffer of this lane
+            }
+        }
+        if (active == 0)
+        {
+            return;
+        }
+        // number of buffered blocks that can be processed by all active lanes
+        m = HASH32_BUFBLK;
+        for (l = 0; l < HASH32_LANES; l++)
+        {
+            if ((item[l] < nitems) && (nbuf[l] < m))
+            {
+                m = nbuf[l];
+            }
+        }
+        for (j = 0; j < m; j++)
+        {
+            for (l = 0; l < HASH32_LANES; l++)
+            {
+                k[l] = blk[l][(bpos[l] + j)];
+            }
+            muxhash_lanes(k, lh);
+        }
+        for (l = 0; l < HASH32_LANES; l++)
+        {
+            if (item[l] < nitems)
+            {
+                nbuf[l] -= m;
+                bpos[l] += m;
+            }
+        }
+    }
+}
+
+/**
+ * Returns the non-reversible (hash) REF+ALT encoding for an array of variants stored in columnar format.
+ * This is equivalent to calling encode_refalt_hash for each row, but several alleles are hashed at once
+ * in parallel SIMD lanes (see hash32_cols). It is mostly useful for long alleles.
+ *
+ * @param vc       Structure containing the pointers to the input columns (chrom and pos are not used).
+ * @param refalt   Output array of REF+ALT codes. It must be sized to contain at least vc.nrows elements.
+ */
+static inline void encode_refalt_hash_cols(variantkey_cols_t vc, uint32_t *refalt)
+{
+    uint32_t halt[256];
+    uint64_t i, j, n;
+    for (i = 0; i < vc.nrows; i += n)
+    {
+        n = (((vc.nrows - i) < 256) ? (vc.nrows - i) : 256);
+        hash32_cols(vc.ref, (vc.refoffset + i), (vc.sizeref + i), n, (refalt + i));
+        hash32_cols(vc.alt, (vc.altoffset + i), (vc.sizealt + i), n, halt);
+        for (j = 0; j < n; j++)
+        {
+            refalt[(i + j)] = finalize_refalt_hash(refalt[(i + j)], halt[j]);
+        }
+    }
+}
+
 /** @brief Returns reference+alternate numerical encoding.
  *
  * @param ref      Reference allele. String containing a sequence of nucleotide letters.
@@ -509,6 +849,166 @@ static inline uint64_t variantkey(const char *chrom, size_t sizechrom, uint32_t
     return encode_variantkey(encode_chrom(chrom, sizechrom), pos, encode_refalt(ref, sizeref, alt, sizealt));
 }
 
+#if defined(__AVX2__) || defined(__SSSE3__)
+
+// Load 16 bytes starting from the allele offset, without reading past the end of the buffer.
+static inline __m128i load_allele_block(const char *buf, uint64_t bufsize, uint64_t offset, size_t size)
+{
+    if ((offset + 16) <= bufsize)
+    {
+        return _mm_loadu_si128((const __m128i *)(buf + offset));
+    }
+    uint8_t blk[16] = {0};
+    memcpy(blk, (buf + offset), size);
+    return _mm_loadu_si128((const __m128i *)blk);
+}
+
+// Returns a zero-padded 16 byte block containing REF followed by ALT (the combined size must be less or equal 11).
+static inline __m128i combine_refalt_block(__m128i ref, size_t sizeref, __m128i alt, size_t sizealt)
+{
+    // a 16 byte window starting at (16 - n) selects the first n bytes
+    static const int8_t win[32] = {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                   0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+                                  };
+    // a 16 byte window starting at (16 - n) shifts the bytes n positions forward
+    static const int8_t shf[32] = {-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128,
+                                   0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15
+                                  };
+    ref = _mm_and_si128(ref, _mm_loadu_si128((const __m128i *)(win + 16 - sizeref)));
+    alt = _mm_shuffle_epi8(alt, _mm_loadu_si128((const __m128i *)(shf + 16 - sizeref)));
+    return _mm_and_si128(_mm_or_si128(ref, alt), _mm_loadu_si128((const __m128i *)(win + 16 - sizeref - sizealt)));
+}
+
+// Assemble the reversible REF+ALT code from the packed 8 bit groups of 4 bases returned by the SIMD kernels.
+static inline uint32_t pack_refalt_rev(const uint32_t *grp, size_t sizeref, size_t sizealt)
+{
+    return (((uint32_t)sizeref << 27) | ((uint32_t)sizealt << 23) | (grp[0] << 15) | (grp[1] << 7) | (grp[2] >> 1));
+}
+
+#endif
+
+#if defined(__AVX2__)
+
+/**
+ * AVX2 kernel to encode the bases of two zero-padded 16 byte REF+ALT blocks at once.
+ * Each 32 bit element of grp contains 4 bases encoded with 2 bit (A=0, C=1, G=2, T=3), starting from the MSB.
+ * Returns a bitmask with one bit set for every valid (ACGTacgt) byte.
+ */
+static inline uint32_t encode_refalt_blocks_avx2(__m128i blk0, __m128i blk1, uint32_t *grp)
+{
+    const __m256i v = _mm256_and_si256(_mm256_inserti128_si256(_mm256_castsi128_si256(blk0), blk1, 1), _mm256_set1_epi8((char)0xDF)); // uppercase
+    const __m256i ok = _mm256_or_si256(
+                           _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('A')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('C'))),
+                           _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('G')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('T'))));
+    // map the low nibble of A (1), C (3), G (7) and T (4) to the 2 bit code
+    const __m256i lut = _mm256_setr_epi8(0, 0, 0, 1, 3, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0,
+                                         0, 0, 0, 1, 3, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0);
+    __m256i c = _mm256_and_si256(_mm256_shuffle_epi8(lut, _mm256_and_si256(v, _mm256_set1_epi8(0x0F))), ok);
+    c = _mm256_maddubs_epi16(c, _mm256_set1_epi16(0x0104)); // 2 bases per 16 bit
+    c = _mm256_madd_epi16(c, _mm256_set1_epi32(0x00010010)); // 4 bases per 32 bit
+    _mm256_storeu_si256((__m256i *)grp, c);
+    return (uint32_t)_mm256_movemask_epi8(ok);
+}
+
+#elif defined(__SSSE3__)
+
+/**
+ * SSSE3 kernel to encode the bases of a zero-padded 16 byte REF+ALT block.
+ * Each 32 bit element of grp contains 4 bases encoded with 2 bit (A=0, C=1, G=2, T=3), starting from the MSB.
+ * Returns a bitmask with one bit set for every valid (ACGTacgt) byte.
+ */
+static inline uint32_t encode_refalt_block_ssse3(__m128i blk, uint32_t *grp)
+{
+    const __m128i v = _mm_and_si128(blk, _mm_set1_epi8((char)0xDF)); // uppercase
+    const __m128i ok = _mm_or_si128(
+                           _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('A')), _mm_cmpeq_epi8(v, _mm_set1_epi8('C'))),
+                           _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('G')), _mm_cmpeq_epi8(v, _mm_set1_epi8('T'))));
+    // map the low nibble of A (1), C (3), G (7) and T (4) to the 2 bit code
+    const __m128i lut = _mm_setr_epi8(0, 0, 0, 1, 3, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0);
+    __m128i c = _mm_and_si128(_mm_shuffle_epi8(lut, _mm_and_si128(v, _mm_set1_epi8(0x0F))), ok);
+    c = _mm_maddubs_epi16(c, _mm_set1_epi16(0x0104)); // 2 bases per 16 bit
+    c = _mm_madd_epi16(c, _mm_set1_epi32(0x00010010)); // 4 bases per 32 bit
+    _mm_storeu_si128((__m128i *)grp, c);
+    return (uint32_t)_mm_movemask_epi8(ok);
+}
+
+#endif
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+
+// Returns the zero-padded REF+ALT block for the specified row.
+static inline __m128i get_refalt_block(variantkey_cols_t vc, uint64_t i)
+{
+    return combine_refalt_block(load_allele_block(vc.ref, vc.refbufsize, vc.refoffset[i], vc.sizeref[i]), vc.sizeref[i],
+                                load_allele_block(vc.alt, vc.altbufsize, vc.altoffset[i], vc.sizealt[i]), vc.sizealt[i]);
+}
+
+// Returns the REF+ALT code for the specified row, using the reversible encoding when the SIMD kernel reports only valid bases.
+static inline uint32_t select_refalt_code(variantkey_cols_t vc, uint64_t i, uint32_t valid, const uint32_t *grp)
+{
+    size_t sizeref = vc.sizeref[i];
+    size_t sizealt = vc.sizealt[i];
+    uint32_t mask = (((uint32_t)1 << (sizeref + sizealt)) - 1);
+    if ((valid & mask) == mask)
+    {
+        return pack_refalt_rev(grp, sizeref, sizealt);
+    }
+    return encode_refalt_hash((vc.ref + vc.refoffset[i]), sizeref, (vc.alt + vc.altoffset[i]), sizealt);
+}
+
+#endif
+
+// Returns the VariantKey for the specified row using the scalar encoder.
+static inline uint64_t variantkey_cols_row(variantkey_cols_t vc, uint64_t i)
+{
+    return encode_variantkey(vc.chrom[i], vc.pos[i], encode_refalt((vc.ref + vc.refoffset[i]), vc.sizeref[i], (vc.alt + vc.altoffset[i]), vc.sizealt[i]));
+}
+
+/**
+ * Encode the VariantKeys for an array of variants stored in columnar format.
+ * This returns exactly the same values of calling variantkey() for each row,
+ * but the reversible REF+ALT encoding is processed with SIMD instructions when AVX2 or SSSE3 are available.
+ * The variants should be already normalized (see normalize_variant or use normalized_variantkey).
+ *
+ * @param vc    Structure containing the pointers to the input columns.
+ * @param vk    Output array of VariantKeys. It must be sized to contain at least vc.nrows elements.
+ */
+static inline void variantkey_cols(variantkey_cols_t vc, uint64_t *vk)
+{
+    uint64_t i = 0;
+#if defined(__AVX2__)
+    uint32_t grp[8];
+    uint32_t valid;
+    for (; (i + 1) < vc.nrows; i += 2)
+    {
+        if (((vc.sizeref[i] + vc.sizealt[i]) > 11) || ((vc.sizeref[(i + 1)] + vc.sizealt[(i + 1)]) > 11))
+        {
+            vk[i] = variantkey_cols_row(vc, i);
+            vk[(i + 1)] = variantkey_cols_row(vc, (i + 1));
+            continue;
+        }
+        valid = encode_refalt_blocks_avx2(get_refalt_block(vc, i), get_refalt_block(vc, (i + 1)), grp);
+        vk[i] = encode_variantkey(vc.chrom[i], vc.pos[i], select_refalt_code(vc, i, valid, grp));
+        vk[(i + 1)] = encode_variantkey(vc.chrom[(i + 1)], vc.pos[(i + 1)], select_refalt_code(vc, (i + 1), (valid >> 16), (grp + 4)));
+    }
+#elif defined(__SSSE3__)
+    uint32_t grp[4];
+    for (; i < vc.nrows; i++)
+    {
+        if ((vc.sizeref[i] + vc.sizealt[i]) > 11)
+        {
+            vk[i] = variantkey_cols_row(vc, i);
+            continue;
+        }
+        vk[i] = encode_variantkey(vc.chrom[i], vc.pos[i], select_refalt_code(vc, i, encode_refalt_block_ssse3(get_refalt_block(vc, i), grp), grp));
+    }
+#endif
+    for (; i < vc.nrows; i++)
+    {
+        vk[i] = variantkey_cols_row(vc, i);
+    }
+}
+
 /** @brief Returns minimum and maximum VariantKeys for range searches.
  *
  * @param chrom     Chromosome encoded number.
@@ -130,6 +130,63 @@ int benchmark_find_rv_variantkey_by_rsid()
     return 0;
 }
 
+int benchmark_find_rv_variantkey_by_rsid_dir()
+{
+    const char *filename = "rsvk_test.bin"; // generated by benchmark_find_rv_variantkey_by_rsid
+    const char *dirfilename = "rsvk_test.bin.dir";
+
+    uint32_t i;
+
+    mmfile_t rv = {0};
+    rv.ncols = 2;
+    rv.ctbytes[0] = 4;
+    rv.ctbytes[1] = 8;
+    rsidvar_cols_t crv = {0};
+    mmap_rsvk_file(filename, &rv, &crv);
+    if (crv.nrows != TEST_DATA_SIZE)
+    {
+        fprintf(stderr, " * %s Expecting rsvk_test.bin %" PRIu64 " items, got instead: %" PRIu64 "\n", __func__, TEST_DATA_SIZE, crv.nrows);
+        return 1;
+    }
+
+    uint64_t tstart, tend;
+    tstart = get_time();
+    size_t len = save_rsvk_dir_file(dirfilename, crv);
+    tend = get_time();
+    if (len == 0)
+    {
+        fprintf(stderr, " * %s Unable to write the %s file.\n", __func__, dirfilename);
+        return 1;
+    }
+    fprintf(stdout, " * %s directory: %lu bytes -- build time: %" PRIu64 " ns\n", __func__, len, (tend - tstart));
+
+    mmfile_t mf = {0};
+    rsidvar_dir_t dir = {0};
+    if (mmap_rsvk_dir_file(dirfilename, crv, &mf, &dir) != 0)
+    {
+        fprintf(stderr, " * %s Unable to map the %s file.\n", __func__, dirfilename);
+        return 1;
+    }
+
+    volatile uint64_t sum = 0;
+    uint64_t first;
+
+    int j;
+    for (j=0 ; j < 3; j++)
+    {
+        sum = 0;
+        tstart = get_time();
+        for (i=0 ; i < TEST_DATA_SIZE; i++)
+        {
+            sum += find_rv_variantkey_by_rsid_dir(crv, dir, &first, i);
+        }
+        tend = get_time();
+        fprintf(stdout, "   * %s %d. sum: %" PRIu64 " -- time: %" PRIu64 " ns -- %" PRIu64 " ns/op\n", __func__, j, sum, (tend - tstart), (tend - tstart)/TEST_DATA_SIZE);
+    }
+    munmap_binfile(mf);
+    return munmap_binfile(rv);
+}
+
 int benchmark_find_vr_rsid_by_variantkey()
 {
     const char *filename = "vkrs_test.bin";
@@ -202,10 +259,63 @@ int benchmark_find_vr_rsid_by_variantkey()
     return 0;
 }
 
+int benchmark_join_vr_rsid_by_variantkey()
+{
+    const char *filename = "vkrs_test.bin"; // generated by benchmark_find_vr_rsid_by_variantkey
+
+    mmfile_t vr = {0};
+    vr.ncols = 2;
+    vr.ctbytes[0] = 8;
+    vr.ctbytes[1] = 4;
+    rsidvar_cols_t cvr = {0};
+    mmap_vkrs_file(filename, &vr, &cvr);
+    if (cvr.nrows != TEST_DATA_SIZE)
+    {
+        fprintf(stderr, " * %s Expecting vkrs_test.bin %" PRIu64 " items, got instead: %" PRIu64 "\n", __func__, TEST_DATA_SIZE, cvr.nrows);
+        return 1;
+    }
+
+    const uint64_t nkeys = 1000;
+    uint64_t *keys = (uint64_t *)malloc(sizeof(uint64_t) * TEST_DATA_SIZE);
+    uint64_t *ovk = (uint64_t *)malloc(sizeof(uint64_t) * nkeys);
+    uint32_t *ors = (uint32_t *)malloc(sizeof(uint32_t) * nkeys);
+    uint64_t i, n, kpos, rpos, tstart, tend;
+    volatile uint64_t sum = 0;
+    for (i=0 ; i < TEST_DATA_SIZE; i++)
+    {
+        keys[i] = i;
+    }
+
+    int j;
+    for (j=0 ; j < 3; j++)
+    {
+        sum = 0;
+        kpos = 0;
+        rpos = 0;
+        tstart = get_time();
+        while (kpos < TEST_DATA_SIZE)
+        {
+            n = join_vr_rsid_by_variantkey(cvr, keys, TEST_DATA_SIZE, &kpos, &rpos, ovk, ors, nkeys);
+            for (i=0 ; i < n; i++)
+            {
+                sum += ors[i];
+            }
+        }
+        tend = get_time();
+        fprintf(stdout, "   * %s %d. sum: %" PRIu64 " -- time: %" PRIu64 " ns -- %" PRIu64 " ns/op\n", __func__, j, sum, (tend - tstart), (tend - tstart)/TEST_DATA_SIZE);
+    }
+    free(ors);
+    free(ovk);
+    free(keys);
+    return munmap_binfile(vr);
+}
+
 int main()
 {
     int ret = 0;
     ret += benchmark_find_rv_variantkey_by_rsid();
+    ret += benchmark_find_rv_variantkey_by_rsid_dir();
     ret += benchmark_find_vr_rsid_by_variantkey();
+    ret += benchmark_join_vr_rsid_by_variantkey();
     return ret;
 }
@@ -0,0 +1,269 @@
+// Nicola Asuni
+
+#if __STDC_VERSION__ >= 199901L
+#define _XOPEN_SOURCE 600
+#else
+#define _XOPEN_SOURCE 500
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include "../src/variantkey/binfuse.h"
+
+#define TEST_DATA_ITEMS 251
+#define TEST_BENCH_ITEMS 4000000
+#define TEST_BENCH_LOOKUPS 1000000
+
+static const uint64_t test_sizes[] = {0, 1, 2, 3, 17, 256, 4097, 65537, 300000};
+
+// returns current time in nanoseconds
+uint64_t get_time()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+    return (((uint64_t)t.tv_sec * 1000000000) + (uint64_t)t.tv_nsec);
+}
+
+static uint64_t test_rand(uint64_t *x)
+{
+    *x ^= *x << 13;
+    *x ^= *x >> 7;
+    *x ^= *x << 17;
+    return *x;
+}
+
+static int cmp_uint64_t(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// generate sorted VariantKey-like values (with some duplicates): CHROM, increasing POS with random gaps, random REF+ALT
+static void gen_sorted_keys(uint64_t *src, uint64_t nrows, uint64_t *seed)
+{
+    uint64_t i, pos = 0, chrom = 1;
+    uint64_t rowsperchrom = (nrows / 25) + 1;
+    for (i = 0; i < nrows; i++)
+    {
+        if ((i > 0) && ((i % rowsperchrom) == 0))
+        {
+            ++chrom;
+            pos = 0;
+        }
+        pos += (test_rand(seed) % 300);
+        src[i] = (chrom << 59) | ((pos & 0xfffffff) << 31) | (test_rand(seed) & 0x7ffffffe) | 1;
+        if ((i > 0) && ((test_rand(seed) % 16) == 0))
+        {
+            src[i] = src[(i - 1)];
+        }
+    }
+    qsort(src, nrows, sizeof(uint64_t), cmp_uint64_t);
+}
+
+// returns the number of false positives
+static uint64_t check_binfuse(const uint64_t *filter, const uint64_t *src, uint64_t nrows, uint64_t nneg, int *errors)
+{
+    uint64_t i, key, fp = 0;
+    for (i = 0; i < nrows; i++)
+    {
+        if (!binfuse_contain(filter, src[i]))
+        {
+            fprintf(stderr, "%s (%" PRIu64 ") : False negative for %016" PRIx64 "\n", __func__, i, src[i]);
+            ++(*errors);
+            break;
+        }
+    }
+    for (i = 0; i < nneg; i++)
+    {
+        key = (binfuse_mix(i, 0) & ~(uint64_t)1); // never in the column
+        fp += binfuse_contain(filter, key);
+    }
+    return fp;
+}
+
+int test_binfuse_col(mmfile_t mf)
+{
+    int errors = 0;
+    const uint64_t *src = get_src_offset_uint64_t(mf.src, mf.index[3]);
+    uint64_t *filter = build_binfuse(src, TEST_DATA_ITEMS);
+    if (filter == NULL)
+    {
+        fprintf(stderr, "%s : Unable to build the filter\n", __func__);
+        return 1;
+    }
+    check_binfuse(filter, src, TEST_DATA_ITEMS, 0, &errors);
+    free(filter);
+    return errors;
+}
+
+int test_binfuse_random()
+{
+    int errors = 0;
+    uint64_t seed = 0x1234567890abcdef;
+    uint64_t j, fp, nneg = 100000;
+    for (j = 0; j < (sizeof(test_sizes) / sizeof(test_sizes[0])); j++)
+    {
+        uint64_t nrows = test_sizes[j];
+        uint64_t *src = (uint64_t *)malloc(sizeof(uint64_t) * (nrows + 1));
+        gen_sorted_keys(src, nrows, &seed);
+        uint64_t *filter = build_binfuse(src, nrows);
+        if (filter == NULL)
+        {
+            fprintf(stderr, "%s (%" PRIu64 ") : Unable to build the filter\n", __func__, nrows);
+            ++errors;
+            free(src);
+            continue;
+        }
+        fp = check_binfuse(filter, src, nrows, nneg, &errors);
+        if (fp > (nneg / 100))
+        {
+            fprintf(stderr, "%s (%" PRIu64 ") : Too many false positives: %" PRIu64 "\n", __func__, nrows, fp);
+            ++errors;
+        }
+        if ((nrows >= 65537) && ((filter[BINFUSE_INFO_NFP] * 8) > (nrows * 10)))
+        {
+            fprintf(stderr, "%s (%" PRIu64 ") : The filter is too large: %" PRIu64 " bytes\n", __func__, nrows, filter[BINFUSE_INFO_NFP]);
+            ++errors;
+        }
+        free(filter);
+        free(src);
+    }
+    return errors;
+}
+
+int test_binfuse_unsorted()
+{
+    int errors = 0;
+    const uint64_t src[3] = {3, 1, 2};
+    uint64_t *filter = build_binfuse(src, 3);
+    if (filter != NULL)
+    {
+        fprintf(stderr, "%s : Expecting an error for an unsorted column\n", __func__);
+        ++errors;
+        free(filter);
+    }
+    return errors;
+}
+
+int test_binfuse_file(mmfile_t mf)
+{
+    int errors = 0;
+    const uint64_t *src = get_src_offset_uint64_t(mf.src, mf.index[3]);
+    if (build_binfuse_file("test_binfuse.bin", src, TEST_DATA_ITEMS) == 0)
+    {
+        fprintf(stderr, "%s : Unable to save the filter file\n", __func__);
+        return 1;
+    }
+    if (build_binfuse_file("/WRONG/../../test_binfuse.bin", src, TEST_DATA_ITEMS) != 0)
+    {
+        fprintf(stderr, "%s : Expecting an error for an invalid file\n", __func__);
+        ++errors;
+    }
+    mmfile_t fmf = {0};
+    const uint64_t *filter = mmap_binfuse_file("test_binfuse.bin", &fmf, src, (TEST_DATA_ITEMS - 1));
+    if (filter != NULL)
+    {
+        fprintf(stderr, "%s : Expecting an error for a different column\n", __func__);
+        ++errors;
+    }
+    munmap_binfile(fmf);
+    filter = mmap_binfuse_file("test_binfuse.bin", &fmf, (src + 1), TEST_DATA_ITEMS);
+    if (filter != NULL)
+    {
+        fprintf(stderr, "%s : Expecting an error for a different column\n", __func__);
+        ++errors;
+    }
+    munmap_binfile(fmf);
+    filter = mmap_binfuse_file("test_binfuse.bin", &fmf, src, TEST_DATA_ITEMS);
+    if (filter == NULL)
+    {
+        fprintf(stderr, "%s : Unable to map the filter file\n", __func__);
+        return 1;
+    }
+    check_binfuse(filter, src, TEST_DATA_ITEMS, 0, &errors);
+    munmap_binfile(fmf);
+    return errors;
+}
+
+void benchmark_binfuse()
+{
+    uint64_t tstart, tend, i, first, last, sum = 0;
+    uint64_t seed = 0x1234567890abcdef;
+    uint64_t *src = (uint64_t *)malloc(sizeof(uint64_t) * TEST_BENCH_ITEMS);
+    uint64_t *keys = (uint64_t *)malloc(sizeof(uint64_t) * TEST_BENCH_LOOKUPS);
+    gen_sorted_keys(src, TEST_BENCH_ITEMS, &seed);
+    for (i = 0; i < TEST_BENCH_LOOKUPS; i++)
+    {
+        keys[i] = (src[(test_rand(&seed) % TEST_BENCH_ITEMS)] & ~(uint64_t)1); // misses
+    }
+    tstart = get_time();
+    uint64_t *filter = build_binfuse(src, TEST_BENCH_ITEMS);
+    tend = get_time();
+    fprintf(stdout, " * %s build_binfuse : %lu ns/key\n", __func__, (tend - tstart) / TEST_BENCH_ITEMS);
+    tstart = get_time();
+    for (i = 0; i < TEST_BENCH_LOOKUPS; i++)
+    {
+        first = 0;
+        last = TEST_BENCH_ITEMS;
+        sum += col_find_first_uint64_t(src, &first, &last, keys[i]);
+    }
+    tend = get_time();
+    fprintf(stdout, " * %s col_find_first_uint64_t (miss) : %lu ns/op\n", __func__, (tend - tstart) / TEST_BENCH_LOOKUPS);
+    tstart = get_time();
+    for (i = 0; i < TEST_BENCH_LOOKUPS; i++)
+    {
+        sum += (uint64_t)binfuse_contain(filter, keys[i]);
+    }
+    tend = get_time();
+    fprintf(stdout, " * %s binfuse_contain (miss) : %lu ns/op (%" PRIx64 ")\n", __func__, (tend - tstart) / TEST_BENCH_LOOKUPS, sum);
+    free(filter);
+    free(keys);
+    free(src);
+}
+
+int main()
+{
+    int errors = 0;
+
+    char *file = "test_data_col.bin"; // file containing test data
+
+    mmfile_t mf = {0};
+    mf.ncols = 4;
+    mf.ctbytes[0] = 1;
+    mf.ctbytes[1] = 2;
+    mf.ctbytes[2] = 4;
+    mf.ctbytes[3] = 8;
+    mmap_binfile(file, &mf);
+
+    if (mf.fd < 0)
+    {
+        fprintf(stderr, "can't open %s for reading\n", file);
+        return 1;
+    }
+    if (mf.src == MAP_FAILED)
+    {
+        fprintf(stderr, "mmap error! [%s]\n", strerror(errno));
+        return 1;
+    }
+
+    errors += test_binfuse_col(mf);
+    errors += test_binfuse_random();
+    errors += test_binfuse_unsorted();
+    errors += test_binfuse_file(mf);
+
+    benchmark_binfuse();
+
+    int e = munmap_binfile(mf);
+    if (e != 0)
+    {
+        fprintf(stderr, "Got %d error while unmapping the file\n", e);
+        return 1;
+    }
+
+    return errors;
+}
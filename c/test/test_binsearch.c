@@ -6,6 +6,7 @@
 #define _XOPEN_SOURCE 500
 #endif
 
+#include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
@@ -963,6 +964,88 @@ define_test_find_last(le, uint16_t)
 define_test_find_last(le, uint32_t)
 define_test_find_last(le, uint64_t)
 
+typedef struct test_edge_t
+{
+    uint64_t search;
+    uint64_t foundFirst;
+    uint64_t foundLast;
+} test_edge_t;
+
+// searches hitting or missing past both ends of the whole range
+static const test_edge_t test_edge_data[] =
+{
+    {0x0000000000000001, 4, 4},
+    {0x0000000000000002, 0, 0},
+    {0x0000000000000004, 1, 2},
+    {0x0000000000000008, 3, 3},
+    {0x0000000000000009, 4, 4},
+};
+
+// the buffer is sized exactly to the items, so reads outside the range are caught by sanitizers
+int test_find_edges()
+{
+    int errors = 0;
+    int i, j;
+    const uint64_t nitems = 4;
+    const uint64_t items[] = {2, 4, 4, 8};
+    uint64_t found, first, last;
+    uint8_t *src = (uint8_t *)malloc(nitems * sizeof(uint64_t));
+    uint64_t *col = (uint64_t *)malloc(nitems * sizeof(uint64_t));
+    if ((src == NULL) || (col == NULL))
+    {
+        free(src);
+        free(col);
+        fprintf(stderr, "%s : memory allocation error\n", __func__);
+        return 1;
+    }
+    for (i = 0; i < (int)nitems; i++)
+    {
+        for (j = 0; j < 8; j++)
+        {
+            src[((i * 8) + j)] = (uint8_t)(items[i] >> (56 - (j * 8)));
+        }
+        col[i] = items[i];
+    }
+    for (i = 0; i < (int)(sizeof(test_edge_data) / sizeof(test_edge_t)); i++)
+    {
+        first = 0;
+        last = nitems;
+        found = find_first_be_uint64_t(src, 8, 0, &first, &last, test_edge_data[i].search);
+        if (found != test_edge_data[i].foundFirst)
+        {
+            fprintf(stderr, "%s FIRST (%d) Expected found %" PRIu64 ", got %" PRIu64 "\n", __func__, i, test_edge_data[i].foundFirst, found);
+            ++errors;
+        }
+        first = 0;
+        last = nitems;
+        found = find_last_be_uint64_t(src, 8, 0, &first, &last, test_edge_data[i].search);
+        if (found != test_edge_data[i].foundLast)
+        {
+            fprintf(stderr, "%s LAST (%d) Expected found %" PRIu64 ", got %" PRIu64 "\n", __func__, i, test_edge_data[i].foundLast, found);
+            ++errors;
+        }
+        first = 0;
+        last = nitems;
+        found = col_find_first_uint64_t(col, &first, &last, test_edge_data[i].search);
+        if (found != test_edge_data[i].foundFirst)
+        {
+            fprintf(stderr, "%s COL FIRST (%d) Expected found %" PRIu64 ", got %" PRIu64 "\n", __func__, i, test_edge_data[i].foundFirst, found);
+            ++errors;
+        }
+        first = 0;
+        last = nitems;
+        found = col_find_last_uint64_t(col, &first, &last, test_edge_data[i].search);
+        if (found != test_edge_data[i].foundLast)
+        {
+            fprintf(stderr, "%s COL LAST (%d) Expected found %" PRIu64 ", got %" PRIu64 "\n", __func__, i, test_edge_data[i].foundLast, found);
+            ++errors;
+        }
+    }
+    free(src);
+    free(col);
+    return errors;
+}
+
 // returns current time in nanoseconds
 uint64_t get_time()
 {
@@ -971,6 +1054,67 @@ uint64_t get_time()
     return (((uint64_t)t.tv_sec * 1000000000) + (uint64_t)t.tv_nsec);
 }
 
+#define define_test_find_batch(O, T) \
+int test_find_batch_##O##_##T(mmfile_t mf, uint64_t blklen) \
+{ \
+    int errors = 0; \
+    int i; \
+    uint64_t first, last, exp, ffound, lfound; \
+    T search[TEST_DATA_SIZE]; \
+    uint64_t found[TEST_DATA_SIZE]; \
+    for (i=0 ; i < TEST_DATA_SIZE; i++) \
+    { \
+        search[0] = test_data_##O##_##T[i].search; \
+        find_first_batch_##O##_##T(mf.src, blklen, test_data_##O##_##T[i].blkpos, test_data_##O##_##T[i].first, test_data_##O##_##T[i].last, search, 1, &ffound); \
+        if (ffound != test_data_##O##_##T[i].foundFirst) \
+        { \
+            fprintf(stderr, "%s FIRST (%d) Expected found %" PRIx64 ", got %" PRIx64 "\n", __func__, i, test_data_##O##_##T[i].foundFirst, ffound); \
+            ++errors; \
+        } \
+        find_last_batch_##O##_##T(mf.src, blklen, test_data_##O##_##T[i].blkpos, test_data_##O##_##T[i].first, test_data_##O##_##T[i].last, search, 1, &lfound); \
+        if (lfound != test_data_##O##_##T[i].foundLast) \
+        { \
+            fprintf(stderr, "%s LAST (%d) Expected found %" PRIx64 ", got %" PRIx64 "\n", __func__, i, test_data_##O##_##T[i].foundLast, lfound); \
+            ++errors; \
+        } \
+        search[i] = test_data_##O##_##T[i].search; \
+    } \
+    find_first_batch_##O##_##T(mf.src, blklen, test_data_##O##_##T[0].blkpos, 0, 251, search, TEST_DATA_SIZE, found); \
+    for (i=0 ; i < TEST_DATA_SIZE; i++) \
+    { \
+        first = 0; \
+        last = 251; \
+        exp = find_first_##O##_##T(mf.src, blklen, test_data_##O##_##T[0].blkpos, &first, &last, search[i]); \
+        if (found[i] != exp) \
+        { \
+            fprintf(stderr, "%s FIRST BATCH (%d) Expected found %" PRIx64 ", got %" PRIx64 "\n", __func__, i, exp, found[i]); \
+            ++errors; \
+        } \
+    } \
+    find_last_batch_##O##_##T(mf.src, blklen, test_data_##O##_##T[0].blkpos, 0, 251, search, TEST_DATA_SIZE, found); \
+    for (i=0 ; i < TEST_DATA_SIZE; i++) \
+    { \
+        first = 0; \
+        last = 251; \
+        exp = find_last_##O##_##T(mf.src, blklen, test_data_##O##_##T[0].blkpos, &first, &last, search[i]); \
+        if (found[i] != exp) \
+        { \
+            fprintf(stderr, "%s LAST BATCH (%d) Expected found %" PRIx64 ", got %" PRIx64 "\n", __func__, i, exp, found[i]); \
+            ++errors; \
+        } \
+    } \
+    return errors; \
+}
+
+define_test_find_batch(be, uint8_t)
+define_test_find_batch(be, uint16_t)
+define_test_find_batch(be, uint32_t)
+define_test_find_batch(be, uint64_t)
+define_test_find_batch(le, uint8_t)
+define_test_find_batch(le, uint16_t)
+define_test_find_batch(le, uint32_t)
+define_test_find_batch(le, uint64_t)
+
 #define define_benchmark_find_first(O, T) \
 void benchmark_find_first_##O##_##T(mmfile_t mf, uint64_t blklen, uint64_t nrows) \
 { \
@@ -1156,6 +1300,17 @@ int main()
     errors += test_find_first_le_uint64_t(mf, blklen);
     errors += test_find_last_le_uint64_t(mf, blklen);
 
+    errors += test_find_edges();
+
+    errors += test_find_batch_be_uint8_t(mf, blklen);
+    errors += test_find_batch_be_uint16_t(mf, blklen);
+    errors += test_find_batch_be_uint32_t(mf, blklen);
+    errors += test_find_batch_be_uint64_t(mf, blklen);
+    errors += test_find_batch_le_uint8_t(mf, blklen);
+    errors += test_find_batch_le_uint16_t(mf, blklen);
+    errors += test_find_batch_le_uint32_t(mf, blklen);
+    errors += test_find_batch_le_uint64_t(mf, blklen);
+
     benchmark_find_first_be_uint8_t(mf, blklen, nrows);
     benchmark_find_last_be_uint8_t(mf, blklen, nrows);
     benchmark_find_first_be_uint16_t(mf, blklen, nrows);
@@ -7,6 +7,7 @@
 #endif
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <errno.h>
@@ -590,6 +591,94 @@ define_test_col_find_last(uint16_t)
 define_test_col_find_last(uint32_t)
 define_test_col_find_last(uint64_t)
 
+#define define_test_col_find_gallop(T) \
+int test_col_find_gallop_##T(mmfile_t mf) \
+{ \
+    int errors = 0; \
+    uint64_t i, j, k, exp, got; \
+    const T *src = get_src_offset_##T(mf.src, mf.index[typecolmap[sizeof(T)]]); \
+    T search; \
+    for (i = 0; i < TEST_DATA_ITEMS; i += 7) \
+    { \
+        for (j = 0; j < TEST_DATA_ITEMS; j++) \
+        { \
+            search = (T)(src[j] + (T)(j % 3) - 1); \
+            for (k = i; (k < TEST_DATA_ITEMS) && (src[k] < search); k++); \
+            exp = k; \
+            got = col_find_gallop_##T(src, i, TEST_DATA_ITEMS, search); \
+            if (got != exp) \
+            { \
+                fprintf(stderr, "%s (%" PRIu64 ", %" PRIu64 ") Expected %" PRIu64 ", got %" PRIu64 "\n", __func__, i, j, exp, got); \
+                ++errors; \
+            } \
+        } \
+    } \
+    return errors; \
+}
+
+define_test_col_find_gallop(uint8_t)
+define_test_col_find_gallop(uint16_t)
+define_test_col_find_gallop(uint32_t)
+define_test_col_find_gallop(uint64_t)
+
+#define define_test_col_find_batch(T) \
+int test_col_find_batch_##T(mmfile_t mf) \
+{ \
+    int errors = 0; \
+    int i; \
+    const T *src = get_src_offset_##T(mf.src, mf.index[typecolmap[sizeof(T)]]); \
+    uint64_t first, last, exp, ffound, lfound; \
+    T search[TEST_DATA_SIZE]; \
+    uint64_t found[TEST_DATA_SIZE]; \
+    for (i=0 ; i < TEST_DATA_SIZE; i++) \
+    { \
+        search[0] = test_col_data_##T[i].search; \
+        col_find_first_batch_##T(src, test_col_data_##T[i].first, test_col_data_##T[i].last, search, 1, &ffound); \
+        if (ffound != test_col_data_##T[i].foundFirst) \
+        { \
+            fprintf(stderr, "%s FIRST (%d) Expected found %" PRIx64 ", got %" PRIx64 "\n", __func__, i, test_col_data_##T[i].foundFirst, ffound); \
+            ++errors; \
+        } \
+        col_find_last_batch_##T(src, test_col_data_##T[i].first, test_col_data_##T[i].last, search, 1, &lfound); \
+        if (lfound != test_col_data_##T[i].foundLast) \
+        { \
+            fprintf(stderr, "%s LAST (%d) Expected found %" PRIx64 ", got %" PRIx64 "\n", __func__, i, test_col_data_##T[i].foundLast, lfound); \
+            ++errors; \
+        } \
+        search[i] = test_col_data_##T[i].search; \
+    } \
+    col_find_first_batch_##T(src, 0, TEST_DATA_ITEMS, search, TEST_DATA_SIZE, found); \
+    for (i=0 ; i < TEST_DATA_SIZE; i++) \
+    { \
+        first = 0; \
+        last = TEST_DATA_ITEMS; \
+        exp = col_find_first_##T(src, &first, &last, search[i]); \
+        if (found[i] != exp) \
+        { \
+            fprintf(stderr, "%s FIRST BATCH (%d) Expected found %" PRIx64 ", got %" PRIx64 "\n", __func__, i, exp, found[i]); \
+            ++errors; \
+        } \
+    } \
+    col_find_last_batch_##T(src, 0, TEST_DATA_ITEMS, search, TEST_DATA_SIZE, found); \
+    for (i=0 ; i < TEST_DATA_SIZE; i++) \
+    { \
+        first = 0; \
+        last = TEST_DATA_ITEMS; \
+        exp = col_find_last_##T(src, &first, &last, search[i]); \
+        if (found[i] != exp) \
+        { \
+            fprintf(stderr, "%s LAST BATCH (%d) Expected found %" PRIx64 ", got %" PRIx64 "\n", __func__, i, exp, found[i]); \
+            ++errors; \
+        } \
+    } \
+    return errors; \
+}
+
+define_test_col_find_batch(uint8_t)
+define_test_col_find_batch(uint16_t)
+define_test_col_find_batch(uint32_t)
+define_test_col_find_batch(uint64_t)
+
 // returns current time in nanoseconds
 uint64_t get_time()
 {
@@ -708,6 +797,48 @@ define_benchmark_col_find_last_sub(uint16_t)
 define_benchmark_col_find_last_sub(uint32_t)
 define_benchmark_col_find_last_sub(uint64_t)
 
+void benchmark_col_find_first_batch_uint64_t()
+{
+    uint64_t tstart, tend, i, first, last, sum = 0;
+    uint64_t seed = 0x1234567890abcdef;
+    const uint64_t nrows = 4000000;
+    const uint64_t nkeys = 1000000;
+    uint64_t *src = (uint64_t *)malloc(sizeof(uint64_t) * nrows);
+    uint64_t *keys = (uint64_t *)malloc(sizeof(uint64_t) * nkeys);
+    uint64_t *found = (uint64_t *)malloc(sizeof(uint64_t) * nkeys);
+    for (i = 0; i < nrows; i++)
+    {
+        src[i] = (i << 8) | (i & 0xff); // sorted values with gaps
+    }
+    for (i = 0; i < nkeys; i++)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        keys[i] = src[(seed % nrows)];
+    }
+    tstart = get_time();
+    for (i = 0; i < nkeys; i++)
+    {
+        first = 0;
+        last = nrows;
+        sum += col_find_first_uint64_t(src, &first, &last, keys[i]);
+    }
+    tend = get_time();
+    fprintf(stdout, " * %s single : %lu ns/op\n", __func__, (tend - tstart) / nkeys);
+    tstart = get_time();
+    col_find_first_batch_uint64_t(src, 0, nrows, keys, nkeys, found);
+    tend = get_time();
+    for (i = 0; i < nkeys; i++)
+    {
+        sum -= found[i];
+    }
+    fprintf(stdout, " * %s batch : %lu ns/op (%" PRIx64 ")\n", __func__, (tend - tstart) / nkeys, sum);
+    free(found);
+    free(keys);
+    free(src);
+}
+
 int main()
 {
     int errors = 0;
@@ -752,6 +883,14 @@ int main()
     errors += test_col_find_last_uint32_t(mf);
     errors += test_col_find_first_uint64_t(mf);
     errors += test_col_find_last_uint64_t(mf);
+    errors += test_col_find_batch_uint8_t(mf);
+    errors += test_col_find_batch_uint16_t(mf);
+    errors += test_col_find_batch_uint32_t(mf);
+    errors += test_col_find_batch_uint64_t(mf);
+    errors += test_col_find_gallop_uint8_t(mf);
+    errors += test_col_find_gallop_uint16_t(mf);
+    errors += test_col_find_gallop_uint32_t(mf);
+    errors += test_col_find_gallop_uint64_t(mf);
 
     benchmark_col_find_first_uint8_t(mf);
     benchmark_col_find_last_uint8_t(mf);
@@ -771,6 +910,8 @@ int main()
     benchmark_col_find_first_sub_uint64_t(mf);
     benchmark_col_find_last_sub_uint64_t(mf);
 
+    benchmark_col_find_first_batch_uint64_t();
+
     int e = munmap_binfile(mf);
     if (e != 0)
     {
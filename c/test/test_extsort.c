@@ -0,0 +1,370 @@
+// VariantKey
+//
+// test_extsort.c
+//
+// @category   Tools
+// @author     Nicola Asuni <nicola.asuni@genomicsplc.com>
+// @copyright  2017-2018 GENOMICS plc
+// @license    MIT (see LICENSE)
+// @link       https://github.com/genomicsplc/variantkey
+//
+// LICENSE
+//
+// Copyright (c) 2017-2018 GENOMICS plc
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Test for extsort
+
+#if __STDC_VERSION__ >= 199901L
+#define _XOPEN_SOURCE 600
+#else
+#define _XOPEN_SOURCE 500
+#endif
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+#include "../src/variantkey/extsort.h"
+
+#define TEST_EXTSORT_NITEMS 200003
+
+// returns current time in nanoseconds
+uint64_t get_time()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+    return (((uint64_t)t.tv_sec * 1000000000) + (uint64_t)t.tv_nsec);
+}
+
+static uint64_t test_rand(uint64_t *x)
+{
+    *x ^= *x << 13;
+    *x ^= *x >> 7;
+    *x ^= *x << 17;
+    return *x;
+}
+
+// VariantKey-like values from a few chromosomes, with duplicates
+static void gen_keys(uint64_t *arr, uint64_t nitems, uint64_t seed)
+{
+    uint64_t i;
+    for (i = 0; i < nitems; i++)
+    {
+        test_rand(&seed);
+        arr[i] = (((seed % 3) + 1) << 59) | ((seed >> 8) & 0x7fff80000000);
+    }
+}
+
+// expected output: sorted and optionally unique copy of the input
+static uint64_t gen_expected(const uint64_t *arr, uint64_t nitems, uint8_t unique, uint64_t *exp)
+{
+    uint64_t *tmp = (uint64_t *)malloc(nitems * sizeof(uint64_t));
+    memcpy(exp, arr, nitems * sizeof(uint64_t));
+    parallel_sort_uint64_t(exp, tmp, nitems, 1);
+    free(tmp);
+    if (unique)
+    {
+        return (uint64_t)(unique_uint64_t(exp, nitems) - exp);
+    }
+    return nitems;
+}
+
+static int check_binsrc1_file(const char *func, const char *file, const uint64_t *exp, uint64_t nexp)
+{
+    int errors = 0;
+    mmfile_t mf = {0};
+    mmap_binfile(file, &mf);
+    if ((mf.fd < 0) || (mf.src == MAP_FAILED))
+    {
+        fprintf(stderr, "%s : Unable to map %s\n", func, file);
+        return 1;
+    }
+    if ((mf.ncols != 1) || (mf.ctbytes[0] != 8) || (mf.nrows != nexp) || (mf.size != (32 + (nexp * 8))))
+    {
+        fprintf(stderr, "%s : Unexpected header: ncols=%" PRIu8 " nrows=%" PRIu64 " (expected %" PRIu64 ") size=%" PRIu64 "\n", func, mf.ncols, mf.nrows, nexp, mf.size);
+        ++errors;
+    }
+    else
+    {
+        const uint64_t *col = (const uint64_t *)(mf.src + mf.index[0]);
+        uint64_t i;
+        for (i = 0; i < nexp; i++)
+        {
+            if (col[i] != exp[i])
+            {
+                fprintf(stderr, "%s : Expected %016" PRIx64 ", got %016" PRIx64 " at row %" PRIu64 "\n", func, exp[i], col[i], i);
+                ++errors;
+                break;
+            }
+        }
+    }
+    munmap_binfile(mf);
+    return errors;
+}
+
+int test_extsort(uint64_t maxmem, uint32_t nthreads)
+{
+    int errors = 0;
+    const char *file = "test_extsort.bin";
+    uint64_t *arr = (uint64_t *)malloc(TEST_EXTSORT_NITEMS * sizeof(uint64_t));
+    uint64_t *exp = (uint64_t *)malloc(TEST_EXTSORT_NITEMS * sizeof(uint64_t));
+    gen_keys(arr, TEST_EXTSORT_NITEMS, 0x9e3779b97f4a7c15);
+    extsort_t es;
+    uint64_t i, n, nexp, nrows;
+    uint8_t unique;
+    for (unique = 0; unique <= 1; unique++)
+    {
+        nexp = gen_expected(arr, TEST_EXTSORT_NITEMS, unique, exp);
+        if (extsort_init(&es, maxmem, NULL, nthreads, unique) != 0)
+        {
+            fprintf(stderr, "%s : Unable to initialize\n", __func__);
+            ++errors;
+            continue;
+        }
+        // add the values in blocks of different sizes
+        for (i = 0, n = 1; i < TEST_EXTSORT_NITEMS; i += n, n = (n * 7) + 1)
+        {
+            if (n > (TEST_EXTSORT_NITEMS - i))
+            {
+                n = (TEST_EXTSORT_NITEMS - i);
+            }
+            if (extsort_add_uint64_t(&es, arr + i, n) != 0)
+            {
+                fprintf(stderr, "%s : Unable to add items\n", __func__);
+                ++errors;
+            }
+        }
+        if (extsort_save_binsrc1(&es, file, &nrows) != 0)
+        {
+            fprintf(stderr, "%s (maxmem=%" PRIu64 ", unique=%" PRIu8 ") : Unable to save %s\n", __func__, maxmem, unique, file);
+            ++errors;
+        }
+        if (nrows != nexp)
+        {
+            fprintf(stderr, "%s (maxmem=%" PRIu64 ", unique=%" PRIu8 ") : Expected %" PRIu64 " rows, got %" PRIu64 "\n", __func__, maxmem, unique, nexp, nrows);
+            ++errors;
+        }
+        errors += check_binsrc1_file(__func__, file, exp, nexp);
+        extsort_free(&es);
+    }
+    free(arr);
+    free(exp);
+    return errors;
+}
+
+int test_extsort_empty()
+{
+    int errors = 0;
+    extsort_t es;
+    uint64_t nrows = 1;
+    if ((extsort_init(&es, 0, NULL, 1, 1) != 0) || (extsort_save_binsrc1(&es, "test_extsort_empty.bin", &nrows) != 0) || (nrows != 0))
+    {
+        fprintf(stderr, "%s : Unexpected result\n", __func__);
+        ++errors;
+    }
+    extsort_free(&es);
+    errors += check_binsrc1_file(__func__, "test_extsort_empty.bin", NULL, 0);
+    return errors;
+}
+
+int test_extsort_file_uint64_t()
+{
+    int errors = 0;
+    const char *infile = "test_extsort.raw";
+    const char *outfile = "test_extsort_file.bin";
+    uint64_t *arr = (uint64_t *)malloc(TEST_EXTSORT_NITEMS * sizeof(uint64_t));
+    uint64_t *exp = (uint64_t *)malloc(TEST_EXTSORT_NITEMS * sizeof(uint64_t));
+    gen_keys(arr, TEST_EXTSORT_NITEMS, 0x2545f4914f6cdd1d);
+    uint64_t nexp = gen_expected(arr, TEST_EXTSORT_NITEMS, 1, exp);
+    FILE *fp = fopen(infile, "wb");
+    if ((fp == NULL) || (fwrite(arr, sizeof(uint64_t), TEST_EXTSORT_NITEMS, fp) != TEST_EXTSORT_NITEMS) || (fclose(fp) != 0))
+    {
+        fprintf(stderr, "%s : Unable to write %s\n", __func__, infile);
+        free(arr);
+        free(exp);
+        return 1;
+    }
+    uint64_t nrows = 0;
+    if ((extsort_file_uint64_t(infile, outfile, 100000, ".", 2, 1, &nrows) != 0) || (nrows != nexp))
+    {
+        fprintf(stderr, "%s : Expected %" PRIu64 " rows, got %" PRIu64 "\n", __func__, nexp, nrows);
+        ++errors;
+    }
+    errors += check_binsrc1_file(__func__, outfile, exp, nexp);
+    if (extsort_file_uint64_t("missing.raw", outfile, 100000, NULL, 1, 0, &nrows) == 0)
+    {
+        fprintf(stderr, "%s : Expected error for a missing file\n", __func__);
+        ++errors;
+    }
+    free(arr);
+    free(exp);
+    return errors;
+}
+
+typedef struct test_kv_t
+{
+    uint64_t key;
+    uint64_t val;
+} test_kv_t;
+
+typedef struct test_kv_out_t
+{
+    test_kv_t *kv;
+    uint64_t n;
+    uint64_t max;
+} test_kv_out_t;
+
+static int cmp_kv(const void *a, const void *b)
+{
+    const test_kv_t *x = (const test_kv_t *)a;
+    const test_kv_t *y = (const test_kv_t *)b;
+    if (x->key != y->key)
+    {
+        return (x->key > y->key) ? 1 : -1;
+    }
+    return (x->val > y->val) - (x->val < y->val);
+}
+
+static int put_kv(void *ctx, uint64_t key, uint64_t val)
+{
+    test_kv_out_t *out = (test_kv_out_t *)ctx;
+    if (out->n == out->max)
+    {
+        return 1;
+    }
+    out->kv[out->n].key = key;
+    out->kv[out->n].val = val;
+    out->n++;
+    return 0;
+}
+
+int test_extsort_kv(uint64_t maxmem, uint64_t maxitems, uint32_t nthreads)
+{
+    int errors = 0;
+    uint64_t nitems = 50021;
+    uint64_t *key = (uint64_t *)malloc(nitems * sizeof(uint64_t));
+    uint64_t *val = (uint64_t *)malloc(nitems * sizeof(uint64_t));
+    test_kv_t *exp = (test_kv_t *)malloc(nitems * sizeof(test_kv_t));
+    test_kv_out_t out = {(test_kv_t *)malloc(nitems * sizeof(test_kv_t)), 0, nitems};
+    gen_keys(key, nitems, 0x2545f4914f6cdd1d);
+    uint64_t i, j, nexp, seed = 0x9e3779b97f4a7c15;
+    for (i = 0; i < nitems; i++)
+    {
+        val[i] = (test_rand(&seed) % 5); // equal keys with different values and duplicate pairs
+        exp[i].key = key[i];
+        exp[i].val = val[i];
+    }
+    qsort(exp, nitems, sizeof(test_kv_t), cmp_kv);
+    extsort_t es;
+    uint8_t unique;
+    for (unique = 0; unique < 2; unique++)
+    {
+        nexp = nitems;
+        if (unique)
+        {
+            for (i = 1, j = 0; i < nitems; i++)
+            {
+                if (cmp_kv(&exp[i], &exp[j]) != 0)
+                {
+                    exp[++j] = exp[i];
+                }
+            }
+            nexp = (j + 1);
+        }
+        if (extsort_init_kv(&es, maxmem, NULL, nthreads, unique) != 0)
+        {
+            fprintf(stderr, "%s (%" PRIu64 ", %" PRIu64 ", %" PRIu8 ") : Unable to initialize\n", __func__, maxmem, maxitems, unique);
+            ++errors;
+            break;
+        }
+        if ((maxitems > 0) && (maxitems < es.maxitems))
+        {
+            es.maxitems = maxitems;
+        }
+        out.n = 0;
+        if ((extsort_add_uint64_t(&es, key, 1) == 0) || (extsort_add_kv_uint64_t(&es, key, val, nitems) != 0) || (extsort_merge(&es, put_kv, &out) != 0))
+        {
+            fprintf(stderr, "%s (%" PRIu64 ", %" PRIu64 ", %" PRIu8 ") : Unexpected sort result\n", __func__, maxmem, maxitems, unique);
+            ++errors;
+        }
+        else if (out.n != nexp)
+        {
+            fprintf(stderr, "%s (%" PRIu64 ", %" PRIu64 ", %" PRIu8 ") : Expected %" PRIu64 " pairs, got %" PRIu64 "\n", __func__, maxmem, maxitems, unique, nexp, out.n);
+            ++errors;
+        }
+        else
+        {
+            for (i = 0; i < nexp; i++)
+            {
+                if (cmp_kv(&out.kv[i], &exp[i]) != 0)
+                {
+                    fprintf(stderr, "%s (%" PRIu64 ", %" PRIu64 ", %" PRIu8 ") : Expected %016" PRIx64 ":%" PRIu64 ", got %016" PRIx64 ":%" PRIu64 " at row %" PRIu64 "\n", __func__, maxmem, maxitems, unique, exp[i].key, exp[i].val, out.kv[i].key, out.kv[i].val, i);
+                    ++errors;
+                    break;
+                }
+            }
+        }
+        extsort_free(&es);
+    }
+    free(key);
+    free(val);
+    free(exp);
+    free(out.kv);
+    return errors;
+}
+
+void benchmark_extsort()
+{
+    const uint64_t nitems = 2000000;
+    uint64_t *arr = (uint64_t *)malloc(nitems * sizeof(uint64_t));
+    gen_keys(arr, nitems, 0x9e3779b97f4a7c15);
+    extsort_t es;
+    uint64_t nrows, tstart, tend;
+    tstart = get_time();
+    extsort_init(&es, (nitems * 4), NULL, 1, 0); // 4 runs
+    extsort_add_uint64_t(&es, arr, nitems);
+    extsort_save_binsrc1(&es, "test_extsort.bin", &nrows);
+    extsort_free(&es);
+    tend = get_time();
+    fprintf(stdout, " * %s : %" PRIu64 " ns/op\n", __func__, (tend - tstart) / nitems);
+    free(arr);
+}
+
+int main()
+{
+    int errors = 0;
+
+    errors += test_extsort(64 << 20, 1);   // in memory
+    errors += test_extsort(1 << 20, 2);    // few runs, shared read buffers
+    errors += test_extsort(16 * 1024, 1);  // many small runs
+    errors += test_extsort_empty();
+    errors += test_extsort_file_uint64_t();
+    errors += test_extsort_kv(64 << 20, 0, 2);  // in memory
+    errors += test_extsort_kv(1 << 20, 0, 1);   // few runs
+    errors += test_extsort_kv(1 << 20, 997, 1); // many small runs, separate read buffers
+
+    benchmark_extsort();
+
+    return errors;
+}
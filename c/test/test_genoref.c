@@ -208,6 +208,130 @@ void benchmark_get_genoref_seq(mmfile_t mf)
     fprintf(stdout, " * %s : %lu ns/op\n", __func__, (tend - tstart)/(size*25));
 }
 
+// reference implementation of the IUPAC consistency check
+static int ref_check_reference_char(char uref, char gref)
+{
+    if (uref == gref)
+    {
+        return 0;
+    }
+    if ((uref == 'N')
+            || (gref == 'N')
+            || ((uref == 'B') && (gref != 'A'))
+            || ((gref == 'B') && (uref != 'A'))
+            || ((uref == 'D') && (gref != 'C'))
+            || ((gref == 'D') && (uref != 'C'))
+            || ((uref == 'H') && (gref != 'G'))
+            || ((gref == 'H') && (uref != 'G'))
+            || ((uref == 'V') && (gref != 'T'))
+            || ((gref == 'V') && (uref != 'T'))
+            || ((uref == 'W') && ((gref == 'A') || (gref == 'T')))
+            || ((gref == 'W') && ((uref == 'A') || (uref == 'T')))
+            || ((uref == 'S') && ((gref == 'C') || (gref == 'G')))
+            || ((gref == 'S') && ((uref == 'C') || (uref == 'G')))
+            || ((uref == 'M') && ((gref == 'A') || (gref == 'C')))
+            || ((gref == 'M') && ((uref == 'A') || (uref == 'C')))
+            || ((uref == 'K') && ((gref == 'G') || (gref == 'T')))
+            || ((gref == 'K') && ((uref == 'G') || (uref == 'T')))
+            || ((uref == 'R') && ((gref == 'A') || (gref == 'G')))
+            || ((gref == 'R') && ((uref == 'A') || (uref == 'G')))
+            || ((uref == 'Y') && ((gref == 'C') || (gref == 'T')))
+            || ((gref == 'Y') && ((uref == 'C') || (uref == 'T'))))
+    {
+        return NORM_VALID;
+    }
+    return NORM_INVALID;
+}
+
+int test_check_reference_char()
+{
+    int errors = 0;
+    int u, g, ret, exp;
+    for (u = 0; u < 256; u++)
+    {
+        for (g = 0; g < 256; g++)
+        {
+            exp = ref_check_reference_char((char)u, (char)g);
+            ret = check_reference_char((char)u, (char)g);
+            if (ret != exp)
+            {
+                fprintf(stderr, "%s (%d %d): Expected %d, got %d\n", __func__, u, g, exp, ret);
+                ++errors;
+            }
+        }
+    }
+    return errors;
+}
+
+int test_check_reference_seq()
+{
+    int errors = 0;
+    char gseq[200], ref[200];
+    size_t size, i, k;
+    int ret;
+    static const char bases[] = "ACGT";
+    for (i = 0; i < sizeof(gseq); i++)
+    {
+        gseq[i] = bases[((i * 7) & 3)];
+    }
+    for (size = 1; size <= sizeof(gseq); size++)
+    {
+        for (k = 0; k < size; k += 13)
+        {
+            // exact match with lowercase letters
+            for (i = 0; i < size; i++)
+            {
+                ref[i] = (char)(((i % 3) == 0) ? (gseq[i] | 0x20) : gseq[i]);
+            }
+            ret = check_reference_seq(gseq, ref, size);
+            if (ret != 0)
+            {
+                fprintf(stderr, "%s (%lu): Expected 0, got %d\n", __func__, size, ret);
+                ++errors;
+            }
+            // consistent IUPAC code at position k
+            ref[k] = 'N';
+            ret = check_reference_seq(gseq, ref, size);
+            if (ret != NORM_VALID)
+            {
+                fprintf(stderr, "%s (%lu %lu): Expected %d, got %d\n", __func__, size, k, NORM_VALID, ret);
+                ++errors;
+            }
+            // mismatch at the last position
+            ref[(size - 1)] = ((gseq[(size - 1)] == 'A') ? 'C' : 'A');
+            ret = check_reference_seq(gseq, ref, size);
+            if (ret != NORM_INVALID)
+            {
+                fprintf(stderr, "%s (%lu %lu): Expected %d, got %d\n", __func__, size, k, NORM_INVALID, ret);
+                ++errors;
+            }
+        }
+    }
+    return errors;
+}
+
+void benchmark_check_reference_seq()
+{
+    uint64_t tstart, tend;
+    char gseq[1000], ref[1000];
+    size_t i;
+    int j, sum = 0, size = 100000;
+    static const char bases[] = "ACGTacgt";
+    for (i = 0; i < sizeof(gseq); i++)
+    {
+        ref[i] = bases[((i * 7) & 7)];
+        gseq[i] = (char)aztoupper(ref[i]);
+    }
+    tstart = get_time();
+    for (j = 0; j < size; j++)
+    {
+        ref[(j % 1000)] = gseq[(j % 1000)];
+        sum += check_reference_seq(gseq, ref, sizeof(ref));
+    }
+    tend = get_time();
+    fprintf(stdout, " * %s : %lu ns/op (1000 nucleotides) (%d)\n", __func__, (tend - tstart)/size, sum);
+}
+
 int test_check_reference(mmfile_t mf)
 {
     int errors = 0;
@@ -278,6 +402,161 @@ int test_check_reference(mmfile_t mf)
     return errors;
 }
 
+int test_genoref_2bit(mmfile_t mf, mmfile_t mf2)
+{
+    int errors = 0;
+    int ret, exp;
+    uint8_t chrom;
+    uint32_t pos;
+    size_t len, k;
+    char ref[8];
+    static const char iupac[] = "ACGTNBDHVWSMKRYZ";
+    if ((mf2.ncols != GENOREF_2BIT_NCOLS) || (mf2.nrows != 26))
+    {
+        fprintf(stderr, "%s : Invalid 2-bit genoref header: %u columns, %" PRIu64 " rows\n", __func__, mf2.ncols, mf2.nrows);
+        return 1;
+    }
+    for (chrom = 0; chrom <= 26; chrom++)
+    {
+        for (pos = 0; pos <= 28; pos++)
+        {
+            if (get_genoref_2bit_seq(mf2, chrom, pos) != get_genoref_seq(mf, chrom, pos))
+            {
+                fprintf(stderr, "%s (%d %u): Expected reference '%c', got '%c'\n", __func__, chrom, pos, get_genoref_seq(mf, chrom, pos), get_genoref_2bit_seq(mf2, chrom, pos));
+                ++errors;
+            }
+            if ((chrom == 0) || (chrom > 25))
+            {
+                continue;
+            }
+            for (len = 1; len <= 4; len++)
+            {
+                // sequences taken from the reference with one base replaced by all the IUPAC codes
+                for (k = 0; k < (sizeof(iupac) - 1); k++)
+                {
+                    for (ret = 0; ret < (int)len; ret++)
+                    {
+                        ref[ret] = get_genoref_seq(mf, chrom, pos + (uint32_t)ret);
+                    }
+                    ref[(len - 1)] = iupac[k];
+                    exp = check_reference(mf, chrom, pos, ref, len);
+                    ret = check_reference_2bit(mf2, chrom, pos, ref, len);
+                    if (ret != exp)
+                    {
+                        fprintf(stderr, "%s (%d %u %.*s): Expected %d, got %d\n", __func__, chrom, pos, (int)len, ref, exp, ret);
+                        ++errors;
+                    }
+                }
+            }
+        }
+    }
+    return errors;
+}
+
+void benchmark_get_genoref_2bit_seq(mmfile_t mf)
+{
+    uint8_t chrom;
+    uint64_t tstart, tend;
+    int i;
+    int size = 100000;
+    tstart = get_time();
+    for (i=0 ; i < size; i++)
+    {
+        for (chrom = 1; chrom <= 25; chrom++)
+        {
+            get_genoref_2bit_seq(mf, chrom, 1);
+        }
+    }
+    tend = get_time();
+    fprintf(stdout, " * %s : %lu ns/op\n", __func__, (tend - tstart)/(size*25));
+}
+
+int test_genoref_2bit_random()
+{
+    int errors = 0;
+    static const char bases[] = "ACGTacgt";
+    static const char iupac[] = "NBDHVWSMKRYnr";
+    mmfile_t mf = {0};
+    mmfile_t mf2 = {0};
+    uint64_t seed = 0x2545f4914f6cdd1d;
+    uint64_t i, k, n, size = 0;
+    uint8_t chrom;
+    uint8_t *src = (uint8_t *)malloc(25 * 5000);
+    mf.ncols = 27;
+    for (chrom = 0; chrom <= 26; chrom++)
+    {
+        mf.index[chrom] = size;
+        if ((chrom == 0) || (chrom == 26))
+        {
+            continue;
+        }
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        n = seed % 5000;
+        for (i = 0; i < n;)
+        {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            if ((seed & 0xFFF0) == 0)
+            {
+                for (k = (seed % 100); (k > 0) && (i < n); k--)
+                {
+                    src[(size + i++)] = 'N'; // N run
+                }
+                continue;
+            }
+            src[(size + i++)] = (uint8_t)(((seed & 0xFF00) == 0) ? iupac[(seed % (sizeof(iupac) - 1))] : bases[(seed % (sizeof(bases) - 1))]);
+        }
+        size += n;
+    }
+    mf.src = src;
+    mf.size = size;
+    if (genoref_to_2bit_file(mf, "genoref_random.2bit.bin") == 0)
+    {
+        fprintf(stderr, "%s : Unable to write the 2-bit genoref file\n", __func__);
+        free(src);
+        return 1;
+    }
+    mmap_genoref_2bit_file("genoref_random.2bit.bin", &mf2);
+    if (mf2.size > ((size / 4) + (size / 16) + 1024))
+    {
+        fprintf(stderr, "%s : Unexpected 2-bit genoref file size %" PRIu64 " for %" PRIu64 " nucleotides\n", __func__, mf2.size, size);
+        ++errors;
+    }
+    char exp, ref;
+    for (chrom = 1; chrom <= 25; chrom++)
+    {
+        for (i = 0; i <= (mf.index[(chrom + 1)] - mf.index[chrom]); i++)
+        {
+            exp = get_genoref_seq(mf, chrom, (uint32_t)i);
+            exp = (char)aztoupper(exp);
+            ref = get_genoref_2bit_seq(mf2, chrom, (uint32_t)i);
+            if (ref != exp)
+            {
+                fprintf(stderr, "%s (%d %" PRIu64 "): Expected reference '%c', got '%c'\n", __func__, chrom, i, exp, ref);
+                ++errors;
+                break;
+            }
+        }
+        n = mf.index[(chrom + 1)] - mf.index[chrom];
+        if ((n > 0) && (check_reference_2bit(mf2, chrom, 0, (const char *)(src + mf.index[chrom]), (size_t)n) != 0))
+        {
+            fprintf(stderr, "%s (%d): The reference sequence does not match itself\n", __func__, chrom);
+            ++errors;
+        }
+        if (check_reference_2bit(mf2, chrom, 0, "A", (size_t)n + 1) != NORM_WRONGPOS)
+        {
+            fprintf(stderr, "%s (%d): Expected invalid position\n", __func__, chrom);
+            ++errors;
+        }
+    }
+    munmap_binfile(mf2);
+    free(src);
+    return errors;
+}
+
 int test_flip_allele()
 {
     int errors = 0;
@@ -327,7 +606,7 @@ int test_normalize_variant(mmfile_t mf)
         char       ref[256];
         char       alt[256];
     } test_norm_t;
-    static test_norm_t test_norm[12] =
+    test_norm_t test_norm[12] =
     {
         {-2, 1, 26, 26, 1, 1, 1, 1, "A",  "C",  "A",      "C"     },  // invalid position
         {-1, 1,  0,  0, 1, 1, 1, 1, "J",  "C",  "J",      "C"     },  // invalid reference
@@ -382,9 +661,13 @@ int test_normalize_variant(mmfile_t mf)
 int test_normalized_variantkey(mmfile_t mf)
 {
     int errors = 0;
-    int ret;
+    int ret, aret;
     int i;
-    uint64_t vk;
+    uint64_t vk, avk;
+    uint32_t apos;
+    allele_arena_t arena = {0};
+    const char *nref, *nalt;
+    size_t nsizeref, nsizealt;
     typedef struct test_nvk_t
     {
         int        exp;
@@ -402,7 +685,7 @@ int test_normalized_variantkey(mmfile_t mf)
         char       ref[256];
         char       alt[256];
     } test_nvk_t;
-    static test_nvk_t test_nvk[12] =
+    test_nvk_t test_nvk[12] =
     {
         {-2, "1",  0, 26, 26, 1, 1, 1, 1, 0x0800000d08880000, "A",  "C",  "A",      "C"     },  // invalid position
         {-1, "1",  1,  1,  0, 1, 1, 1, 1, 0x08000000736a947f, "J",  "C",  "J",      "C"     },  // invalid reference
@@ -419,6 +702,15 @@ int test_normalized_variantkey(mmfile_t mf)
     };
     for (i = 0; i < 12; i++)
     {
+        apos = test_nvk[i].pos;
+        aret = 0;
+        avk = normalized_variantkey_arena(mf, test_nvk[i].chrom, strlen(test_nvk[i].chrom), &apos, test_nvk[i].posindex, test_nvk[i].ref, test_nvk[i].sizeref, test_nvk[i].alt, test_nvk[i].sizealt, &arena, &nref, &nsizeref, &nalt, &nsizealt, &aret);
+        if ((avk != test_nvk[i].vk) || (aret != test_nvk[i].exp) || (apos != test_nvk[i].exp_pos) || (nsizeref != test_nvk[i].exp_sizeref) || (nsizealt != test_nvk[i].exp_sizealt)
+                || (strcmp(nref, test_nvk[i].exp_ref) != 0) || (strcmp(nalt, test_nvk[i].exp_alt) != 0))
+        {
+            fprintf(stderr, "%s (%d): Unexpected arena result %016" PRIx64 " %d %" PRIu32 " %s %s\n", __func__, i, avk, aret, apos, nref, nalt);
+            ++errors;
+        }
         ret = 0;
         vk = normalized_variantkey(mf, test_nvk[i].chrom, strlen(test_nvk[i].chrom), &test_nvk[i].pos, test_nvk[i].posindex, test_nvk[i].ref, &test_nvk[i].sizeref, test_nvk[i].alt, &test_nvk[i].sizealt, &ret);
         if (vk != test_nvk[i].vk)
@@ -457,9 +749,307 @@ int test_normalized_variantkey(mmfile_t mf)
             ++errors;
         }
     }
+    allele_arena_free(&arena);
+    return errors;
+}
+
+// compare normalize_variant_cols with normalize_variant on random variants
+int test_normalize_variant_cols(mmfile_t mf)
+{
+    int errors = 0;
+    const uint64_t nrows = 5000;
+    static const char bases[] = "ACGTacgtNMKAAA";
+    uint8_t *chrom = (uint8_t *)malloc(nrows);
+    uint32_t *pos = (uint32_t *)malloc(nrows * sizeof(uint32_t));
+    uint32_t *sizeref = (uint32_t *)malloc(nrows * sizeof(uint32_t));
+    uint32_t *sizealt = (uint32_t *)malloc(nrows * sizeof(uint32_t));
+    uint64_t *refoffset = (uint64_t *)malloc(nrows * sizeof(uint64_t));
+    uint64_t *altoffset = (uint64_t *)malloc(nrows * sizeof(uint64_t));
+    char *ref = (char *)malloc(nrows * 8);
+    char *alt = (char *)malloc(nrows * 8);
+    uint64_t seed = 0x9e3779b97f4a7c15;
+    uint64_t i, j, roff = 0, aoff = 0;
+    for (i = 0; i < nrows; i++)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        chrom[i] = (uint8_t)(1 + (seed % 25));
+        pos[i] = (uint32_t)((seed >> 8) % (27 - chrom[i]));
+        sizeref[i] = (uint32_t)((seed >> 16) % 6);
+        sizealt[i] = (uint32_t)((seed >> 24) % 6);
+        refoffset[i] = roff;
+        altoffset[i] = aoff;
+        for (j = 0; j < sizeref[i]; j++)
+        {
+            // mostly take the bases from the reference to exercise all the normalization steps
+            ref[roff] = ((seed >> (32 + j)) & 1) ? get_genoref_seq(mf, chrom[i], (pos[i] + (uint32_t)j)) : 0;
+            if (ref[roff] == 0)
+            {
+                ref[roff] = bases[((seed >> (40 + j)) % (sizeof(bases) - 1))];
+            }
+            roff++;
+        }
+        for (j = 0; j < sizealt[i]; j++)
+        {
+            alt[aoff] = ((seed >> (36 + j)) & 1) ? get_genoref_seq(mf, chrom[i], (pos[i] + (uint32_t)j + 1)) : 0;
+            if (alt[aoff] == 0)
+            {
+                alt[aoff] = bases[((seed >> (48 + j)) % (sizeof(bases) - 1))];
+            }
+            aoff++;
+        }
+    }
+    variantkey_cols_t vc = {chrom, pos, ref, refoffset, sizeref, alt, altoffset, sizealt, roff, aoff, nrows};
+    uint64_t bufsize = normalize_variant_cols_bufsize(vc);
+    normalized_cols_t nc;
+    nc.pos = (uint32_t *)malloc(nrows * sizeof(uint32_t));
+    nc.ref = (char *)malloc(bufsize);
+    nc.refoffset = (uint64_t *)malloc(nrows * sizeof(uint64_t));
+    nc.sizeref = (uint32_t *)malloc(nrows * sizeof(uint32_t));
+    nc.alt = (char *)malloc(bufsize);
+    nc.altoffset = (uint64_t *)malloc(nrows * sizeof(uint64_t));
+    nc.sizealt = (uint32_t *)malloc(nrows * sizeof(uint32_t));
+    nc.status = (int *)malloc(nrows * sizeof(int));
+    nc.refbufsize = bufsize;
+    nc.altbufsize = bufsize;
+    uint64_t *vk = (uint64_t *)malloc(nrows * sizeof(uint64_t));
+    uint64_t n = normalized_variantkey_cols(mf, vc, nc, vk);
+    if (n != nrows)
+    {
+        fprintf(stderr, "%s : Expected %" PRIu64 " rows, got %" PRIu64 "\n", __func__, nrows, n);
+        ++errors;
+    }
+    char eref[ALLELE_MAXSIZE], ealt[ALLELE_MAXSIZE];
+    size_t esizeref, esizealt;
+    uint32_t epos;
+    int ret;
+    for (i = 0; i < n; i++)
+    {
+        memcpy(eref, ref + refoffset[i], sizeref[i]);
+        memcpy(ealt, alt + altoffset[i], sizealt[i]);
+        eref[sizeref[i]] = 0;
+        ealt[sizealt[i]] = 0;
+        esizeref = sizeref[i];
+        esizealt = sizealt[i];
+        epos = pos[i];
+        ret = normalize_variant(mf, chrom[i], &epos, eref, &esizeref, ealt, &esizealt);
+        if ((ret != nc.status[i]) || (epos != nc.pos[i]) || (esizeref != nc.sizeref[i]) || (esizealt != nc.sizealt[i])
+                || (memcmp(eref, nc.ref + nc.refoffset[i], esizeref) != 0) || (memcmp(ealt, nc.alt + nc.altoffset[i], esizealt) != 0))
+        {
+            fprintf(stderr, "%s (%" PRIu64 "): Expected %d %" PRIu32 " %s %s, got %d %" PRIu32 " %.*s %.*s\n", __func__, i, ret, epos, eref, ealt,
+                    nc.status[i], nc.pos[i], (int)nc.sizeref[i], nc.ref + nc.refoffset[i], (int)nc.sizealt[i], nc.alt + nc.altoffset[i]);
+            ++errors;
+            continue;
+        }
+        if ((ret >= 0) && (vk[i] != encode_variantkey(chrom[i], epos, encode_refalt(eref, esizeref, ealt, esizealt))))
+        {
+            fprintf(stderr, "%s (%" PRIu64 "): Unexpected VariantKey %016" PRIx64 "\n", __func__, i, vk[i]);
+            ++errors;
+        }
+    }
+    // small arenas stop the normalization early
+    nc.refbufsize = 10;
+    n = normalize_variant_cols(mf, vc, nc);
+    if ((n == 0) || (n >= nrows) || (nc.refoffset[(n - 1)] + nc.sizeref[(n - 1)] > 10))
+    {
+        fprintf(stderr, "%s : Unexpected number of rows with a small arena: %" PRIu64 "\n", __func__, n);
+        ++errors;
+    }
+    free(chrom);
+    free(pos);
+    free(sizeref);
+    free(sizealt);
+    free(refoffset);
+    free(altoffset);
+    free(ref);
+    free(alt);
+    free(nc.pos);
+    free(nc.ref);
+    free(nc.refoffset);
+    free(nc.sizeref);
+    free(nc.alt);
+    free(nc.altoffset);
+    free(nc.sizealt);
+    free(nc.status);
+    free(vk);
+    return errors;
+}
+
+// compare normalize_variant and normalize_variant_arena on long alleles (above ALLELE_MAXSIZE)
+int test_normalize_variant_long(mmfile_t mf)
+{
+    int errors = 0;
+    const uint32_t size = 20000;
+    const size_t maxlen = 6000;
+    static const char bases[] = "ACGT";
+    uint64_t seed = 0x3c6ef372fe94f82b;
+    uint64_t i;
+    uint32_t j, pos, epos, apos, len, del;
+    size_t sizeref, sizealt, esizeref, esizealt, asizeref, asizealt;
+    const char *aref, *aalt;
+    allele_arena_t arena = {0};
+    char *ref = (char *)malloc(maxlen + 2);
+    char *alt = (char *)malloc(maxlen + 2);
+    char *eref = (char *)malloc(maxlen + 2);
+    char *ealt = (char *)malloc(maxlen + 2);
+    int ret, aret, op;
+    for (i = 0; i < 300; i++)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        len = (uint32_t)(1 + ((seed >> 8) % (maxlen - 1)));
+        pos = (uint32_t)((seed >> 24) % (size - len));
+        del = (uint32_t)(1 + ((seed >> 40) % len));
+        op = (int)(i % 5);
+        // REF from the reference and ALT with a deletion of del bases inside REF
+        for (j = 0; j < len; j++)
+        {
+            ref[j] = get_genoref_seq_any(mf, 1, (pos + j));
+        }
+        sizeref = len;
+        sizealt = 0;
+        for (j = 0; j < len; j++)
+        {
+            if ((j < ((len - del) / 2)) || (j >= (((len - del) / 2) + del)))
+            {
+                alt[sizealt++] = ref[j];
+            }
+        }
+        if (op == 1)
+        {
+            alt[sizealt++] = bases[(seed % 4)]; // mismatch at the end
+        }
+        if ((op == 2) || (op == 4))
+        {
+            swap_alleles(ref, &sizeref, alt, &sizealt);
+        }
+        if ((op == 3) || (op == 4))
+        {
+            flip_allele(ref, sizeref);
+            flip_allele(alt, sizealt);
+        }
+        ref[sizeref] = 0;
+        alt[sizealt] = 0;
+        memcpy(eref, ref, sizeref + 1);
+        memcpy(ealt, alt, sizealt + 1);
+        esizeref = sizeref;
+        esizealt = sizealt;
+        epos = pos;
+        ret = normalize_variant(mf, 1, &epos, eref, &esizeref, ealt, &esizealt);
+        apos = pos;
+        aret = normalize_variant_arena(mf, 1, &apos, ref, sizeref, alt, sizealt, &arena, &aref, &asizeref, &aalt, &asizealt);
+        if ((ret != aret) || (epos != apos) || (esizeref != asizeref) || (esizealt != asizealt)
+                || (strcmp(eref, aref) != 0) || (strcmp(ealt, aalt) != 0))
+        {
+            fprintf(stderr, "%s (%" PRIu64 "): Expected %d %" PRIu32 " %lu %lu, got %d %" PRIu32 " %lu %lu\n", __func__, i, ret, epos, esizeref, esizealt, aret, apos, asizeref, asizealt);
+            ++errors;
+            continue;
+        }
+        if ((aret < 0) || (check_reference_any(mf, 1, apos, aref, asizeref) < 0) || ((asizeref - asizealt) != (size_t)(del - (op == 1))))
+        {
+            fprintf(stderr, "%s (%" PRIu64 "): Unexpected normalized deletion %d %" PRIu32 " %lu %lu\n", __func__, i, aret, apos, asizeref, asizealt);
+            ++errors;
+        }
+    }
+    // the arena is not reallocated for smaller alleles
+    const char *buf = arena.buf;
+    apos = 3;
+    aret = normalize_variant_arena(mf, 1, &apos, "AC", 2, "A", 1, &arena, &aref, &asizeref, &aalt, &asizealt);
+    if ((arena.buf != buf) || (aref != buf))
+    {
+        fprintf(stderr, "%s : The arena has been reallocated\n", __func__);
+        ++errors;
+    }
+    allele_arena_free(&arena);
+    free(ref);
+    free(alt);
+    free(eref);
+    free(ealt);
     return errors;
 }
 
+// run test_normalize_variant_long on a random chromosome 1 with both genoref formats
+int test_normalize_variant_long_random()
+{
+    int errors = 0;
+    static const char bases[] = "ACGT";
+    const uint64_t size = 20000;
+    uint64_t seed = 0xa54ff53a5f1d36f1;
+    uint64_t i;
+    mmfile_t mf = {0};
+    mmfile_t mf2 = {0};
+    uint8_t *src = (uint8_t *)malloc(size);
+    for (i = 0; i < size; i++)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        src[i] = (uint8_t)bases[(seed % 4)];
+    }
+    mf.src = src;
+    mf.size = size;
+    mf.ncols = 27;
+    for (i = 2; i <= 26; i++)
+    {
+        mf.index[i] = size;
+    }
+    errors += test_normalize_variant_long(mf);
+    if (genoref_to_2bit_file(mf, "genoref_long.2bit.bin") == 0)
+    {
+        fprintf(stderr, "%s : Unable to write the 2-bit genoref file\n", __func__);
+        free(src);
+        return (errors + 1);
+    }
+    mmap_genoref_2bit_file("genoref_long.2bit.bin", &mf2);
+    errors += test_normalize_variant_long(mf2);
+    munmap_binfile(mf2);
+    free(src);
+    return errors;
+}
+
+void benchmark_normalize_variant_arena(mmfile_t mf)
+{
+    allele_arena_t arena = {0};
+    const char *nref, *nalt;
+    size_t nsizeref, nsizealt;
+    uint32_t pos;
+    uint64_t tstart, tend;
+    int i;
+    int size = 100000;
+    tstart = get_time();
+    for (i=0 ; i < size; i++)
+    {
+        pos = 2;
+        normalize_variant_arena(mf, 1, &pos, "G", 1, "C", 1, &arena, &nref, &nsizeref, &nalt, &nsizealt);
+    }
+    tend = get_time();
+    fprintf(stdout, " * %s : %lu ns/op\n", __func__, (tend - tstart)/size);
+    allele_arena_free(&arena);
+}
+
+void benchmark_normalize_variant(mmfile_t mf)
+{
+    char ref[ALLELE_MAXSIZE], alt[ALLELE_MAXSIZE];
+    size_t sizeref, sizealt;
+    uint32_t pos;
+    uint64_t tstart, tend;
+    int i;
+    int size = 100000;
+    tstart = get_time();
+    for (i=0 ; i < size; i++)
+    {
+        pos = 2;
+        ref[0] = 'G';
+        alt[0] = 'C';
+        sizeref = sizealt = 1;
+        normalize_variant(mf, 1, &pos, ref, &sizeref, alt, &sizealt);
+    }
+    tend = get_time();
+    fprintf(stdout, " * %s : %lu ns/op\n", __func__, (tend - tstart)/size);
+}
+
 int main()
 {
     int errors = 0;
@@ -468,20 +1058,48 @@ int main()
     mmfile_t genoref = {0};
     mmap_genoref_file("genoref.bin", &genoref);
 
+    mmfile_t genoref2 = {0};
+    if (genoref_to_2bit_file(genoref, "genoref.2bit.bin") == 0)
+    {
+        fprintf(stderr, "Unable to write the 2-bit genoref file\n");
+        return 1;
+    }
+    mmap_genoref_2bit_file("genoref.2bit.bin", &genoref2);
+
     errors += test_aztoupper();
     errors += test_prepend_char();
     errors += test_swap_sizes();
     errors += test_swap_alleles();
     errors += test_get_genoref_seq(genoref);
+    errors += test_check_reference_char();
+    errors += test_check_reference_seq();
     errors += test_check_reference(genoref);
     errors += test_flip_allele();
     errors += test_normalize_variant(genoref);
     errors += test_normalized_variantkey(genoref);
+    errors += test_genoref_2bit(genoref, genoref2);
+    errors += test_genoref_2bit_random();
+    errors += test_normalize_variant_cols(genoref);
+    errors += test_normalize_variant_cols(genoref2);
+    errors += test_normalize_variant(genoref2);
+    errors += test_normalized_variantkey(genoref2);
+    errors += test_normalize_variant_long_random();
 
     benchmark_aztoupper();
     benchmark_prepend_char();
     benchmark_get_genoref_seq(genoref);
+    benchmark_get_genoref_2bit_seq(genoref2);
+    benchmark_check_reference_seq();
     benchmark_flip_allele();
+    benchmark_normalize_variant(genoref);
+    benchmark_normalize_variant_arena(genoref);
+
+    err = munmap_binfile(genoref2);
+    if (err != 0)
+    {
+        fprintf(stderr, "Got %d error while unmapping the 2-bit genoref file\n", err);
+        return 1;
+    }
 
     err = munmap_binfile(genoref);
     if (err != 0)
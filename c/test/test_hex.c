@@ -39,6 +39,7 @@
 #endif
 
 #include <errno.h>
+#include <fcntl.h>
 #include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
@@ -110,15 +111,255 @@ void benchmark_parse_hex_uint64_t()
     fprintf(stdout, " * %s : %lu ns/op (%" PRIx64 ")\n", __func__, (tend - tstart)/size, k);
 }
 
+static uint64_t test_rand(uint64_t *x)
+{
+    *x ^= *x << 13;
+    *x ^= *x >> 7;
+    *x ^= *x << 17;
+    return *x;
+}
+
+int test_hex_uint64_array()
+{
+    int errors = 0;
+    uint64_t src[37], seed = 0x0123456789abcdef;
+    char dst[(37 * 17)], exp[((37 * 17) + 1)];
+    uint64_t n, i;
+    size_t len;
+    for (i = 0; i < 37; i++)
+    {
+        src[i] = (i < 3) ? (0xFFFFFFFFFFFFFFFF * i) : test_rand(&seed);
+    }
+    for (n = 0; n <= 37; n += 5)
+    {
+        for (i = 0; i < n; i++)
+        {
+            sprintf((exp + (i * 16)), "%016" PRIx64, src[i]);
+        }
+        len = hex_uint64_array(src, n, dst, 0);
+        if ((len != (n * 16)) || (memcmp(dst, exp, len) != 0))
+        {
+            fprintf(stderr, "%s (%" PRIu64 ") Unexpected packed hex array\n", __func__, n);
+            ++errors;
+        }
+        for (i = 0; i < n; i++)
+        {
+            sprintf((exp + (i * 17)), "%016" PRIx64 "\n", src[i]);
+        }
+        len = hex_uint64_array(src, n, dst, '\n');
+        if ((len != (n * 17)) || (memcmp(dst, exp, len) != 0))
+        {
+            fprintf(stderr, "%s (%" PRIu64 ") Unexpected hex lines\n", __func__, n);
+            ++errors;
+        }
+    }
+    return errors;
+}
+
+int test_parse_hex_uint64_array()
+{
+    int errors = 0;
+    static const char invalid[] = {'/', ':', '@', 'G', '`', 'g', ' ', '\n', 0, (char)0x80, (char)0xC6};
+    uint64_t src[37], dst[37], seed = 0xfedcba9876543210;
+    char hex[(37 * 17)];
+    uint64_t n, i, j;
+    for (i = 0; i < 37; i++)
+    {
+        src[i] = test_rand(&seed);
+    }
+    hex_uint64_array(src, 37, hex, '\n');
+    hex[1] = 'A'; // uppercase
+    src[0] = ((src[0] & 0xF0FFFFFFFFFFFFFF) | 0x0A00000000000000);
+    for (i = 0; i < 37; i++)
+    {
+        dst[i] = 0;
+    }
+    n = parse_hex_uint64_array(hex, 37, dst, 1);
+    if ((n != 37) || (memcmp(src, dst, sizeof(src)) != 0))
+    {
+        fprintf(stderr, "%s Unexpected values (%" PRIu64 ")\n", __func__, n);
+        ++errors;
+    }
+    for (j = 0; j < sizeof(invalid); j++)
+    {
+        i = (j * 3);
+        char c = hex[((i * 17) + (j % 16))];
+        hex[((i * 17) + (j % 16))] = invalid[j];
+        n = parse_hex_uint64_array(hex, 37, dst, 1);
+        if (n != i)
+        {
+            fprintf(stderr, "%s (%02x) Expecting %" PRIu64 " valid values, got %" PRIu64 "\n", __func__, (uint8_t)invalid[j], i, n);
+            ++errors;
+        }
+        hex[((i * 17) + (j % 16))] = c;
+    }
+    hex_uint64_array(src, 37, hex, 0);
+    n = parse_hex_uint64_array(hex, 37, dst, 0);
+    if ((n != 37) || (memcmp(src, dst, sizeof(src)) != 0))
+    {
+        fprintf(stderr, "%s Unexpected packed values (%" PRIu64 ")\n", __func__, n);
+        ++errors;
+    }
+    return errors;
+}
+
+int test_parse_hex_uint64_lines()
+{
+    int errors = 0;
+    static const char lines[] = "0123456789abcdef\n00000000000000ff\nF\n\n1a2B\r\n0123456789ABCDEF\r\nffffffffffffffff\n1234";
+    static const uint64_t exp[] = {0x0123456789abcdef, 0xff, 0xf, 0x1a2b, 0x0123456789abcdef, 0xffffffffffffffff};
+    uint64_t dst[64];
+    size_t pos, len = strlen(lines);
+    uint64_t n;
+    n = parse_hex_uint64_lines(lines, len, dst, &pos);
+    if ((n != 6) || (memcmp(dst, exp, sizeof(exp)) != 0) || (pos != (len - 4)))
+    {
+        fprintf(stderr, "%s Unexpected values (%" PRIu64 ", %lu)\n", __func__, n, pos);
+        ++errors;
+    }
+    static const char bad[] = "0123456789abcdef\n00000000000000ff\n0123456789abcdeg\nff\n";
+    n = parse_hex_uint64_lines(bad, strlen(bad), dst, &pos);
+    if ((n != 2) || (pos != 34))
+    {
+        fprintf(stderr, "%s Expecting the invalid line at 34, got %" PRIu64 " values at %lu\n", __func__, n, pos);
+        ++errors;
+    }
+    static const char toolong[] = "f\n0123456789abcdef0\n";
+    n = parse_hex_uint64_lines(toolong, strlen(toolong), dst, &pos);
+    if ((n != 1) || (pos != 2))
+    {
+        fprintf(stderr, "%s Expecting the invalid line at 2, got %" PRIu64 " values at %lu\n", __func__, n, pos);
+        ++errors;
+    }
+    return errors;
+}
+
+static int convert_file(const char *infile, const char *outfile, int tohex, uint64_t *nitems)
+{
+    int ret;
+    int infd = open(infile, O_RDONLY);
+    int outfd = open(outfile, (O_WRONLY | O_CREAT | O_TRUNC), 0644);
+    if ((infd < 0) || (outfd < 0))
+    {
+        return 1;
+    }
+    ret = tohex ? uint64_to_hex_stream(infd, outfd, nitems) : hex_to_uint64_stream(infd, outfd, nitems);
+    close(infd);
+    close(outfd);
+    return ret;
+}
+
+int test_hex_stream()
+{
+    int errors = 0;
+    const uint64_t nitems = 200000; // multiple buffers
+    uint64_t *src = (uint64_t *)malloc(nitems * sizeof(uint64_t));
+    uint64_t *dst = (uint64_t *)malloc(nitems * sizeof(uint64_t));
+    char *hex = (char *)malloc(nitems * 17);
+    uint64_t i, n = 0, seed = 0x0123456789abcdef;
+    FILE *fp;
+    for (i = 0; i < nitems; i++)
+    {
+        src[i] = test_rand(&seed);
+    }
+    fp = fopen("hex.test.bin", "wb");
+    fwrite(src, sizeof(uint64_t), nitems, fp);
+    fclose(fp);
+    if ((convert_file("hex.test.bin", "hex.test.hex", 1, &n) != 0) || (n != nitems))
+    {
+        fprintf(stderr, "%s Unable to convert to hex (%" PRIu64 ")\n", __func__, n);
+        ++errors;
+    }
+    fp = fopen("hex.test.hex", "rb");
+    if ((fp == NULL) || (fread(hex, 17, nitems, fp) != nitems) || (parse_hex_uint64_array(hex, nitems, dst, 1) != nitems) || (memcmp(src, dst, (nitems * sizeof(uint64_t))) != 0))
+    {
+        fprintf(stderr, "%s Unexpected hex file\n", __func__);
+        ++errors;
+    }
+    if (fp != NULL)
+    {
+        fclose(fp);
+    }
+    if ((convert_file("hex.test.hex", "hex.test.out.bin", 0, &n) != 0) || (n != nitems))
+    {
+        fprintf(stderr, "%s Unable to convert to binary (%" PRIu64 ")\n", __func__, n);
+        ++errors;
+    }
+    fp = fopen("hex.test.out.bin", "rb");
+    if ((fp == NULL) || (fread(dst, sizeof(uint64_t), nitems, fp) != nitems) || (memcmp(src, dst, (nitems * sizeof(uint64_t))) != 0))
+    {
+        fprintf(stderr, "%s Unexpected binary file\n", __func__);
+        ++errors;
+    }
+    if (fp != NULL)
+    {
+        fclose(fp);
+    }
+    // invalid line, last line without newline and truncated binary input
+    fp = fopen("hex.test.hex", "wb");
+    fprintf(fp, "ff\n0123456789abcdef\nzz\n");
+    fclose(fp);
+    if (convert_file("hex.test.hex", "hex.test.out.bin", 0, &n) == 0)
+    {
+        fprintf(stderr, "%s Expecting an error for an invalid line\n", __func__);
+        ++errors;
+    }
+    fp = fopen("hex.test.hex", "wb");
+    fprintf(fp, "ff\n0123456789abcdef");
+    fclose(fp);
+    if ((convert_file("hex.test.hex", "hex.test.out.bin", 0, &n) != 0) || (n != 2))
+    {
+        fprintf(stderr, "%s Expecting 2 values, got %" PRIu64 "\n", __func__, n);
+        ++errors;
+    }
+    if (convert_file("hex.test.hex", "hex.test.out.hex", 1, &n) == 0)
+    {
+        fprintf(stderr, "%s Expecting an error for a truncated binary file\n", __func__);
+        ++errors;
+    }
+    free(src);
+    free(dst);
+    free(hex);
+    return errors;
+}
+
+void benchmark_hex_uint64_array()
+{
+    const uint64_t nitems = 1000000;
+    uint64_t *src = (uint64_t *)malloc(nitems * sizeof(uint64_t));
+    char *hex = (char *)malloc(nitems * 17);
+    uint64_t tstart, tend, i, n, seed = 0x0123456789abcdef;
+    size_t pos;
+    for (i = 0; i < nitems; i++)
+    {
+        src[i] = test_rand(&seed);
+    }
+    tstart = get_time();
+    hex_uint64_array(src, nitems, hex, '\n');
+    tend = get_time();
+    fprintf(stdout, " * %s encode : %lu ns/value\n", __func__, (tend - tstart) / nitems);
+    tstart = get_time();
+    n = parse_hex_uint64_lines(hex, (nitems * 17), src, &pos);
+    tend = get_time();
+    fprintf(stdout, " * %s decode : %lu ns/value (%" PRIu64 ")\n", __func__, (tend - tstart) / nitems, n);
+    free(src);
+    free(hex);
+}
+
 int main()
 {
     int errors = 0;
 
     errors += test_hex_uint64_t();
     errors += test_parse_hex_uint64_t();
+    errors += test_hex_uint64_array();
+    errors += test_parse_hex_uint64_array();
+    errors += test_parse_hex_uint64_lines();
+    errors += test_hex_stream();
 
     benchmark_hex_uint64_t();
     benchmark_parse_hex_uint64_t();
+    benchmark_hex_uint64_array();
 
     return errors;
 }
@@ -200,6 +200,37 @@ int test_reverse_variantkey(nrvk_cols_t nvc)
     return errors;
 }
 
+int test_reverse_variantkey_arena(nrvk_cols_t nvc)
+{
+    int errors = 0;
+    int i;
+    variantkey_rev_t exp = {0};
+    variantkey_rev_arena_t rev;
+    allele_arena_t arena = {0};
+    size_t len, explen;
+    uint64_t vk[(TEST_DATA_SIZE + 2)];
+    for (i=0 ; i < TEST_DATA_SIZE; i++)
+    {
+        vk[i] = test_data[i].vk;
+    }
+    vk[TEST_DATA_SIZE] = variantkey("X", 1, 12345, "ACGTACG", 7, "TTAC", 4); // reversible
+    vk[(TEST_DATA_SIZE + 1)] = 0xffffffff; // not found
+    for (i=0 ; i < (TEST_DATA_SIZE + 2); i++)
+    {
+        memset(&exp, 0, sizeof(exp));
+        explen = reverse_variantkey(nvc, vk[i], &exp);
+        len = reverse_variantkey_arena(nvc, vk[i], &arena, &rev);
+        if ((len != explen) || (rev.sizeref != exp.sizeref) || (rev.sizealt != exp.sizealt) || (rev.pos != exp.pos)
+                || (strcmp(rev.chrom, exp.chrom) != 0) || (strcmp(rev.ref, exp.ref) != 0) || (strcmp(rev.alt, exp.alt) != 0))
+        {
+            fprintf(stderr, "%s (%d) Expected %lu %s %" PRIu32 " %s %s, got %lu %s %" PRIu32 " %s %s\n", __func__, i, explen, exp.chrom, exp.pos, exp.ref, exp.alt, len, rev.chrom, rev.pos, rev.ref, rev.alt);
+            ++errors;
+        }
+    }
+    allele_arena_free(&arena);
+    return errors;
+}
+
 void benchmark_reverse_variantkey(nrvk_cols_t nvc)
 {
     variantkey_rev_t rev = {0};
@@ -215,6 +246,23 @@ void benchmark_reverse_variantkey(nrvk_cols_t nvc)
     fprintf(stdout, " * %s : %lu ns/op\n", __func__, (tend - tstart)/size);
 }
 
+void benchmark_reverse_variantkey_arena(nrvk_cols_t nvc)
+{
+    variantkey_rev_arena_t rev;
+    allele_arena_t arena = {0};
+    uint64_t tstart, tend;
+    int i;
+    int size = 100000;
+    tstart = get_time();
+    for (i=0 ; i < size; i++)
+    {
+        reverse_variantkey_arena(nvc, 0xb000c35b64690b25, &arena, &rev);
+    }
+    tend = get_time();
+    fprintf(stdout, " * %s : %lu ns/op\n", __func__, (tend - tstart)/size);
+    allele_arena_free(&arena);
+}
+
 int test_get_variantkey_ref_length(nrvk_cols_t nvc)
 {
     int errors = 0;
@@ -274,6 +322,70 @@ int test_get_variantkey_endpos(nrvk_cols_t nvc)
     return errors;
 }
 
+// each NRVK key is followed by a duplicate and by a reversible key, in ascending order or in a shuffled order
+static void build_variantkey_array(uint64_t *vk, uint64_t nitems, int shuffle)
+{
+    uint64_t i, j, t, seed = 0x0123456789abcdef;
+    for (i = 0; i < nitems; i++)
+    {
+        j = ((i / 3) % TEST_DATA_SIZE);
+        vk[i] = ((i % 3) == 2) ? variantkey(test_data[j].chrom, strlen(test_data[j].chrom), (test_data[j].pos + 1), "ACG", 3, "T", 1) : test_data[j].vk;
+    }
+    if (shuffle)
+    {
+        vk[0] = 0x1000c3517f91cdb3; // not found
+        for (i = (nitems - 1); i > 0; i--)
+        {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            j = (seed % (i + 1));
+            t = vk[i];
+            vk[i] = vk[j];
+            vk[j] = t;
+        }
+    }
+}
+
+int test_get_variantkey_endpos_array(nrvk_cols_t nvc)
+{
+    int errors = 0;
+    uint64_t i, nitems;
+    int shuffle;
+    uint64_t *vk = (uint64_t *)malloc(200000 * sizeof(uint64_t));
+    uint32_t *endpos = (uint32_t *)malloc(200000 * sizeof(uint32_t));
+    uint32_t *reflen = (uint32_t *)malloc(200000 * sizeof(uint32_t));
+    for (shuffle = 0; shuffle < 2; shuffle++)
+    {
+        // the large array is split in multiple sorting batches
+        for (nitems = (3 * TEST_DATA_SIZE); nitems <= 200000; nitems += (200000 - (3 * TEST_DATA_SIZE)))
+        {
+            build_variantkey_array(vk, nitems, shuffle);
+            get_variantkey_endpos_array(nvc, vk, nitems, endpos);
+            get_variantkey_ref_length_array(nvc, vk, nitems, reflen);
+            for (i = 0; i < nitems; i++)
+            {
+                if (endpos[i] != get_variantkey_endpos(nvc, vk[i]))
+                {
+                    fprintf(stderr, "%s (%d %" PRIu64 ") Expecting END POS %" PRIu32 ", got %" PRIu32 "\n", __func__, shuffle, i, get_variantkey_endpos(nvc, vk[i]), endpos[i]);
+                    ++errors;
+                    break;
+                }
+                if (reflen[i] != get_variantkey_ref_length(nvc, vk[i]))
+                {
+                    fprintf(stderr, "%s (%d %" PRIu64 ") Expecting REF length %lu, got %" PRIu32 "\n", __func__, shuffle, i, get_variantkey_ref_length(nvc, vk[i]), reflen[i]);
+                    ++errors;
+                    break;
+                }
+            }
+        }
+    }
+    free(vk);
+    free(endpos);
+    free(reflen);
+    return errors;
+}
+
 int test_get_variantkey_chrom_startpos()
 {
     int errors = 0;
@@ -333,6 +445,522 @@ int test_nrvk_bin_to_tsv_error(nrvk_cols_t nvc)
     return errors;
 }
 
+int test_nrvk_cols(nrvk_cols_t nvc)
+{
+    int errors = 0;
+    errors += test_find_ref_alt_by_variantkey(nvc);
+    errors += test_find_ref_alt_by_variantkey_notfound(nvc);
+    errors += test_reverse_variantkey(nvc);
+    errors += test_reverse_variantkey_arena(nvc);
+    errors += test_get_variantkey_ref_length(nvc);
+    errors += test_get_variantkey_ref_length_reversible(nvc);
+    errors += test_get_variantkey_ref_length_notfound(nvc);
+    errors += test_get_variantkey_endpos(nvc);
+    errors += test_get_variantkey_endpos_array(nvc);
+    errors += test_get_variantkey_chrom_endpos(nvc);
+    errors += test_nrvk_bin_to_tsv(nvc);
+    errors += test_nrvk_bin_to_tsv_error(nvc);
+    return errors;
+}
+
+int test_nrvk_to_v2_file(nrvk_cols_t nvc, uint64_t blockrows)
+{
+    int errors = 0;
+    size_t len = nrvk_to_v2_file(nvc, blockrows, "nrvk2.test.bin");
+    if (len == 0)
+    {
+        fprintf(stderr, "%s (%" PRIu64 ") Unable to write the compressed file\n", __func__, blockrows);
+        return 1;
+    }
+    mmfile_t mf = {0};
+    nrvk_cols_t nvc2 = {0};
+    int e = mmap_nrvk_file("nrvk2.test.bin", &mf, &nvc2);
+    if ((e != 0) || (nvc2.nrows != nvc.nrows) || (nvc2.blockrows != blockrows))
+    {
+        fprintf(stderr, "%s (%" PRIu64 ") Expecting %" PRIu64 " rows, got %" PRIu64 "\n", __func__, blockrows, nvc.nrows, nvc2.nrows);
+        munmap_binfile(mf);
+        return 1;
+    }
+    errors += test_nrvk_cols(nvc2);
+    if (blockrows == NRVK2_BLOCK_ROWS)
+    {
+        benchmark_find_ref_alt_by_variantkey(nvc2);
+        benchmark_reverse_variantkey(nvc2);
+    }
+    munmap_binfile(mf);
+    len = nrvk_to_v2_file(nvc2, blockrows, "nrvk2.test.bin");
+    if (len != 0)
+    {
+        fprintf(stderr, "%s (%" PRIu64 ") Expecting 0 bytes when the source is compressed, got %lu\n", __func__, blockrows, len);
+        ++errors;
+    }
+    return errors;
+}
+
+int test_nrvk_to_v2_file_error(nrvk_cols_t nvc)
+{
+    int errors = 0;
+    size_t len = nrvk_to_v2_file(nvc, NRVK2_BLOCK_ROWS, "/WRONG/../../nrvk2.test.bin");
+    if (len != 0)
+    {
+        fprintf(stderr, "%s Expecting 0 bytes, got %lu\n", __func__, len);
+        ++errors;
+    }
+    return errors;
+}
+
+int test_mmap_nrvk_file_version(nrvk_cols_t nvc)
+{
+    int errors = 0;
+    mmfile_t mf = {0};
+    nrvk_cols_t nvc2 = {0};
+    if (mmap_nrvk_file("nrvk.missing.bin", &mf, &nvc2) != 1)
+    {
+        fprintf(stderr, "%s Expecting an error for a missing file\n", __func__);
+        ++errors;
+    }
+    if (nrvk_to_v2_file(nvc, NRVK2_BLOCK_ROWS, "nrvk2.version.test.bin") == 0)
+    {
+        fprintf(stderr, "%s Unable to write the compressed file\n", __func__);
+        return 1;
+    }
+    // overwrite the format version stored in the info column
+    mmap_binfile("nrvk2.version.test.bin", &mf);
+    uint64_t infopos = mf.index[NRVK2_COL_INFO];
+    munmap_binfile(mf);
+    const uint64_t version = (NRVK2_VERSION + 1);
+    FILE *fp = fopen("nrvk2.version.test.bin", "r+b");
+    if ((fp == NULL) || (fseek(fp, (long)infopos, SEEK_SET) != 0) || (fwrite(&version, sizeof(version), 1, fp) != 1))
+    {
+        fprintf(stderr, "%s Unable to update the compressed file\n", __func__);
+        if (fp != NULL)
+        {
+            fclose(fp);
+        }
+        return (errors + 1);
+    }
+    fclose(fp);
+    if (mmap_nrvk_file("nrvk2.version.test.bin", &mf, &nvc2) != 1)
+    {
+        fprintf(stderr, "%s Expecting an error for an unsupported version\n", __func__);
+        ++errors;
+    }
+    if ((nvc2.nrows != 0) || (nvc2.vk != NULL) || (nvc2.data != NULL))
+    {
+        fprintf(stderr, "%s Expecting empty columns for an unsupported version\n", __func__);
+        ++errors;
+    }
+    munmap_binfile(mf);
+    return errors;
+}
+
+// Build an uncompressed NRVK table in memory with random alleles (long, lowercase, N, same REF in consecutive rows).
+void build_nrvk_random(uint64_t nrows, uint64_t *vk, uint64_t *offset, uint8_t *data)
+{
+    static const char letters[] = "ACGTACGTACGTACGTacgtN";
+    uint64_t i, off = 0;
+    size_t j, sizeref = 0, sizealt;
+    uint8_t *prev = NULL;
+    srand(13);
+    for (i = 0; i < nrows; i++)
+    {
+        vk[i] = ((i << 1) | 1);
+        offset[i] = off;
+        if ((prev != NULL) && ((rand() % 3) > 0))
+        {
+            memcpy((data + off + 2), (prev + 2), sizeref); // same REF
+        }
+        else
+        {
+            sizeref = (size_t)((rand() % 8) ? (rand() % 20) : (rand() % 256));
+            for (j = 0; j < sizeref; j++)
+            {
+                data[(off + 2 + j)] = (uint8_t)letters[(rand() % ((rand() % 16) ? 4 : 21))];
+            }
+        }
+        sizealt = (size_t)((rand() % 8) ? (rand() % 12) : (rand() % 256));
+        for (j = 0; j < sizealt; j++)
+        {
+            data[(off + 2 + sizeref + j)] = (uint8_t)letters[(rand() % ((rand() % 16) ? 4 : 21))];
+        }
+        data[off] = (uint8_t)sizeref;
+        data[(off + 1)] = (uint8_t)sizealt;
+        prev = (data + off);
+        off += (2 + sizeref + sizealt);
+    }
+}
+
+void benchmark_get_variantkey_endpos_array()
+{
+    const uint64_t nrows = 200000, nitems = 1000000;
+    uint64_t *nvk = (uint64_t *)malloc(nrows * sizeof(uint64_t));
+    uint64_t *offset = (uint64_t *)malloc(nrows * sizeof(uint64_t));
+    uint8_t *data = (uint8_t *)malloc(nrows * 512);
+    uint64_t *vk = (uint64_t *)malloc(nitems * sizeof(uint64_t));
+    uint32_t *endpos = (uint32_t *)malloc(nitems * sizeof(uint32_t));
+    uint64_t tstart, tend, i;
+    uint32_t sum = 0;
+    build_nrvk_random(nrows, nvk, offset, data);
+    nrvk_cols_t nvc = {nvk, offset, data, nrows, 0, NULL, 0, NULL};
+    // random mix of reversible keys and non-reversible keys stored in the NRVK columns
+    for (i = 0; i < nitems; i++)
+    {
+        vk[i] = (rand() % 2) ? nvk[(rand() % nrows)] : variantkey("1", 1, (uint32_t)rand() % 1000000, "ACGT", (size_t)(1 + (rand() % 4)), "A", 1);
+    }
+    tstart = get_time();
+    get_variantkey_endpos_array(nvc, vk, nitems, endpos);
+    tend = get_time();
+    fprintf(stdout, " * %s : %lu ns/op\n", __func__, (tend - tstart) / nitems);
+    tstart = get_time();
+    for (i = 0; i < nitems; i++)
+    {
+        sum += get_variantkey_endpos(nvc, vk[i]);
+    }
+    tend = get_time();
+    fprintf(stdout, " * %s get_variantkey_endpos : %lu ns/op (%" PRIu32 ")\n", __func__, (tend - tstart) / nitems, sum);
+    free(nvk);
+    free(offset);
+    free(data);
+    free(vk);
+    free(endpos);
+}
+
+int test_nrvk_to_v2_file_random()
+{
+    int errors = 0;
+    const uint64_t nrows = 10000;
+    uint64_t *vk = (uint64_t *)malloc(nrows * sizeof(uint64_t));
+    uint64_t *offset = (uint64_t *)malloc(nrows * sizeof(uint64_t));
+    uint8_t *data = (uint8_t *)malloc(nrows * 514);
+    build_nrvk_random(nrows, vk, offset, data);
+    nrvk_cols_t nvc = {vk, offset, data, nrows, 0, NULL, 0, NULL};
+    uint64_t datalen = (offset[(nrows - 1)] + 2 + data[offset[(nrows - 1)]] + data[(offset[(nrows - 1)] + 1)]);
+    char ref[256], alt[256], eref[256], ealt[256];
+    size_t sizeref = 0, sizealt = 0, esizeref, esizealt, len;
+    uint64_t blockrows, i;
+    for (blockrows = 1; blockrows <= 256; blockrows *= 4)
+    {
+        len = nrvk_to_v2_file(nvc, blockrows, "nrvk2.test.bin");
+        if ((blockrows > 1) && (len >= (datalen + (16 * nrows))))
+        {
+            fprintf(stderr, "%s (%" PRIu64 ") The compressed file (%lu bytes) is larger than the uncompressed one (%" PRIu64 " bytes)\n", __func__, blockrows, len, (datalen + (16 * nrows)));
+            ++errors;
+        }
+        mmfile_t mf = {0};
+        nrvk_cols_t nvc2 = {0};
+        mmap_nrvk_file("nrvk2.test.bin", &mf, &nvc2);
+        if (nvc2.nrows != nrows)
+        {
+            fprintf(stderr, "%s (%" PRIu64 ") Expecting %" PRIu64 " rows, got %" PRIu64 "\n", __func__, blockrows, nrows, nvc2.nrows);
+            ++errors;
+        }
+        for (i = 0; i < nvc2.nrows; i++)
+        {
+            get_nrvk_ref_alt_by_pos(nvc, i, eref, &esizeref, ealt, &esizealt);
+            len = find_ref_alt_by_variantkey(nvc2, vk[i], ref, &sizeref, alt, &sizealt);
+            if ((len != (esizeref + esizealt)) || (sizeref != esizeref) || (sizealt != esizealt) || (strcmp(ref, eref) != 0) || (strcmp(alt, ealt) != 0))
+            {
+                fprintf(stderr, "%s (%" PRIu64 ", %" PRIu64 ") Expecting %s %s, got %s %s\n", __func__, blockrows, i, eref, ealt, ref, alt);
+                ++errors;
+                break;
+            }
+        }
+        munmap_binfile(mf);
+    }
+    free(vk);
+    free(offset);
+    free(data);
+    return errors;
+}
+
+// compare the parallel TSV export with the expected content built row by row
+static int check_parallel_nrvk_bin_to_tsv(nrvk_cols_t nvc, const char *exp, size_t explen)
+{
+    int errors = 0;
+    uint32_t nthreads;
+    size_t len;
+    char *tsv = (char *)malloc(explen + 1);
+    FILE *fp;
+    for (nthreads = 0; nthreads <= 8; nthreads += 3)
+    {
+        len = parallel_nrvk_bin_to_tsv(nvc, "nrvk.parallel.test", nthreads);
+        if (len != explen)
+        {
+            fprintf(stderr, "%s (%" PRIu32 ") Expecting %lu bytes, got %lu\n", __func__, nthreads, explen, len);
+            ++errors;
+            continue;
+        }
+        fp = fopen("nrvk.parallel.test", "r");
+        len = ((fp == NULL) ? 0 : fread(tsv, 1, (explen + 1), fp));
+        if ((len != explen) || (memcmp(tsv, exp, explen) != 0))
+        {
+            fprintf(stderr, "%s (%" PRIu32 ") The file content is different from the expected one\n", __func__, nthreads);
+            ++errors;
+        }
+        if (fp != NULL)
+        {
+            fclose(fp);
+        }
+    }
+    free(tsv);
+    return errors;
+}
+
+int test_parallel_nrvk_bin_to_tsv_random()
+{
+    int errors = 0;
+    const uint64_t nrows = 150000; // multiple chunks and rounds
+    uint64_t *vk = (uint64_t *)malloc(nrows * sizeof(uint64_t));
+    uint64_t *offset = (uint64_t *)malloc(nrows * sizeof(uint64_t));
+    uint8_t *data = (uint8_t *)malloc(nrows * 512);
+    char *exp = (char *)malloc(nrows * 530);
+    char ref[256], alt[256];
+    size_t sizeref, sizealt, explen = 0;
+    uint64_t i;
+    build_nrvk_random(nrows, vk, offset, data);
+    nrvk_cols_t nvc = {vk, offset, data, nrows, 0, NULL, 0, NULL};
+    for (i = 0; i < nrows; i++)
+    {
+        get_nrvk_ref_alt_by_pos(nvc, i, ref, &sizeref, alt, &sizealt);
+        explen += (size_t)sprintf((exp + explen), "%016" PRIx64 "\t%s\t%s\n", vk[i], ref, alt);
+    }
+    errors += check_parallel_nrvk_bin_to_tsv(nvc, exp, explen);
+    // compressed format, with the chunks not aligned to the blocks
+    if (nrvk_to_v2_file(nvc, 3, "nrvk2.test.bin") == 0)
+    {
+        fprintf(stderr, "%s Unable to write the compressed file\n", __func__);
+        ++errors;
+    }
+    mmfile_t mf = {0};
+    nrvk_cols_t nvc2 = {0};
+    mmap_nrvk_file("nrvk2.test.bin", &mf, &nvc2);
+    errors += check_parallel_nrvk_bin_to_tsv(nvc2, exp, explen);
+    if (parallel_nrvk_bin_to_tsv(nvc2, "/WRONG/../../nrvk.parallel.test", 4) != 0)
+    {
+        fprintf(stderr, "%s Expecting 0 bytes for an invalid file\n", __func__);
+        ++errors;
+    }
+    munmap_binfile(mf);
+    free(vk);
+    free(offset);
+    free(data);
+    free(exp);
+    return errors;
+}
+
+// returns the wall clock time in nanoseconds (the threads CPU time is added by get_time)
+static uint64_t get_wall_time()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (((uint64_t)t.tv_sec * 1000000000) + (uint64_t)t.tv_nsec);
+}
+
+void benchmark_parallel_nrvk_bin_to_tsv()
+{
+    const uint64_t nrows = 1000000;
+    uint64_t *vk = (uint64_t *)malloc(nrows * sizeof(uint64_t));
+    uint64_t *offset = (uint64_t *)malloc(nrows * sizeof(uint64_t));
+    uint8_t *data = (uint8_t *)malloc(nrows * 512);
+    char ref[256], alt[256];
+    size_t sizeref, sizealt;
+    uint64_t tstart, tend, i;
+    uint32_t nthreads;
+    size_t len;
+    build_nrvk_random(nrows, vk, offset, data);
+    nrvk_cols_t nvc = {vk, offset, data, nrows, 0, NULL, 0, NULL};
+    for (nthreads = 1; nthreads <= 4; nthreads *= 4)
+    {
+        tstart = get_wall_time();
+        len = parallel_nrvk_bin_to_tsv(nvc, "nrvk.parallel.test", nthreads);
+        tend = get_wall_time();
+        fprintf(stdout, " * %s (%" PRIu32 " threads) : %lu ns/row (%lu bytes)\n", __func__, nthreads, (tend - tstart) / nrows, len);
+    }
+    // one fprintf per row
+    FILE *fp = fopen("nrvk.parallel.test", "w");
+    tstart = get_wall_time();
+    for (i = 0; i < nrows; i++)
+    {
+        get_nrvk_ref_alt_by_pos(nvc, i, ref, &sizeref, alt, &sizealt);
+        fprintf(fp, "%016" PRIx64 "\t%s\t%s\n", vk[i], ref, alt);
+    }
+    fclose(fp);
+    tend = get_wall_time();
+    fprintf(stdout, " * %s fprintf : %lu ns/row\n", __func__, (tend - tstart) / nrows);
+    free(vk);
+    free(offset);
+    free(data);
+}
+
+int test_nrvk_hash_file(nrvk_cols_t nvc)
+{
+    int errors = 0;
+    size_t len = nrvk_hash_to_file(nvc, "nrvkhash.test.bin");
+    if (len == 0)
+    {
+        fprintf(stderr, "%s Unable to write the hash index\n", __func__);
+        return 1;
+    }
+    mmfile_t mf = {0};
+    mmap_nrvk_hash_file("nrvkhash.test.bin", &mf, &nvc);
+    if ((nvc.hash == NULL) || (nvc.hashbits != 5))
+    {
+        fprintf(stderr, "%s Expecting a 5 bits hash index, got %" PRIu64 "\n", __func__, nvc.hashbits);
+        munmap_binfile(mf);
+        return 1;
+    }
+    errors += test_nrvk_cols(nvc);
+    benchmark_find_ref_alt_by_variantkey(nvc);
+    benchmark_reverse_variantkey(nvc);
+    munmap_binfile(mf);
+    // the index of a different NRVK file must be ignored
+    nrvk_cols_t other = nvc;
+    other.hash = NULL;
+    other.hashbits = 0;
+    other.nrows--;
+    mmap_nrvk_hash_file("nrvkhash.test.bin", &mf, &other);
+    if (other.hash != NULL)
+    {
+        fprintf(stderr, "%s Expecting the hash index to be ignored\n", __func__);
+        ++errors;
+    }
+    munmap_binfile(mf);
+    // the index of a rebuilt NRVK file with the same number of rows must be ignored
+    uint64_t *vk = (uint64_t *)malloc(nvc.nrows * sizeof(uint64_t));
+    memcpy(vk, nvc.vk, (nvc.nrows * sizeof(uint64_t)));
+    other = nvc;
+    other.hash = NULL;
+    other.hashbits = 0;
+    other.vk = vk;
+    vk[(nvc.nrows - 1)]++;
+    mmap_nrvk_hash_file("nrvkhash.test.bin", &mf, &other);
+    if (other.hash != NULL)
+    {
+        fprintf(stderr, "%s Expecting the hash index of a different file to be ignored\n", __func__);
+        ++errors;
+    }
+    munmap_binfile(mf);
+    // the rows returned by the index are verified against the VariantKey column
+    vk[(nvc.nrows - 1)]--;
+    vk[3] ^= 0x10;
+    mmap_nrvk_hash_file("nrvkhash.test.bin", &mf, &other);
+    if (other.hash == NULL)
+    {
+        fprintf(stderr, "%s Unable to map the hash index\n", __func__);
+        ++errors;
+    }
+    if (find_nrvk_row(other, nvc.vk[3]) != other.nrows)
+    {
+        fprintf(stderr, "%s Expecting a changed VariantKey not to be found\n", __func__);
+        ++errors;
+    }
+    if (find_nrvk_row(other, nvc.vk[4]) != 4)
+    {
+        fprintf(stderr, "%s Expecting row 4\n", __func__);
+        ++errors;
+    }
+    munmap_binfile(mf);
+    free(vk);
+    return errors;
+}
+
+int test_nrvk_hash_file_error(nrvk_cols_t nvc)
+{
+    int errors = 0;
+    size_t len = nrvk_hash_to_file(nvc, "/WRONG/../../nrvkhash.test.bin");
+    if (len != 0)
+    {
+        fprintf(stderr, "%s Expecting 0 bytes, got %lu\n", __func__, len);
+        ++errors;
+    }
+    mmfile_t mf = {0};
+    mmap_nrvk_hash_file("nrvk.10.bin", &mf, &nvc); // not a hash index
+    if (nvc.hash != NULL)
+    {
+        fprintf(stderr, "%s Expecting the file to be ignored\n", __func__);
+        ++errors;
+    }
+    munmap_binfile(mf);
+    return errors;
+}
+
+int test_nrvk_hash_file_random()
+{
+    int errors = 0;
+    const uint64_t nrows = 10000;
+    uint64_t *vk = (uint64_t *)malloc(nrows * sizeof(uint64_t));
+    uint64_t *offset = (uint64_t *)malloc(nrows * sizeof(uint64_t));
+    uint8_t *data = (uint8_t *)malloc(nrows * 514);
+    build_nrvk_random(nrows, vk, offset, data);
+    uint64_t i;
+    for (i = 1; i < nrows; i++)
+    {
+        vk[i] = (vk[(i - 1)] + ((i % 7) ? (uint64_t)(rand() % 64) * 2 : 0)); // with duplicates and clustered keys
+    }
+    nrvk_cols_t nvc = {vk, offset, data, nrows, 0, NULL, 0, NULL};
+    mmfile_t mf = {0};
+    nrvk_cols_t nvch = nvc;
+    if (nrvk_hash_to_file(nvc, "nrvkhash.test.bin") == 0)
+    {
+        fprintf(stderr, "%s Unable to write the hash index\n", __func__);
+        ++errors;
+    }
+    mmap_nrvk_hash_file("nrvkhash.test.bin", &mf, &nvch);
+    if (nvch.hash == NULL)
+    {
+        fprintf(stderr, "%s Unable to map the hash index\n", __func__);
+        ++errors;
+    }
+    uint64_t exp, row, key;
+    for (i = 0; i < (2 * nrows); i++)
+    {
+        key = (i < nrows) ? vk[i] : (vk[(i - nrows)] + 1); // even keys are never stored
+        exp = find_nrvk_row(nvc, key);
+        row = find_nrvk_row(nvch, key);
+        if (row != exp)
+        {
+            fprintf(stderr, "%s (%" PRIu64 ") Expecting row %" PRIu64 ", got %" PRIu64 "\n", __func__, i, exp, row);
+            ++errors;
+            break;
+        }
+    }
+    munmap_binfile(mf);
+    free(vk);
+    free(offset);
+    free(data);
+    return errors;
+}
+
+int test_nrvk_filter_file(nrvk_cols_t nvc)
+{
+    int errors = 0;
+    if (build_binfuse_file("nrvk.10.bin.filter", nvc.vk, nvc.nrows) == 0)
+    {
+        fprintf(stderr, "%s Unable to write the filter\n", __func__);
+        return 1;
+    }
+    mmfile_t mf = {0};
+    mmap_nrvk_filter_file("nrvk.10.bin.filter", &mf, &nvc);
+    if (nvc.filter == NULL)
+    {
+        fprintf(stderr, "%s Unable to map the filter\n", __func__);
+        return 1;
+    }
+    errors += test_nrvk_cols(nvc);
+    munmap_binfile(mf);
+    // the filter of a different NRVK file must be ignored
+    nvc.vk++;
+    nvc.nrows--;
+    mmap_nrvk_filter_file("nrvk.10.bin.filter", &mf, &nvc);
+    if (nvc.filter != NULL)
+    {
+        fprintf(stderr, "%s Expecting the filter to be ignored\n", __func__);
+        ++errors;
+    }
+    munmap_binfile(mf);
+    return errors;
+}
+
 int main()
 {
     int errors = 0;
@@ -348,20 +976,25 @@ int main()
         return 1;
     }
 
-    errors += test_find_ref_alt_by_variantkey(nvc);
-    errors += test_find_ref_alt_by_variantkey_notfound(nvc);
-    errors += test_reverse_variantkey(nvc);
-    errors += test_get_variantkey_ref_length(nvc);
-    errors += test_get_variantkey_ref_length_reversible(nvc);
-    errors += test_get_variantkey_ref_length_notfound(nvc);
-    errors += test_get_variantkey_endpos(nvc);
+    errors += test_nrvk_cols(nvc);
     errors += test_get_variantkey_chrom_startpos();
-    errors += test_get_variantkey_chrom_endpos(nvc);
-    errors += test_nrvk_bin_to_tsv(nvc);
-    errors += test_nrvk_bin_to_tsv_error(nvc);
+    errors += test_nrvk_to_v2_file(nvc, NRVK2_BLOCK_ROWS);
+    errors += test_nrvk_to_v2_file(nvc, 3);
+    errors += test_nrvk_to_v2_file(nvc, 1);
+    errors += test_nrvk_to_v2_file_error(nvc);
+    errors += test_mmap_nrvk_file_version(nvc);
+    errors += test_nrvk_to_v2_file_random();
+    errors += test_parallel_nrvk_bin_to_tsv_random();
+    errors += test_nrvk_hash_file(nvc);
+    errors += test_nrvk_hash_file_error(nvc);
+    errors += test_nrvk_hash_file_random();
+    errors += test_nrvk_filter_file(nvc);
 
     benchmark_find_ref_alt_by_variantkey(nvc);
     benchmark_reverse_variantkey(nvc);
+    benchmark_reverse_variantkey_arena(nvc);
+    benchmark_get_variantkey_endpos_array();
+    benchmark_parallel_nrvk_bin_to_tsv();
 
     err = munmap_binfile(nrvk);
     if (err != 0)
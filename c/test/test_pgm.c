@@ -0,0 +1,267 @@
+// Nicola Asuni
+
+#if __STDC_VERSION__ >= 199901L
+#define _XOPEN_SOURCE 600
+#else
+#define _XOPEN_SOURCE 500
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include "../src/variantkey/pgm.h"
+
+#define TEST_DATA_ITEMS 251
+#define TEST_BENCH_ITEMS 4000000
+#define TEST_BENCH_LOOKUPS 1000000
+
+static const uint64_t test_sizes[] = {0, 1, 2, 3, 17, 256, 4097, 65537, 300000};
+static const uint64_t test_eps[] = {0, 1, 8, 64};
+
+// returns current time in nanoseconds
+uint64_t get_time()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+    return (((uint64_t)t.tv_sec * 1000000000) + (uint64_t)t.tv_nsec);
+}
+
+static uint64_t test_rand(uint64_t *x)
+{
+    *x ^= *x << 13;
+    *x ^= *x >> 7;
+    *x ^= *x << 17;
+    return *x;
+}
+
+static int cmp_uint64_t(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// generate sorted VariantKey-like values: CHROM, increasing POS with random gaps, random REF+ALT
+static void gen_sorted_keys(uint64_t *src, uint64_t nrows, uint64_t *seed)
+{
+    uint64_t i, pos = 0, chrom = 1;
+    uint64_t rowsperchrom = (nrows / 25) + 1;
+    for (i = 0; i < nrows; i++)
+    {
+        if ((i > 0) && ((i % rowsperchrom) == 0))
+        {
+            ++chrom;
+            pos = 0;
+        }
+        pos += (test_rand(seed) % 300);
+        src[i] = (chrom << 59) | ((pos & 0xfffffff) << 31) | (test_rand(seed) & 0x7fffffff);
+    }
+    qsort(src, nrows, sizeof(uint64_t), cmp_uint64_t);
+}
+
+int check_pgm(const uint64_t *src, uint64_t nrows, uint64_t eps, uint64_t *seed)
+{
+    int errors = 0;
+    uint64_t i, first, last, exp, got, search;
+    uint64_t size = get_pgm_max_size(src, nrows, eps);
+    uint64_t *key = (uint64_t *)malloc(sizeof(uint64_t) * size);
+    uint64_t *pos = (uint64_t *)malloc(sizeof(uint64_t) * size);
+    double *slope = (double *)malloc(sizeof(double) * size);
+    pgm_t pgm = {key, pos, slope, 0};
+    pgm.nsegs = build_pgm(src, nrows, eps, key, pos, slope) - 1;
+    for (i = 0; i < 2000; i++)
+    {
+        search = (nrows > 0) ? src[(test_rand(seed) % nrows)] : test_rand(seed);
+        search += (i % 3) - 1;
+        if ((i % 7) == 0)
+        {
+            search = test_rand(seed);
+        }
+        first = 0;
+        last = nrows;
+        exp = (nrows > 0) ? col_find_first_uint64_t(src, &first, &last, search) : 0;
+        got = pgm_find_first(src, pgm, search);
+        if (got != exp)
+        {
+            fprintf(stderr, "%s (%" PRIu64 ", %" PRIu64 ", %016" PRIx64 ") Expected %" PRIu64 ", got %" PRIu64 "\n", __func__, nrows, eps, search, exp, got);
+            ++errors;
+        }
+        for (exp = 0; (exp < nrows) && (src[exp] < search); exp++);
+        got = pgm_lower_bound(src, pgm, search);
+        if (got != exp)
+        {
+            fprintf(stderr, "%s LOWER BOUND (%" PRIu64 ", %" PRIu64 ", %016" PRIx64 ") Expected %" PRIu64 ", got %" PRIu64 "\n", __func__, nrows, eps, search, exp, got);
+            ++errors;
+        }
+        if (nrows > 4097)
+        {
+            i += 10; // skip some slow linear checks
+        }
+    }
+    free(key);
+    free(pos);
+    free(slope);
+    return errors;
+}
+
+int test_pgm_col(mmfile_t mf)
+{
+    int errors = 0;
+    uint64_t seed = 0x1234567890abcdef;
+    uint64_t e;
+    const uint64_t *src = get_src_offset_uint64_t(mf.src, mf.index[3]);
+    for (e = 0; e < (sizeof(test_eps) / sizeof(test_eps[0])); e++)
+    {
+        errors += check_pgm(src, TEST_DATA_ITEMS, test_eps[e], &seed);
+    }
+    return errors;
+}
+
+int test_pgm_random()
+{
+    int errors = 0;
+    uint64_t seed = 0x1234567890abcdef;
+    uint64_t i, k, e, nrows;
+    uint64_t *buf, *src;
+    for (k = 0; k < (sizeof(test_sizes) / sizeof(test_sizes[0])); k++)
+    {
+        nrows = test_sizes[k];
+        buf = (uint64_t *)calloc((nrows + 2), sizeof(uint64_t)); // col_find_first may read one item outside the range
+        src = buf + 1;
+        gen_sorted_keys(src, nrows, &seed);
+        for (i = 1; i < nrows; i += 5)
+        {
+            src[i] = src[(i - 1)]; // duplicates
+        }
+        if (nrows > 0)
+        {
+            src[nrows] = src[(nrows - 1)];
+        }
+        for (e = 0; e < (sizeof(test_eps) / sizeof(test_eps[0])); e++)
+        {
+            errors += check_pgm(src, nrows, test_eps[e], &seed);
+        }
+        free(buf);
+    }
+    return errors;
+}
+
+int test_pgm_file(mmfile_t mf)
+{
+    int errors = 0;
+    uint64_t i;
+    const uint64_t *src = get_src_offset_uint64_t(mf.src, mf.index[3]);
+    if (save_pgm_file("test_pgm.bin", src, TEST_DATA_ITEMS, 4) == 0)
+    {
+        fprintf(stderr, "%s : Unable to save the index file\n", __func__);
+        return 1;
+    }
+    mmfile_t imf = {0};
+    pgm_t pgm = {0};
+    if (mmap_pgm_file("test_pgm.bin", &imf, &pgm) != 0)
+    {
+        fprintf(stderr, "%s : Unable to map the index file\n", __func__);
+        return 1;
+    }
+    for (i = 0; i < TEST_DATA_ITEMS; i++)
+    {
+        if (src[pgm_find_first(src, pgm, src[i])] != src[i])
+        {
+            fprintf(stderr, "%s (%" PRIu64 ") : Unexpected position\n", __func__, i);
+            ++errors;
+        }
+    }
+    munmap_binfile(imf);
+    return errors;
+}
+
+void benchmark_pgm()
+{
+    uint64_t tstart, tend, i, e, first, last, size, sum = 0;
+    uint64_t seed = 0x1234567890abcdef;
+    uint64_t *src = (uint64_t *)malloc(sizeof(uint64_t) * TEST_BENCH_ITEMS);
+    uint64_t *keys = (uint64_t *)malloc(sizeof(uint64_t) * TEST_BENCH_LOOKUPS);
+    gen_sorted_keys(src, TEST_BENCH_ITEMS, &seed);
+    for (i = 0; i < TEST_BENCH_LOOKUPS; i++)
+    {
+        keys[i] = src[(test_rand(&seed) % TEST_BENCH_ITEMS)];
+    }
+    tstart = get_time();
+    for (i = 0; i < TEST_BENCH_LOOKUPS; i++)
+    {
+        first = 0;
+        last = TEST_BENCH_ITEMS;
+        sum += col_find_first_uint64_t(src, &first, &last, keys[i]);
+    }
+    tend = get_time();
+    fprintf(stdout, " * %s col_find_first_uint64_t : %lu ns/op\n", __func__, (tend - tstart) / TEST_BENCH_LOOKUPS);
+    for (e = 16; e <= 256; e <<= 2)
+    {
+        size = get_pgm_max_size(src, TEST_BENCH_ITEMS, e);
+        uint64_t *key = (uint64_t *)malloc(sizeof(uint64_t) * size);
+        uint64_t *pos = (uint64_t *)malloc(sizeof(uint64_t) * size);
+        double *slope = (double *)malloc(sizeof(double) * size);
+        pgm_t pgm = {key, pos, slope, 0};
+        pgm.nsegs = build_pgm(src, TEST_BENCH_ITEMS, e, key, pos, slope) - 1;
+        tstart = get_time();
+        for (i = 0; i < TEST_BENCH_LOOKUPS; i++)
+        {
+            sum -= pgm_find_first(src, pgm, keys[i]);
+        }
+        tend = get_time();
+        fprintf(stdout, " * %s pgm_find_first (eps %" PRIu64 ", %" PRIu64 " levels, %" PRIu64 " bytes) : %lu ns/op (%" PRIx64 ")\n", __func__, e, (uint64_t)slope[pgm.nsegs], 24 * (pgm.nsegs + 1), (tend - tstart) / TEST_BENCH_LOOKUPS, sum);
+        for (i = 0; i < TEST_BENCH_LOOKUPS; i++)
+        {
+            sum += pgm_find_first(src, pgm, keys[i]);
+        }
+        free(key);
+        free(pos);
+        free(slope);
+    }
+    free(keys);
+    free(src);
+}
+
+int main()
+{
+    int errors = 0;
+
+    char *file = "test_data_col.bin"; // file containing test data
+
+    mmfile_t mf = {0};
+    mf.ncols = 4;
+    mf.ctbytes[0] = 1;
+    mf.ctbytes[1] = 2;
+    mf.ctbytes[2] = 4;
+    mf.ctbytes[3] = 8;
+    mmap_binfile(file, &mf);
+
+    if (mf.fd < 0)
+    {
+        fprintf(stderr, "can't open %s for reading\n", file);
+        return 1;
+    }
+    if (mf.src == MAP_FAILED)
+    {
+        fprintf(stderr, "mmap error! [%s]\n", strerror(errno));
+        return 1;
+    }
+
+    errors += test_pgm_col(mf);
+    errors += test_pgm_random();
+    errors += test_pgm_file(mf);
+
+    benchmark_pgm();
+
+    int e = munmap_binfile(mf);
+    if (e != 0)
+    {
+        fprintf(stderr, "Got %d error while unmapping the file\n", e);
+        return 1;
+    }
+
+    return errors;
+}
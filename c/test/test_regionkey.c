@@ -552,6 +552,299 @@ int test_variantkey_to_regionkey(nrvk_cols_t nvc)
     return errors;
 }
 
+static uint64_t test_rand(uint64_t *x)
+{
+    *x ^= *x << 13;
+    *x ^= *x >> 7;
+    *x ^= *x << 17;
+    return *x;
+}
+
+static int cmp_uint64_t(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// generate sorted random regions on 3 chromosomes, with lengths from 0 to (maxlen - 1)
+static void gen_sorted_regionkeys(uint64_t *rk, uint64_t nrows, uint32_t maxpos, uint32_t maxlen, uint64_t *seed)
+{
+    uint64_t i;
+    uint32_t start;
+    for (i = 0; i < nrows; i++)
+    {
+        start = (uint32_t)(test_rand(seed) % maxpos);
+        rk[i] = encode_regionkey((uint8_t)(1 + (test_rand(seed) % 3)), start, (start + (uint32_t)(test_rand(seed) % maxlen)), (uint8_t)(test_rand(seed) % 3));
+    }
+    qsort(rk, nrows, sizeof(uint64_t), cmp_uint64_t);
+}
+
+static int check_regionkey_index(rkindex_cols_t idx, uint64_t q, uint64_t *rows, uint64_t maxrows)
+{
+    uint64_t i, n, exp = 0;
+    n = find_overlapping_regionkeys(idx, q, rows, maxrows);
+    for (i = 0; i < idx.nrows; i++)
+    {
+        if (are_overlapping_regionkeys(idx.rk[i], q))
+        {
+            if ((exp < maxrows) && (exp < n) && (rows[exp] != i))
+            {
+                fprintf(stderr, "%s (%016" PRIx64 ") Expecting row %" PRIu64 ", got %" PRIu64 "\n", __func__, q, i, rows[exp]);
+                return 1;
+            }
+            exp++;
+        }
+    }
+    if (n != exp)
+    {
+        fprintf(stderr, "%s (%016" PRIx64 ") Expecting %" PRIu64 " overlaps, got %" PRIu64 "\n", __func__, q, exp, n);
+        return 1;
+    }
+    return 0;
+}
+
+int test_find_overlapping_regionkeys()
+{
+    int errors = 0;
+    static const uint64_t sizes[] = {0, 1, 2, 3, 7, 8, 9, 15, 16, 17, 100, 1000, 5000};
+    uint64_t seed = 0x1234567890abcdef;
+    uint64_t j, q, nrows;
+    uint32_t start;
+    uint64_t *rk = (uint64_t *)malloc(5000 * sizeof(uint64_t));
+    uint64_t *maxend = (uint64_t *)malloc(5000 * sizeof(uint64_t));
+    uint64_t *rows = (uint64_t *)malloc(5000 * sizeof(uint64_t));
+    size_t k;
+    for (k = 0; k < (sizeof(sizes) / sizeof(sizes[0])); k++)
+    {
+        nrows = sizes[k];
+        gen_sorted_regionkeys(rk, nrows, 100000, ((k & 1) ? 50000 : 500), &seed);
+        if (build_regionkey_index(rk, nrows, maxend) != 0)
+        {
+            fprintf(stderr, "%s (%" PRIu64 ") Unable to build the index\n", __func__, nrows);
+            ++errors;
+            continue;
+        }
+        rkindex_cols_t idx = {rk, maxend, nrows};
+        for (j = 0; j < 200; j++)
+        {
+            start = (uint32_t)(test_rand(&seed) % 110000);
+            q = encode_regionkey((uint8_t)(test_rand(&seed) % 5), start, (start + (uint32_t)(test_rand(&seed) % ((j & 1) ? 2000 : 2))), 0);
+            errors += check_regionkey_index(idx, q, rows, ((j % 3) ? 5000 : 2));
+        }
+    }
+    uint64_t unsorted[2] = {0x0800000080000000, 0x0800000000000000};
+    if (build_regionkey_index(unsorted, 2, maxend) == 0)
+    {
+        fprintf(stderr, "%s Expecting an error for unsorted RegionKeys\n", __func__);
+        ++errors;
+    }
+    free(rk);
+    free(maxend);
+    free(rows);
+    return errors;
+}
+
+int test_regionkey_index_file()
+{
+    int errors = 0;
+    uint64_t seed = 0xfedcba0987654321;
+    uint64_t rk[1000], rows[1000];
+    gen_sorted_regionkeys(rk, 1000, 1000000, 10000, &seed);
+    if (save_regionkey_index_file("rkindex.test.bin", rk, 1000) == 0)
+    {
+        fprintf(stderr, "%s Unable to save the index file\n", __func__);
+        return 1;
+    }
+    if (save_regionkey_index_file("/WRONG/../../rkindex.test.bin", rk, 1000) != 0)
+    {
+        fprintf(stderr, "%s Expecting an error for an invalid file\n", __func__);
+        ++errors;
+    }
+    mmfile_t mf = {0};
+    rkindex_cols_t idx = {0};
+    if (mmap_regionkey_index_file("rkindex.test.bin", &mf, &idx) != 0)
+    {
+        fprintf(stderr, "%s Unable to map the index file\n", __func__);
+        return 1;
+    }
+    uint64_t i;
+    for (i = 0; i < 1000; i += 7)
+    {
+        errors += check_regionkey_index(idx, rk[i], rows, 1000);
+    }
+    munmap_binfile(mf);
+    if (mmap_regionkey_index_file("nrvk.10.bin", &mf, &idx) == 0)
+    {
+        fprintf(stderr, "%s Expecting an error for an invalid index file\n", __func__);
+        ++errors;
+    }
+    munmap_binfile(mf);
+    return errors;
+}
+
+// generate sorted random variants on 3 chromosomes, with REF lengths from 1 to 16 (non-reversible if longer than 11)
+static void gen_sorted_variantkeys(uint64_t *vk, uint64_t nrows, uint32_t maxpos, uint64_t *seed)
+{
+    static const char *chrom[3] = {"1", "2", "3"};
+    static const char *ref = "ACGTACGTACGTACGT";
+    uint64_t i;
+    for (i = 0; i < nrows; i++)
+    {
+        vk[i] = variantkey(chrom[(test_rand(seed) % 3)], 1, (uint32_t)(test_rand(seed) % maxpos), ref, (size_t)(1 + (test_rand(seed) % 16)), "A", 1);
+    }
+    qsort(vk, nrows, sizeof(uint64_t), cmp_uint64_t);
+}
+
+static int check_join_variantkey_regionkey(nrvk_cols_t nvc, const uint64_t *vk, uint64_t nvk, const uint64_t *rk, uint64_t nrk, const uint64_t *ovk, const uint64_t *ork, uint64_t npairs)
+{
+    uint64_t i, j, exp = 0;
+    for (i = 0; i < nvk; i++)
+    {
+        for (j = 0; j < nrk; j++)
+        {
+            if (are_overlapping_variantkey_regionkey(nvc, vk[i], rk[j]))
+            {
+                if ((exp < npairs) && ((ovk[exp] != vk[i]) || (ork[exp] != rk[j])))
+                {
+                    fprintf(stderr, "%s (%" PRIu64 ") Expecting %016" PRIx64 ":%016" PRIx64 ", got %016" PRIx64 ":%016" PRIx64 "\n", __func__, exp, vk[i], rk[j], ovk[exp], ork[exp]);
+                    return 1;
+                }
+                exp++;
+            }
+        }
+    }
+    if (exp != npairs)
+    {
+        fprintf(stderr, "%s Expecting %" PRIu64 " pairs, got %" PRIu64 "\n", __func__, exp, npairs);
+        return 1;
+    }
+    return 0;
+}
+
+int test_join_variantkey_regionkey(nrvk_cols_t nvc)
+{
+    int errors = 0;
+    uint64_t seed = 0x0123456789abcdef;
+    uint64_t nvk = 2010, nrk = 1000, maxpairs = 100000;
+    uint64_t *vk = (uint64_t *)malloc(nvk * sizeof(uint64_t));
+    uint64_t *rk = (uint64_t *)malloc(nrk * sizeof(uint64_t));
+    uint32_t *endpos = (uint32_t *)malloc(nvk * sizeof(uint32_t));
+    uint64_t *ovk = (uint64_t *)malloc(maxpairs * sizeof(uint64_t));
+    uint64_t *ork = (uint64_t *)malloc(maxpairs * sizeof(uint64_t));
+    uint64_t i, n, blk, maxp;
+    // include the NRVK keys, so some end positions come from the NRVK file
+    gen_sorted_variantkeys(vk, (nvk - nvc.nrows), 200000, &seed);
+    for (i = 0; i < nvc.nrows; i++)
+    {
+        vk[(nvk - nvc.nrows + i)] = nvc.vk[i];
+    }
+    qsort(vk, nvk, sizeof(uint64_t), cmp_uint64_t);
+    gen_sorted_regionkeys(rk, nrk, 200000, 2000, &seed);
+    get_variantkey_endpos_array(nvc, vk, nvk, endpos);
+    // full join, limited output and VariantKeys in blocks
+    for (blk = 1; blk <= nvk; blk *= 7)
+    {
+        for (maxp = 1; maxp <= maxpairs; maxp *= 100)
+        {
+            vkrk_join_t jn;
+            init_vkrk_join(&jn);
+            n = 0;
+            for (i = 0; i < nvk; i += blk)
+            {
+                jn.vpos = 0;
+                while (jn.vpos < (((nvk - i) < blk) ? (nvk - i) : blk))
+                {
+                    n += join_variantkey_regionkey(&jn, (vk + i), (endpos + i), (((nvk - i) < blk) ? (nvk - i) : blk), rk, nrk, (ovk + n), (ork + n), (((maxpairs - n) < maxp) ? (maxpairs - n) : maxp));
+                }
+            }
+            free_vkrk_join(&jn);
+            errors += check_join_variantkey_regionkey(nvc, vk, nvk, rk, nrk, ovk, ork, n);
+        }
+    }
+    // parallel join
+    n = parallel_join_variantkey_regionkey(nvc, vk, nvk, rk, nrk, ovk, ork, maxpairs, 4);
+    errors += check_join_variantkey_regionkey(nvc, vk, nvk, rk, nrk, ovk, ork, n);
+    i = parallel_join_variantkey_regionkey(nvc, vk, nvk, rk, nrk, ovk, ork, 10, 1);
+    if (i != n)
+    {
+        fprintf(stderr, "%s Expecting %" PRIu64 " total pairs, got %" PRIu64 "\n", __func__, n, i);
+        ++errors;
+    }
+    n = parallel_join_variantkey_regionkey(nvc, vk, 0, rk, nrk, ovk, ork, maxpairs, 2);
+    if (n != 0)
+    {
+        fprintf(stderr, "%s Expecting 0 pairs, got %" PRIu64 "\n", __func__, n);
+        ++errors;
+    }
+    free(vk);
+    free(rk);
+    free(endpos);
+    free(ovk);
+    free(ork);
+    return errors;
+}
+
+void benchmark_find_overlapping_regionkeys()
+{
+    uint64_t tstart, tend, i, j, n = 0, nrows = 1000000, nq = 10000;
+    uint64_t seed = 0x1234567890abcdef;
+    uint64_t *rk = (uint64_t *)malloc(nrows * sizeof(uint64_t));
+    uint64_t *maxend = (uint64_t *)malloc(nrows * sizeof(uint64_t));
+    uint64_t rows[1000];
+    gen_sorted_regionkeys(rk, nrows, 100000000, 20000, &seed);
+    build_regionkey_index(rk, nrows, maxend);
+    rkindex_cols_t idx = {rk, maxend, nrows};
+    tstart = get_time();
+    for (i = 0; i < nq; i++)
+    {
+        n += find_overlapping_regionkeys(idx, rk[(test_rand(&seed) % nrows)], rows, 1000);
+    }
+    tend = get_time();
+    fprintf(stdout, " * %s : %lu ns/op (%" PRIu64 " overlaps/op)\n", __func__, (tend - tstart) / nq, n / nq);
+    tstart = get_time();
+    for (i = 0; i < 100; i++)
+    {
+        uint64_t q = rk[(test_rand(&seed) % nrows)];
+        for (j = 0; j < nrows; j++)
+        {
+            n += are_overlapping_regionkeys(rk[j], q);
+        }
+    }
+    tend = get_time();
+    fprintf(stdout, " * %s linear scan : %lu ns/op (%" PRIu64 ")\n", __func__, (tend - tstart) / 100, n);
+    free(rk);
+    free(maxend);
+}
+
+void benchmark_join_variantkey_regionkey(nrvk_cols_t nvc)
+{
+    uint64_t tstart, tend, i, n = 0, nvk = 1000000, nrk = 100000, maxpairs = 10000000;
+    uint64_t seed = 0x1234567890abcdef;
+    uint64_t *vk = (uint64_t *)malloc(nvk * sizeof(uint64_t));
+    uint64_t *rk = (uint64_t *)malloc(nrk * sizeof(uint64_t));
+    uint64_t *ovk = (uint64_t *)malloc(maxpairs * sizeof(uint64_t));
+    uint64_t *ork = (uint64_t *)malloc(maxpairs * sizeof(uint64_t));
+    gen_sorted_variantkeys(vk, nvk, 100000000, &seed);
+    gen_sorted_regionkeys(rk, nrk, 100000000, 20000, &seed);
+    tstart = get_time();
+    n = parallel_join_variantkey_regionkey(nvc, vk, nvk, rk, nrk, ovk, ork, maxpairs, 1);
+    tend = get_time();
+    fprintf(stdout, " * %s : %lu ns/variant (%" PRIu64 " pairs)\n", __func__, (tend - tstart) / nvk, n);
+    tstart = get_time();
+    n = 0;
+    for (i = 0; i < 1000; i++)
+    {
+        n += are_overlapping_variantkey_regionkey(nvc, vk[i], rk[(test_rand(&seed) % nrk)]);
+    }
+    tend = get_time();
+    fprintf(stdout, " * %s pairwise check : %lu ns/pair (%" PRIu64 ")\n", __func__, (tend - tstart) / 1000, n);
+    free(vk);
+    free(rk);
+    free(ovk);
+    free(ork);
+}
+
 int main()
 {
     int errors = 0;
@@ -588,9 +881,34 @@ int main()
     errors += test_are_overlapping_variantkey_regionkey(nvc);
     errors += test_variantkey_to_regionkey(nvc);
 
+    // same results using the NRVK hash index
+    mmfile_t nrvkhash = {0};
+    if (nrvk_hash_to_file(nvc, "nrvkhash.regionkey.test.bin") == 0)
+    {
+        fprintf(stderr, "Unable to write the NRVK hash index\n");
+        ++errors;
+    }
+    mmap_nrvk_hash_file("nrvkhash.regionkey.test.bin", &nrvkhash, &nvc);
+    if (nvc.hash == NULL)
+    {
+        fprintf(stderr, "Unable to map the NRVK hash index\n");
+        ++errors;
+    }
+    errors += test_are_overlapping_variantkey_regionkey(nvc);
+    errors += test_variantkey_to_regionkey(nvc);
+    munmap_binfile(nrvkhash);
+    nvc.hash = NULL;
+    nvc.hashbits = 0;
+
+    errors += test_find_overlapping_regionkeys();
+    errors += test_regionkey_index_file();
+    errors += test_join_variantkey_regionkey(nvc);
+
     benchmark_decode_regionkey();
     benchmark_reverse_regionkey();
     benchmark_regionkey();
+    benchmark_find_overlapping_regionkeys();
+    benchmark_join_variantkey_regionkey(nvc);
 
     err = munmap_binfile(nrvk);
     if (err != 0)
@@ -40,6 +40,7 @@
 
 #include <errno.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <sys/mman.h>
@@ -122,6 +123,55 @@ int test_find_rv_variantkey_by_rsid_notfound(rsidvar_cols_t crv)
     return errors;
 }
 
+int test_find_rv_variantkey_by_rsid_dir(rsidvar_cols_t crv)
+{
+    int errors = 0;
+    int i;
+    uint64_t vk;
+    uint64_t first;
+    mmfile_t mf = {0};
+    rsidvar_dir_t dir = {0};
+    size_t len = save_rsvk_dir_file("rsvk.10.bin.dir", crv);
+    if (len != (32 + (8 * get_rsvk_dir_size(crv))))
+    {
+        fprintf(stderr, "%s : Unexpected directory file size %lu\n", __func__, len);
+        return 1;
+    }
+    if (mmap_rsvk_dir_file("rsvk.10.bin.dir", crv, &mf, &dir) != 0)
+    {
+        fprintf(stderr, "%s : Unable to map the directory file\n", __func__);
+        return 1;
+    }
+    for (i=0 ; i < TEST_DATA_SIZE; i++)
+    {
+        vk = find_rv_variantkey_by_rsid_dir(crv, dir, &first, test_data[i].rsid);
+        if (first != (uint64_t)i)
+        {
+            fprintf(stderr, "%s (%d) Expected first %d, got %" PRIu64 "\n", __func__, i, i, first);
+            ++errors;
+        }
+        if (vk != test_data[i].vk)
+        {
+            fprintf(stderr, "%s (%d) Expected variantkey %" PRIx64 ", got %" PRIx64 "\n", __func__, i, test_data[i].vk, vk);
+            ++errors;
+        }
+        vk = find_rv_variantkey_by_rsid_dir(crv, dir, &first, test_data[i].rsid + 1);
+        if ((vk != 0) && (test_data[i].rsid + 1 != test_data[(i + 1) % TEST_DATA_SIZE].rsid))
+        {
+            fprintf(stderr, "%s (%d) Expected variantkey 0, got %" PRIx64 "\n", __func__, i, vk);
+            ++errors;
+        }
+    }
+    vk = find_rv_variantkey_by_rsid_dir(crv, dir, &first, 0xfffffff0);
+    if (vk != 0)
+    {
+        fprintf(stderr, "%s : Expected variantkey 0, got %" PRIx64 "\n", __func__, vk);
+        ++errors;
+    }
+    munmap_binfile(mf);
+    return errors;
+}
+
 int test_get_next_rv_variantkey_by_rsid(rsidvar_cols_t crv)
 {
     int errors = 0;
@@ -224,6 +274,68 @@ int test_get_next_vr_rsid_by_variantkey(rsidvar_cols_t cvr)
     return errors;
 }
 
+int test_join_vr_rsid_by_variantkey(rsidvar_cols_t cvr)
+{
+    int errors = 0;
+    uint64_t keys[(2 * TEST_DATA_SIZE) + 2];
+    uint64_t ovk[(2 * TEST_DATA_SIZE) + 2], evk[(2 * TEST_DATA_SIZE) + 2];
+    uint32_t ors[(2 * TEST_DATA_SIZE) + 2], ers[(2 * TEST_DATA_SIZE) + 2];
+    uint64_t i, j, n, ne = 0, kpos, rpos, first, pos, maxpairs;
+    uint32_t rsid;
+    uint64_t nkeys = 0;
+    keys[nkeys++] = 0;
+    for (i = 0; i < TEST_DATA_SIZE; i++)
+    {
+        keys[nkeys++] = test_data[i].vk;
+        if ((i & 1) == 0)
+        {
+            keys[nkeys++] = test_data[i].vk; // duplicate key
+        }
+    }
+    keys[nkeys++] = 0xfffffffffffffff0;
+    for (i = 0; i < nkeys; i++)
+    {
+        first = 0;
+        rsid = find_vr_rsid_by_variantkey(cvr, &first, cvr.nrows, keys[i]);
+        if (rsid == 0)
+        {
+            continue;
+        }
+        pos = first;
+        do
+        {
+            evk[ne] = keys[i];
+            ers[ne++] = rsid;
+            rsid = get_next_vr_rsid_by_variantkey(cvr, &pos, cvr.nrows, keys[i]);
+        }
+        while (rsid != 0);
+    }
+    for (maxpairs = 1; maxpairs <= ne; maxpairs += 4)
+    {
+        kpos = 0;
+        rpos = 0;
+        j = 0;
+        while (kpos < nkeys)
+        {
+            n = join_vr_rsid_by_variantkey(cvr, keys, nkeys, &kpos, &rpos, ovk, ors, maxpairs);
+            for (i = 0; (i < n) && (j < ne); i++, j++)
+            {
+                if ((ovk[i] != evk[j]) || (ors[i] != ers[j]))
+                {
+                    fprintf(stderr, "%s (%" PRIu64 ", %" PRIu64 ") Expected %016" PRIx64 " %" PRIx32 ", got %016" PRIx64 " %" PRIx32 "\n",  __func__, maxpairs, j, evk[j], ers[j], ovk[i], ors[i]);
+                    ++errors;
+                }
+            }
+        }
+        if (j != ne)
+        {
+            fprintf(stderr, "%s (%" PRIu64 ") Expected %" PRIu64 " pairs, got %" PRIu64 "\n",  __func__, maxpairs, ne, j);
+            ++errors;
+        }
+    }
+    return errors;
+}
+
 int test_find_vr_chrompos_range(rsidvar_cols_t cvr)
 {
     int errors = 0;
@@ -308,6 +420,69 @@ void benchmark_find_rv_variantkey_by_rsid(rsidvar_cols_t crv)
     fprintf(stdout, " * %s : %lu ns/op\n", __func__, (tend - tstart)/size);
 }
 
+void benchmark_find_rv_variantkey_by_rsid_dir(rsidvar_cols_t crv)
+{
+    uint64_t tstart, tend;
+    uint64_t first = 0;
+    uint64_t *idx = (uint64_t *)malloc(sizeof(uint64_t) * get_rsvk_dir_size(crv));
+    rsidvar_dir_t dir = {idx, get_rsvk_dir_size(crv)};
+    build_rsvk_dir(crv, idx);
+    int i;
+    int size = 100000;
+    tstart = get_time();
+    for (i=0 ; i < size; i++)
+    {
+        find_rv_variantkey_by_rsid_dir(crv, dir, &first, 0x000026F5);
+    }
+    tend = get_time();
+    fprintf(stdout, " * %s : %lu ns/op\n", __func__, (tend - tstart)/size);
+    free(idx);
+}
+
+void benchmark_find_vr_rsid_by_variantkey_miss(rsidvar_cols_t cvr)
+{
+    uint64_t tstart, tend;
+    uint64_t first = 0;
+    int i;
+    int size = 100000;
+    tstart = get_time();
+    for (i=0 ; i < size; i++)
+    {
+        first = 0;
+        find_vr_rsid_by_variantkey(cvr, &first, cvr.nrows, 0X160017CCA313D0E2);
+    }
+    tend = get_time();
+    fprintf(stdout, " * %s (%s) : %lu ns/op\n", __func__, (cvr.filter != NULL) ? "filter" : "no filter", (tend - tstart)/size);
+}
+
+int test_find_vr_rsid_by_variantkey_filter(rsidvar_cols_t cvr)
+{
+    int errors = 0;
+    if (build_binfuse_file("vkrs.10.bin.filter", cvr.vk, cvr.nrows) == 0)
+    {
+        fprintf(stderr, "%s : Unable to write the filter\n",  __func__);
+        return 1;
+    }
+    mmfile_t mf = {0};
+    mmap_vkrs_filter_file("vkrs.10.bin.filter", &mf, &cvr);
+    if (cvr.filter == NULL)
+    {
+        fprintf(stderr, "%s : Unable to map the filter\n",  __func__);
+        return 1;
+    }
+    errors += test_find_vr_rsid_by_variantkey(cvr);
+    uint64_t first = 0;
+    uint32_t rsid = find_vr_rsid_by_variantkey(cvr, &first, cvr.nrows, 0xfffffffffffffff0);
+    if (rsid != 0)
+    {
+        fprintf(stderr, "%s : Expected rsid 0, got %" PRIx32 "\n",  __func__, rsid);
+        ++errors;
+    }
+    benchmark_find_vr_rsid_by_variantkey_miss(cvr);
+    munmap_binfile(mf);
+    return errors;
+}
+
 void benchmark_find_vr_rsid_by_variantkey(rsidvar_cols_t cvr)
 {
     uint64_t tstart, tend;
@@ -324,6 +499,29 @@ void benchmark_find_vr_rsid_by_variantkey(rsidvar_cols_t cvr)
     fprintf(stdout, " * %s : %lu ns/op\n", __func__, (tend - tstart)/size);
 }
 
+void benchmark_join_vr_rsid_by_variantkey(rsidvar_cols_t cvr)
+{
+    uint64_t tstart, tend;
+    uint64_t keys[TEST_DATA_SIZE], ovk[TEST_DATA_SIZE];
+    uint32_t ors[TEST_DATA_SIZE];
+    uint64_t kpos, rpos;
+    int i;
+    int size = 100000;
+    for (i=0 ; i < TEST_DATA_SIZE; i++)
+    {
+        keys[i] = test_data[i].vk;
+    }
+    tstart = get_time();
+    for (i=0 ; i < size; i++)
+    {
+        kpos = 0;
+        rpos = 0;
+        join_vr_rsid_by_variantkey(cvr, keys, TEST_DATA_SIZE, &kpos, &rpos, ovk, ors, TEST_DATA_SIZE);
+    }
+    tend = get_time();
+    fprintf(stdout, " * %s : %lu ns/op\n", __func__, (tend - tstart)/(size * TEST_DATA_SIZE));
+}
+
 void benchmark_find_vr_chrompos_range(rsidvar_cols_t cvr)
 {
     uint64_t tstart, tend;
@@ -366,15 +564,21 @@ int main()
 
     errors += test_find_rv_variantkey_by_rsid(crv);
     errors += test_find_rv_variantkey_by_rsid_notfound(crv);
+    errors += test_find_rv_variantkey_by_rsid_dir(crv);
     errors += test_get_next_rv_variantkey_by_rsid(crv);
     errors += test_find_vr_rsid_by_variantkey(cvr);
     errors += test_find_vr_rsid_by_variantkey_notfound(cvr);
     errors += test_get_next_vr_rsid_by_variantkey(cvr);
+    errors += test_join_vr_rsid_by_variantkey(cvr);
     errors += test_find_vr_chrompos_range(cvr);
     errors += test_find_vr_chrompos_range_notfound(cvr);
+    errors += test_find_vr_rsid_by_variantkey_filter(cvr);
 
     benchmark_find_rv_variantkey_by_rsid(crv);
+    benchmark_find_rv_variantkey_by_rsid_dir(crv);
     benchmark_find_vr_rsid_by_variantkey(cvr);
+    benchmark_find_vr_rsid_by_variantkey_miss(cvr);
+    benchmark_join_vr_rsid_by_variantkey(cvr);
     benchmark_find_vr_chrompos_range(cvr);
 
     err = munmap_binfile(rv);
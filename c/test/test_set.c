@@ -41,6 +41,7 @@
 #include <errno.h>
 #include <inttypes.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <strings.h>
 #include <time.h>
@@ -140,6 +141,147 @@ int test_order_uint64_t()
     return errors;
 }
 
+#define PSORT_NITEMS 300007
+
+// pseudo-random VariantKey-like values sharing the same CHROM byte
+static void fill_psort_data(uint64_t *arr, uint64_t nitems)
+{
+    uint64_t i, x = 0x9e3779b97f4a7c15;
+    for (i = 0; i < nitems; i++)
+    {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        arr[i] = 0x0800000000000000 | (x & 0x00ffffff000fffff);
+    }
+}
+
+int test_parallel_sort_uint64_t()
+{
+    int errors = 0;
+    uint64_t *arr = (uint64_t *)malloc(PSORT_NITEMS * sizeof(uint64_t));
+    uint64_t *tmp = (uint64_t *)malloc(PSORT_NITEMS * sizeof(uint64_t));
+    uint64_t *exp = (uint64_t *)malloc(PSORT_NITEMS * sizeof(uint64_t));
+    fill_psort_data(exp, PSORT_NITEMS);
+    sort_uint64_t(exp, tmp, PSORT_NITEMS);
+    uint32_t nthreads;
+    uint64_t i;
+    for (nthreads = 0; nthreads <= 5; nthreads++)
+    {
+        fill_psort_data(arr, PSORT_NITEMS);
+        parallel_sort_uint64_t(arr, tmp, PSORT_NITEMS, nthreads);
+        for (i = 0; i < PSORT_NITEMS; i++)
+        {
+            if (arr[i] != exp[i])
+            {
+                fprintf(stderr, "%s (%" PRIu32 " threads): Expected %" PRIx64 ", got %" PRIx64 " at %" PRIu64 "\n", __func__, nthreads, exp[i], arr[i], i);
+                ++errors;
+                break;
+            }
+        }
+    }
+    free(arr);
+    free(tmp);
+    free(exp);
+    return errors;
+}
+
+int test_parallel_sort_uint64_t_small()
+{
+    int errors = 0;
+    uint64_t arr[10] = {8,1,9,3,2,7,4,0,5,6};
+    uint64_t same[3] = {5,5,5};
+    uint64_t tmp[10];
+    parallel_sort_uint64_t(arr, tmp, 10, 4);
+    parallel_sort_uint64_t(same, tmp, 3, 4);
+    parallel_sort_uint64_t(NULL, NULL, 0, 4);
+    uint32_t i;
+    for(i = 0; i < 10; i++)
+    {
+        if (arr[i] != i)
+        {
+            fprintf(stderr, "%s : Expected %" PRIu32 ", got %" PRIu64 "\n", __func__, i, arr[i]);
+            ++errors;
+        }
+    }
+    for(i = 0; i < 3; i++)
+    {
+        if (same[i] != 5)
+        {
+            fprintf(stderr, "%s : Expected 5, got %" PRIu64 "\n", __func__, same[i]);
+            ++errors;
+        }
+    }
+    return errors;
+}
+
+int test_parallel_order_uint64_t()
+{
+    int errors = 0;
+    uint64_t *arr = (uint64_t *)malloc(PSORT_NITEMS * sizeof(uint64_t));
+    uint64_t *tmp = (uint64_t *)malloc(PSORT_NITEMS * sizeof(uint64_t));
+    uint64_t *src = (uint64_t *)malloc(PSORT_NITEMS * sizeof(uint64_t));
+    uint64_t *idx = (uint64_t *)malloc(PSORT_NITEMS * sizeof(uint64_t));
+    uint64_t *tdx = (uint64_t *)malloc(PSORT_NITEMS * sizeof(uint64_t));
+    fill_psort_data(src, PSORT_NITEMS);
+    uint64_t i;
+    for (i = 0; i < PSORT_NITEMS; i++)
+    {
+        src[i] &= 0xffffffffff00ffff; // add duplicates to check the stability
+    }
+    uint32_t nthreads;
+    for (nthreads = 1; nthreads <= 4; nthreads++)
+    {
+        memcpy(arr, src, PSORT_NITEMS * sizeof(uint64_t));
+        parallel_order_uint64_t(arr, tmp, idx, tdx, PSORT_NITEMS, nthreads);
+        for (i = 0; i < PSORT_NITEMS; i++)
+        {
+            if ((arr[i] != src[idx[i]]) || ((i > 0) && ((arr[i] < arr[i - 1]) || ((arr[i] == arr[i - 1]) && (idx[i] < idx[i - 1])))))
+            {
+                fprintf(stderr, "%s (%" PRIu32 " threads): Unexpected order at %" PRIu64 "\n", __func__, nthreads, i);
+                ++errors;
+                break;
+            }
+        }
+    }
+    uint64_t same[3] = {5,5,5};
+    parallel_order_uint64_t(same, tmp, idx, tdx, 3, 2);
+    for(i = 0; i < 3; i++)
+    {
+        if (idx[i] != i)
+        {
+            fprintf(stderr, "%s : Expected index %" PRIu64 ", got %" PRIu64 "\n", __func__, i, idx[i]);
+            ++errors;
+        }
+    }
+    free(arr);
+    free(tmp);
+    free(src);
+    free(idx);
+    free(tdx);
+    return errors;
+}
+
+void benchmark_parallel_sort_uint64_t()
+{
+    const uint64_t nitems = 4000000;
+    uint64_t *arr = (uint64_t *)malloc(nitems * sizeof(uint64_t));
+    uint64_t *tmp = (uint64_t *)malloc(nitems * sizeof(uint64_t));
+    struct timespec t0, t1;
+    uint32_t nthreads;
+    for (nthreads = 1; nthreads <= 4; nthreads *= 2)
+    {
+        fill_psort_data(arr, nitems);
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        parallel_sort_uint64_t(arr, tmp, nitems, nthreads);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        uint64_t ns = (((uint64_t)(t1.tv_sec - t0.tv_sec) * 1000000000) + (uint64_t)t1.tv_nsec) - (uint64_t)t0.tv_nsec;
+        fprintf(stdout, " * %s (%" PRIu32 " threads) : %.3f ns/op\n", __func__, nthreads, (double)ns / nitems);
+    }
+    free(arr);
+    free(tmp);
+}
+
 int test_reverse_uint64_t()
 {
     int errors = 0;
@@ -272,20 +414,411 @@ int test_union_uint64_t_ba()
     return errors;
 }
 
+// generate a sorted set of nitems unique values, each one selected with probability 1/density
+static uint64_t gen_set(uint64_t *arr, uint64_t nitems, uint64_t density, uint64_t *seed)
+{
+    uint64_t n = 0, v = 0;
+    while (n < nitems)
+    {
+        *seed ^= *seed << 13;
+        *seed ^= *seed >> 7;
+        *seed ^= *seed << 17;
+        v += 1 + (*seed % density);
+        arr[n++] = v;
+    }
+    return n;
+}
+
+// reference implementation: flags 1 = only in a, 2 = only in b, 3 = in both
+static uint64_t ref_set_op(const uint64_t *a, uint64_t na, const uint64_t *b, uint64_t nb, int keep, uint64_t *o)
+{
+    uint64_t i = 0, j = 0, n = 0;
+    while ((i < na) || (j < nb))
+    {
+        if ((j >= nb) || ((i < na) && (a[i] < b[j])))
+        {
+            if (keep & 1) o[n++] = a[i];
+            i++;
+        }
+        else if ((i >= na) || (b[j] < a[i]))
+        {
+            if (keep & 2) o[n++] = b[j];
+            j++;
+        }
+        else
+        {
+            if (keep & 4) o[n++] = a[i];
+            i++;
+            j++;
+        }
+    }
+    return n;
+}
+
+static int check_set_result(const char *func, const char *op, uint64_t na, uint64_t nb, const uint64_t *exp, uint64_t nexp, const uint64_t *out, uint64_t nout)
+{
+    uint64_t i;
+    if (nout != nexp)
+    {
+        fprintf(stderr, "%s %s (%" PRIu64 ", %" PRIu64 "): Expected %" PRIu64 " items, got %" PRIu64 "\n", func, op, na, nb, nexp, nout);
+        return 1;
+    }
+    for (i = 0; i < nexp; i++)
+    {
+        if (out[i] != exp[i])
+        {
+            fprintf(stderr, "%s %s (%" PRIu64 ", %" PRIu64 "): Expected %" PRIu64 ", got %" PRIu64 " at %" PRIu64 "\n", func, op, na, nb, exp[i], out[i], i);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int test_set_operations()
+{
+    int errors = 0;
+    const uint64_t sizes[][3] =
+    {
+        // a_nitems, b_nitems, density
+        {0, 0, 2}, {0, 10, 2}, {10, 0, 2}, {1, 1, 1}, {3, 5, 2}, {4, 4, 1}, {7, 9, 3},
+        {100, 103, 2}, {1000, 1000, 2}, {1003, 997, 4}, {999, 1001, 1},
+        {10, 5000, 2}, {5000, 10, 2}, {3, 1000, 1}, {1000, 3, 1}, {1, 100000, 1}, {50, 100000, 2},
+    };
+    const uint64_t ntests = sizeof(sizes) / sizeof(sizes[0]);
+    uint64_t *a = (uint64_t *)malloc(100000 * sizeof(uint64_t));
+    uint64_t *b = (uint64_t *)malloc(100000 * sizeof(uint64_t));
+    uint64_t *exp = (uint64_t *)malloc(200000 * sizeof(uint64_t));
+    uint64_t *out = (uint64_t *)malloc(200000 * sizeof(uint64_t));
+    uint64_t seed = 0x9e3779b97f4a7c15;
+    uint64_t t, na, nb, nexp;
+    for (t = 0; t < ntests; t++)
+    {
+        na = gen_set(a, sizes[t][0], sizes[t][2], &seed);
+        nb = gen_set(b, sizes[t][1], sizes[t][2], &seed);
+        nexp = ref_set_op(a, na, b, nb, 4, exp);
+        errors += check_set_result(__func__, "intersection", na, nb, exp, nexp, out, (uint64_t)(intersection_set_uint64_t(a, na, b, nb, out) - out));
+        nexp = ref_set_op(a, na, b, nb, 7, exp);
+        errors += check_set_result(__func__, "union", na, nb, exp, nexp, out, (uint64_t)(union_set_uint64_t(a, na, b, nb, out) - out));
+        nexp = ref_set_op(a, na, b, nb, 1, exp);
+        errors += check_set_result(__func__, "difference", na, nb, exp, nexp, out, (uint64_t)(difference_set_uint64_t(a, na, b, nb, out) - out));
+        nexp = ref_set_op(a, na, b, nb, 3, exp);
+        errors += check_set_result(__func__, "symmetric_difference", na, nb, exp, nexp, out, (uint64_t)(symmetric_difference_set_uint64_t(a, na, b, nb, out) - out));
+    }
+    free(a);
+    free(b);
+    free(exp);
+    free(out);
+    return errors;
+}
+
+int test_gallop_uint64_t()
+{
+    int errors = 0;
+    uint64_t arr[10] = {2, 4, 6, 8, 10, 12, 14, 16, 18, 20};
+    uint64_t search, exp, pos;
+    for (search = 0; search <= 22; search++)
+    {
+        exp = (search <= 2) ? 0 : ((search > 20) ? 10 : ((search + 1) / 2) - 1);
+        pos = gallop_uint64_t(arr, 10, search);
+        if (pos != exp)
+        {
+            fprintf(stderr, "%s (%" PRIu64 "): Expected %" PRIu64 ", got %" PRIu64 "\n", __func__, search, exp, pos);
+            ++errors;
+        }
+    }
+    if (gallop_uint64_t(arr, 0, 5) != 0)
+    {
+        fprintf(stderr, "%s : Expected 0 for an empty array\n", __func__);
+        ++errors;
+    }
+    return errors;
+}
+
+typedef uint64_t *(*set_op_t)(const uint64_t *, uint64_t, const uint64_t *, uint64_t, uint64_t *);
+
+static uint64_t *intersection_scalar(const uint64_t *a, uint64_t na, const uint64_t *b, uint64_t nb, uint64_t *o)
+{
+    return intersection_uint64_t((uint64_t *)a, na, (uint64_t *)b, nb, o);
+}
+
+static uint64_t *union_scalar(const uint64_t *a, uint64_t na, const uint64_t *b, uint64_t nb, uint64_t *o)
+{
+    return union_uint64_t((uint64_t *)a, na, (uint64_t *)b, nb, o);
+}
+
+static void benchmark_set_op(const char *name, set_op_t fn, const uint64_t *a, uint64_t na, const uint64_t *b, uint64_t nb, uint64_t *o)
+{
+    struct timespec t0, t1;
+    int r, nrep = 5;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (r = 0; r < nrep; r++)
+    {
+        fn(a, na, b, nb, o);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    uint64_t ns = (((uint64_t)(t1.tv_sec - t0.tv_sec) * 1000000000) + (uint64_t)t1.tv_nsec) - (uint64_t)t0.tv_nsec;
+    fprintf(stdout, " * %s (%" PRIu64 " x %" PRIu64 ") : %.3f ns/item\n", name, na, nb, (double)ns / ((double)nrep * (double)(na + nb)));
+}
+
+void benchmark_set_operations()
+{
+    const uint64_t nitems = 1000000;
+    uint64_t *a = (uint64_t *)malloc(nitems * sizeof(uint64_t));
+    uint64_t *b = (uint64_t *)malloc(nitems * sizeof(uint64_t));
+    uint64_t *o = (uint64_t *)malloc(2 * nitems * sizeof(uint64_t));
+    uint64_t seed = 0x2545f4914f6cdd1d;
+    uint64_t nsmall = 1000;
+    gen_set(a, nitems, 4, &seed);
+    gen_set(b, nitems, 4, &seed);
+    benchmark_set_op("intersection_uint64_t", intersection_scalar, a, nitems, b, nitems, o);
+    benchmark_set_op("intersection_set_uint64_t", intersection_set_uint64_t, a, nitems, b, nitems, o);
+    benchmark_set_op("union_uint64_t", union_scalar, a, nitems, b, nitems, o);
+    benchmark_set_op("union_set_uint64_t", union_set_uint64_t, a, nitems, b, nitems, o);
+    benchmark_set_op("difference_set_uint64_t", difference_set_uint64_t, a, nitems, b, nitems, o);
+    benchmark_set_op("symmetric_difference_set_uint64_t", symmetric_difference_set_uint64_t, a, nitems, b, nitems, o);
+    // small sample against a large panel
+    gen_set(a, nsmall, 4000, &seed);
+    benchmark_set_op("intersection_uint64_t", intersection_scalar, a, nsmall, b, nitems, o);
+    benchmark_set_op("intersection_set_uint64_t", intersection_set_uint64_t, a, nsmall, b, nitems, o);
+    benchmark_set_op("union_uint64_t", union_scalar, a, nsmall, b, nitems, o);
+    benchmark_set_op("union_set_uint64_t", union_set_uint64_t, a, nsmall, b, nitems, o);
+    benchmark_set_op("difference_set_uint64_t", difference_set_uint64_t, a, nsmall, b, nitems, o);
+    benchmark_set_op("symmetric_difference_set_uint64_t", symmetric_difference_set_uint64_t, a, nsmall, b, nitems, o);
+    free(a);
+    free(b);
+    free(o);
+}
+
+// generate nsets sorted sets of VariantKey-like values spread over all the CHROM bytes
+static void gen_kway_sets(uint64_t **arr, uint64_t *nitems, uint32_t nsets, uint64_t maxitems, uint64_t *seed)
+{
+    uint32_t s;
+    uint64_t n, v, step;
+    for (s = 0; s < nsets; s++)
+    {
+        *seed ^= *seed << 13;
+        *seed ^= *seed >> 7;
+        *seed ^= *seed << 17;
+        nitems[s] = (s == 3) ? 0 : (*seed % maxitems); // one empty set
+        step = 0xFFFFFFFFFFFFFFFF / ((nitems[s] * 2) + 1);
+        v = 0;
+        for (n = 0; n < nitems[s]; n++)
+        {
+            *seed ^= *seed << 13;
+            *seed ^= *seed >> 7;
+            *seed ^= *seed << 17;
+            v += 1 + ((*seed % step) & 0xFFFFFFFFFFFFFFC0); // overlapping values across sets
+            arr[s][n] = v;
+        }
+    }
+}
+
+// reference k-way count: sort all the values and count the runs
+static uint64_t ref_kway_count(uint64_t **arr, const uint64_t *nitems, uint32_t nsets, uint32_t mincount, uint64_t *o_arr, uint32_t *o_cnt)
+{
+    uint64_t total = 0, i, n = 0;
+    uint32_t s;
+    for (s = 0; s < nsets; s++)
+    {
+        total += nitems[s];
+    }
+    uint64_t *all = (uint64_t *)malloc((total + 1) * sizeof(uint64_t));
+    uint64_t *tmp = (uint64_t *)malloc((total + 1) * sizeof(uint64_t));
+    for (total = 0, s = 0; s < nsets; s++)
+    {
+        memcpy(all + total, arr[s], nitems[s] * sizeof(uint64_t));
+        total += nitems[s];
+    }
+    parallel_sort_uint64_t(all, tmp, total, 1);
+    uint32_t cnt;
+    for (i = 0; i < total; i += cnt)
+    {
+        for (cnt = 1; ((i + cnt) < total) && (all[i + cnt] == all[i]); cnt++);
+        if (cnt >= mincount)
+        {
+            o_cnt[n] = cnt;
+            o_arr[n++] = all[i];
+        }
+    }
+    free(all);
+    free(tmp);
+    return n;
+}
+
+static int check_kway_result(const char *func, const char *op, uint32_t nsets, uint32_t param, const uint64_t *exp, const uint32_t *ecnt, uint64_t nexp, const uint64_t *out, const uint32_t *ocnt, uint64_t nout)
+{
+    uint64_t i;
+    if (nout != nexp)
+    {
+        fprintf(stderr, "%s %s (%" PRIu32 " sets, %" PRIu32 "): Expected %" PRIu64 " items, got %" PRIu64 "\n", func, op, nsets, param, nexp, nout);
+        return 1;
+    }
+    for (i = 0; i < nexp; i++)
+    {
+        if ((out[i] != exp[i]) || ((ocnt != NULL) && (ocnt[i] != ecnt[i])))
+        {
+            fprintf(stderr, "%s %s (%" PRIu32 " sets, %" PRIu32 "): Unexpected item %" PRIu64 "\n", func, op, nsets, param, i);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int test_kway()
+{
+    int errors = 0;
+    const uint32_t tsets[] = {1, 2, 4, 7, 70, 300};
+    const uint64_t maxitems = 2000;
+    uint32_t maxsets = 300;
+    uint64_t **arr = (uint64_t **)malloc(maxsets * sizeof(uint64_t *));
+    uint64_t *nitems = (uint64_t *)malloc(maxsets * sizeof(uint64_t));
+    uint64_t *exp = (uint64_t *)malloc(maxsets * maxitems * sizeof(uint64_t));
+    uint64_t *out = (uint64_t *)malloc(maxsets * maxitems * sizeof(uint64_t));
+    uint32_t *ecnt = (uint32_t *)malloc(maxsets * maxitems * sizeof(uint32_t));
+    uint32_t *ocnt = (uint32_t *)malloc(maxsets * maxitems * sizeof(uint32_t));
+    uint64_t seed = 0x9e3779b97f4a7c15;
+    uint64_t nexp, nout, n;
+    uint32_t t, s, nsets, mincount, nthreads;
+    for (s = 0; s < maxsets; s++)
+    {
+        arr[s] = (uint64_t *)malloc(maxitems * sizeof(uint64_t));
+    }
+    for (t = 0; t < (sizeof(tsets) / sizeof(tsets[0])); t++)
+    {
+        nsets = tsets[t];
+        gen_kway_sets(arr, nitems, nsets, maxitems, &seed);
+        if (nsets > 3)
+        {
+            nitems[3] = 1; // avoid an empty intersection
+        }
+        const uint64_t **carr = (const uint64_t **)arr;
+        for (mincount = 1; mincount <= nsets; mincount = (mincount * 2) + 1)
+        {
+            nexp = ref_kway_count(arr, nitems, nsets, mincount, exp, ecnt);
+            nout = kway_count_uint64_t(carr, nitems, nsets, mincount, out, ocnt);
+            errors += check_kway_result(__func__, "count", nsets, mincount, exp, ecnt, nexp, out, ocnt, nout);
+            for (nthreads = 1; nthreads <= 3; nthreads += 2)
+            {
+                nout = parallel_kway_count_uint64_t(carr, nitems, nsets, mincount, out, ocnt, nthreads);
+                errors += check_kway_result(__func__, "parallel_count", nsets, mincount, exp, ecnt, nexp, out, ocnt, nout);
+            }
+        }
+        nexp = ref_kway_count(arr, nitems, nsets, 1, exp, ecnt);
+        nout = kway_union_uint64_t(carr, nitems, nsets, out);
+        errors += check_kway_result(__func__, "union", nsets, 1, exp, ecnt, nexp, out, NULL, nout);
+        nout = parallel_kway_union_uint64_t(carr, nitems, nsets, out, 3);
+        errors += check_kway_result(__func__, "parallel_union", nsets, 1, exp, ecnt, nexp, out, NULL, nout);
+        nexp = ref_kway_count(arr, nitems, nsets, nsets, exp, ecnt);
+        nout = kway_intersection_uint64_t(carr, nitems, nsets, out);
+        errors += check_kway_result(__func__, "intersection", nsets, nsets, exp, ecnt, nexp, out, NULL, nout);
+        nout = parallel_kway_intersection_uint64_t(carr, nitems, nsets, out, 3);
+        errors += check_kway_result(__func__, "parallel_intersection", nsets, nsets, exp, ecnt, nexp, out, NULL, nout);
+    }
+    // intersection of identical sets
+    for (n = 0; n < maxitems; n++)
+    {
+        arr[0][n] = n * 0x0008100000000003;
+    }
+    for (s = 0; s < 5; s++)
+    {
+        memcpy(arr[s], arr[0], maxitems * sizeof(uint64_t));
+        nitems[s] = maxitems;
+    }
+    nout = kway_intersection_uint64_t((const uint64_t **)arr, nitems, 5, out);
+    errors += check_kway_result(__func__, "intersection_same", 5, 5, arr[0], NULL, maxitems, out, NULL, nout);
+    if ((kway_union_uint64_t(NULL, NULL, 0, out) != 0) || (kway_intersection_uint64_t(NULL, NULL, 0, out) != 0) || (parallel_kway_union_uint64_t(NULL, NULL, 0, out, 2) != 0))
+    {
+        fprintf(stderr, "%s : Expected 0 items for 0 sets\n", __func__);
+        ++errors;
+    }
+    for (s = 0; s < maxsets; s++)
+    {
+        free(arr[s]);
+    }
+    free(arr);
+    free(nitems);
+    free(exp);
+    free(out);
+    free(ecnt);
+    free(ocnt);
+    return errors;
+}
+
+void benchmark_kway()
+{
+    const uint32_t nsets = 100;
+    const uint64_t maxitems = 20000;
+    uint64_t **arr = (uint64_t **)malloc(nsets * sizeof(uint64_t *));
+    uint64_t *nitems = (uint64_t *)malloc(nsets * sizeof(uint64_t));
+    uint64_t *out = (uint64_t *)malloc(nsets * maxitems * sizeof(uint64_t));
+    uint64_t *tmp = (uint64_t *)malloc(nsets * maxitems * sizeof(uint64_t));
+    uint64_t seed = 0x2545f4914f6cdd1d;
+    uint64_t total = 0, n = 0;
+    uint32_t s;
+    for (s = 0; s < nsets; s++)
+    {
+        arr[s] = (uint64_t *)malloc(maxitems * sizeof(uint64_t));
+    }
+    gen_kway_sets(arr, nitems, nsets, maxitems, &seed);
+    for (s = 0; s < nsets; s++)
+    {
+        total += nitems[s];
+    }
+    struct timespec t0, t1;
+    uint64_t ns;
+    // chained two-way unions
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (s = 0; s < nsets; s++)
+    {
+        n = (uint64_t)(union_uint64_t(out, n, arr[s], nitems[s], tmp) - tmp);
+        memcpy(out, tmp, n * sizeof(uint64_t));
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    ns = (((uint64_t)(t1.tv_sec - t0.tv_sec) * 1000000000) + (uint64_t)t1.tv_nsec) - (uint64_t)t0.tv_nsec;
+    fprintf(stdout, " * %s chained union_uint64_t (%" PRIu32 " sets) : %.3f ns/item\n", __func__, nsets, (double)ns / total);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    kway_union_uint64_t((const uint64_t **)arr, nitems, nsets, out);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    ns = (((uint64_t)(t1.tv_sec - t0.tv_sec) * 1000000000) + (uint64_t)t1.tv_nsec) - (uint64_t)t0.tv_nsec;
+    fprintf(stdout, " * %s kway_union_uint64_t (%" PRIu32 " sets) : %.3f ns/item\n", __func__, nsets, (double)ns / total);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    parallel_kway_union_uint64_t((const uint64_t **)arr, nitems, nsets, out, 4);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    ns = (((uint64_t)(t1.tv_sec - t0.tv_sec) * 1000000000) + (uint64_t)t1.tv_nsec) - (uint64_t)t0.tv_nsec;
+    fprintf(stdout, " * %s parallel_kway_union_uint64_t (%" PRIu32 " sets, 4 threads) : %.3f ns/item\n", __func__, nsets, (double)ns / total);
+    for (s = 0; s < nsets; s++)
+    {
+        free(arr[s]);
+    }
+    free(arr);
+    free(nitems);
+    free(out);
+    free(tmp);
+}
+
 int main()
 {
     int errors = 0;
 
     errors += test_sort_uint64_t();
     errors += test_order_uint64_t();
+    errors += test_parallel_sort_uint64_t();
+    errors += test_parallel_sort_uint64_t_small();
+    errors += test_parallel_order_uint64_t();
     errors += test_reverse_uint64_t();
     errors += test_unique_uint64_t();
     errors += test_unique_uint64_t_zero();
     errors += test_intersection_uint64_t();
     errors += test_union_uint64_t();
     errors += test_union_uint64_t_ba();
+    errors += test_gallop_uint64_t();
+    errors += test_set_operations();
+    errors += test_kway();
 
     benchmark_sort_uint64_t();
+    benchmark_parallel_sort_uint64_t();
+    benchmark_set_operations();
+    benchmark_kway();
 
     return errors;
 }
@@ -0,0 +1,294 @@
+// Nicola Asuni
+
+#if __STDC_VERSION__ >= 199901L
+#define _XOPEN_SOURCE 600
+#else
+#define _XOPEN_SOURCE 500
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include "../src/variantkey/stree.h"
+
+#define TEST_DATA_ITEMS 251
+#define TEST_BENCH_ITEMS 4000000
+#define TEST_BENCH_LOOKUPS 1000000
+
+static const uint8_t typecolmap[] = {0,0,1,0,2,0,0,0,3};
+
+static const uint64_t test_sizes[] = {0, 1, 2, 7, 15, 16, 17, 255, 256, 257, 4095, 4096, 4097, 65537, 300000};
+
+// returns current time in nanoseconds
+uint64_t get_time()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+    return (((uint64_t)t.tv_sec * 1000000000) + (uint64_t)t.tv_nsec);
+}
+
+static uint64_t test_rand(uint64_t *x)
+{
+    *x ^= *x << 13;
+    *x ^= *x >> 7;
+    *x ^= *x << 17;
+    return *x;
+}
+
+static int cmp_uint64_t(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+#define define_check_stree(T) \
+int check_stree_##T(const T *src, uint64_t nrows, T search) \
+{ \
+    int errors = 0; \
+    stree_t st; \
+    T *idx = (T *)malloc(sizeof(T) * (stree_layout(nrows, &st) + 1)); \
+    build_stree_##T(src, &st, idx); \
+    uint64_t first = 0, last = nrows; \
+    uint64_t exp = (nrows > 0) ? col_find_first_##T(src, &first, &last, search) : 0; \
+    uint64_t got = stree_find_first_##T(src, idx, &st, search); \
+    if (got != exp) \
+    { \
+        fprintf(stderr, "%s (%" PRIu64 ", %" PRIx64 ") FIRST Expected %" PRIu64 ", got %" PRIu64 "\n", __func__, nrows, (uint64_t)search, exp, got); \
+        ++errors; \
+    } \
+    first = 0; \
+    last = nrows; \
+    exp = (nrows > 0) ? col_find_last_##T(src, &first, &last, search) : 0; \
+    got = stree_find_last_##T(src, idx, &st, search); \
+    if (got != exp) \
+    { \
+        fprintf(stderr, "%s (%" PRIu64 ", %" PRIx64 ") LAST Expected %" PRIu64 ", got %" PRIu64 "\n", __func__, nrows, (uint64_t)search, exp, got); \
+        ++errors; \
+    } \
+    free(idx); \
+    return errors; \
+}
+
+define_check_stree(uint8_t)
+define_check_stree(uint16_t)
+define_check_stree(uint32_t)
+define_check_stree(uint64_t)
+
+#define define_test_stree_col(T) \
+int test_stree_col_##T(mmfile_t mf) \
+{ \
+    int errors = 0; \
+    uint64_t i; \
+    const T *src = get_src_offset_##T(mf.src, mf.index[typecolmap[sizeof(T)]]); \
+    for (i = 0; i < TEST_DATA_ITEMS; i++) \
+    { \
+        errors += check_stree_##T(src, TEST_DATA_ITEMS, src[i]); \
+        errors += check_stree_##T(src, TEST_DATA_ITEMS, (T)(src[i] + 1)); \
+        errors += check_stree_##T(src, TEST_DATA_ITEMS, (T)(src[i] - 1)); \
+        errors += check_stree_##T(src, i, src[i]); \
+    } \
+    errors += check_stree_##T(src, TEST_DATA_ITEMS, (T)(~(T)0)); \
+    return errors; \
+}
+
+define_test_stree_col(uint8_t)
+define_test_stree_col(uint16_t)
+define_test_stree_col(uint32_t)
+define_test_stree_col(uint64_t)
+
+#define define_test_stree_random(T) \
+int test_stree_random_##T() \
+{ \
+    int errors = 0; \
+    uint64_t seed = 0x1234567890abcdef; \
+    uint64_t i, j, k, nrows, first, last, exp, got, *tmp; \
+    T *buf, *src, *idx, search; \
+    stree_t st; \
+    for (k = 0; k < (sizeof(test_sizes) / sizeof(test_sizes[0])); k++) \
+    { \
+        nrows = test_sizes[k]; \
+        tmp = (uint64_t *)malloc(sizeof(uint64_t) * (nrows + 1)); \
+        buf = (T *)calloc((nrows + 2), sizeof(T)); /* col_find_* may read one item outside the range */ \
+        src = buf + 1; \
+        for (i = 0; i < nrows; i++) \
+        { \
+            tmp[i] = (test_rand(&seed) >> 1) % (((uint64_t)1 << (4 * sizeof(T))) + (nrows >> 1)); /* include duplicates */ \
+        } \
+        qsort(tmp, nrows, sizeof(uint64_t), cmp_uint64_t); \
+        for (i = 0; i < nrows; i++) \
+        { \
+            src[i] = (T)tmp[i]; \
+            if ((i > 0) && (src[i] < src[(i - 1)])) \
+            { \
+                src[i] = src[(i - 1)]; \
+            } \
+        } \
+        if (nrows > 0) \
+        { \
+            buf[0] = src[0]; /* guard values never matching out of range searches */ \
+            src[nrows] = src[(nrows - 1)]; \
+        } \
+        idx = (T *)malloc(sizeof(T) * (stree_layout(nrows, &st) + 1)); \
+        build_stree_##T(src, &st, idx); \
+        for (j = 0; j < 5000; j++) \
+        { \
+            search = (T)((nrows > 0) ? src[(test_rand(&seed) % nrows)] : test_rand(&seed)); \
+            search = (T)(search + (T)(j % 3) - 1); \
+            first = 0; \
+            last = nrows; \
+            exp = (nrows > 0) ? col_find_first_##T(src, &first, &last, search) : 0; \
+            got = stree_find_first_##T(src, idx, &st, search); \
+            if (got != exp) \
+            { \
+                fprintf(stderr, "%s (%" PRIu64 ", %" PRIx64 ") FIRST Expected %" PRIu64 ", got %" PRIu64 "\n", __func__, nrows, (uint64_t)search, exp, got); \
+                ++errors; \
+            } \
+            first = 0; \
+            last = nrows; \
+            exp = (nrows > 0) ? col_find_last_##T(src, &first, &last, search) : 0; \
+            got = stree_find_last_##T(src, idx, &st, search); \
+            if (got != exp) \
+            { \
+                fprintf(stderr, "%s (%" PRIu64 ", %" PRIx64 ") LAST Expected %" PRIu64 ", got %" PRIu64 "\n", __func__, nrows, (uint64_t)search, exp, got); \
+                ++errors; \
+            } \
+        } \
+        free(idx); \
+        free(buf); \
+        free(tmp); \
+    } \
+    return errors; \
+}
+
+define_test_stree_random(uint8_t)
+define_test_stree_random(uint16_t)
+define_test_stree_random(uint32_t)
+define_test_stree_random(uint64_t)
+
+int test_stree_file(mmfile_t mf)
+{
+    int errors = 0;
+    uint64_t i;
+    const uint64_t *src = get_src_offset_uint64_t(mf.src, mf.index[3]);
+    stree_t st;
+    uint64_t *idx = (uint64_t *)malloc(sizeof(uint64_t) * stree_layout(TEST_DATA_ITEMS, &st));
+    build_stree_uint64_t(src, &st, idx);
+    size_t len = save_stree_uint64_t("test_stree.bin", idx, &st);
+    if (len != (32 + (sizeof(uint64_t) * st.nitems)))
+    {
+        fprintf(stderr, "%s : Unexpected file size %lu\n", __func__, len);
+        ++errors;
+    }
+    free(idx);
+    mmfile_t imf = {0};
+    stree_t ist;
+    const uint64_t *iidx = (const uint64_t *)mmap_stree_file("test_stree.bin", TEST_DATA_ITEMS, &imf, &ist);
+    if (iidx == NULL)
+    {
+        fprintf(stderr, "%s : Unable to map the index file\n", __func__);
+        return ++errors;
+    }
+    for (i = 0; i < TEST_DATA_ITEMS; i++)
+    {
+        if (stree_find_first_uint64_t(src, iidx, &ist, src[i]) != i)
+        {
+            fprintf(stderr, "%s (%" PRIu64 ") : Unexpected position\n", __func__, i);
+            ++errors;
+        }
+    }
+    munmap_binfile(imf);
+    return errors;
+}
+
+void benchmark_stree_uint64_t()
+{
+    uint64_t tstart, tend, i, first, last, sum = 0;
+    uint64_t seed = 0x1234567890abcdef;
+    uint64_t *src = (uint64_t *)malloc(sizeof(uint64_t) * TEST_BENCH_ITEMS);
+    uint64_t *keys = (uint64_t *)malloc(sizeof(uint64_t) * TEST_BENCH_LOOKUPS);
+    for (i = 0; i < TEST_BENCH_ITEMS; i++)
+    {
+        src[i] = test_rand(&seed);
+    }
+    qsort(src, TEST_BENCH_ITEMS, sizeof(uint64_t), cmp_uint64_t);
+    for (i = 0; i < TEST_BENCH_LOOKUPS; i++)
+    {
+        keys[i] = src[(test_rand(&seed) % TEST_BENCH_ITEMS)];
+    }
+    stree_t st;
+    uint64_t *idx = (uint64_t *)malloc(sizeof(uint64_t) * stree_layout(TEST_BENCH_ITEMS, &st));
+    tstart = get_time();
+    build_stree_uint64_t(src, &st, idx);
+    tend = get_time();
+    fprintf(stdout, " * %s build : %lu ns/row (index: %" PRIu64 " bytes, %u levels)\n", __func__, (tend - tstart) / TEST_BENCH_ITEMS, st.nitems * 8, st.nlevels);
+    tstart = get_time();
+    for (i = 0; i < TEST_BENCH_LOOKUPS; i++)
+    {
+        first = 0;
+        last = TEST_BENCH_ITEMS;
+        sum += col_find_first_uint64_t(src, &first, &last, keys[i]);
+    }
+    tend = get_time();
+    fprintf(stdout, " * %s col_find_first : %lu ns/op\n", __func__, (tend - tstart) / TEST_BENCH_LOOKUPS);
+    tstart = get_time();
+    for (i = 0; i < TEST_BENCH_LOOKUPS; i++)
+    {
+        sum -= stree_find_first_uint64_t(src, idx, &st, keys[i]);
+    }
+    tend = get_time();
+    fprintf(stdout, " * %s stree_find_first : %lu ns/op (%" PRIx64 ")\n", __func__, (tend - tstart) / TEST_BENCH_LOOKUPS, sum);
+    free(idx);
+    free(keys);
+    free(src);
+}
+
+int main()
+{
+    int errors = 0;
+
+    char *file = "test_data_col.bin"; // file containing test data
+
+    mmfile_t mf = {0};
+    mf.ncols = 4;
+    mf.ctbytes[0] = 1;
+    mf.ctbytes[1] = 2;
+    mf.ctbytes[2] = 4;
+    mf.ctbytes[3] = 8;
+    mmap_binfile(file, &mf);
+
+    if (mf.fd < 0)
+    {
+        fprintf(stderr, "can't open %s for reading\n", file);
+        return 1;
+    }
+    if (mf.src == MAP_FAILED)
+    {
+        fprintf(stderr, "mmap error! [%s]\n", strerror(errno));
+        return 1;
+    }
+
+    errors += test_stree_col_uint8_t(mf);
+    errors += test_stree_col_uint16_t(mf);
+    errors += test_stree_col_uint32_t(mf);
+    errors += test_stree_col_uint64_t(mf);
+    errors += test_stree_random_uint8_t();
+    errors += test_stree_random_uint16_t();
+    errors += test_stree_random_uint32_t();
+    errors += test_stree_random_uint64_t();
+    errors += test_stree_file(mf);
+
+    benchmark_stree_uint64_t();
+
+    int e = munmap_binfile(mf);
+    if (e != 0)
+    {
+        fprintf(stderr, "Got %d error while unmapping the file\n", e);
+        return 1;
+    }
+
+    return errors;
+}
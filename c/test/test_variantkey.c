@@ -39,6 +39,7 @@
 #endif
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <strings.h>
 #include <inttypes.h>
@@ -946,6 +947,137 @@ void benchmark_encode_refalt_hash()
     fprintf(stdout, " * %s : %lu ns/op (%" PRIx32 ")\n", __func__, (tend - tstart)/size, hash);
 }
 
+int test_encode_refalt_hash_cols()
+{
+    int errors = 0;
+    static const uint64_t nrows = 1000;
+    static const char chars[] = "ACGTacgtNn*-<>DELIN`";
+    char *ref = (char *)malloc(nrows * 300);
+    char *alt = (char *)malloc(nrows * 300);
+    uint64_t *refoffset = (uint64_t *)malloc(nrows * sizeof(uint64_t));
+    uint64_t *altoffset = (uint64_t *)malloc(nrows * sizeof(uint64_t));
+    uint32_t *sizeref = (uint32_t *)malloc(nrows * sizeof(uint32_t));
+    uint32_t *sizealt = (uint32_t *)malloc(nrows * sizeof(uint32_t));
+    uint32_t *refalt = (uint32_t *)malloc(nrows * sizeof(uint32_t));
+    uint64_t i, j, ro = 0, ao = 0;
+    uint32_t seed = 1, h;
+    for (i=0 ; i < nrows; i++)
+    {
+        seed = ((seed * 1103515245) + 12345);
+        sizeref[i] = ((seed >> 8) % 300);
+        seed = ((seed * 1103515245) + 12345);
+        sizealt[i] = ((i % 7) == 0) ? 0 : ((seed >> 8) % 37);
+        refoffset[i] = ro;
+        altoffset[i] = ao;
+        for (j=0 ; j < sizeref[i]; j++)
+        {
+            seed = ((seed * 1103515245) + 12345);
+            ref[ro++] = chars[((seed >> 16) % 20)];
+        }
+        for (j=0 ; j < sizealt[i]; j++)
+        {
+            seed = ((seed * 1103515245) + 12345);
+            alt[ao++] = chars[((seed >> 16) % 20)];
+        }
+    }
+    variantkey_cols_t vc = {0};
+    vc.ref = ref;
+    vc.refoffset = refoffset;
+    vc.sizeref = sizeref;
+    vc.alt = alt;
+    vc.altoffset = altoffset;
+    vc.sizealt = sizealt;
+    vc.refbufsize = ro;
+    vc.altbufsize = ao;
+    vc.nrows = nrows;
+    encode_refalt_hash_cols(vc, refalt);
+    for (i=0 ; i < nrows; i++)
+    {
+        h = encode_refalt_hash((ref + refoffset[i]), sizeref[i], (alt + altoffset[i]), sizealt[i]);
+        if (refalt[i] != h)
+        {
+            fprintf(stderr, "%s (%" PRIu64 "): Unexpected hash: expected %08" PRIx32 ", got %08" PRIx32 "\n", __func__, i, h, refalt[i]);
+            ++errors;
+        }
+    }
+    hash32_cols(ref, refoffset, sizeref, nrows, refalt);
+    for (i=0 ; i < nrows; i++)
+    {
+        h = hash32((ref + refoffset[i]), sizeref[i]);
+        if (refalt[i] != h)
+        {
+            fprintf(stderr, "%s (%" PRIu64 "): Unexpected hash32: expected %08" PRIx32 ", got %08" PRIx32 "\n", __func__, i, h, refalt[i]);
+            ++errors;
+        }
+    }
+    free(ref);
+    free(alt);
+    free(refoffset);
+    free(altoffset);
+    free(sizeref);
+    free(sizealt);
+    free(refalt);
+    return errors;
+}
+
+void benchmark_encode_refalt_hash_cols()
+{
+    static const uint32_t lengths[] = {1, 10, 100, 1000, 10000};
+    static const uint64_t totsize = 4000000;
+    static const char *bases = "ACGT";
+    char *ref = (char *)malloc(totsize);
+    uint64_t *refoffset = (uint64_t *)malloc(totsize * sizeof(uint64_t));
+    uint32_t *sizeref = (uint32_t *)malloc(totsize * sizeof(uint32_t));
+    uint64_t *altoffset = (uint64_t *)calloc(totsize, sizeof(uint64_t));
+    uint32_t *sizealt = (uint32_t *)malloc(totsize * sizeof(uint32_t));
+    uint32_t *refalt = (uint32_t *)malloc(totsize * sizeof(uint32_t));
+    uint64_t tstart, tend, i, nrows;
+    volatile uint32_t sum = 0;
+    int k;
+    for (i=0 ; i < totsize; i++)
+    {
+        ref[i] = bases[((i * 7) >> 2) & 3];
+        sizealt[i] = 1;
+    }
+    variantkey_cols_t vc = {0};
+    vc.ref = ref;
+    vc.refoffset = refoffset;
+    vc.sizeref = sizeref;
+    vc.alt = ref;
+    vc.altoffset = altoffset;
+    vc.sizealt = sizealt;
+    vc.refbufsize = totsize;
+    vc.altbufsize = totsize;
+    for (k=0 ; k < 5; k++)
+    {
+        nrows = (totsize / lengths[k]);
+        for (i=0 ; i < nrows; i++)
+        {
+            refoffset[i] = (i * lengths[k]);
+            sizeref[i] = (lengths[k] - (uint32_t)(i & (lengths[k] > 1))); // mix of different lengths
+        }
+        vc.nrows = nrows;
+        tstart = get_time();
+        for (i=0 ; i < nrows; i++)
+        {
+            sum += encode_refalt_hash((ref + refoffset[i]), sizeref[i], ref, 1);
+        }
+        tend = get_time();
+        fprintf(stdout, " * %s (scalar loop, %" PRIu32 " bp) : %lu ns/op\n", __func__, lengths[k], (tend - tstart)/nrows);
+        tstart = get_time();
+        encode_refalt_hash_cols(vc, refalt);
+        tend = get_time();
+        sum += refalt[(nrows - 1)];
+        fprintf(stdout, " * %s (%" PRIu32 " bp) : %lu ns/op\n", __func__, lengths[k], (tend - tstart)/nrows);
+    }
+    free(ref);
+    free(refoffset);
+    free(sizeref);
+    free(altoffset);
+    free(sizealt);
+    free(refalt);
+}
+
 void benchmark_decode_refalt()
 {
     char ref[11], alt[11];
@@ -1117,6 +1249,134 @@ void benchmark_variantkey()
     fprintf(stdout, " * %s : %lu ns/op\n", __func__, (tend - tstart)/size);
 }
 
+// build the columnar input from the test data
+void gen_variantkey_cols(variantkey_cols_t *vc, uint8_t *chrom, uint32_t *pos, char *ref, uint64_t *refoffset, uint32_t *sizeref, char *alt, uint64_t *altoffset, uint32_t *sizealt, uint64_t nrows)
+{
+    uint64_t i, ro = 0, ao = 0;
+    size_t k;
+    for (i=0 ; i < nrows; i++)
+    {
+        k = (i % k_test_size);
+        chrom[i] = test_data[k].vkchrom;
+        pos[i] = test_data[k].pos;
+        sizeref[i] = strlen(test_data[k].ref);
+        sizealt[i] = strlen(test_data[k].alt);
+        memcpy((ref + ro), test_data[k].ref, sizeref[i]);
+        memcpy((alt + ao), test_data[k].alt, sizealt[i]);
+        refoffset[i] = ro;
+        altoffset[i] = ao;
+        ro += sizeref[i];
+        ao += sizealt[i];
+    }
+    vc->chrom = chrom;
+    vc->pos = pos;
+    vc->ref = ref;
+    vc->refoffset = refoffset;
+    vc->sizeref = sizeref;
+    vc->alt = alt;
+    vc->altoffset = altoffset;
+    vc->sizealt = sizealt;
+    vc->refbufsize = ro;
+    vc->altbufsize = ao;
+    vc->nrows = nrows;
+}
+
+int test_variantkey_cols()
+{
+    int errors = 0;
+    uint64_t i;
+    uint8_t chrom[k_test_size];
+    uint32_t pos[k_test_size], sizeref[k_test_size], sizealt[k_test_size];
+    uint64_t refoffset[k_test_size], altoffset[k_test_size], vk[k_test_size];
+    char ref[(k_test_size * 16)], alt[(k_test_size * 16)];
+    variantkey_cols_t vc;
+    gen_variantkey_cols(&vc, chrom, pos, ref, refoffset, sizeref, alt, altoffset, sizealt, k_test_size);
+    variantkey_cols(vc, vk);
+    for (i=0 ; i < (uint64_t)k_test_size; i++)
+    {
+        if (vk[i] != test_data[i].vk)
+        {
+            fprintf(stderr, "%s (%" PRIu64 "): Unexpected variantkey: expected 0x%016" PRIx64 ", got 0x%016" PRIx64 "\n", __func__, i, test_data[i].vk, vk[i]);
+            ++errors;
+        }
+    }
+    // mixed reversible, non-reversible and long alleles
+    static const char *input_data[] =
+    {"A", "C", "N", "GT", "ACG", "ACGTa", "ACGTac", "ACGTacg", "ACGTacgt", "ACGTACGTAC", "ACGTacgtACGT", "", "aCgTn", "ACGTACGTACGTACGTACGTACGT"};
+    static const int tlen = 14;
+    int r, a;
+    uint64_t n = 0, ro = 0, ao = 0;
+    for (r=0 ; r < tlen; r++)
+    {
+        for (a=0 ; a < tlen; a++)
+        {
+            chrom[n] = (uint8_t)(1 + (n % 25));
+            pos[n] = (uint32_t)(n * 1001);
+            sizeref[n] = strlen(input_data[r]);
+            sizealt[n] = strlen(input_data[a]);
+            memcpy((ref + ro), input_data[r], sizeref[n]);
+            memcpy((alt + ao), input_data[a], sizealt[n]);
+            refoffset[n] = ro;
+            altoffset[n] = ao;
+            ro += sizeref[n];
+            ao += sizealt[n];
+            n++;
+        }
+    }
+    vc.refbufsize = ro;
+    vc.altbufsize = ao;
+    vc.nrows = n;
+    variantkey_cols(vc, vk);
+    for (i=0 ; i < n; i++)
+    {
+        uint64_t e = variantkey("1", 1, pos[i], (ref + refoffset[i]), sizeref[i], (alt + altoffset[i]), sizealt[i]);
+        e = ((e & ~VKMASK_CHROM) | ((uint64_t)chrom[i] << VKSHIFT_CHROM));
+        if (vk[i] != e)
+        {
+            fprintf(stderr, "%s (%" PRIu64 "): Unexpected variantkey: expected 0x%016" PRIx64 ", got 0x%016" PRIx64 "\n", __func__, i, e, vk[i]);
+            ++errors;
+        }
+    }
+    return errors;
+}
+
+void benchmark_variantkey_cols()
+{
+    const uint64_t size = 100000;
+    uint8_t *chrom = (uint8_t *)malloc(size * sizeof(uint8_t));
+    uint32_t *pos = (uint32_t *)malloc(size * sizeof(uint32_t));
+    uint32_t *sizeref = (uint32_t *)malloc(size * sizeof(uint32_t));
+    uint32_t *sizealt = (uint32_t *)malloc(size * sizeof(uint32_t));
+    uint64_t *refoffset = (uint64_t *)malloc(size * sizeof(uint64_t));
+    uint64_t *altoffset = (uint64_t *)malloc(size * sizeof(uint64_t));
+    uint64_t *vk = (uint64_t *)malloc(size * sizeof(uint64_t));
+    char *ref = (char *)malloc(size * 16);
+    char *alt = (char *)malloc(size * 16);
+    variantkey_cols_t vc;
+    gen_variantkey_cols(&vc, chrom, pos, ref, refoffset, sizeref, alt, altoffset, sizealt, size);
+    uint64_t tstart, tend, i;
+    tstart = get_time();
+    for (i=0 ; i < size; i++)
+    {
+        vk[i] = encode_variantkey(chrom[i], pos[i], encode_refalt((ref + refoffset[i]), sizeref[i], (alt + altoffset[i]), sizealt[i]));
+    }
+    tend = get_time();
+    fprintf(stdout, " * %s (scalar loop) : %lu ns/op (%016" PRIx64 ")\n", __func__, (tend - tstart)/size, vk[(size - 1)]);
+    tstart = get_time();
+    variantkey_cols(vc, vk);
+    tend = get_time();
+    fprintf(stdout, " * %s : %lu ns/op (%016" PRIx64 ")\n", __func__, (tend - tstart)/size, vk[(size - 1)]);
+    free(chrom);
+    free(pos);
+    free(sizeref);
+    free(sizealt);
+    free(refoffset);
+    free(altoffset);
+    free(vk);
+    free(ref);
+    free(alt);
+}
+
 int test_variantkey_range()
 {
     int errors = 0;
@@ -1326,12 +1586,14 @@ int main()
     errors += test_encode_chrom();
     errors += test_decode_chrom();
     errors += test_encode_refalt();
+    errors += test_encode_refalt_hash_cols();
     errors += test_encode_variantkey();
     errors += test_extract_variantkey_chrom();
     errors += test_extract_variantkey_pos();
     errors += test_extract_variantkey_refalt();
     errors += test_decode_variantkey();
     errors += test_variantkey();
+    errors += test_variantkey_cols();
     errors += test_variantkey_range();
     errors += test_compare_variantkey_chrom();
     errors += test_compare_variantkey_chrom_pos();
@@ -1342,10 +1604,12 @@ int main()
     benchmark_decode_chrom();
     benchmark_encode_refalt_rev();
     benchmark_encode_refalt_hash();
+    benchmark_encode_refalt_hash_cols();
     benchmark_decode_refalt();
     benchmark_encode_variantkey();
     benchmark_decode_variantkey();
     benchmark_variantkey();
+    benchmark_variantkey_cols();
     benchmark_variantkey_range();
     benchmark_variantkey_hex();
     benchmark_parse_variantkey_hex();
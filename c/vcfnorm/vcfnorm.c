@@ -0,0 +1,849 @@
+// VariantKey VCF Normalizer Command Line Application
+//
+// vcfnorm.c
+//
+// @category   Tools
+// @author     Nicola Asuni <nicola.asuni@genomicsplc.com>
+// @copyright  2017-2018 GENOMICS plc
+// @license    MIT (see LICENSE)
+// @link       https://github.com/genomicsplc/variantkey
+//
+// LICENSE
+//
+// Copyright (c) 2017-2018 GENOMICS plc
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Normalize the variants of a VCF file against a genoref (or 2-bit packed genoref) file,
+// replacing the external "vt normalize" step of resources/tools/vcfnorm.sh.
+//
+// The input is plain VCF text (use "bgzip -dc" or "zcat" to stream compressed files).
+// It is read in chunks of complete lines that are normalized in parallel by a pool
+// of worker threads sharing the same memory-mapped genoref file, while a writer
+// thread emits the processed chunks in the original input order.
+//
+// Each bi-allelic record is normalized with normalize_variant_cols (see genoref.h)
+// and its POS, REF and ALT fields are rewritten. Header lines, multi-allelic records
+// (see "vt decompose" or "bcftools norm -m -"), symbolic alleles and records with
+// an unknown chromosome or an inconsistent reference are copied unchanged.
+// Optionally the normalized VariantKey is added to the INFO field.
+
+#if __STDC_VERSION__ >= 199901L
+#define _XOPEN_SOURCE 600
+#else
+#define _XOPEN_SOURCE 500
+#endif
+
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../src/variantkey/genoref.h"
+
+#ifndef VERSION
+#define VERSION "0.0.0-0"
+#endif
+
+#define VCFNORM_DEFAULT_CHUNK "4M" //!< Default chunk size
+#define VCFNORM_MAX_THREADS   256 //!< Maximum number of worker threads
+#define VCFNORM_IOBUF_SIZE    (1 << 20) //!< Size of the output stream buffer
+#define VCFNORM_LINE_EXTRA    40  //!< Maximum number of bytes added to a line (POS digits, left extension and VK field)
+#define VCFNORM_VK_INFO       "##INFO=<ID=VK,Number=1,Type=String,Description=\"VariantKey of the normalized variant\">\n"
+
+enum vcfnorm_state_t
+{
+    VCFNORM_FREE,  // the chunk can be filled by the reader
+    VCFNORM_READY, // the chunk contains input lines to be processed
+    VCFNORM_DONE,  // the chunk contains output lines to be written
+};
+
+// Position of the fields of a VCF data line, relative to the beginning of the line.
+typedef struct vcfnorm_rec_t
+{
+    size_t line;   // offset of the line in the input chunk
+    size_t len;    // line length, excluding the newline
+    size_t fpos;   // offset of the POS field
+    size_t fid;    // offset of the ID field
+    size_t fref;   // offset of the REF field
+    size_t falt;   // offset of the ALT field
+    size_t frest;  // offset of the first byte after the ALT field
+    size_t finfo;  // offset of the INFO field (0 if not present)
+    size_t einfo;  // offset of the first byte after the INFO field
+    int64_t row;   // row index in the normalization columns (-1 = copy unchanged)
+} vcfnorm_rec_t;
+
+typedef struct vcfnorm_chunk_t
+{
+    int state;
+    char *in;      // input lines
+    size_t inlen;
+    size_t insize;
+    char *out;     // output lines
+    size_t outlen;
+    size_t outsize;
+    vcfnorm_rec_t *rec;
+    size_t nrec;
+    size_t maxrec;
+    // normalization columns
+    uint8_t *chrom;
+    uint32_t *pos;
+    uint64_t *refoffset;
+    uint32_t *sizeref;
+    uint64_t *altoffset;
+    uint32_t *sizealt;
+    uint32_t *npos;
+    uint64_t *nrefoffset;
+    uint32_t *nsizeref;
+    uint64_t *naltoffset;
+    uint32_t *nsizealt;
+    int *status;
+    uint64_t *vk;
+    size_t maxrow;
+    char *nref;
+    char *nalt;
+    size_t arenasize;
+} vcfnorm_chunk_t;
+
+typedef struct vcfnorm_t
+{
+    mmfile_t mf;
+    int addvk;
+    FILE *out;
+    vcfnorm_chunk_t *chunk;
+    size_t nchunks;
+    uint64_t nread;   // number of chunks filled by the reader
+    uint64_t nwork;   // number of chunks taken by the workers
+    uint64_t nwrite;  // number of chunks written
+    int eof;
+    int err;
+    uint64_t nrows;   // number of data records
+    uint64_t nnorm;   // number of normalized records
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} vcfnorm_t;
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "VariantKey VCF Normalizer %s\n"
+            "Usage: vcfnorm [-p THREADS] [-c CHUNK_SIZE] [-k] GENOREF INPUT OUTPUT\n"
+            "  GENOREF : genoref.bin or 2-bit packed genoref file\n"
+            "  INPUT   : input VCF file (\"-\" for standard input, use \"bgzip -dc\" for compressed files)\n"
+            "  OUTPUT  : output VCF file (\"-\" for standard output)\n"
+            "  -p      : number of worker threads (default 1)\n"
+            "  -c      : size of the input chunks processed by each thread in bytes, or with a K, M or G suffix (default %s)\n"
+            "  -k      : add the VariantKey of the normalized variant to the INFO field (VK)\n",
+            VERSION, VCFNORM_DEFAULT_CHUNK);
+}
+
+static double now_sec(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return ((double)t.tv_sec + ((double)t.tv_nsec / 1e9));
+}
+
+// Returns the offset of the next TAB in line[start:end], or end if not found.
+static size_t next_field(const char *line, size_t start, size_t end)
+{
+    const char *p = (const char *)memchr(line + start, '\t', end - start);
+    return (p == NULL) ? end : (size_t)(p - line);
+}
+
+// Parse the 1-based POS field. Returns 0 if invalid.
+static uint32_t parse_pos(const char *s, size_t len)
+{
+    uint64_t v = 0;
+    size_t i;
+    if ((len == 0) || (len > 10))
+    {
+        return 0;
+    }
+    for (i = 0; i < len; i++)
+    {
+        if ((s[i] < '0') || (s[i] > '9'))
+        {
+            return 0;
+        }
+        v = (v * 10) + (uint64_t)(s[i] - '0');
+    }
+    return (v > UINT32_MAX) ? 0 : (uint32_t)v;
+}
+
+// Returns true if the allele can be normalized (non-empty sequence of letters).
+static int is_sequence(const char *s, size_t len)
+{
+    size_t i;
+    if (len == 0)
+    {
+        return 0;
+    }
+    for (i = 0; i < len; i++)
+    {
+        if (((s[i] | 0x20) < 'a') || ((s[i] | 0x20) > 'z'))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static size_t write_uint32(char *dst, uint32_t v)
+{
+    char tmp[10];
+    size_t n = 0, i;
+    do
+    {
+        tmp[n++] = (char)('0' + (v % 10));
+        v /= 10;
+    }
+    while (v > 0);
+    for (i = 0; i < n; i++)
+    {
+        dst[i] = tmp[(n - 1 - i)];
+    }
+    return n;
+}
+
+static int grow(void **ptr, size_t *cap, size_t need, size_t itemsize)
+{
+    size_t n;
+    void *p;
+    if (need <= *cap)
+    {
+        return 0;
+    }
+    n = (*cap > 0) ? *cap : 1024;
+    while (n < need)
+    {
+        n *= 2;
+    }
+    p = realloc(*ptr, n * itemsize);
+    if (p == NULL)
+    {
+        return -1;
+    }
+    *ptr = p;
+    *cap = n;
+    return 0;
+}
+
+// Resize the array to n items, keeping the original buffer if the allocation fails.
+static int resize(void **ptr, size_t n, size_t itemsize)
+{
+    void *p = realloc(*ptr, n * itemsize);
+    if (p == NULL)
+    {
+        return -1;
+    }
+    *ptr = p;
+    return 0;
+}
+
+static int alloc_rows(vcfnorm_chunk_t *c, size_t nrows)
+{
+    size_t n;
+    if (nrows <= c->maxrow)
+    {
+        return 0;
+    }
+    n = c->maxrow;
+    if ((grow((void **)&c->chrom, &n, nrows, sizeof(uint8_t)) != 0)
+            || (resize((void **)&c->pos, n, sizeof(uint32_t)) != 0)
+            || (resize((void **)&c->refoffset, n, sizeof(uint64_t)) != 0)
+            || (resize((void **)&c->sizeref, n, sizeof(uint32_t)) != 0)
+            || (resize((void **)&c->altoffset, n, sizeof(uint64_t)) != 0)
+            || (resize((void **)&c->sizealt, n, sizeof(uint32_t)) != 0)
+            || (resize((void **)&c->npos, n, sizeof(uint32_t)) != 0)
+            || (resize((void **)&c->nrefoffset, n, sizeof(uint64_t)) != 0)
+            || (resize((void **)&c->nsizeref, n, sizeof(uint32_t)) != 0)
+            || (resize((void **)&c->naltoffset, n, sizeof(uint64_t)) != 0)
+            || (resize((void **)&c->nsizealt, n, sizeof(uint32_t)) != 0)
+            || (resize((void **)&c->status, n, sizeof(int)) != 0)
+            || (resize((void **)&c->vk, n, sizeof(uint64_t)) != 0))
+    {
+        return -1;
+    }
+    c->maxrow = n;
+    return 0;
+}
+
+static void free_chunk(vcfnorm_chunk_t *c)
+{
+    free(c->in);
+    free(c->out);
+    free(c->rec);
+    free(c->chrom);
+    free(c->pos);
+    free(c->refoffset);
+    free(c->sizeref);
+    free(c->altoffset);
+    free(c->sizealt);
+    free(c->npos);
+    free(c->nrefoffset);
+    free(c->nsizeref);
+    free(c->naltoffset);
+    free(c->nsizealt);
+    free(c->status);
+    free(c->vk);
+    free(c->nref);
+    free(c->nalt);
+}
+
+// Split the chunk in lines and collect the variants to normalize in the input columns.
+static int parse_chunk(vcfnorm_chunk_t *c, size_t *nrows)
+{
+    size_t start = 0, end, nrec = 0, nrow = 0;
+    vcfnorm_rec_t *r;
+    const char *line;
+    const char *eol;
+    uint32_t pos;
+    uint8_t chrom;
+    while (start < c->inlen)
+    {
+        eol = (const char *)memchr(c->in + start, '\n', c->inlen - start);
+        end = (eol == NULL) ? c->inlen : (size_t)(eol - c->in);
+        if ((grow((void **)&c->rec, &c->maxrec, nrec + 1, sizeof(vcfnorm_rec_t)) != 0) || (alloc_rows(c, nrow + 1) != 0))
+        {
+            return -1;
+        }
+        r = &c->rec[nrec++];
+        memset(r, 0, sizeof(vcfnorm_rec_t));
+        r->line = start;
+        r->len = end - start;
+        r->row = -1;
+        line = c->in + start;
+        start = end + 1;
+        if ((r->len == 0) || (line[0] == '#'))
+        {
+            continue;
+        }
+        r->fpos = next_field(line, 0, r->len) + 1;
+        if (r->fpos >= r->len)
+        {
+            continue;
+        }
+        r->fid = next_field(line, r->fpos, r->len) + 1;
+        if (r->fid >= r->len)
+        {
+            continue;
+        }
+        r->fref = next_field(line, r->fid, r->len) + 1;
+        if (r->fref >= r->len)
+        {
+            continue;
+        }
+        r->falt = next_field(line, r->fref, r->len) + 1;
+        if (r->falt >= r->len)
+        {
+            continue;
+        }
+        r->frest = next_field(line, r->falt, r->len);
+        if (r->frest < r->len)
+        {
+            // QUAL, FILTER, INFO
+            size_t f = next_field(line, r->frest + 1, r->len);
+            if (f < r->len)
+            {
+                f = next_field(line, f + 1, r->len);
+                if (f < r->len)
+                {
+                    r->finfo = f + 1;
+                    r->einfo = next_field(line, r->finfo, r->len);
+                }
+            }
+        }
+        pos = parse_pos(line + r->fpos, r->fid - r->fpos - 1);
+        chrom = encode_chrom(line, r->fpos - 1);
+        if ((pos == 0) || (chrom == 0)
+                || !is_sequence(line + r->fref, r->falt - r->fref - 1)
+                || !is_sequence(line + r->falt, r->frest - r->falt))
+        {
+            continue;
+        }
+        c->chrom[nrow] = chrom;
+        c->pos[nrow] = pos - 1;
+        c->refoffset[nrow] = (uint64_t)(r->line + r->fref);
+        c->sizeref[nrow] = (uint32_t)(r->falt - r->fref - 1);
+        c->altoffset[nrow] = (uint64_t)(r->line + r->falt);
+        c->sizealt[nrow] = (uint32_t)(r->frest - r->falt);
+        r->row = (int64_t)nrow++;
+    }
+    c->nrec = nrec;
+    *nrows = nrow;
+    return 0;
+}
+
+static char *put(char *dst, const char *src, size_t len)
+{
+    memcpy(dst, src, len);
+    return dst + len;
+}
+
+// Normalize the variants of the chunk and generate the output lines.
+static int process_chunk(vcfnorm_t *ctx, vcfnorm_chunk_t *c, uint64_t *nrows, uint64_t *nnorm)
+{
+    size_t i, nrow = 0;
+    uint64_t bufsize;
+    variantkey_cols_t vc;
+    normalized_cols_t nc;
+    char *o;
+    if (parse_chunk(c, &nrow) != 0)
+    {
+        return -1;
+    }
+    vc.chrom = c->chrom;
+    vc.pos = c->pos;
+    vc.ref = c->in;
+    vc.refoffset = c->refoffset;
+    vc.sizeref = c->sizeref;
+    vc.alt = c->in;
+    vc.altoffset = c->altoffset;
+    vc.sizealt = c->sizealt;
+    vc.refbufsize = c->inlen;
+    vc.altbufsize = c->inlen;
+    vc.nrows = nrow;
+    bufsize = normalize_variant_cols_bufsize(vc);
+    if (bufsize > c->arenasize)
+    {
+        free(c->nref);
+        free(c->nalt);
+        c->nref = (char *)malloc(bufsize);
+        c->nalt = (char *)malloc(bufsize);
+        c->arenasize = (size_t)bufsize;
+        if ((c->nref == NULL) || (c->nalt == NULL))
+        {
+            c->arenasize = 0;
+            return -1;
+        }
+    }
+    nc.pos = c->npos;
+    nc.ref = c->nref;
+    nc.refoffset = c->nrefoffset;
+    nc.sizeref = c->nsizeref;
+    nc.alt = c->nalt;
+    nc.altoffset = c->naltoffset;
+    nc.sizealt = c->nsizealt;
+    nc.status = c->status;
+    nc.refbufsize = c->arenasize;
+    nc.altbufsize = c->arenasize;
+    if (ctx->addvk)
+    {
+        normalized_variantkey_cols(ctx->mf, vc, nc, c->vk);
+    }
+    else
+    {
+        normalize_variant_cols(ctx->mf, vc, nc);
+    }
+    if (grow((void **)&c->out, &c->outsize, c->inlen + (c->nrec * VCFNORM_LINE_EXTRA) + sizeof(VCFNORM_VK_INFO), 1) != 0)
+    {
+        return -1;
+    }
+    o = c->out;
+    for (i = 0; i < c->nrec; i++)
+    {
+        const vcfnorm_rec_t *r = &c->rec[i];
+        const char *line = c->in + r->line;
+        if (r->row < 0)
+        {
+            if (ctx->addvk && (r->len >= 6) && (memcmp(line, "#CHROM", 6) == 0))
+            {
+                o = put(o, VCFNORM_VK_INFO, sizeof(VCFNORM_VK_INFO) - 1);
+            }
+            if ((r->len > 0) && (line[0] != '#'))
+            {
+                (*nrows)++;
+            }
+            o = put(o, line, r->len);
+            *(o++) = '\n';
+            continue;
+        }
+        (*nrows)++;
+        size_t k = (size_t)r->row;
+        size_t rest = r->frest;
+        if (c->status[k] >= 0)
+        {
+            (*nnorm)++;
+            o = put(o, line, r->fpos);
+            o += write_uint32(o, c->npos[k] + 1);
+            o = put(o, line + r->fid - 1, r->fref - r->fid + 1);
+            o = put(o, c->nref + c->nrefoffset[k], c->nsizeref[k]);
+            *(o++) = '\t';
+            o = put(o, c->nalt + c->naltoffset[k], c->nsizealt[k]);
+        }
+        else
+        {
+            o = put(o, line, rest);
+        }
+        if (ctx->addvk && (r->finfo > 0))
+        {
+            o = put(o, line + rest, r->finfo - rest);
+            if ((r->einfo - r->finfo == 1) && (line[r->finfo] == '.'))
+            {
+                o = put(o, "VK=", 3);
+            }
+            else
+            {
+                o = put(o, line + r->finfo, r->einfo - r->finfo);
+                o = put(o, ";VK=", 4);
+            }
+            o += variantkey_hex(c->vk[k], o);
+            rest = r->einfo;
+        }
+        o = put(o, line + rest, r->len - rest);
+        *(o++) = '\n';
+    }
+    c->outlen = (size_t)(o - c->out);
+    return 0;
+}
+
+static void *worker(void *arg)
+{
+    vcfnorm_t *ctx = (vcfnorm_t *)arg;
+    vcfnorm_chunk_t *c;
+    uint64_t nrows = 0, nnorm = 0;
+    int err;
+    for (;;)
+    {
+        pthread_mutex_lock(&ctx->lock);
+        while ((ctx->nwork == ctx->nread) && !ctx->eof && !ctx->err)
+        {
+            pthread_cond_wait(&ctx->cond, &ctx->lock);
+        }
+        if ((ctx->nwork == ctx->nread) || ctx->err)
+        {
+            ctx->nrows += nrows;
+            ctx->nnorm += nnorm;
+            pthread_mutex_unlock(&ctx->lock);
+            return NULL;
+        }
+        c = &ctx->chunk[ctx->nwork % ctx->nchunks];
+        ctx->nwork++;
+        pthread_mutex_unlock(&ctx->lock);
+        err = process_chunk(ctx, c, &nrows, &nnorm);
+        pthread_mutex_lock(&ctx->lock);
+        if (err != 0)
+        {
+            ctx->err = 1;
+        }
+        c->state = VCFNORM_DONE;
+        pthread_cond_broadcast(&ctx->cond);
+        pthread_mutex_unlock(&ctx->lock);
+    }
+}
+
+static void *writer(void *arg)
+{
+    vcfnorm_t *ctx = (vcfnorm_t *)arg;
+    vcfnorm_chunk_t *c;
+    for (;;)
+    {
+        pthread_mutex_lock(&ctx->lock);
+        c = &ctx->chunk[ctx->nwrite % ctx->nchunks];
+        while (!ctx->err && !((ctx->nwrite < ctx->nread) && (c->state == VCFNORM_DONE)) && !(ctx->eof && (ctx->nwrite == ctx->nread)))
+        {
+            pthread_cond_wait(&ctx->cond, &ctx->lock);
+        }
+        if (ctx->err || (ctx->nwrite == ctx->nread))
+        {
+            pthread_mutex_unlock(&ctx->lock);
+            return NULL;
+        }
+        pthread_mutex_unlock(&ctx->lock);
+        int err = (fwrite(c->out, 1, c->outlen, ctx->out) != c->outlen);
+        pthread_mutex_lock(&ctx->lock);
+        if (err)
+        {
+            ctx->err = 1;
+        }
+        c->state = VCFNORM_FREE;
+        ctx->nwrite++;
+        pthread_cond_broadcast(&ctx->cond);
+        pthread_mutex_unlock(&ctx->lock);
+    }
+}
+
+// Parse a size in bytes with an optional K, M or G suffix.
+// Returns 0 for invalid or zero sizes.
+static size_t parse_size(const char *str)
+{
+    char *end = NULL;
+    unsigned long long v = strtoull(str, &end, 10);
+    unsigned shift = 0;
+    if ((end == str) || (str[0] == '-'))
+    {
+        return 0;
+    }
+    switch (*end)
+    {
+    case 'k':
+    case 'K':
+        shift = 10;
+        end++;
+        break;
+    case 'm':
+    case 'M':
+        shift = 20;
+        end++;
+        break;
+    case 'g':
+    case 'G':
+        shift = 30;
+        end++;
+        break;
+    default:
+        break;
+    }
+    if ((*end != 0) || (v > ((unsigned long long)SIZE_MAX >> shift)))
+    {
+        return 0;
+    }
+    return (size_t)(v << shift);
+}
+
+// Fill the chunk with complete lines, carrying over the last partial line.
+// Returns 1 at the end of the input, 0 otherwise and -1 in case of error.
+static int fill_chunk(FILE *in, vcfnorm_chunk_t *c, char **carry, size_t *ncarry, size_t *carrysize)
+{
+    size_t n, last;
+    const char *eol;
+    if (grow((void **)&c->in, &c->insize, *ncarry + 1, 1) != 0)
+    {
+        return -1;
+    }
+    if (*ncarry > 0)
+    {
+        memcpy(c->in, *carry, *ncarry);
+    }
+    c->inlen = *ncarry;
+    *ncarry = 0;
+    for (;;)
+    {
+        n = fread(c->in + c->inlen, 1, c->insize - c->inlen, in);
+        c->inlen += n;
+        if (n == 0)
+        {
+            return ferror(in) ? -1 : 1;
+        }
+        if (c->inlen < c->insize)
+        {
+            continue;
+        }
+        // find the end of the last complete line
+        for (last = c->inlen; (last > 0) && (c->in[(last - 1)] != '\n'); last--) {}
+        if (last > 0)
+        {
+            break;
+        }
+        // a single line does not fit in the chunk
+        if (grow((void **)&c->in, &c->insize, c->insize + 1, 1) != 0)
+        {
+            return -1;
+        }
+    }
+    eol = c->in + last;
+    *ncarry = c->inlen - last;
+    if (grow((void **)carry, carrysize, *ncarry, 1) != 0)
+    {
+        return -1;
+    }
+    if (*ncarry > 0)
+    {
+        memcpy(*carry, eol, *ncarry);
+    }
+    c->inlen = last;
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t chunksize = parse_size(VCFNORM_DEFAULT_CHUNK);
+    uint32_t nthreads = 1;
+    int addvk = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "p:c:kh")) != -1)
+    {
+        switch (opt)
+        {
+        case 'p':
+            nthreads = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 'c':
+            chunksize = parse_size(optarg);
+            break;
+        case 'k':
+            addvk = 1;
+            break;
+        default:
+            usage();
+            return 1;
+        }
+    }
+    if (((argc - optind) != 3) || (chunksize == 0) || (nthreads == 0) || (nthreads > VCFNORM_MAX_THREADS))
+    {
+        usage();
+        return 1;
+    }
+    const char *genoref = argv[optind];
+    const char *infile = argv[optind + 1];
+    const char *outfile = argv[optind + 2];
+    double tstart = now_sec();
+
+    vcfnorm_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.addvk = addvk;
+    mmap_binfile(genoref, &ctx.mf);
+    if ((ctx.mf.src == MAP_FAILED) || (ctx.mf.ncols == 0))
+    {
+        fprintf(stderr, "vcfnorm: unable to open %s\n", genoref);
+        return 1;
+    }
+    if (!is_genoref_2bit(ctx.mf))
+    {
+        munmap_binfile(ctx.mf);
+        mmap_genoref_file(genoref, &ctx.mf);
+    }
+    FILE *in = (strcmp(infile, "-") == 0) ? stdin : fopen(infile, "rb");
+    if (in == NULL)
+    {
+        fprintf(stderr, "vcfnorm: unable to open %s: %s\n", infile, strerror(errno));
+        return 1;
+    }
+    ctx.out = (strcmp(outfile, "-") == 0) ? stdout : fopen(outfile, "wb");
+    if (ctx.out == NULL)
+    {
+        fprintf(stderr, "vcfnorm: unable to write %s: %s\n", outfile, strerror(errno));
+        return 1;
+    }
+    setvbuf(ctx.out, NULL, _IOFBF, VCFNORM_IOBUF_SIZE);
+
+    // two chunks per worker: one being processed and one waiting to be written
+    ctx.nchunks = 2 * (size_t)nthreads;
+    ctx.chunk = (vcfnorm_chunk_t *)calloc(ctx.nchunks, sizeof(vcfnorm_chunk_t));
+    if (ctx.chunk == NULL)
+    {
+        fprintf(stderr, "vcfnorm: unable to allocate memory\n");
+        return 1;
+    }
+    size_t i;
+    for (i = 0; i < ctx.nchunks; i++)
+    {
+        ctx.chunk[i].insize = chunksize;
+        ctx.chunk[i].in = (char *)malloc(ctx.chunk[i].insize);
+        if (ctx.chunk[i].in == NULL)
+        {
+            fprintf(stderr, "vcfnorm: unable to allocate %zu bytes of memory\n", chunksize * ctx.nchunks);
+            return 1;
+        }
+    }
+    pthread_mutex_init(&ctx.lock, NULL);
+    pthread_cond_init(&ctx.cond, NULL);
+    pthread_t *tid = (pthread_t *)malloc((nthreads + 1) * sizeof(pthread_t));
+    if (tid == NULL)
+    {
+        fprintf(stderr, "vcfnorm: unable to allocate memory\n");
+        return 1;
+    }
+    for (i = 0; i < nthreads; i++)
+    {
+        if (pthread_create(&tid[i], NULL, worker, &ctx) != 0)
+        {
+            fprintf(stderr, "vcfnorm: unable to create thread\n");
+            return 1;
+        }
+    }
+    if (pthread_create(&tid[nthreads], NULL, writer, &ctx) != 0)
+    {
+        fprintf(stderr, "vcfnorm: unable to create thread\n");
+        return 1;
+    }
+
+    // read the input chunks
+    char *carry = NULL;
+    size_t ncarry = 0, carrysize = 0;
+    int ret = 0, stop = 0, readerr = 0;
+    vcfnorm_chunk_t *c;
+    while (ret == 0)
+    {
+        pthread_mutex_lock(&ctx.lock);
+        c = &ctx.chunk[ctx.nread % ctx.nchunks];
+        while ((c->state != VCFNORM_FREE) && !ctx.err)
+        {
+            pthread_cond_wait(&ctx.cond, &ctx.lock);
+        }
+        stop = ctx.err;
+        pthread_mutex_unlock(&ctx.lock);
+        if (stop)
+        {
+            break;
+        }
+        ret = fill_chunk(in, c, &carry, &ncarry, &carrysize);
+        pthread_mutex_lock(&ctx.lock);
+        if (ret < 0)
+        {
+            ctx.err = readerr = 1;
+        }
+        else if (c->inlen > 0)
+        {
+            c->state = VCFNORM_READY;
+            ctx.nread++;
+        }
+        if (ret != 0)
+        {
+            ctx.eof = 1;
+        }
+        pthread_cond_broadcast(&ctx.cond);
+        pthread_mutex_unlock(&ctx.lock);
+    }
+    for (i = 0; i <= nthreads; i++)
+    {
+        pthread_join(tid[i], NULL);
+    }
+    free(tid);
+    free(carry);
+    if (in != stdin)
+    {
+        fclose(in);
+    }
+    for (i = 0; i < ctx.nchunks; i++)
+    {
+        free_chunk(&ctx.chunk[i]);
+    }
+    free(ctx.chunk);
+    pthread_mutex_destroy(&ctx.lock);
+    pthread_cond_destroy(&ctx.cond);
+    munmap_binfile(ctx.mf);
+    if (readerr)
+    {
+        fprintf(stderr, "vcfnorm: error reading %s\n", infile);
+        return 1;
+    }
+    if (ctx.err || (fflush(ctx.out) != 0) || ((ctx.out != stdout) && (fclose(ctx.out) != 0)))
+    {
+        fprintf(stderr, "vcfnorm: error writing %s\n", outfile);
+        return 1;
+    }
+    double elapsed = now_sec() - tstart;
+    fprintf(stderr, "vcfnorm: %" PRIu64 " records, %" PRIu64 " normalized in %.3f s (%.0f records/s)\n", ctx.nrows, ctx.nnorm, elapsed, (elapsed > 0) ? ((double)ctx.nrows / elapsed) : 0.0);
+    return 0;
+}
@@ -0,0 +1,22 @@
+# Run vcfnorm on the INPUT file and compare the OUTPUT with the EXPECTED file (EXPECTED_VK with -k),
+# with a single worker and with multiple workers, also splitting the input in many small chunks
+# (the chunk sizes are below the longest line to exercise the carry and the chunk growth).
+foreach(OPTS "-p;1" "-p;3" "-p;1;-k" "-p;3;-k" "-p;3;-c;64" "-p;4;-c;37;-k" "-p;2;-c;1;-k")
+    if(OPTS MATCHES "-k")
+        set(REF ${EXPECTED_VK})
+    else()
+        set(REF ${EXPECTED})
+    endif()
+    execute_process(
+        COMMAND ${VCFNORM} ${OPTS} ${GENOREF} ${INPUT} ${OUTPUT}
+        RESULT_VARIABLE RET)
+    if(NOT RET EQUAL 0)
+        message(FATAL_ERROR "vcfnorm ${OPTS} failed: ${RET}")
+    endif()
+    execute_process(
+        COMMAND ${CMAKE_COMMAND} -E compare_files ${OUTPUT} ${REF}
+        RESULT_VARIABLE RET)
+    if(NOT RET EQUAL 0)
+        message(FATAL_ERROR "vcfnorm ${OPTS}: ${OUTPUT} differs from ${REF}")
+    endif()
+endforeach()
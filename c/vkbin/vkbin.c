@@ -0,0 +1,801 @@
+// VariantKey Binary Lookup Table Builder Command Line Application
+//
+// vkbin.c
+//
+// @category   Tools
+// @author     Nicola Asuni <nicola.asuni@genomicsplc.com>
+// @copyright  2017-2018 GENOMICS plc
+// @license    MIT (see LICENSE)
+// @link       https://github.com/genomicsplc/variantkey
+//
+// LICENSE
+//
+// Copyright (c) 2017-2018 GENOMICS plc
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+// Build the BINSRC1 lookup tables (vkrs.bin, rsvk.bin and nrvk.bin) directly
+// from the hexadecimal/TSV files generated by the bcftools variantkey-hex plugin.
+//
+// The records are sorted as key/value pairs with the external sort of extsort.h:
+// the chunks that do not fit in memory are spilled to temporary sorted runs and
+// k-way merged while the columns are written in their final position.
+// The nrvk "REF\tALT" strings are stored in a temporary file and the sorted pairs
+// refer to them by offset; the strings of equal VariantKeys are sorted while writing.
+//
+// Input formats (one record per line, same as resources/tools/*.sh):
+//    vkrs : [16 HEX VARIANTKEY][TAB][8 HEX RSID]
+//    rsvk : [8 HEX RSID][TAB][16 HEX VARIANTKEY]
+//    nrvk : [16 HEX VARIANTKEY][TAB][REF][TAB][ALT]
+//    vk   : [16 HEX VARIANTKEY][TAB ...] (or raw uint64_t values with -b),
+//           sorted with extsort.h into a single-column BINSRC1 file.
+//    nrvkhash : nrvk.bin file, used to build the NRVK hash index (see nrvk.h).
+//    filter   : BINSRC1 file with the VariantKey in the first column (e.g. nrvk.bin or vkrs.bin),
+//               used to build the binary fuse filter of the first column (see binfuse.h).
+//    rkindex  : BINSRC1 file with the sorted RegionKeys in the first column (e.g. the output of the vk type),
+//               used to build the RegionKey interval index (see regionkey.h).
+//
+// The output is identical to the one generated by the equivalent shell scripts
+// (records are sorted in the same byte order as "LC_ALL=C sort").
+
+#if __STDC_VERSION__ >= 199901L
+#define _XOPEN_SOURCE 600
+#else
+#define _XOPEN_SOURCE 500
+#endif
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../src/variantkey/binsearch.h"
+#include "../src/variantkey/extsort.h"
+#include "../src/variantkey/hex.h"
+#include "../src/variantkey/nrvk.h"
+#include "../src/variantkey/regionkey.h"
+
+#ifndef VERSION
+#define VERSION "0.0.0-0"
+#endif
+
+#define VKBIN_DEFAULT_MEMORY 1024      //!< Default memory limit in MB
+#define VKBIN_IOBUF_SIZE     (1 << 20) //!< Size of the input and output buffers
+#define VKBIN_MAX_ALLELE     255       //!< Maximum REF or ALT length (stored as one byte)
+#define VKBIN_MAX_STR        ((2 * VKBIN_MAX_ALLELE) + 1) //!< Maximum length of the "REF\tALT" string
+
+enum vkbin_type_t
+{
+    VKBIN_VKRS,
+    VKBIN_RSVK,
+    VKBIN_NRVK,
+    VKBIN_VK,
+    VKBIN_NRVKHASH,
+    VKBIN_FILTER,
+    VKBIN_RKINDEX
+};
+
+// Buffered line reader.
+typedef struct vkbin_reader_t
+{
+    FILE *fp;
+    char *buf;
+    size_t pos;
+    size_t len;
+    int eof;
+} vkbin_reader_t;
+
+// Output column writer.
+typedef struct vkbin_col_t
+{
+    FILE *fp;
+    char *buf;
+    uint8_t ctbytes;
+    uint64_t len;
+} vkbin_col_t;
+
+// Output state.
+typedef struct vkbin_out_t
+{
+    int type;
+    uint8_t ncols;
+    vkbin_col_t col[3];
+    uint64_t dataoffset; // nrvk data column running offset
+} vkbin_out_t;
+
+// Merge state: receives the sorted pairs from extsort_merge.
+// The nrvk value is the offset of the [uint16_t length]["REF\tALT"] record in the strings file.
+typedef struct vkbin_merge_t
+{
+    vkbin_out_t *out;
+    const uint8_t *str; // memory mapped nrvk strings file
+    uint64_t *group;    // string offsets of the nrvk records with the same VariantKey
+    size_t ngroup;
+    size_t maxgroup;
+    uint64_t key;       // VariantKey of the group
+} vkbin_merge_t;
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "VariantKey Binary Lookup Table Builder %s\n"
+            "Usage: vkbin [-m MEMORY_MB] [-r MAXRECORDS] [-t TMPDIR] [-p THREADS] [-u] [-b] TYPE INPUT OUTPUT\n"
+            "  TYPE   : vkrs | rsvk | nrvk | vk | nrvkhash | filter | rkindex\n"
+            "  INPUT  : input file (\"-\" for standard input)\n"
+            "  OUTPUT : output BINSRC1 file\n"
+            "  -m     : maximum memory used to sort records in MB (default %d)\n"
+            "  -r     : maximum number of records per sorted run (default: limited by memory)\n"
+            "  -t     : directory for temporary files (default $TMPDIR or /tmp)\n"
+            "  -p     : number of threads used to sort (default 1)\n"
+            "  -u     : remove duplicate VariantKeys (vk only)\n"
+            "  -b     : the input is a raw array of uint64_t values (vk only)\n",
+            VERSION, VKBIN_DEFAULT_MEMORY);
+}
+
+static double now_sec(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return ((double)t.tv_sec + ((double)t.tv_nsec / 1e9));
+}
+
+// Return the next line (without the trailing newline) or NULL at the end of the input.
+static char *read_line(vkbin_reader_t *r, size_t *len, int *err)
+{
+    char *line, *nl;
+    size_t n;
+    for (;;)
+    {
+        line = r->buf + r->pos;
+        nl = (char *)memchr(line, '\n', r->len - r->pos);
+        if (nl != NULL)
+        {
+            *len = (size_t)(nl - line);
+            r->pos += *len + 1;
+            break;
+        }
+        if (r->eof)
+        {
+            if (r->pos >= r->len)
+            {
+                return NULL;
+            }
+            *len = r->len - r->pos; // last line without newline
+            r->pos = r->len;
+            break;
+        }
+        if ((r->pos == 0) && (r->len == VKBIN_IOBUF_SIZE))
+        {
+            *err = 1; // line too long
+            return NULL;
+        }
+        r->len -= r->pos;
+        memmove(r->buf, line, r->len);
+        r->pos = 0;
+        n = fread(r->buf + r->len, 1, VKBIN_IOBUF_SIZE - r->len, r->fp);
+        r->len += n;
+        if (n == 0)
+        {
+            if (ferror(r->fp))
+            {
+                *err = 1;
+                return NULL;
+            }
+            r->eof = 1;
+        }
+    }
+    if ((*len > 0) && (line[*len - 1] == '\r'))
+    {
+        (*len)--;
+    }
+    return line;
+}
+
+// Parse one input line: the key and value of vkrs and rsvk records, or the key and the "REF\tALT" string of nrvk records.
+static int parse_line(int type, const char *line, size_t len, uint64_t *key, uint64_t *val, const char **str, size_t *slen)
+{
+    const char *tab = (const char *)memchr(line, '\t', len);
+    if (tab == NULL)
+    {
+        return 1;
+    }
+    size_t klen = (size_t)(tab - line);
+    const char *v = tab + 1;
+    size_t vlen = len - klen - 1;
+    if (parse_hex_uint64_t_checked(line, klen, key) != 0)
+    {
+        return 1;
+    }
+    if (type != VKBIN_NRVK)
+    {
+        if (parse_hex_uint64_t_checked(v, vlen, val) != 0)
+        {
+            return 1;
+        }
+        return (((type == VKBIN_VKRS) && (*val > 0xFFFFFFFF)) || ((type == VKBIN_RSVK) && (*key > 0xFFFFFFFF)));
+    }
+    const char *alt = (const char *)memchr(v, '\t', vlen);
+    if ((alt == NULL) || ((size_t)(alt - v) > VKBIN_MAX_ALLELE) || ((size_t)(v + vlen - alt - 1) > VKBIN_MAX_ALLELE))
+    {
+        return 1;
+    }
+    *str = v;
+    *slen = vlen;
+    return 0;
+}
+
+static int cmp_str(const char *a, size_t alen, const char *b, size_t blen)
+{
+    int r = memcmp(a, b, (alen < blen) ? alen : blen);
+    if (r != 0)
+    {
+        return r;
+    }
+    return (alen > blen) - (alen < blen);
+}
+
+static int open_tmp(const char *tmpdir)
+{
+    char path[4096];
+    if (snprintf(path, sizeof(path), "%s/vkbin.XXXXXX", tmpdir) >= (int)sizeof(path))
+    {
+        return -1;
+    }
+    int fd = mkstemp(path);
+    if (fd >= 0)
+    {
+        unlink(path); // the file is removed when closed
+    }
+    return fd;
+}
+
+static int out_open(vkbin_out_t *o, int type, const char *file, uint64_t nrows)
+{
+    static const uint8_t ctbytes[3][3] = {{8, 4, 0}, {4, 8, 0}, {8, 8, 1}};
+    uint64_t offset[3];
+    uint8_t i;
+    memset(o, 0, sizeof(vkbin_out_t));
+    o->type = type;
+    o->ncols = (type == VKBIN_NRVK) ? 3 : 2;
+    FILE *fp = fopen(file, "wb");
+    if (fp == NULL)
+    {
+        return 1;
+    }
+    size_t hlen = write_binsrc1_header(fp, o->ncols, ctbytes[type], nrows, offset);
+    if ((fclose(fp) != 0) || (hlen == 0))
+    {
+        return 1;
+    }
+    // each column is written sequentially by its own stream at its final position
+    for (i = 0; i < o->ncols; i++)
+    {
+        o->col[i].ctbytes = ctbytes[type][i];
+        o->col[i].buf = (char *)malloc(VKBIN_IOBUF_SIZE);
+        o->col[i].fp = fopen(file, "r+b");
+        if ((o->col[i].buf == NULL) || (o->col[i].fp == NULL))
+        {
+            return 1;
+        }
+        setvbuf(o->col[i].fp, o->col[i].buf, _IOFBF, VKBIN_IOBUF_SIZE);
+        if (fseeko(o->col[i].fp, (off_t)offset[i], SEEK_SET) != 0)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int out_put(vkbin_col_t *col, const void *data, size_t len)
+{
+    col->len += len;
+    return (fwrite(data, 1, len, col->fp) != len);
+}
+
+// Append one sorted record to the output columns.
+static int out_rec(vkbin_out_t *o, uint64_t key, uint64_t val, const char *str, size_t slen)
+{
+    uint32_t u32;
+    if (o->type == VKBIN_VKRS)
+    {
+        u32 = (uint32_t)val;
+        return (out_put(&o->col[0], &key, 8) | out_put(&o->col[1], &u32, 4));
+    }
+    if (o->type == VKBIN_RSVK)
+    {
+        u32 = (uint32_t)key;
+        return (out_put(&o->col[0], &u32, 4) | out_put(&o->col[1], &val, 8));
+    }
+    const char *tab = (const char *)memchr(str, '\t', slen);
+    uint8_t len[2];
+    len[0] = (uint8_t)(tab - str);
+    len[1] = (uint8_t)(slen - len[0] - 1);
+    int err = out_put(&o->col[0], &key, 8) | out_put(&o->col[1], &o->dataoffset, 8);
+    err |= out_put(&o->col[2], len, 2) | out_put(&o->col[2], str, len[0]) | out_put(&o->col[2], tab + 1, len[1]);
+    o->dataoffset += 2 + len[0] + len[1];
+    return err;
+}
+
+static int out_close(vkbin_out_t *o)
+{
+    static const uint8_t pad[8] = {0};
+    int err = 0;
+    uint8_t i;
+    for (i = 0; i < o->ncols; i++)
+    {
+        if (o->col[i].fp == NULL)
+        {
+            err = 1;
+            continue;
+        }
+        // the fixed-width columns are 8-byte padded, the nrvk data column is left unpadded as the original format
+        if (o->col[i].ctbytes > 1)
+        {
+            err |= out_put(&o->col[i], pad, (size_t)((8 - (o->col[i].len & 7)) & 7));
+        }
+        err |= (fclose(o->col[i].fp) != 0);
+        free(o->col[i].buf);
+    }
+    return err;
+}
+
+
+// Return the "REF\tALT" string of the nrvk record at the specified offset of the strings file.
+static const char *merge_str(const vkbin_merge_t *m, uint64_t off, size_t *slen)
+{
+    uint16_t len;
+    memcpy(&len, m->str + off, sizeof(len));
+    *slen = len;
+    return (const char *)(m->str + off + sizeof(len));
+}
+
+// Sort the nrvk records of the current VariantKey by "REF\tALT" (insertion sort on the usually tiny groups) and write them.
+static int merge_flush(vkbin_merge_t *m)
+{
+    size_t i, j, alen, blen;
+    const char *a, *b;
+    uint64_t off;
+    int err = 0;
+    for (i = 1; i < m->ngroup; i++)
+    {
+        off = m->group[i];
+        a = merge_str(m, off, &alen);
+        for (j = i; j > 0; j--)
+        {
+            b = merge_str(m, m->group[j - 1], &blen);
+            if (cmp_str(b, blen, a, alen) <= 0)
+            {
+                break;
+            }
+            m->group[j] = m->group[j - 1];
+        }
+        m->group[j] = off;
+    }
+    for (i = 0; (i < m->ngroup) && (err == 0); i++)
+    {
+        a = merge_str(m, m->group[i], &alen);
+        err = out_rec(m->out, m->key, 0, a, alen);
+    }
+    m->ngroup = 0;
+    return err;
+}
+
+// Write one sorted key/value pair (extsort_put_t callback).
+static int merge_put(void *ctx, uint64_t key, uint64_t val)
+{
+    vkbin_merge_t *m = (vkbin_merge_t *)ctx;
+    if (m->out->type != VKBIN_NRVK)
+    {
+        return out_rec(m->out, key, val, NULL, 0);
+    }
+    if ((m->ngroup > 0) && (key != m->key) && (merge_flush(m) != 0))
+    {
+        return 1;
+    }
+    if (m->ngroup == m->maxgroup)
+    {
+        size_t maxgroup = (m->maxgroup == 0) ? 16 : (2 * m->maxgroup);
+        uint64_t *group = (uint64_t *)realloc(m->group, maxgroup * sizeof(uint64_t));
+        if (group == NULL)
+        {
+            return 1;
+        }
+        m->group = group;
+        m->maxgroup = maxgroup;
+    }
+    m->key = key;
+    m->group[m->ngroup++] = val;
+    return 0;
+}
+
+// Sort the vkrs, rsvk or nrvk records of the input file into a BINSRC1 lookup table.
+static int build_kv(int type, const char *name, const char *infile, const char *outfile, size_t memory, size_t maxrec, const char *tmpdir, uint32_t nthreads, uint64_t *nrows, uint32_t *nruns)
+{
+    extsort_t es;
+    if (extsort_init_kv(&es, (uint64_t)memory << 20, tmpdir, nthreads, 0) != 0)
+    {
+        fprintf(stderr, "vkbin: unable to allocate %zu MB of memory\n", memory);
+        return 1;
+    }
+    if ((maxrec > 0) && (maxrec < es.maxitems))
+    {
+        es.maxitems = maxrec;
+    }
+    vkbin_reader_t in;
+    memset(&in, 0, sizeof(in));
+    in.buf = (char *)malloc(VKBIN_IOBUF_SIZE);
+    in.fp = (strcmp(infile, "-") == 0) ? stdin : fopen(infile, "rb");
+    if ((in.fp == NULL) || (in.buf == NULL))
+    {
+        fprintf(stderr, "vkbin: unable to open %s: %s\n", infile, strerror(errno));
+        free(in.buf);
+        extsort_free(&es);
+        return 1;
+    }
+    // the nrvk strings are appended to a temporary file, memory mapped for the merge
+    FILE *sfp = NULL;
+    if (type == VKBIN_NRVK)
+    {
+        int sfd = open_tmp(tmpdir);
+        sfp = (sfd < 0) ? NULL : fdopen(sfd, "w+b");
+        if (sfp == NULL)
+        {
+            fprintf(stderr, "vkbin: unable to write a temporary file in %s\n", tmpdir);
+            if (sfd >= 0)
+            {
+                close(sfd);
+            }
+            if (in.fp != stdin)
+            {
+                fclose(in.fp);
+            }
+            free(in.buf);
+            extsort_free(&es);
+            return 1;
+        }
+        setvbuf(sfp, NULL, _IOFBF, VKBIN_IOBUF_SIZE);
+    }
+    uint64_t lineno = 0, key, val, soff = 0;
+    const char *str = NULL;
+    char *line = NULL;
+    size_t len, slen = 0;
+    uint16_t len16;
+    int err = 0;
+    while ((err == 0) && ((line = read_line(&in, &len, &err)) != NULL))
+    {
+        lineno++;
+        if (len == 0)
+        {
+            continue;
+        }
+        if (parse_line(type, line, len, &key, &val, &str, &slen) != 0)
+        {
+            fprintf(stderr, "vkbin: invalid %s record at line %" PRIu64 "\n", name, lineno);
+            err = 1;
+            break;
+        }
+        if (sfp != NULL)
+        {
+            len16 = (uint16_t)slen;
+            if ((fwrite(&len16, sizeof(len16), 1, sfp) != 1) || (fwrite(str, 1, slen, sfp) != slen))
+            {
+                fprintf(stderr, "vkbin: unable to write a temporary file in %s\n", tmpdir);
+                err = 1;
+                break;
+            }
+            val = soff;
+            soff += sizeof(len16) + slen;
+        }
+        if (extsort_add_kv_uint64_t(&es, &key, &val, 1) != 0)
+        {
+            fprintf(stderr, "vkbin: unable to write a temporary file in %s\n", tmpdir);
+            err = 1;
+            break;
+        }
+        (*nrows)++;
+    }
+    if ((err != 0) && (line == NULL))
+    {
+        fprintf(stderr, "vkbin: error reading %s at line %" PRIu64 "\n", infile, lineno + 1);
+    }
+    if (in.fp != stdin)
+    {
+        fclose(in.fp);
+    }
+    free(in.buf);
+    vkbin_merge_t m;
+    memset(&m, 0, sizeof(m));
+    void *smap = MAP_FAILED;
+    if ((err == 0) && (soff > 0))
+    {
+        smap = (fflush(sfp) == 0) ? mmap(NULL, (size_t)soff, PROT_READ, MAP_PRIVATE, fileno(sfp), 0) : MAP_FAILED;
+        if (smap == MAP_FAILED)
+        {
+            fprintf(stderr, "vkbin: unable to map a temporary file in %s\n", tmpdir);
+            err = 1;
+        }
+        m.str = (const uint8_t *)smap;
+    }
+    *nruns = (es.nruns == 0) ? 0 : (es.nruns + (es.nitems > 0));
+    vkbin_out_t out;
+    if ((err == 0) && (out_open(&out, type, outfile, *nrows) != 0))
+    {
+        fprintf(stderr, "vkbin: unable to write %s: %s\n", outfile, strerror(errno));
+        out_close(&out);
+        err = 1;
+    }
+    if (err == 0)
+    {
+        m.out = &out;
+        err = (extsort_merge(&es, merge_put, &m) != 0);
+        if ((err == 0) && (m.ngroup > 0))
+        {
+            err = merge_flush(&m);
+        }
+        if ((out_close(&out) != 0) || (err != 0))
+        {
+            fprintf(stderr, "vkbin: error writing %s\n", outfile);
+            err = 1;
+        }
+    }
+    if (smap != MAP_FAILED)
+    {
+        munmap(smap, (size_t)soff);
+    }
+    if (sfp != NULL)
+    {
+        fclose(sfp);
+    }
+    free(m.group);
+    extsort_free(&es);
+    return err;
+}
+
+// Sort a VariantKey column (first field of each hex line or raw binary values) into a single-column BINSRC1 file.
+static int build_vk(const char *infile, const char *outfile, size_t memory, size_t maxrec, const char *tmpdir, uint32_t nthreads, uint8_t unique, int binary, uint64_t *nrows)
+{
+    extsort_t es;
+    if (extsort_init(&es, (uint64_t)memory << 20, tmpdir, nthreads, unique) != 0)
+    {
+        fprintf(stderr, "vkbin: unable to allocate %zu MB of memory\n", memory);
+        return 1;
+    }
+    if ((maxrec > 0) && (maxrec < es.maxitems))
+    {
+        es.maxitems = maxrec;
+    }
+    vkbin_reader_t in;
+    memset(&in, 0, sizeof(in));
+    in.buf = (char *)malloc(VKBIN_IOBUF_SIZE);
+    in.fp = (strcmp(infile, "-") == 0) ? stdin : fopen(infile, "rb");
+    if ((in.fp == NULL) || (in.buf == NULL))
+    {
+        fprintf(stderr, "vkbin: unable to open %s\n", infile);
+        free(in.buf);
+        extsort_free(&es);
+        return 1;
+    }
+    uint64_t *vk = (uint64_t *)in.buf;
+    const size_t maxvk = VKBIN_IOBUF_SIZE / sizeof(uint64_t);
+    uint64_t lineno = 0;
+    size_t n = 0, len;
+    char *line, *tab;
+    int err = 0;
+    if (binary)
+    {
+        while ((err == 0) && ((n = fread(vk, sizeof(uint64_t), maxvk, in.fp)) > 0))
+        {
+            err = extsort_add_uint64_t(&es, vk, n);
+        }
+        err |= ferror(in.fp);
+    }
+    else
+    {
+        // the parsed values are buffered in a separate array as the line buffer is in use
+        uint64_t *buf = (uint64_t *)malloc(maxvk * sizeof(uint64_t));
+        err = (buf == NULL);
+        while ((err == 0) && ((line = read_line(&in, &len, &err)) != NULL))
+        {
+            lineno++;
+            if (len == 0)
+            {
+                continue;
+            }
+            tab = (char *)memchr(line, '\t', len);
+            if (parse_hex_uint64_t_checked(line, (tab == NULL) ? len : (size_t)(tab - line), &buf[n]) != 0)
+            {
+                fprintf(stderr, "vkbin: invalid vk record at line %" PRIu64 "\n", lineno);
+                err = 1;
+                break;
+            }
+            if ((++n == maxvk) && ((err = extsort_add_uint64_t(&es, buf, n)) == 0))
+            {
+                n = 0;
+            }
+        }
+        if ((err == 0) && (n > 0))
+        {
+            err = extsort_add_uint64_t(&es, buf, n);
+        }
+        free(buf);
+    }
+    if (in.fp != stdin)
+    {
+        fclose(in.fp);
+    }
+    free(in.buf);
+    if ((err == 0) && (extsort_save_binsrc1(&es, outfile, nrows) != 0))
+    {
+        fprintf(stderr, "vkbin: error writing %s\n", outfile);
+        err = 1;
+    }
+    extsort_free(&es);
+    return (err != 0);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t memory = VKBIN_DEFAULT_MEMORY;
+    size_t maxrec = 0;
+    uint32_t nthreads = 1;
+    uint8_t unique = 0;
+    int binary = 0;
+    const char *tmpdir = getenv("TMPDIR");
+    int opt;
+    while ((opt = getopt(argc, argv, "m:r:t:p:ubh")) != -1)
+    {
+        switch (opt)
+        {
+        case 'p':
+            nthreads = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 'u':
+            unique = 1;
+            break;
+        case 'b':
+            binary = 1;
+            break;
+        case 'm':
+            memory = (size_t)strtoull(optarg, NULL, 10);
+            break;
+        case 'r':
+            maxrec = (size_t)strtoull(optarg, NULL, 10);
+            break;
+        case 't':
+            tmpdir = optarg;
+            break;
+        default:
+            usage();
+            return 1;
+        }
+    }
+    if (((argc - optind) != 3) || (memory == 0))
+    {
+        usage();
+        return 1;
+    }
+    if ((tmpdir == NULL) || (*tmpdir == 0))
+    {
+        tmpdir = "/tmp";
+    }
+    int type;
+    if (strcmp(argv[optind], "vkrs") == 0)
+    {
+        type = VKBIN_VKRS;
+    }
+    else if (strcmp(argv[optind], "rsvk") == 0)
+    {
+        type = VKBIN_RSVK;
+    }
+    else if (strcmp(argv[optind], "nrvk") == 0)
+    {
+        type = VKBIN_NRVK;
+    }
+    else if (strcmp(argv[optind], "vk") == 0)
+    {
+        type = VKBIN_VK;
+    }
+    else if (strcmp(argv[optind], "nrvkhash") == 0)
+    {
+        type = VKBIN_NRVKHASH;
+    }
+    else if (strcmp(argv[optind], "filter") == 0)
+    {
+        type = VKBIN_FILTER;
+    }
+    else if (strcmp(argv[optind], "rkindex") == 0)
+    {
+        type = VKBIN_RKINDEX;
+    }
+    else
+    {
+        usage();
+        return 1;
+    }
+    const char *infile = argv[optind + 1];
+    const char *outfile = argv[optind + 2];
+    double tstart = now_sec();
+    double elapsed;
+    uint64_t nrows = 0;
+    if (type == VKBIN_VK)
+    {
+        if (build_vk(infile, outfile, memory, maxrec, tmpdir, nthreads, unique, binary, &nrows) != 0)
+        {
+            return 1;
+        }
+        elapsed = now_sec() - tstart;
+        fprintf(stderr, "vkbin: %" PRIu64 " rows in %.3f s (%.0f rows/s)\n", nrows, elapsed, (elapsed > 0) ? ((double)nrows / elapsed) : 0.0);
+        return 0;
+    }
+    if ((type == VKBIN_FILTER) || (type == VKBIN_RKINDEX))
+    {
+        mmfile_t mf = {0};
+        mmap_binfile(infile, &mf);
+        if ((mf.fd < 0) || (mf.src == MAP_FAILED) || (mf.ncols == 0) || (mf.ctbytes[0] != 8))
+        {
+            fprintf(stderr, "vkbin: unable to map the first uint64 column of %s\n", infile);
+            return 1;
+        }
+        nrows = mf.nrows;
+        const uint64_t *col = (const uint64_t *)(mf.src + mf.index[0]);
+        size_t len = (type == VKBIN_FILTER) ? build_binfuse_file(outfile, col, nrows) : save_regionkey_index_file(outfile, col, nrows);
+        munmap_binfile(mf);
+        if (len == 0)
+        {
+            fprintf(stderr, "vkbin: unable to write %s (the first column must be sorted)\n", outfile);
+            return 1;
+        }
+        elapsed = now_sec() - tstart;
+        fprintf(stderr, "vkbin: %" PRIu64 " rows in %.3f s (%.0f rows/s)\n", nrows, elapsed, (elapsed > 0) ? ((double)nrows / elapsed) : 0.0);
+        return 0;
+    }
+    if (type == VKBIN_NRVKHASH)
+    {
+        mmfile_t mf = {0};
+        nrvk_cols_t nvc = {0};
+        if ((mmap_nrvk_file(infile, &mf, &nvc) != 0) || (nvc.nrows == 0))
+        {
+            fprintf(stderr, "vkbin: unable to map the NRVK file %s (missing, empty or unsupported format)\n", infile);
+            return 1;
+        }
+        nrows = nvc.nrows;
+        size_t len = nrvk_hash_to_file(nvc, outfile);
+        munmap_binfile(mf);
+        if (len == 0)
+        {
+            fprintf(stderr, "vkbin: unable to write %s\n", outfile);
+            return 1;
+        }
+        elapsed = now_sec() - tstart;
+        fprintf(stderr, "vkbin: %" PRIu64 " rows in %.3f s (%.0f rows/s)\n", nrows, elapsed, (elapsed > 0) ? ((double)nrows / elapsed) : 0.0);
+        return 0;
+    }
+
+    uint32_t nruns = 0;
+    if (build_kv(type, argv[optind], infile, outfile, memory, maxrec, tmpdir, nthreads, &nrows, &nruns) != 0)
+    {
+        return 1;
+    }
+    elapsed = now_sec() - tstart;
+    fprintf(stderr, "vkbin: %" PRIu64 " rows in %.3f s (%.0f rows/s, %" PRIu32 " runs)\n", nrows, elapsed, (elapsed > 0) ? ((double)nrows / elapsed) : 0.0, nruns);
+    return 0;
+}
@@ -0,0 +1,16 @@
+# Run vkbin on the INPUT file and compare the OUTPUT with the EXPECTED file,
+# both with in-memory sorting and with multiple spilled runs.
+foreach(MAXREC 0 3 1)
+    execute_process(
+        COMMAND ${VKBIN} -r ${MAXREC} ${TYPE} ${INPUT} ${OUTPUT}
+        RESULT_VARIABLE RET)
+    if(NOT RET EQUAL 0)
+        message(FATAL_ERROR "vkbin -r ${MAXREC} ${TYPE} failed: ${RET}")
+    endif()
+    execute_process(
+        COMMAND ${CMAKE_COMMAND} -E compare_files ${OUTPUT} ${EXPECTED}
+        RESULT_VARIABLE RET)
+    if(NOT RET EQUAL 0)
+        message(FATAL_ERROR "vkbin -r ${MAXREC} ${TYPE}: ${OUTPUT} differs from ${EXPECTED}")
+    endif()
+endforeach()
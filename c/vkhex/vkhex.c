@@ -0,0 +1,114 @@
+// VariantKey Hexadecimal Converter Command Line Application
+//
+// vkhex.c
+//
+// @category   Tools
+// @author     Nicola Asuni <nicola.asuni@genomicsplc.com>
+// @copyright  2017-2018 GENOMICS plc
+// @license    MIT (see LICENSE)
+// @link       https://github.com/genomicsplc/variantkey
+//
+// LICENSE
+//
+// Copyright (c) 2017-2018 GENOMICS plc
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Convert a stream of newline-delimited hexadecimal VariantKeys (or any uint64_t values),
+// like the ones generated by the bcftools variantkey-hex plugin, to a stream of raw uint64_t
+// values in the host byte order (e.g. the input of "vkbin -b"), or the reverse with -r.
+//
+// The conversion is done in large blocks with the SIMD functions of hex.h.
+
+#if __STDC_VERSION__ >= 199901L
+#define _XOPEN_SOURCE 600
+#else
+#define _XOPEN_SOURCE 500
+#endif
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "../src/variantkey/hex.h"
+
+#ifndef VERSION
+#define VERSION "0.0.0-0"
+#endif
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "VariantKey Hexadecimal Converter %s\n"
+            "Usage: vkhex [-r] [INPUT [OUTPUT]]\n"
+            "  INPUT  : input file (default or \"-\" for standard input)\n"
+            "  OUTPUT : output file (default or \"-\" for standard output)\n"
+            "  -r     : convert raw uint64_t values to hexadecimal lines (default: hexadecimal lines to raw values)\n",
+            VERSION);
+}
+
+int main(int argc, char *argv[])
+{
+    int reverse = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "rh")) != -1)
+    {
+        switch (opt)
+        {
+        case 'r':
+            reverse = 1;
+            break;
+        default:
+            usage();
+            return 1;
+        }
+    }
+    if ((argc - optind) > 2)
+    {
+        usage();
+        return 1;
+    }
+    const char *infile = ((argc - optind) > 0) ? argv[optind] : "-";
+    const char *outfile = ((argc - optind) > 1) ? argv[(optind + 1)] : "-";
+    int infd = (strcmp(infile, "-") == 0) ? STDIN_FILENO : open(infile, O_RDONLY);
+    if (infd < 0)
+    {
+        fprintf(stderr, "vkhex: unable to open %s\n", infile);
+        return 1;
+    }
+    int outfd = (strcmp(outfile, "-") == 0) ? STDOUT_FILENO : open(outfile, (O_WRONLY | O_CREAT | O_TRUNC), 0666);
+    if (outfd < 0)
+    {
+        fprintf(stderr, "vkhex: unable to open %s\n", outfile);
+        return 1;
+    }
+    uint64_t nitems = 0;
+    int err = reverse ? uint64_to_hex_stream(infd, outfd, &nitems) : hex_to_uint64_stream(infd, outfd, &nitems);
+    if ((outfd != STDOUT_FILENO) && (close(outfd) != 0))
+    {
+        err = 1;
+    }
+    if (err != 0)
+    {
+        fprintf(stderr, "vkhex: conversion error after %" PRIu64 " values\n", nitems);
+        return 1;
+    }
+    return 0;
+}
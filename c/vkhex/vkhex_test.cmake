@@ -0,0 +1,26 @@
+# Convert the INPUT hex file to raw values (OUTPUT.bin) and back to hex (OUTPUT.hex),
+# then compare the result with the INPUT file.
+execute_process(
+    COMMAND ${VKHEX} ${INPUT} ${OUTPUT}.bin
+    RESULT_VARIABLE RET)
+if(NOT RET EQUAL 0)
+    message(FATAL_ERROR "vkhex ${INPUT} failed: ${RET}")
+endif()
+file(SIZE ${INPUT} INSIZE)
+file(SIZE ${OUTPUT}.bin BINSIZE)
+math(EXPR EXPSIZE "${INSIZE} / 17 * 8")
+if(NOT BINSIZE EQUAL EXPSIZE)
+    message(FATAL_ERROR "vkhex: ${OUTPUT}.bin has ${BINSIZE} bytes instead of ${EXPSIZE}")
+endif()
+execute_process(
+    COMMAND ${VKHEX} -r ${OUTPUT}.bin ${OUTPUT}.hex
+    RESULT_VARIABLE RET)
+if(NOT RET EQUAL 0)
+    message(FATAL_ERROR "vkhex -r ${OUTPUT}.bin failed: ${RET}")
+endif()
+execute_process(
+    COMMAND ${CMAKE_COMMAND} -E compare_files ${OUTPUT}.hex ${INPUT}
+    RESULT_VARIABLE RET)
+if(NOT RET EQUAL 0)
+    message(FATAL_ERROR "vkhex: ${OUTPUT}.hex differs from ${INPUT}")
+endif()
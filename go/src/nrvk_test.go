@@ -59,6 +59,45 @@ func TestFindRefAltByVariantKey(t *testing.T) {
 	}
 }
 
+func TestFindRefAltByVariantKeyHash(t *testing.T) {
+	hmf, hnrvk, err := nrvk.MmapNRVKHashFile("../../c/test/data/nrvkhash.10.bin")
+	if err != nil {
+		t.Errorf("Unexpected error: %v", err)
+		return
+	}
+	defer func() { _ = hmf.Close() }()
+	for i, tt := range testNonRevVKData {
+		ref, alt, _, _, _ := hnrvk.FindRefAltByVariantKey(tt.vk)
+		if ref != tt.ref || alt != tt.alt {
+			t.Errorf("%d. Expected %s %s, got %s %s", i, tt.ref, tt.alt, ref, alt)
+		}
+	}
+}
+
+func TestMmapNRVKHashFileError(t *testing.T) {
+	_, _, err := nrvk.MmapNRVKHashFile("error")
+	if err == nil {
+		t.Errorf("An error was expected")
+	}
+	hmf, _, err := nrvk.MmapNRVKHashFile("../../c/test/data/nrvk.10.bin")
+	if err == nil {
+		t.Errorf("An error was expected")
+	}
+	_ = hmf.Close()
+}
+
+func TestMmapNRVKFilterFileError(t *testing.T) {
+	_, _, err := nrvk.MmapNRVKFilterFile("error")
+	if err == nil {
+		t.Errorf("An error was expected")
+	}
+	fmf, _, err := nrvk.MmapNRVKFilterFile("../../c/test/data/nrvkhash.10.bin")
+	if err == nil {
+		t.Errorf("An error was expected")
+	}
+	_ = fmf.Close()
+}
+
 func BenchmarkFindRefAltByVariantKey(b *testing.B) {
 	b.ResetTimer()
 	for i := 0; i < b.N; i++ {
@@ -131,6 +131,37 @@ func TestFindVRRsidByVariantKeyNotFound(t *testing.T) {
 	}
 }
 
+func TestFindVRRsidByVariantKeyFilter(t *testing.T) {
+	fmf, fvr, err := vr.MmapVKRSFilterFile("../../c/test/data/vkrs.10.bin.filter")
+	if err != nil {
+		t.Errorf("Unexpected error: %v", err)
+		return
+	}
+	defer func() { _ = fmf.Close() }()
+	for i, tt := range testData {
+		rsid, _ := fvr.FindVRRsidByVariantKey(0, fvr.NRows, tt.vk)
+		if rsid != tt.rsid {
+			t.Errorf("%d. Expected rsid %x, got %x", i, tt.rsid, rsid)
+		}
+	}
+	rsid, _ := fvr.FindVRRsidByVariantKey(0, fvr.NRows, 0xfffffffffffffff0)
+	if rsid != 0 {
+		t.Errorf("Expected rsid 0, got %x", rsid)
+	}
+}
+
+func TestMmapVKRSFilterFileError(t *testing.T) {
+	_, _, err := vr.MmapVKRSFilterFile("error")
+	if err == nil {
+		t.Errorf("An error was expected")
+	}
+	fmf, _, err := vr.MmapVKRSFilterFile("../../c/test/data/nrvkhash.10.bin")
+	if err == nil {
+		t.Errorf("An error was expected")
+	}
+	_ = fmf.Close()
+}
+
 func BenchmarkFindVRRsidByVariantKey(b *testing.B) {
 	b.ResetTimer()
 	for i := 0; i < b.N; i++ {
@@ -31,7 +31,8 @@
 package variantkey
 
 /*
-#cgo CFLAGS: -O3 -pedantic -std=c99 -Wextra -Wno-strict-prototypes -Wcast-align -Wundef -Wformat-security -Wshadow
+#cgo CFLAGS: -O3 -pedantic -std=c99 -Wextra -Wno-strict-prototypes -Wcast-align -Wundef -Wformat-security -Wshadow -pthread
+#cgo LDFLAGS: -pthread
 #include <stdlib.h>
 #include <inttypes.h>
 #include "../../c/src/variantkey/binsearch.h"
@@ -305,17 +306,19 @@ func (mf TMMFile) Close() error {
 
 // RSIDVARCols contains the RSVK or VKRS memory mapped file column info.
 type RSIDVARCols struct {
-	Vk    unsafe.Pointer // Pointer to the VariantKey column.
-	Rs    unsafe.Pointer // Pointer to the rsID column.
-	NRows uint64         // Number of rows.
+	Vk     unsafe.Pointer // Pointer to the VariantKey column.
+	Rs     unsafe.Pointer // Pointer to the rsID column.
+	NRows  uint64         // Number of rows.
+	Filter unsafe.Pointer // Pointer to the optional binary fuse filter of the VKRS VariantKey column.
 }
 
 // castCRSIDVARColsToGo convert C.rsidvar_cols_t to GO RSIDVARCols.
 func castCRSIDVARColsToGo(crv C.rsidvar_cols_t) RSIDVARCols {
 	return RSIDVARCols{
-		Vk:    unsafe.Pointer(crv.vk), // #nosec
-		Rs:    unsafe.Pointer(crv.rs), // #nosec
-		NRows: uint64(crv.nrows),
+		Vk:     unsafe.Pointer(crv.vk),     // #nosec
+		Rs:     unsafe.Pointer(crv.rs),     // #nosec
+		NRows:  uint64(crv.nrows),
+		Filter: unsafe.Pointer(crv.filter), // #nosec
 	}
 }
 
@@ -325,6 +328,7 @@ func castGoRSIDVARColsToC(rc RSIDVARCols) C.rsidvar_cols_t {
 	rvc.vk = (*C.uint64_t)(rc.Vk)
 	rvc.rs = (*C.uint32_t)(rc.Rs)
 	rvc.nrows = C.uint64_t(rc.NRows)
+	rvc.filter = (*C.uint64_t)(rc.Filter)
 	return rvc
 }
 
@@ -349,6 +353,26 @@ func MmapVKRSFile(file string, ctbytes []uint8) (TMMFile, RSIDVARCols, error) {
 	return castCTMMFileToGo(mf), castCRSIDVARColsToGo(rc), nil
 }
 
+// MmapVKRSFilterFile memory map the binary fuse filter file of the VKRS VariantKey column and returns a copy of the VKRS columns using it.
+func (crv RSIDVARCols) MmapVKRSFilterFile(file string) (TMMFile, RSIDVARCols, error) {
+	bfile := StringToNTBytes(file)
+	flen := len(bfile)
+	var p unsafe.Pointer
+	if flen > 0 {
+		p = unsafe.Pointer(&bfile[0]) // #nosec
+	}
+	var mf C.mmfile_t
+	rc := castGoRSIDVARColsToC(crv)
+	C.mmap_vkrs_filter_file((*C.char)(p), &mf, &rc)
+	if mf.fd < 0 || mf.size == 0 || mf.src == nil {
+		return TMMFile{}, crv, fmt.Errorf("unable to map the file: %s", file)
+	}
+	if rc.filter == nil {
+		return castCTMMFileToGo(mf), crv, fmt.Errorf("invalid filter: %s", file)
+	}
+	return castCTMMFileToGo(mf), castCRSIDVARColsToGo(rc), nil
+}
+
 // MmapRSVKFile memory map the RSVK binary file.
 func MmapRSVKFile(file string, ctbytes []uint8) (TMMFile, RSIDVARCols, error) {
 	bfile := StringToNTBytes(file)
@@ -442,19 +466,27 @@ func (crv RSIDVARCols) FindVRChromPosRange(first, last uint64, chrom uint8, posM
 
 // NRVKCols contains the NRVK memory mapped file column info.
 type NRVKCols struct {
-	Vk     unsafe.Pointer // Pointer to the VariantKey column.
-	Offset unsafe.Pointer // Pointer to the Offset column.
-	Data   unsafe.Pointer // Pointer to the Data column.
-	NRows  uint64         // Number of rows.
+	Vk        unsafe.Pointer // Pointer to the VariantKey column.
+	Offset    unsafe.Pointer // Pointer to the Offset column (block offsets in the compressed format).
+	Data      unsafe.Pointer // Pointer to the Data column.
+	NRows     uint64         // Number of rows.
+	BlockRows uint64         // Number of rows per block in the compressed format, 0 for the uncompressed format.
+	Hash      unsafe.Pointer // Pointer to the optional hash index slots (nil when the hash index is not loaded).
+	HashBits  uint64         // Number of bits of the hash index slot number.
+	Filter    unsafe.Pointer // Pointer to the optional binary fuse filter of the VariantKey column.
 }
 
 // castCNRVKColsToGo convert C.nrvk_cols_t to GO NRVKCols.
 func castCNRVKColsToGo(nr C.nrvk_cols_t) NRVKCols {
 	return NRVKCols{
-		Vk:     unsafe.Pointer(nr.vk),     // #nosec
-		Offset: unsafe.Pointer(nr.offset), // #nosec
-		Data:   unsafe.Pointer(nr.data),   // #nosec
-		NRows:  uint64(nr.nrows),
+		Vk:        unsafe.Pointer(nr.vk),     // #nosec
+		Offset:    unsafe.Pointer(nr.offset), // #nosec
+		Data:      unsafe.Pointer(nr.data),   // #nosec
+		NRows:     uint64(nr.nrows),
+		BlockRows: uint64(nr.blockrows),
+		Hash:      unsafe.Pointer(nr.hash), // #nosec
+		HashBits:  uint64(nr.hashbits),
+		Filter:    unsafe.Pointer(nr.filter), // #nosec
 	}
 }
 
@@ -465,6 +497,10 @@ func castGoNRVKColsToC(nr NRVKCols) C.nrvk_cols_t {
 	cnr.offset = (*C.uint64_t)(nr.Offset)
 	cnr.data = (*C.uint8_t)(nr.Data)
 	cnr.nrows = C.uint64_t(nr.NRows)
+	cnr.blockrows = C.uint64_t(nr.BlockRows)
+	cnr.hash = (*C.uint64_t)(nr.Hash)
+	cnr.hashbits = C.uint64_t(nr.HashBits)
+	cnr.filter = (*C.uint64_t)(nr.Filter)
 	return cnr
 }
 
@@ -478,10 +514,53 @@ func MmapNRVKFile(file string) (TMMFile, NRVKCols, error) {
 	}
 	var mf C.mmfile_t
 	var rc C.nrvk_cols_t
-	C.mmap_nrvk_file((*C.char)(p), &mf, &rc)
+	e := int(C.mmap_nrvk_file((*C.char)(p), &mf, &rc))
 	if mf.fd < 0 || mf.size == 0 || mf.src == nil {
 		return TMMFile{}, NRVKCols{}, fmt.Errorf("unable to map the file: %s", file)
 	}
+	if e != 0 {
+		return castCTMMFileToGo(mf), NRVKCols{}, fmt.Errorf("unsupported NRVK file format: %s", file)
+	}
+	return castCTMMFileToGo(mf), castCNRVKColsToGo(rc), nil
+}
+
+// MmapNRVKHashFile memory map the NRVK hash index file and returns a copy of the NRVK columns using it.
+func (nr NRVKCols) MmapNRVKHashFile(file string) (TMMFile, NRVKCols, error) {
+	bfile := StringToNTBytes(file)
+	flen := len(bfile)
+	var p unsafe.Pointer
+	if flen > 0 {
+		p = unsafe.Pointer(&bfile[0]) // #nosec
+	}
+	var mf C.mmfile_t
+	rc := castGoNRVKColsToC(nr)
+	C.mmap_nrvk_hash_file((*C.char)(p), &mf, &rc)
+	if mf.fd < 0 || mf.size == 0 || mf.src == nil {
+		return TMMFile{}, nr, fmt.Errorf("unable to map the file: %s", file)
+	}
+	if rc.hash == nil {
+		return castCTMMFileToGo(mf), nr, fmt.Errorf("invalid NRVK hash index: %s", file)
+	}
+	return castCTMMFileToGo(mf), castCNRVKColsToGo(rc), nil
+}
+
+// MmapNRVKFilterFile memory map the binary fuse filter file of the NRVK VariantKey column and returns a copy of the NRVK columns using it.
+func (nr NRVKCols) MmapNRVKFilterFile(file string) (TMMFile, NRVKCols, error) {
+	bfile := StringToNTBytes(file)
+	flen := len(bfile)
+	var p unsafe.Pointer
+	if flen > 0 {
+		p = unsafe.Pointer(&bfile[0]) // #nosec
+	}
+	var mf C.mmfile_t
+	rc := castGoNRVKColsToC(nr)
+	C.mmap_nrvk_filter_file((*C.char)(p), &mf, &rc)
+	if mf.fd < 0 || mf.size == 0 || mf.src == nil {
+		return TMMFile{}, nr, fmt.Errorf("unable to map the file: %s", file)
+	}
+	if rc.filter == nil {
+		return castCTMMFileToGo(mf), nr, fmt.Errorf("invalid filter: %s", file)
+	}
 	return castCTMMFileToGo(mf), castCNRVKColsToGo(rc), nil
 }
 
@@ -61,7 +61,11 @@ setup(
             "-Wformat-security",
             "-Wshadow",
             "-Wno-format-overflow",
+            "-pthread",
             "-I../c/src/variantkey",
+        ],
+        extra_link_args=[
+            "-pthread",
         ])
     ],
     classifiers=[
@@ -18,6 +18,8 @@ set -e -u -x -o pipefail
 : ${VCF_INPUT_FILE:?}               # Input VCF file
 : ${VCF_OUTPUT_NAME:?}              # Name to be used for the output VCF file (e.g. dbsnp)
 : ${REFERENCE_GENOME_FASTA_FILE:?}  # Genome reference genome FASTA file
+: ${GENOREF_FILE:=}                 # Optional binary genome reference file (genoref.bin) used by vcfnorm
+: ${PARALLEL:=4}                    # Number of threads used by vcfnorm
 
 
 if [ -x "$(command -v greadlink)" ]; then READLINK=greadlink; else READLINK=readlink; fi
@@ -25,12 +27,21 @@ SCRIPT_DIR=$(${READLINK} -f $(dirname "$0"))
 VERSION=$(cat ${SCRIPT_DIR}/../../VERSION)
 DATE=$(date -u --iso-8601=d)
 
-# Remove "chr" from chromosome names in the FASTA file
-cat "${REFERENCE_GENOME_FASTA_FILE}" | sed 's/>chrM/>MT/g' | sed 's/>chr/>/g' > genome.fa
-
 # Index the VCF file
 vt index "${VCF_INPUT_FILE}"
 
+# The native "vcfnorm" tool (c/vcfnorm) is used when available together with a binary
+# genome reference file (see fastabin.sh), otherwise the variants are normalized by vt.
+if [ -x "$(command -v vcfnorm)" ] && [ -n "${GENOREF_FILE:-}" ]; then
+
+# Decompose multiallelic variants and normalize the biallelic variants with multiple threads
+vt decompose -s -o - "${VCF_INPUT_FILE}" | vcfnorm -p "${PARALLEL}" "${GENOREF_FILE}" - "${VCF_OUTPUT_NAME}.vcf"
+
+else
+
+# Remove "chr" from chromosome names in the FASTA file
+cat "${REFERENCE_GENOME_FASTA_FILE}" | sed 's/>chrM/>MT/g' | sed 's/>chr/>/g' > genome.fa
+
 # Decompose multiallelic variants into biallelic variants
 vt decompose -s -o decomposed.vcf "${VCF_INPUT_FILE}"
 
@@ -40,6 +51,8 @@ vt normalize -m -r genome.fa -o "${VCF_OUTPUT_NAME}.vcf" decomposed.vcf
 # Remove temporary file
 rm -f decomposed.vcf
 
+fi
+
 # Compress VCF file
 bgzip "${VCF_OUTPUT_NAME}.vcf"
 
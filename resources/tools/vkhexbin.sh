@@ -30,6 +30,21 @@ SCRIPT_DIR=$(${READLINK} -f $(dirname "$0"))
 # generate VariantKey hex files
 bcftools +variantkey-hex "${VCF_INPUT_FILE}"
 
+# The native "vkbin" builder (c/vkbin) is used when available,
+# otherwise the binary files are generated by the equivalent shell scripts.
+if [ -x "$(command -v vkbin)" ]; then
+
+# --- NON-REVERSIBLE VARIANTKEY BINARY FILE
+vkbin nrvk "${NRVK_INPUT_FILE:=nrvk.unsorted.tsv}" "${NRVK_OUTPUT_FILE:=nrvk.bin}"
+
+# --- RSID -> VARIANTKEY BINARY FILE
+vkbin rsvk "${RSVK_INPUT_FILE:=rsvk.unsorted.hex}" "${RSVK_OUTPUT_FILE:=rsvk.bin}"
+
+# --- VARIANTKEY -> RSID BINARY FILE
+vkbin vkrs "${VKRS_INPUT_FILE:=vkrs.unsorted.hex}" "${VKRS_OUTPUT_FILE:=vkrs.bin}"
+
+else
+
 # --- NON-REVERSIBLE VARIANTKEY BINARY FILE
 source "${SCRIPT_DIR}/nrvk.sh"
 
@@ -39,6 +54,8 @@ source "${SCRIPT_DIR}/rsvk.sh"
 # --- VARIANTKEY -> RSID BINARY FILE
 source "${SCRIPT_DIR}/vkrs.sh"
 
+fi
+
 # --- ADD VARIANTKEY TO THE VCF FILE
 
 # Add VariantKey fields in the VCF